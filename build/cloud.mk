@@ -6,8 +6,11 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Cloud/Thermal.cpp \
 	$(SRC)/Cloud/Data.cpp \
 	$(SRC)/Cloud/Sender.cpp \
+	$(SRC)/Cloud/Shard.cpp \
+	$(SRC)/Cloud/Worker.cpp \
+	$(SRC)/Cloud/Cluster.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
+CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS THREAD GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
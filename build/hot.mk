@@ -15,6 +15,7 @@ HOT_SOURCES = \
 	$(SRC)/Terrain/RasterTile.cpp \
 	$(SRC)/Terrain/ScanLine.cpp \
 	$(SRC)/Terrain/Intersection.cpp \
+	$(SRC)/Terrain/HeightPyramid.cpp \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/ui/canvas/memory/Canvas.cpp \
 	$(ENGINE_SRC_DIR)/Waypoints/Waypoints.cpp \
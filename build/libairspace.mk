@@ -16,6 +16,7 @@ AIRSPACE_SOURCES = \
 	$(AIRSPACE_SRC_DIR)/Predicate/OutsideAirspacePredicate.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceIntersectionVisitor.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceWarningConfig.cpp \
+	$(AIRSPACE_SRC_DIR)/AirspaceWarningCandidates.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceWarningManager.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceWarning.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceSorter.cpp
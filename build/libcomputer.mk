@@ -22,6 +22,7 @@ LIBCOMPUTER_SOURCES = \
 	$(SRC)/Computer/ThermalBandComputer.cpp \
 	$(SRC)/Computer/Wind/Computer.cpp \
 	$(SRC)/Computer/ContestComputer.cpp \
+	$(SRC)/Computer/ContestCheckpoint.cpp \
 	$(SRC)/Computer/TraceComputer.cpp \
 	$(SRC)/Computer/WarningComputer.cpp \
 	$(SRC)/Computer/ThermalRecency.cpp \
@@ -175,6 +175,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Task/ProtectedTaskManager.cpp \
 	$(SRC)/Task/FileProtectedTaskManager.cpp \
 	$(SRC)/Task/RoutePlannerGlue.cpp \
+	$(SRC)/Task/AlternateRoutePlanner.cpp \
 	$(SRC)/Task/ProtectedRoutePlanner.cpp \
 	$(SRC)/Task/TaskStore.cpp \
 	$(SRC)/Task/TypeStrings.cpp \
@@ -207,6 +208,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Renderer/TaskProgressRenderer.cpp \
 	$(SRC)/Renderer/ClimbPercentRenderer.cpp \
 	\
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
@@ -86,6 +86,8 @@ TEST_NAMES = \
 	TestUnits TestEarth TestSunEphemeris \
 	TestValidity TestUTM \
 	TestAllocatedGrid \
+	TestRasterShading \
+	TestTerrainIntersection \
 	TestRadixTree TestGeoBounds TestGeoClip \
 	TestLogger TestGRecord TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
@@ -100,6 +102,12 @@ TEST_NAMES = \
 	TestTeamCode \
 	TestZeroFinder \
 	TestAirspaceParser \
+	TestAirspaceEdgeIndex \
+	TestAirspaceCache \
+	TestAirspaceLevels \
+	TestContestCheckpoint \
+	TestTriangleContest \
+	TestTaskDijkstra \
 	TestMETARParser \
 	TestIGCParser \
 	TestStrings TestUTF8 \
@@ -190,6 +198,80 @@ TEST_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
 TEST_AIRSPACE_PARSER_DEPENDS = OPERATION IO OS AIRSPACE ZZIP GEO MATH UTIL
 $(eval $(call link-program,TestAirspaceParser,TEST_AIRSPACE_PARSER))
 
+TEST_AIRSPACE_EDGE_INDEX_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeDialogs.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceEdgeIndex.cpp
+TEST_AIRSPACE_EDGE_INDEX_LDADD = $(FAKE_LIBS)
+TEST_AIRSPACE_EDGE_INDEX_DEPENDS = OPERATION IO OS AIRSPACE ZZIP GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceEdgeIndex,TEST_AIRSPACE_EDGE_INDEX))
+
+TEST_AIRSPACE_CACHE_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/util/MD5.cpp \
+	$(TEST_SRC_DIR)/FakeDialogs.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceCache.cpp
+TEST_AIRSPACE_CACHE_LDADD = $(FAKE_LIBS)
+TEST_AIRSPACE_CACHE_DEPENDS = OPERATION IO OS AIRSPACE ZZIP GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceCache,TEST_AIRSPACE_CACHE))
+
+TEST_AIRSPACE_LEVELS_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeDialogs.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAirspaceLevels.cpp
+TEST_AIRSPACE_LEVELS_LDADD = $(FAKE_LIBS)
+TEST_AIRSPACE_LEVELS_DEPENDS = OPERATION IO OS AIRSPACE ZZIP GEO MATH UTIL
+$(eval $(call link-program,TestAirspaceLevels,TEST_AIRSPACE_LEVELS))
+
+TEST_CONTEST_CHECKPOINT_SOURCES = \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestContestCheckpoint.cpp
+TEST_CONTEST_CHECKPOINT_DEPENDS = CONTEST IO OS GEO MATH TIME UTIL
+$(eval $(call link-program,TestContestCheckpoint,TEST_CONTEST_CHECKPOINT))
+
+TEST_TRIANGLE_CONTEST_SOURCES = \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTriangleContest.cpp
+TEST_TRIANGLE_CONTEST_DEPENDS = CONTEST IO OS GEO MATH TIME UTIL
+$(eval $(call link-program,TestTriangleContest,TEST_TRIANGLE_CONTEST))
+
+TEST_TASK_DIJKSTRA_SOURCES = \
+	$(ENGINE_SRC_DIR)/Task/PathSolvers/TaskDijkstra.cpp \
+	$(ENGINE_SRC_DIR)/Task/PathSolvers/TaskDijkstraMin.cpp \
+	$(ENGINE_SRC_DIR)/Task/PathSolvers/TaskDijkstraMax.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTaskDijkstra.cpp
+TEST_TASK_DIJKSTRA_DEPENDS = GEO MATH UTIL
+$(eval $(call link-program,TestTaskDijkstra,TEST_TASK_DIJKSTRA))
+
 TEST_DATE_TIME_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestDateTime.cpp
@@ -305,7 +387,7 @@ TEST_REACH_SOURCES = \
 	$(TEST_SRC_DIR)/Printing.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/test_reach.cpp
-TEST_REACH_DEPENDS = TERRAIN OPERATION IO ZZIP OS ROUTE GLIDE GEO MATH UTIL
+TEST_REACH_DEPENDS = TERRAIN OPERATION IO ZZIP OS ROUTE GLIDE GEO MATH THREAD UTIL
 $(eval $(call link-program,test_reach,TEST_REACH))
 
 TEST_ROUTE_SOURCES = \
@@ -613,6 +695,20 @@ TEST_ALLOCATED_GRID_SOURCES = \
 TEST_ALLOCATED_GRID_DEPENDS = UTIL
 $(eval $(call link-program,TestAllocatedGrid,TEST_ALLOCATED_GRID))
 
+TEST_RASTER_SHADING_SOURCES = \
+	$(SRC)/Terrain/RasterShading.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterShading.cpp
+TEST_RASTER_SHADING_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,TestRasterShading,TEST_RASTER_SHADING))
+
+TEST_TERRAIN_INTERSECTION_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTerrainIntersection.cpp
+TEST_TERRAIN_INTERSECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
+TEST_TERRAIN_INTERSECTION_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,TestTerrainIntersection,TEST_TERRAIN_INTERSECTION))
+
 TEST_RADIX_TREE_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestRadixTree.cpp
@@ -729,6 +825,9 @@ DEBUG_PROGRAM_NAMES = \
 	TestTrace \
 	FlightTable \
 	BenchmarkProjection \
+	BenchmarkRasterRenderer \
+	BenchmarkTerrainIntersection \
+	BenchmarkAirspaceWarnings \
 	BenchmarkFAITriangleSector \
 	DumpTextFile DumpTextZip DumpTextInflate \
 	DumpHexColor \
@@ -738,6 +837,7 @@ DEBUG_PROGRAM_NAMES = \
 	ReadGRecord VerifyGRecord AppendGRecord FixGRecord \
 	AddChecksum \
 	LoadTopography LoadTerrain \
+	ConvertTerrainTiles BenchmarkTerrainTiles \
 	RunHeightMatrix \
 	RunInputParser \
 	RunWaypointParser RunAirspaceParser \
@@ -748,7 +848,7 @@ DEBUG_PROGRAM_NAMES = \
 	TaskInfo DumpTaskFile \
 	DumpFlarmNet \
 	RunRepositoryParser \
-	NearestWaypoints \
+	NearestWaypoints BenchmarkNearestWaypoints \
 	RunKalmanFilter1d \
 	ArcApprox
 
@@ -757,6 +857,9 @@ ifeq ($(TARGET_IS_ANDROID),n)
 DEBUG_PROGRAM_NAMES += \
 	RunTrace \
 	RunContestAnalysis \
+	BenchmarkContest \
+	BenchmarkDijkstra \
+	BenchmarkMacCready \
 	RunWaveComputer \
 	FlightPath \
 	ReadProfileString ReadProfileInt \
@@ -815,7 +918,7 @@ DEBUG_PROGRAM_NAMES += DownloadFile \
 	UploadFile \
 	RunWeGlideClient \
 	RunTimClient \
-	RunNOAADownloader RunSkyLinesTracking RunLiveTrack24
+	RunNOAADownloader RunSkyLinesTracking RunSkyLinesLoad RunLiveTrack24
 endif
 
 ifeq ($(TARGET_IS_LINUX),y)
@@ -890,6 +993,20 @@ BENCHMARK_PROJECTION_DEPENDS = MATH
 BENCHMARK_PROJECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,BenchmarkProjection,BENCHMARK_PROJECTION))
 
+BENCHMARK_RASTER_RENDERER_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(TEST_SRC_DIR)/BenchmarkRasterRenderer.cpp
+BENCHMARK_RASTER_RENDERER_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_RASTER_RENDERER_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkRasterRenderer,BENCHMARK_RASTER_RENDERER))
+
+BENCHMARK_TERRAIN_INTERSECTION_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkTerrainIntersection.cpp
+BENCHMARK_TERRAIN_INTERSECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_INTERSECTION_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainIntersection,BENCHMARK_TERRAIN_INTERSECTION))
+
 BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleSettings.cpp \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleArea.cpp \
@@ -1011,6 +1128,17 @@ RUN_SL_TRACKING_SOURCES = \
 RUN_SL_TRACKING_DEPENDS = $(DEBUG_REPLAY_DEPENDS)
 $(eval $(call link-program,RunSkyLinesTracking,RUN_SL_TRACKING))
 
+RUN_SL_LOAD_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/net/SocketError.cxx \
+	$(SRC)/Tracking/SkyLines/Client.cpp \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Formatter/NMEAFormatter.cpp \
+	$(SRC)/TransponderCode.cpp \
+	$(TEST_SRC_DIR)/RunSkyLinesLoad.cpp
+RUN_SL_LOAD_DEPENDS = $(DEBUG_REPLAY_DEPENDS)
+$(eval $(call link-program,RunSkyLinesLoad,RUN_SL_LOAD))
+
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/net/SocketError.cxx \
@@ -1138,6 +1266,19 @@ LOAD_TERRAIN_CPPFLAGS = $(SCREEN_CPPFLAGS)
 LOAD_TERRAIN_DEPENDS = TERRAIN OPERATION GEO MATH OS IO ZZIP UTIL
 $(eval $(call link-program,LoadTerrain,LOAD_TERRAIN))
 
+CONVERT_TERRAIN_TILES_SOURCES = \
+	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
+	$(TEST_SRC_DIR)/ConvertTerrainTiles.cpp
+CONVERT_TERRAIN_TILES_CPPFLAGS = $(SCREEN_CPPFLAGS)
+CONVERT_TERRAIN_TILES_DEPENDS = TERRAIN OPERATION GEO MATH OS IO ZZIP UTIL
+$(eval $(call link-program,ConvertTerrainTiles,CONVERT_TERRAIN_TILES))
+
+BENCHMARK_TERRAIN_TILES_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkTerrainTiles.cpp
+BENCHMARK_TERRAIN_TILES_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_TILES_DEPENDS = TERRAIN OPERATION GEO MATH OS IO ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainTiles,BENCHMARK_TERRAIN_TILES))
+
 RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
@@ -1202,6 +1343,11 @@ NEAREST_WAYPOINTS_LDADD = $(FAKE_LIBS)
 NEAREST_WAYPOINTS_DEPENDS = WAYPOINT OPERATION IO OS THREAD ZZIP GEO MATH UTIL
 $(eval $(call link-program,NearestWaypoints,NEAREST_WAYPOINTS))
 
+BENCHMARK_NEAREST_WAYPOINTS_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkNearestWaypoints.cpp
+BENCHMARK_NEAREST_WAYPOINTS_DEPENDS = WAYPOINT GEO MATH UTIL
+$(eval $(call link-program,BenchmarkNearestWaypoints,BENCHMARK_NEAREST_WAYPOINTS))
+
 RUN_FLIGHT_PARSER_SOURCES = \
 	$(SRC)/Logger/FlightParser.cpp \
 	$(TEST_SRC_DIR)/RunFlightParser.cpp
@@ -1211,6 +1357,8 @@ $(eval $(call link-program,RunFlightParser,RUN_FLIGHT_PARSER))
 
 RUN_AIRSPACE_PARSER_SOURCES = \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/util/MD5.cpp \
 	$(SRC)/Units/Descriptor.cpp \
 	$(SRC)/Units/System.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
@@ -1583,6 +1731,17 @@ RUN_TASK_SOURCES = \
 RUN_TASK_DEPENDS = $(DEBUG_REPLAY_DEPENDS) TASKFILE WAYPOINT GLIDE GEO MATH UTIL IO TIME
 $(eval $(call link-program,RunTask,RUN_TASK))
 
+BENCHMARK_AIRSPACE_WARNINGS_SOURCES = \
+	$(SRC)/NMEA/Aircraft.cpp \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/TransponderCode.cpp \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspaceWarnings.cpp
+BENCHMARK_AIRSPACE_WARNINGS_DEPENDS = $(DEBUG_REPLAY_DEPENDS) AIRSPACE OPERATION ZZIP GEO MATH UTIL IO TIME
+$(eval $(call link-program,BenchmarkAirspaceWarnings,BENCHMARK_AIRSPACE_WARNINGS))
+
 RUN_TRACE_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/IGC/IGCParser.cpp \
@@ -1610,6 +1769,36 @@ RUN_CONTEST_SOURCES = \
 RUN_CONTEST_DEPENDS = $(DEBUG_REPLAY_DEPENDS) CONTEST UTIL GEO MATH TIME
 $(eval $(call link-program,RunContestAnalysis,RUN_CONTEST))
 
+BENCHMARK_CONTEST_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/TransponderCode.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkContest.cpp
+BENCHMARK_CONTEST_DEPENDS = $(DEBUG_REPLAY_DEPENDS) CONTEST UTIL GEO MATH TIME
+$(eval $(call link-program,BenchmarkContest,BENCHMARK_CONTEST))
+
+BENCHMARK_DIJKSTRA_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/TransponderCode.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(ENGINE_SRC_DIR)/Task/PathSolvers/TaskDijkstra.cpp \
+	$(ENGINE_SRC_DIR)/Task/PathSolvers/TaskDijkstraMin.cpp \
+	$(ENGINE_SRC_DIR)/Task/PathSolvers/TaskDijkstraMax.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkDijkstra.cpp
+BENCHMARK_DIJKSTRA_DEPENDS = $(DEBUG_REPLAY_DEPENDS) CONTEST UTIL GEO MATH TIME
+$(eval $(call link-program,BenchmarkDijkstra,BENCHMARK_DIJKSTRA))
+
+BENCHMARK_MAC_CREADY_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkMacCready.cpp
+BENCHMARK_MAC_CREADY_DEPENDS = GLIDE GEO MATH UTIL
+$(eval $(call link-program,BenchmarkMacCready,BENCHMARK_MAC_CREADY))
+
 RUN_WAVE_COMPUTER_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/Computer/WaveComputer.cpp \
@@ -1768,6 +1957,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(SRC)/Task/ProtectedRoutePlanner.cpp \
 	$(SRC)/Task/RoutePlannerGlue.cpp \
+	$(SRC)/Task/AlternateRoutePlanner.cpp \
 	$(SRC)/Units/Units.cpp \
 	$(SRC)/Units/Settings.cpp \
 	$(SRC)/Units/Descriptor.cpp \
@@ -2129,6 +2319,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Task/ProtectedTaskManager.cpp \
 	$(SRC)/Task/ProtectedRoutePlanner.cpp \
 	$(SRC)/Task/RoutePlannerGlue.cpp \
+	$(SRC)/Task/AlternateRoutePlanner.cpp \
 	$(SRC)/Waypoint/WaypointReaderBase.cpp \
 	$(SRC)/Waypoint/WaypointReaderSeeYou.cpp \
 	$(SRC)/Waypoint/Factory.cpp \
@@ -2212,7 +2403,9 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ActivePredicate.cpp \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/util/MD5.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/AirspaceRendererSettings.cpp \
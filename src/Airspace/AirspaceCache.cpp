@@ -0,0 +1,314 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "io/FileCache.hpp"
+#include "io/FileMapping.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "io/Reader.hxx"
+#include "util/tstring.hpp"
+#include "util/tstring_view.hxx"
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <string.h>
+#include <tchar.h>
+
+static constexpr const TCHAR *airspace_cache_name = _T("airspace");
+
+/**
+ * The file starts with this header, followed by the arrays of
+ * #AirspaceCacheRecord, #AirspaceCachePoint and TCHAR.  The cache is
+ * only used on the machine which wrote it, therefore everything is
+ * stored in host format.
+ */
+struct AirspaceCacheHeader {
+  static constexpr uint32_t MAGIC = 0x41535043;
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic, version;
+
+  char digest[MD5::DIGEST_LENGTH];
+
+  GeoBounds projection_bounds;
+
+  uint32_t n_airspaces, n_points, n_chars;
+};
+
+struct AirspaceCacheRecord {
+  AirspaceAltitude base, top;
+
+  /**
+   * Only used by circles.
+   */
+  GeoPoint center;
+  double radius;
+
+  FlatBoundingBox box;
+
+  /**
+   * The border of a polygon (including the closing point), as a
+   * range of the point array.
+   */
+  uint32_t first_point, n_points;
+
+  uint32_t name_offset, name_length, type_offset, type_length;
+
+  RadioFrequency radio_frequency;
+  AbstractAirspace::Shape shape;
+  AirspaceClass asclass;
+  AirspaceActivity days;
+};
+
+struct AirspaceCachePoint {
+  GeoPoint location;
+  FlatGeoPoint flat_location;
+};
+
+void
+AirspaceCacheKey::Update(Reader &reader)
+{
+  std::byte buffer[16384];
+  uint64_t size = 0;
+
+  while (true) {
+    const std::size_t nbytes = reader.Read(buffer, sizeof(buffer));
+    if (nbytes == 0)
+      break;
+
+    md5.Append(buffer, nbytes);
+    size += nbytes;
+  }
+
+  /* mark the end of this file, so moving data from one file to the
+     next changes the digest */
+  md5.Append(&size, sizeof(size));
+}
+
+void
+AirspaceCacheKey::Finish() noexcept
+{
+  md5.Finalize();
+  md5.GetDigest(digest.data());
+}
+
+void
+SaveAirspaceCache(FileCache &cache, Path original_path,
+                  const AirspaceCacheKey &key, const Airspaces &airspaces)
+{
+  assert(!airspaces.IsEmpty());
+
+  std::vector<AirspaceCacheRecord> records;
+  records.reserve(airspaces.GetSize());
+
+  std::vector<AirspaceCachePoint> points;
+  tstring strings;
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+
+    AirspaceCacheRecord &record = records.emplace_back();
+
+    /* zero-fill all implicit padding bytes (to make valgrind happy) */
+    memset((void *)&record, 0, sizeof(record));
+
+    record.base = airspace.GetBase();
+    record.top = airspace.GetTop();
+    record.box = i;
+    record.radio_frequency = airspace.GetRadioFrequency();
+    record.shape = airspace.GetShape();
+    record.asclass = airspace.GetClass();
+    record.days = airspace.GetDays();
+
+    const tstring_view name = airspace.GetName();
+    record.name_offset = strings.size();
+    record.name_length = name.size();
+    strings.append(name);
+
+    const tstring_view type = airspace.GetType();
+    record.type_offset = strings.size();
+    record.type_length = type.size();
+    strings.append(type);
+
+    switch (airspace.GetShape()) {
+    case AbstractAirspace::Shape::CIRCLE: {
+      const auto &circle = (const AirspaceCircle &)airspace;
+      record.center = circle.GetCenter();
+      record.radius = circle.GetRadius();
+      break;
+    }
+
+    case AbstractAirspace::Shape::POLYGON:
+      record.first_point = points.size();
+      record.n_points = airspace.GetPoints().size();
+
+      for (const auto &p : airspace.GetPoints())
+        points.push_back({p.GetLocation(), p.GetFlatLocation()});
+      break;
+    }
+  }
+
+  AirspaceCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = AirspaceCacheHeader::MAGIC;
+  header.version = AirspaceCacheHeader::VERSION;
+  key.GetDigest().copy(header.digest, sizeof(header.digest));
+  header.projection_bounds = airspaces.GetProjectionBounds();
+  header.n_airspaces = records.size();
+  header.n_points = points.size();
+  header.n_chars = strings.size();
+
+  auto os = cache.Save(airspace_cache_name, original_path);
+  BufferedOutputStream bos(*os);
+  bos.WriteT(header);
+  bos.Write(std::as_bytes(std::span{records}));
+  bos.Write(std::as_bytes(std::span{points}));
+  bos.Write(std::as_bytes(std::span{strings}));
+  bos.Flush();
+  os->Commit();
+}
+
+/**
+ * Copy an object from the mapped file, which may not be aligned
+ * properly.
+ */
+template<typename T>
+static T
+ReadAt(const std::byte *p, std::size_t i) noexcept
+{
+  T value;
+  memcpy(&value, p + i * sizeof(T), sizeof(T));
+  return value;
+}
+
+static AirspacePtr
+LoadPolygon(const AirspaceCacheRecord &record, const std::byte *points,
+            uint32_t n_points)
+{
+  if (record.n_points < 3 || record.first_point > n_points ||
+      record.n_points > n_points - record.first_point)
+    throw std::runtime_error("Malformed airspace polygon");
+
+  SearchPointVector border;
+  border.reserve(record.n_points);
+
+  for (uint32_t j = 0; j < record.n_points; ++j) {
+    const auto p = ReadAt<AirspaceCachePoint>(points,
+                                              record.first_point + j);
+    border.emplace_back(p.location, p.flat_location);
+  }
+
+  if (border.front().GetLocation() != border.back().GetLocation())
+    throw std::runtime_error("Airspace polygon not closed");
+
+  return std::make_shared<AirspacePolygon>(std::move(border));
+}
+
+static AirspacePtr
+LoadCircle(const AirspaceCacheRecord &record)
+{
+  if (!record.center.IsValid() || !(record.radius > 0))
+    throw std::runtime_error("Malformed airspace circle");
+
+  return std::make_shared<AirspaceCircle>(record.center, record.radius);
+}
+
+static tstring
+GetString(tstring_view strings, uint32_t offset, uint32_t length)
+{
+  if (offset > strings.size() || length > strings.size() - offset)
+    throw std::runtime_error("Malformed airspace name");
+
+  return tstring{strings.substr(offset, length)};
+}
+
+bool
+LoadAirspaceCache(FileCache &cache, Path original_path,
+                  const AirspaceCacheKey &key, Airspaces &airspaces)
+{
+  const auto mapping = cache.Map(airspace_cache_name, original_path);
+  if (!mapping)
+    return false;
+
+  const auto payload = FileCache::SkipHeader(*mapping);
+  if (payload.size() < sizeof(AirspaceCacheHeader))
+    throw std::runtime_error("Airspace cache too small");
+
+  const auto header = ReadAt<AirspaceCacheHeader>(payload.data(), 0);
+  if (header.magic != AirspaceCacheHeader::MAGIC ||
+      header.version != AirspaceCacheHeader::VERSION)
+    throw std::runtime_error("Wrong airspace cache version");
+
+  if (key.GetDigest() != std::string_view{header.digest, sizeof(header.digest)})
+    /* the airspace files have been modified */
+    return false;
+
+  const uint64_t records_size =
+    uint64_t(header.n_airspaces) * sizeof(AirspaceCacheRecord);
+  const uint64_t points_size =
+    uint64_t(header.n_points) * sizeof(AirspaceCachePoint);
+  const uint64_t strings_size = uint64_t(header.n_chars) * sizeof(TCHAR);
+
+  if (header.n_airspaces == 0 || !header.projection_bounds.IsValid() ||
+      sizeof(header) + records_size + points_size + strings_size !=
+      payload.size())
+    throw std::runtime_error("Malformed airspace cache");
+
+  const std::byte *records = payload.data() + sizeof(header);
+  const std::byte *points = records + records_size;
+
+  /* copy the string pool, because it may not be aligned properly */
+  tstring strings(header.n_chars, _T('\0'));
+  memcpy(strings.data(), points + points_size, strings_size);
+
+  const TaskProjection projection(header.projection_bounds);
+
+  Airspaces::AirspaceVector v;
+  v.reserve(header.n_airspaces);
+
+  for (uint32_t i = 0; i < header.n_airspaces; ++i) {
+    const auto record = ReadAt<AirspaceCacheRecord>(records, i);
+    if (unsigned(record.asclass) >= AIRSPACECLASSCOUNT)
+      throw std::runtime_error("Malformed airspace class");
+
+    AirspacePtr airspace;
+    switch (record.shape) {
+    case AbstractAirspace::Shape::CIRCLE:
+      airspace = LoadCircle(record);
+      break;
+
+    case AbstractAirspace::Shape::POLYGON:
+      airspace = LoadPolygon(record, points, header.n_points);
+      break;
+
+    default:
+      throw std::runtime_error("Malformed airspace shape");
+    }
+
+    airspace->SetProperties(GetString(strings, record.name_offset,
+                                      record.name_length),
+                            record.asclass,
+                            GetString(strings, record.type_offset,
+                                      record.type_length),
+                            record.base, record.top);
+    airspace->SetRadioFrequency(record.radio_frequency);
+    airspace->SetDays(record.days);
+
+    if (record.shape == AbstractAirspace::Shape::CIRCLE)
+      /* the border of a circle is cheap to calculate and project */
+      v.emplace_back(std::move(airspace), projection);
+    else
+      v.emplace_back(std::move(airspace), record.box);
+  }
+
+  airspaces.Restore(header.projection_bounds, v);
+  return true;
+}
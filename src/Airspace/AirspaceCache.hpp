@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "util/MD5.hpp"
+
+#include <array>
+#include <string_view>
+
+class Airspaces;
+class FileCache;
+class Path;
+class Reader;
+
+/**
+ * Identifies the contents of all airspace files which were parsed
+ * into an #Airspaces object.  The airspace cache is only used if
+ * its key matches.
+ */
+class AirspaceCacheKey {
+  MD5 md5;
+
+  std::array<char, MD5::DIGEST_LENGTH + 1> digest;
+
+public:
+  AirspaceCacheKey() noexcept {
+    md5.Initialise();
+    digest[0] = 0;
+  }
+
+  /**
+   * Add the contents of an airspace file.  Call this for all files,
+   * in the order in which they are parsed.
+   *
+   * Throws on error.
+   */
+  void Update(Reader &reader);
+
+  /**
+   * Call this after the last Update().
+   */
+  void Finish() noexcept;
+
+  std::string_view GetDigest() const noexcept {
+    return {digest.data(), MD5::DIGEST_LENGTH};
+  }
+};
+
+/**
+ * Store the airspaces (after Airspaces::Optimise()) with their
+ * projected borders and bounding boxes in the #FileCache.
+ *
+ * Throws on error.
+ *
+ * @param original_path one of the airspace files; the cache is
+ * discarded when it gets modified
+ */
+void
+SaveAirspaceCache(FileCache &cache, Path original_path,
+                  const AirspaceCacheKey &key, const Airspaces &airspaces);
+
+/**
+ * Load the airspaces from a memory-mapped file which was written by
+ * SaveAirspaceCache(), replacing the contents of the given
+ * #Airspaces object.  This skips parsing and projecting.
+ *
+ * Throws on error.
+ *
+ * @return false if there is no (current) cache
+ */
+bool
+LoadAirspaceCache(FileCache &cache, Path original_path,
+                  const AirspaceCacheKey &key, Airspaces &airspaces);
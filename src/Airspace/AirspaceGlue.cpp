@@ -3,6 +3,7 @@
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Atmosphere/Pressure.hpp"
 #include "Profile/Keys.hpp"
@@ -11,12 +12,16 @@
 #include "LogFile.hpp"
 #include "system/Path.hpp"
 #include "io/FileLineReader.hpp"
+#include "io/FileReader.hxx"
 #include "io/ZipArchive.hpp"
 #include "io/ZipLineReader.hpp"
+#include "io/ZipReader.hpp"
 #include "io/MapFile.hpp"
 #include "util/RuntimeError.hxx"
 #include "Profile/Profile.hpp"
 
+#include <optional>
+
 #include <string.h>
 
 static bool
@@ -62,37 +67,115 @@ try {
   return false;
 }
 
+/**
+ * Calculate the #AirspaceCacheKey of all configured airspace files.
+ *
+ * Throws on error.
+ */
+static AirspaceCacheKey
+MakeCacheKey(Path path, Path additional_path, ZipArchive *archive)
+{
+  AirspaceCacheKey key;
+
+  if (path != nullptr) {
+    FileReader reader(path);
+    key.Update(reader);
+  }
+
+  if (additional_path != nullptr) {
+    FileReader reader(additional_path);
+    key.Update(reader);
+  }
+
+  if (archive != nullptr) {
+    ZipReader reader(archive->get(), "airspace.txt");
+    key.Update(reader);
+  }
+
+  key.Finish();
+  return key;
+}
+
 void
-ReadAirspace(Airspaces &airspaces,
+ReadAirspace(Airspaces &airspaces, FileCache *cache,
              AtmosphericPressure press,
              OperationEnvironment &operation)
 {
   LogString("ReadAirspace");
   operation.SetText(_("Loading Airspace File..."));
 
-  bool airspace_ok = false;
-
   // Read the airspace filenames from the registry
-  if (const auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
-      path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
-
-  if (const auto path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
-      path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+  const auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
+  const auto additional_path =
+    Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
+  const auto map_path = Profile::GetPath(ProfileKeys::MapFile);
 
+  std::optional<ZipArchive> archive;
   try {
-    if (auto archive = OpenMapFile();
-        archive && archive->Exists("airspace.txt"))
-      airspace_ok |= ParseAirspaceFile(airspaces, archive->get(),
-                                       "airspace.txt", operation);
+    if (archive = OpenMapFile(); archive && !archive->Exists("airspace.txt"))
+      archive.reset();
   } catch (...) {
     LogError(std::current_exception(),
              "Failed to load airspaces from map file");
   }
 
+  /* the cache is discarded when the first airspace file gets
+     modified, and its contents are verified with the key */
+  const Path cache_path = path != nullptr
+    ? Path{path}
+    : (additional_path != nullptr
+       ? Path{additional_path}
+       : (archive ? Path{map_path} : nullptr));
+
+  std::optional<AirspaceCacheKey> key;
+  if (cache != nullptr && cache_path != nullptr) {
+    try {
+      key = MakeCacheKey(path, additional_path,
+                         archive ? &*archive : nullptr);
+
+      if (LoadAirspaceCache(*cache, cache_path, *key, airspaces)) {
+        LogString("Loaded airspace cache");
+        airspaces.SetFlightLevels(press);
+        return;
+      }
+    } catch (...) {
+      LogError(std::current_exception(), "Failed to load airspace cache");
+      airspaces.Clear();
+    }
+  }
+
+  bool airspace_ok = false, all_ok = true;
+
+  if (path != nullptr) {
+    const bool ok = ParseAirspaceFile(airspaces, path, operation);
+    airspace_ok |= ok;
+    all_ok &= ok;
+  }
+
+  if (additional_path != nullptr) {
+    const bool ok = ParseAirspaceFile(airspaces, additional_path, operation);
+    airspace_ok |= ok;
+    all_ok &= ok;
+  }
+
+  if (archive) {
+    const bool ok = ParseAirspaceFile(airspaces, archive->get(),
+                                      "airspace.txt", operation);
+    airspace_ok |= ok;
+    all_ok &= ok;
+  }
+
   if (airspace_ok) {
     airspaces.Optimise();
+
+    if (key && all_ok && !airspaces.IsEmpty()) {
+      try {
+        SaveAirspaceCache(*cache, cache_path, *key, airspaces);
+      } catch (...) {
+        LogError(std::current_exception(), "Failed to save airspace cache");
+      }
+    }
+
     airspaces.SetFlightLevels(press);
   } else
     // there was a problem
@@ -7,12 +7,16 @@ class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
 class OperationEnvironment;
+class FileCache;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, then the parsed airspaces are loaded
+ * from (or stored in) this cache
  */
 void
-ReadAirspace(Airspaces &airspaces,
+ReadAirspace(Airspaces &airspaces, FileCache *cache,
              AtmosphericPressure press,
              OperationEnvironment &operation);
 
@@ -42,14 +42,31 @@ CloudClient &
 CloudClientContainer::Make(SocketAddress address,
                            uint64_t key,
                            const GeoPoint &location, int altitude)
+{
+  auto *client = Find(key);
+  if (client == nullptr)
+    return Make(address, key, next_id, location, altitude);
+
+  Refresh(*client, address, location, altitude);
+  return *client;
+}
+
+CloudClient &
+CloudClientContainer::Make(SocketAddress address,
+                           uint64_t key, unsigned id,
+                           const GeoPoint &location, int altitude)
 {
   KeySet::insert_commit_data hint;
   auto result = key_set.insert_check(key, key_set.hash_function(),
                                      key_set.key_eq(), hint);
   if (result.second) {
-    auto client = std::make_shared<CloudClient>(address, key, next_id++,
+    auto client = std::make_shared<CloudClient>(address, key, id,
                                                 location, altitude);
     Insert(*client);
+
+    if (id >= next_id)
+      next_id = id + 1;
+
     return *client;
   } else {
     auto &client = *result.first;
@@ -58,6 +75,14 @@ CloudClientContainer::Make(SocketAddress address,
   }
 }
 
+CloudClient &
+CloudClientContainer::InsertCopy(const CloudClient &src)
+{
+  auto client = std::make_shared<CloudClient>(src);
+  Insert(*client);
+  return *client;
+}
+
 void
 CloudClientContainer::Refresh(CloudClient &client,
                               SocketAddress address)
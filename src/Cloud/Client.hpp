@@ -215,12 +215,38 @@ public:
   [[gnu::pure]]
   CloudClient *Find(uint64_t key);
 
+  /**
+   * The public id which will be assigned to the next new
+   * #CloudClient.
+   */
+  unsigned GetNextId() const noexcept {
+    return next_id;
+  }
+
+  void SetNextId(unsigned _next_id) noexcept {
+    next_id = _next_id;
+  }
+
   /**
    * Create a new #CloudClient, or refresh the existing one.
    */
   CloudClient &Make(SocketAddress address,
                     uint64_t key, const GeoPoint &location, int altitude);
 
+  /**
+   * Like Make(), but assign the given public id to a new
+   * #CloudClient.  This is used when the id is managed by somebody
+   * else, e.g. by the sharded server.
+   */
+  CloudClient &Make(SocketAddress address, uint64_t key, unsigned id,
+                    const GeoPoint &location, int altitude);
+
+  /**
+   * Insert a copy of the given #CloudClient (from another
+   * container).
+   */
+  CloudClient &InsertCopy(const CloudClient &src);
+
   void Refresh(CloudClient &client,
                SocketAddress address);
 
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Cluster.hpp"
+#include "Worker.hpp"
+#include "Data.hpp"
+#include "util/ScopeExit.hxx"
+
+#include <algorithm>
+#include <cassert>
+
+CloudCluster::CloudCluster(EventLoop &_main_loop, unsigned n_workers,
+                           std::chrono::steady_clock::duration _traffic_delay,
+                           SocketAddress bind_address)
+  :main_loop(_main_loop),
+   shard_map(n_workers, CloudWorker::SHARD_RANGE),
+   traffic_delay(_traffic_delay),
+   barrier(n_workers + 1)
+{
+  assert(n_workers > 0);
+  assert(n_workers <= CloudShardMap::MAX_SHARDS);
+
+  workers.reserve(n_workers);
+  for (unsigned i = 0; i < n_workers; ++i)
+    workers.emplace_back(std::make_unique<CloudWorker>(*this, i,
+                                                       bind_address));
+}
+
+CloudCluster::~CloudCluster() noexcept
+{
+  Stop();
+}
+
+unsigned
+CloudCluster::GetId(uint64_t key) noexcept
+{
+  const std::scoped_lock lock{id_mutex};
+  auto [i, inserted] = ids.try_emplace(key, next_id);
+  if (inserted)
+    ++next_id;
+  return i->second;
+}
+
+void
+CloudCluster::Load(const CloudData &src)
+{
+  /* insert the oldest first, because the containers expect the
+     freshest items at the front */
+
+  std::vector<const CloudClient *> clients;
+  for (const auto &client : src.clients)
+    clients.push_back(&client);
+
+  std::sort(clients.begin(), clients.end(), [](auto a, auto b){
+    return a->stamp < b->stamp;
+  });
+
+  for (const auto *client : clients) {
+    ids.emplace(client->key, client->id);
+
+    CloudShardMap::ForEach(shard_map.GetShards(client->location),
+                           [this, client](unsigned i){
+                             workers[i]->GetData().clients.InsertCopy(*client);
+                           });
+  }
+
+  next_id = std::max(next_id, src.clients.GetNextId());
+
+  std::vector<const CloudThermal *> thermals;
+  for (const auto &thermal : src.thermals)
+    thermals.push_back(&thermal);
+
+  std::sort(thermals.begin(), thermals.end(), [](auto a, auto b){
+    return a->time < b->time;
+  });
+
+  for (const auto *thermal : thermals)
+    CloudShardMap::ForEach(shard_map.GetShards(thermal->top_location) |
+                           shard_map.GetShards(thermal->bottom_location),
+                           [this, thermal](unsigned i){
+                             workers[i]->GetData().thermals.InsertCopy(*thermal);
+                           });
+}
+
+void
+CloudCluster::Start()
+{
+  for (auto &i : workers)
+    i->Start();
+}
+
+void
+CloudCluster::Stop() noexcept
+{
+  for (auto &i : workers)
+    i->Stop();
+}
+
+void
+CloudCluster::Snapshot(CloudData &dest)
+{
+  assert(dest.clients.empty());
+  assert(dest.thermals.empty());
+
+  for (auto &i : workers)
+    i->SchedulePause();
+
+  /* wait until all workers have stopped receiving datagrams */
+  barrier.arrive_and_wait();
+
+  /* wait until all workers have handled the messages which were in
+     flight */
+  barrier.arrive_and_wait();
+
+  /* resume the workers when we're done */
+  AtScopeExit(this) { barrier.arrive_and_wait(); };
+
+  /* collect the objects from their owners; the other shards have
+     only copies */
+
+  std::vector<const CloudClient *> clients;
+  std::vector<const CloudThermal *> thermals;
+
+  for (unsigned i = 0; i < workers.size(); ++i) {
+    const auto &data = workers[i]->GetData();
+
+    for (const auto &client : data.clients)
+      if (shard_map.GetShard(client.location) == i)
+        clients.push_back(&client);
+
+    for (const auto &thermal : data.thermals)
+      if (shard_map.GetShard(thermal.top_location) == i)
+        thermals.push_back(&thermal);
+  }
+
+  std::sort(clients.begin(), clients.end(), [](auto a, auto b){
+    return a->stamp < b->stamp;
+  });
+
+  for (const auto *client : clients) {
+    /* if a stale copy claims to be the owner as well (which can
+       happen if the client's address has changed), the freshest one
+       wins */
+    if (auto *old = dest.clients.Find(client->key))
+      dest.clients.Remove(*old);
+
+    dest.clients.InsertCopy(*client);
+  }
+
+  std::sort(thermals.begin(), thermals.end(), [](auto a, auto b){
+    return a->time < b->time;
+  });
+
+  for (const auto *thermal : thermals)
+    dest.thermals.InsertCopy(*thermal);
+
+  /* forget the ids of clients which are gone */
+  const std::scoped_lock lock{id_mutex};
+
+  std::erase_if(ids, [this, &dest](const auto &i){
+    return dest.clients.Find(i.first) == nullptr &&
+      std::none_of(workers.begin(), workers.end(), [&i](const auto &w){
+        return w->HasRoute(i.first);
+      });
+  });
+
+  dest.clients.SetNextId(next_id);
+}
@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Shard.hpp"
+#include "thread/Mutex.hxx"
+
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class EventLoop;
+class SocketAddress;
+class CloudWorker;
+struct CloudData;
+
+/**
+ * The set of #CloudWorker threads of the cloud server.
+ */
+class CloudCluster {
+  EventLoop &main_loop;
+
+  const CloudShardMap shard_map;
+
+  /**
+   * See CloudWorker::DEFAULT_TRAFFIC_DELAY.  Zero sends new traffic
+   * immediately, one datagram per pilot and subscriber.
+   */
+  const std::chrono::steady_clock::duration traffic_delay;
+
+  std::vector<std::unique_ptr<CloudWorker>> workers;
+
+  /**
+   * Synchronises the workers and the main thread in Snapshot().
+   */
+  std::barrier<> barrier;
+
+  /**
+   * Protects #ids and #next_id.
+   */
+  Mutex id_mutex;
+
+  /**
+   * Map the secret key of each client to its public id.  The ids
+   * are managed here, because all shards need to agree on them.
+   */
+  std::unordered_map<uint64_t, unsigned> ids;
+
+  unsigned next_id = 1;
+
+public:
+  /**
+   * Throws on error.
+   *
+   * @param main_loop the #EventLoop of the main thread; it is
+   * stopped when a worker fails
+   */
+  CloudCluster(EventLoop &_main_loop, unsigned n_workers,
+               std::chrono::steady_clock::duration _traffic_delay,
+               SocketAddress bind_address);
+
+  ~CloudCluster() noexcept;
+
+  EventLoop &GetMainLoop() const noexcept {
+    return main_loop;
+  }
+
+  const CloudShardMap &GetShardMap() const noexcept {
+    return shard_map;
+  }
+
+  auto GetTrafficDelay() const noexcept {
+    return traffic_delay;
+  }
+
+  CloudWorker &GetWorker(unsigned i) noexcept {
+    return *workers[i];
+  }
+
+  /**
+   * Look up the public id of the given client, and assign a new one
+   * if it is not yet known.
+   *
+   * This method is thread-safe.
+   */
+  unsigned GetId(uint64_t key) noexcept;
+
+  /**
+   * Distribute the given data over the shards.  This may only be
+   * called before Start().
+   */
+  void Load(const CloudData &src);
+
+  /**
+   * Throws on error.
+   */
+  void Start();
+
+  void Stop() noexcept;
+
+  /**
+   * Copy a consistent snapshot of all shards.  All workers are
+   * paused meanwhile.
+   *
+   * @param dest an empty object
+   */
+  void Snapshot(CloudData &dest);
+
+  /**
+   * Called by a worker thread in response to
+   * CloudWorker::SchedulePause().
+   */
+  void ArriveAndWait() noexcept {
+    barrier.arrive_and_wait();
+  }
+};
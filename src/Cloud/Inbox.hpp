@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoPoint.hpp"
+#include "net/StaticSocketAddress.hxx"
+#include "event/InjectEvent.hxx"
+#include "util/BindMethod.hxx"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/**
+ * A request which is handed from the worker which has received a
+ * datagram to the shards which are responsible for it.
+ */
+struct CloudMessage {
+  enum class Type : uint8_t {
+    /**
+     * A new location of a client.  If #location is invalid, only the
+     * address is refreshed.
+     */
+    FIX,
+
+    /**
+     * The client has left the range of this shard; forget it.
+     */
+    REMOVE,
+
+    TRAFFIC_REQUEST,
+
+    THERMAL_SUBMIT,
+
+    THERMAL_REQUEST,
+  };
+
+  CloudMessage *next;
+
+  Type type;
+
+  StaticSocketAddress address;
+
+  uint64_t key;
+
+  /**
+   * The public id of the client (#FIX only).
+   */
+  unsigned id;
+
+  /**
+   * The client location (#FIX) or the thermal top
+   * (#THERMAL_SUBMIT).
+   */
+  GeoPoint location;
+  int altitude;
+
+  /* the following attributes are only used by #THERMAL_SUBMIT */
+  GeoPoint bottom_location;
+  int bottom_altitude;
+  double lift;
+
+  CloudMessage(Type _type, SocketAddress _address, uint64_t _key) noexcept
+    :type(_type), key(_key), id(0),
+     location(GeoPoint::Invalid()), altitude(0),
+     bottom_location(GeoPoint::Invalid()), bottom_altitude(0),
+     lift(0)
+  {
+    address = _address;
+  }
+};
+
+/**
+ * A lock-free queue of #CloudMessage instances which may be filled
+ * by any thread and is consumed by the thread which runs the given
+ * #EventLoop.
+ */
+class CloudInbox {
+  /**
+   * A singly linked list of pending messages, newest first.
+   */
+  std::atomic<CloudMessage *> head{nullptr};
+
+  /**
+   * Wakes up the consumer after a message has been added to an
+   * empty queue.
+   */
+  InjectEvent event;
+
+public:
+  CloudInbox(EventLoop &event_loop,
+             BoundMethod<void() noexcept> callback) noexcept
+    :event(event_loop, callback) {}
+
+  ~CloudInbox() noexcept {
+    Consume([](CloudMessage &){});
+  }
+
+  CloudInbox(const CloudInbox &) = delete;
+  CloudInbox &operator=(const CloudInbox &) = delete;
+
+  /**
+   * Add a message to the queue.
+   *
+   * This method is thread-safe.
+   */
+  void Push(std::unique_ptr<CloudMessage> message) noexcept {
+    CloudMessage *m = message.release();
+    m->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(m->next, m,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {}
+
+    if (m->next == nullptr)
+      /* the consumer has already seen the previous messages, it
+         needs to be woken up */
+      event.Schedule();
+  }
+
+  /**
+   * Remove all messages from the queue and invoke the given function
+   * for each of them, oldest first.
+   *
+   * This method must be called only by the consumer.
+   */
+  template<typename F>
+  void Consume(F &&f) {
+    CloudMessage *list = head.exchange(nullptr, std::memory_order_acquire);
+
+    /* reverse the list */
+    CloudMessage *reversed = nullptr;
+    while (list != nullptr) {
+      CloudMessage *next = list->next;
+      list->next = reversed;
+      reversed = list;
+      list = next;
+    }
+
+    while (reversed != nullptr) {
+      std::unique_ptr<CloudMessage> m{reversed};
+      reversed = m->next;
+      f(*m);
+    }
+  }
+};
@@ -1,57 +1,51 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // Copyright The XCSoar Project
 
+#include "Cluster.hpp"
+#include "Worker.hpp"
 #include "Data.hpp"
-#include "Dump.hpp"
-#include "Sender.hpp"
 #include "Serialiser.hpp"
 #include "Tracking/SkyLines/Server.hpp"
-#include "Tracking/SkyLines/Protocol.hpp"
-#include "util/ByteOrder.hxx"
 #include "event/Loop.hxx"
 #include "event/CoarseTimerEvent.hxx"
 #include "event/SignalMonitor.hxx"
 #include "net/IPv4Address.hxx"
 #include "io/FileOutputStream.hxx"
 #include "io/FileReader.hxx"
+#include "system/Args.hpp"
+#include "system/Path.hpp"
+#include "util/NumberParser.hpp"
 #include "util/PrintException.hxx"
-#include "util/Exception.hxx"
-#include "util/Compiler.h"
 #include "util/ScopeExit.hxx"
+#include "util/StringCompare.hxx"
 
-#include <array>
 #include <iostream>
-#include <iomanip>
 
 #include <signal.h>
 
-// TODO: review these settings
-static constexpr double TRAFFIC_RANGE = 50000;
-static constexpr double THERMAL_RANGE = 50000;
-
-static constexpr std::chrono::steady_clock::duration MAX_TRAFFIC_AGE = std::chrono::minutes(15);
-static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chrono::minutes(30);
-
-static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
-
 using std::cout;
 using std::cerr;
 using std::endl;
 
-class CloudServer final
-  : public SkyLinesTracking::Server, CloudData
-{
+/**
+ * The main thread of the cloud server: it handles signals and saves
+ * the data periodically, while the #CloudCluster does the real work.
+ */
+class CloudServer final {
   const AllocatedPath db_path;
 
-  CoarseTimerEvent save_timer, expire_timer;
+  CloudCluster cluster;
+
+  CoarseTimerEvent save_timer;
 
 public:
   CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
+              unsigned n_workers,
+              std::chrono::steady_clock::duration traffic_delay,
               SocketAddress bind_address)
-    :SkyLinesTracking::Server(event_loop, bind_address),
-     db_path(std::move(_db_path)),
-     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
-     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer))
+    :db_path(std::move(_db_path)),
+     cluster(event_loop, n_workers, traffic_delay, bind_address),
+     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer))
   {
 #ifndef _WIN32
     SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
@@ -65,12 +59,29 @@ public:
     ScheduleSave();
   }
 
+  auto &GetEventLoop() const noexcept {
+    return save_timer.GetEventLoop();
+  }
+
+  void Start() {
+    cluster.Start();
+  }
+
+  void Stop() noexcept {
+    cluster.Stop();
+  }
+
   void Load();
   void Save();
 
 private:
   void OnSaveTimer() noexcept {
-    Save();
+    try {
+      Save();
+    } catch (...) {
+      PrintException(std::current_exception());
+    }
+
     ScheduleSave();
   }
 
@@ -78,277 +89,40 @@ private:
     save_timer.Schedule(std::chrono::minutes(1));
   }
 
-  void OnExpireTimer() noexcept {
-    clients.Expire(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
-    if (!clients.empty())
-      ScheduleExpire();
-  }
-
-  void ScheduleExpire() {
-    expire_timer.Schedule(std::chrono::minutes(5));
-  }
-
-protected:
-  /* virtual methods from class SkyLinesTracking::Server */
-  void OnFix(const Client &client,
-             std::chrono::milliseconds time_of_day,
-             const ::GeoPoint &location, int altitude) override;
-
-  void OnTrafficRequest(const Client &client,
-                        bool near) override;
-
-  void OnWaveSubmit(const Client &client,
-                    std::chrono::milliseconds time_of_day,
-                    const ::GeoPoint &a, const ::GeoPoint &b,
-                    int bottom_altitude,
-                    int top_altitude,
-                    double lift) override;
-
-  void OnThermalSubmit(const Client &client,
-                       std::chrono::milliseconds time_of_day,
-                       const ::GeoPoint &bottom_location,
-                       int bottom_altitude,
-                       const ::GeoPoint &top_location,
-                       int top_altitude,
-                       double lift) override;
-
-  void OnThermalRequest(const Client &client) override;
-
-  void OnSendError(SocketAddress address,
-                   std::exception_ptr e) noexcept override {
-    cerr << "Failed to send to " << address
-         << ": " << GetFullMessage(e)
-         << endl;
-  }
-
-  void OnError(std::exception_ptr e) override {
-    cerr << GetFullMessage(e) << endl;
-    GetEventLoop().Break();
-  }
-
 #ifndef _WIN32
   void OnQuitSignal() noexcept {
     GetEventLoop().Break();
   }
 
   void OnReloadSignal() noexcept {
-    Save();
+    try {
+      Save();
+    } catch (...) {
+      PrintException(std::current_exception());
+    }
   }
 
   void OnDumpSignal() noexcept {
-    DumpClients();
+    try {
+      CloudData snapshot;
+      cluster.Snapshot(snapshot);
+      snapshot.DumpClients();
+    } catch (...) {
+      PrintException(std::current_exception());
+    }
   }
 #endif
 };
 
-void
-CloudServer::OnFix(const Client &c,
-                   std::chrono::milliseconds time_of_day,
-                   const ::GeoPoint &location, int altitude)
-{
-  (void)time_of_day; // TODO: use this parameter
-
-  CloudClient *client;
-  if (location.IsValid()) {
-    bool was_empty = clients.empty();
-
-    client = &clients.Make(c.address, c.key, location, altitude);
-
-    cout << "FIX\t"
-         << client->address << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm'
-         << endl;
-
-    if (was_empty)
-      ScheduleExpire();
-  } else {
-    client = clients.Find(c.key);
-    if (client != nullptr)
-      clients.Refresh(*client, c.address);
-  }
-
-  /* send this new traffic location to all interested clients
-     immediately */
-  const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_traffic)
-      /* not interested (anymore) */
-      continue;
-
-    TrafficResponseSender s(*this, i->address, i->key);
-    s.Add(client->id, 0, //TODO: time?
-          client->location, client->altitude);
-    s.Flush();
-  }
-}
-
-void
-CloudServer::OnTrafficRequest(const Client &c, bool near)
-{
-  if (!near)
-    /* "near" is the only selection flag we know */
-    return;
-
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
-
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_traffic = now + REQUEST_EXPIRY;
-
-  const auto min_stamp = now - MAX_TRAFFIC_AGE;
-
-  TrafficResponseSender s(*this, c.address, c.key);
-
-  unsigned n = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client->location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
-      continue;
-
-    if (traffic->stamp < min_stamp)
-      /* don't send stale traffic, it's probably not there anymore */
-      continue;
-
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
-
-    if (++n > 64)
-      break;
-  }
-
-  s.Flush();
-}
-
-void
-CloudServer::OnWaveSubmit(const Client &c,
-                          [[maybe_unused]] std::chrono::milliseconds time_of_day,
-                          const ::GeoPoint &a, const ::GeoPoint &b,
-                          int bottom_altitude,
-                          int top_altitude,
-                          double lift)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't trust the client if he didn't sent anything to us
-       yet */
-    return;
-
-  cout << "WAVE\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << a << '\t'
-       << b << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-}
-
-void
-CloudServer::OnThermalSubmit(const Client &c,
-                             [[maybe_unused]] std::chrono::milliseconds time_of_day,
-                             const ::GeoPoint &bottom_location,
-                             int bottom_altitude,
-                             const ::GeoPoint &top_location,
-                             int top_altitude,
-                             double lift)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't trust the client if he didn't sent anything to us
-       yet */
-    return;
-
-  cout << "THERMAL\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
-
-  /* send this new thermal to all interested clients immediately */
-  const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(bottom_location,
-                                                THERMAL_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_thermals)
-      /* not interested (anymore) */
-      continue;
-
-    ThermalResponseSender s(*this, i->address, i->key);
-    s.Add(thermal.Pack());
-    s.Flush();
-  }
-}
-
-void
-CloudServer::OnThermalRequest(const Client &c)
-{
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
-    /* we don't send our data to clients who didn't sent anything to
-       us yet */
-    return;
-
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_thermals = now + REQUEST_EXPIRY;
-
-  const auto min_time = now - MAX_THERMAL_AGE;
-
-  ThermalResponseSender s(*this, c.address, c.key);
-
-  unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (thermal->time < min_time)
-      /* don't send old thermals, they're useless */
-      continue;
-
-    s.Add(thermal->Pack());
-
-    if (++n > 256)
-      break;
-  }
-
-  s.Flush();
-}
-
 void
 CloudServer::Load()
 {
   FileReader fr(db_path);
   Deserialiser s(fr);
-  CloudData::Load(s);
+
+  CloudData data;
+  data.Load(s);
+  cluster.Load(data);
 }
 
 void
@@ -356,11 +130,16 @@ CloudServer::Save()
 {
   cout << "Saving data to " << db_path.c_str() << endl;
 
+  /* copy the data, so the workers can continue while it is being
+     written */
+  CloudData snapshot;
+  cluster.Snapshot(snapshot);
+
   FileOutputStream fos(db_path);
 
   {
     Serialiser s(fos);
-    CloudData::Save(s);
+    snapshot.Save(s);
     s.Flush();
   }
 
@@ -370,19 +149,50 @@ CloudServer::Save()
 int
 main(int argc, char **argv)
 try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
-    return EXIT_FAILURE;
+  Args args(argc, argv, "[--traffic-delay=MS] DBPATH [WORKERS]\n\n"
+            "  --traffic-delay=MS  collect new traffic for this duration\n"
+            "                      before sending it (default 250,\n"
+            "                      0 sends it immediately)");
+
+  std::chrono::steady_clock::duration traffic_delay =
+    CloudWorker::DEFAULT_TRAFFIC_DELAY;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--traffic-delay=")) != nullptr) {
+      char *endptr;
+      const unsigned ms = ParseUnsigned(value, &endptr);
+      if (endptr == value || *endptr != 0)
+        args.UsageError();
+
+      traffic_delay = std::chrono::milliseconds(ms);
+    } else
+      args.UsageError();
   }
 
-  const Path db_path(argv[1]);
+  const Path db_path(args.ExpectNext());
+
+  unsigned n_workers = 1;
+  if (!args.IsEmpty()) {
+    const char *value = args.GetNext();
+    char *endptr;
+    n_workers = ParseUnsigned(value, &endptr);
+    if (endptr == value || *endptr != 0 ||
+        n_workers == 0 || n_workers > CloudShardMap::MAX_SHARDS)
+      args.UsageError();
+  }
+
+  args.ExpectEnd();
 
   EventLoop event_loop;
   SignalMonitorInit(event_loop);
   AtScopeExit() { SignalMonitorFinish(); };
 
-  CloudServer server(db_path, event_loop,
-                     IPv4Address(CloudServer::GetDefaultPort()));
+  CloudServer server(db_path, event_loop, n_workers, traffic_delay,
+                     IPv4Address(SkyLinesTracking::Server::GetDefaultPort()));
 
   try {
     server.Load();
@@ -391,6 +201,9 @@ try {
     PrintException(e);
   }
 
+  server.Start();
+  AtScopeExit(&server) { server.Stop(); };
+
   event_loop.Run();
 
   server.Save();
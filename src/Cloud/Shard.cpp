@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Shard.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+
+#include <algorithm>
+
+static constexpr unsigned
+ToStrip(double longitude, unsigned strip_width, unsigned n_strips) noexcept
+{
+  const double strip = (longitude + 180) / strip_width;
+  return strip <= 0
+    ? 0
+    : std::min(unsigned(strip), n_strips - 1);
+}
+
+unsigned
+CloudShardMap::GetShard(const GeoPoint &location) const noexcept
+{
+  if (n_shards == 1)
+    return 0;
+
+  return GetStripShard(ToStrip(location.longitude.Degrees(),
+                               STRIP_WIDTH, N_STRIPS));
+}
+
+CloudShardMap::Mask
+CloudShardMap::GetShards(const GeoPoint &location) const noexcept
+{
+  if (n_shards == 1)
+    return 1;
+
+  const auto box = BoostRangeBox(location, range);
+
+  const unsigned west = ToStrip(box.min_corner().longitude.Degrees(),
+                                STRIP_WIDTH, N_STRIPS);
+  const unsigned east = ToStrip(box.max_corner().longitude.Degrees(),
+                                STRIP_WIDTH, N_STRIPS);
+
+  const Mask all = All();
+  Mask mask = 0;
+
+  /* the box may wrap around at the antimeridian */
+  for (unsigned x = west;; x = (x + 1) % N_STRIPS) {
+    mask |= Mask(1) << GetStripShard(x);
+
+    if (x == east || mask == all)
+      break;
+  }
+
+  return mask;
+}
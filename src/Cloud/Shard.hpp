@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstdint>
+
+struct GeoPoint;
+
+/**
+ * Assigns locations to the shards of the cloud server.
+ *
+ * The world is divided into longitude strips of #STRIP_WIDTH
+ * degrees, which are assigned to the shards in turn.  A shard "owns"
+ * all clients and thermals located in its strips.  Additionally, it
+ * keeps copies of the objects of other shards which are near its
+ * strips, so range queries can be answered locally.
+ *
+ * The strips are much wider than the copy range, so most objects
+ * have no copy at all, and the others have only one (in the
+ * neighbouring strip).
+ */
+class CloudShardMap {
+public:
+  static constexpr unsigned MAX_SHARDS = 64;
+
+  /**
+   * A bit mask of shard indexes.
+   */
+  using Mask = uint_least64_t;
+
+private:
+  /**
+   * The width of one strip (degrees).  Wider strips mean fewer
+   * copies of objects near strip borders, but a coarser load
+   * distribution.  At 50 degrees latitude, 8 degrees are about
+   * 570 km, i.e. roughly a fifth of all objects are within 60 km of
+   * a border.
+   */
+  static constexpr unsigned STRIP_WIDTH = 8;
+
+  static constexpr unsigned N_STRIPS = 360 / STRIP_WIDTH;
+
+  unsigned n_shards;
+
+  /**
+   * Objects are copied to all shards within this range (m).
+   */
+  double range;
+
+public:
+  constexpr CloudShardMap(unsigned _n_shards, double _range) noexcept
+    :n_shards(_n_shards), range(_range) {}
+
+  constexpr unsigned size() const noexcept {
+    return n_shards;
+  }
+
+  constexpr Mask All() const noexcept {
+    return n_shards >= MAX_SHARDS
+      ? ~Mask(0)
+      : (Mask(1) << n_shards) - 1;
+  }
+
+  /**
+   * Determine the shard which owns the given location.
+   */
+  [[gnu::pure]]
+  unsigned GetShard(const GeoPoint &location) const noexcept;
+
+  /**
+   * Determine all shards which need a copy of an object at the given
+   * location, i.e. those whose strips intersect the box which covers
+   * the range around it.  This includes the owner.
+   */
+  [[gnu::pure]]
+  Mask GetShards(const GeoPoint &location) const noexcept;
+
+  /**
+   * Invoke the given function with the index of each shard in the
+   * mask.
+   */
+  template<typename F>
+  static void ForEach(Mask mask, F &&f) {
+    for (unsigned i = 0; mask != 0; ++i, mask >>= 1)
+      if (mask & 1)
+        f(i);
+  }
+
+private:
+  [[gnu::pure]]
+  unsigned GetStripShard(unsigned x) const noexcept {
+    /* neighbouring strips belong to different shards, which
+       distributes busy regions (several strips wide) over the
+       shards */
+    return x % n_shards;
+  }
+};
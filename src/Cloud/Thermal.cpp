@@ -47,6 +47,14 @@ CloudThermalContainer::Insert(CloudThermal &thermal)
   rtree.insert(thermal.shared_from_this());
 }
 
+CloudThermal &
+CloudThermalContainer::InsertCopy(const CloudThermal &src)
+{
+  auto thermal = std::make_shared<CloudThermal>(src);
+  Insert(*thermal);
+  return *thermal;
+}
+
 void
 CloudThermalContainer::Remove(CloudThermal &thermal)
 {
@@ -115,6 +115,12 @@ public:
 
   void Insert(CloudThermal &client);
 
+  /**
+   * Insert a copy of the given #CloudThermal (from another
+   * container).
+   */
+  CloudThermal &InsertCopy(const CloudThermal &src);
+
   /**
    * Remove a #CloudThermal and its data.  Be careful - the given reference
    * is invalidated, unless the caller holds another #CloudThermalPtr.
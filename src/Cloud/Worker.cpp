@@ -0,0 +1,531 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Worker.hpp"
+#include "Cluster.hpp"
+#include "Dump.hpp"
+#include "Sender.hpp"
+#include "util/Exception.hxx"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+static constexpr std::chrono::steady_clock::duration MAX_TRAFFIC_AGE = std::chrono::minutes(15);
+static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chrono::minutes(30);
+
+static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
+
+static constexpr std::chrono::steady_clock::duration CLIENT_EXPIRY = std::chrono::minutes(10);
+
+using std::cout;
+using std::cerr;
+
+/**
+ * Write a line to the given stream at once, so it does not get mixed
+ * with the output of other threads.
+ */
+static void
+WriteLine(std::ostream &stream, const std::ostringstream &line) noexcept
+{
+  stream << line.str() << std::endl;
+}
+
+CloudWorker::CloudWorker(CloudCluster &_cluster, unsigned _index,
+                         SocketAddress bind_address)
+  :Thread("cloud"),
+   SkyLinesTracking::Server(event_loop, bind_address,
+                            _cluster.GetShardMap().size() > 1),
+   cluster(_cluster), index(_index),
+   inbox(event_loop, BIND_THIS_METHOD(OnInbox)),
+   pause_event(event_loop, BIND_THIS_METHOD(OnPause)),
+   expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer)),
+   traffic_timer(event_loop, BIND_THIS_METHOD(OnTrafficTimer))
+{
+}
+
+CloudWorker::~CloudWorker() noexcept = default;
+
+void
+CloudWorker::Start()
+{
+  event_loop.SetAlive(true);
+  Thread::Start();
+}
+
+void
+CloudWorker::Stop() noexcept
+{
+  if (!IsDefined())
+    return;
+
+  event_loop.InjectBreak();
+  Join();
+
+  /* allow the destructor to unregister the socket from the main
+     thread */
+  event_loop.SetAlive(false);
+}
+
+void
+CloudWorker::Run() noexcept
+{
+  event_loop.Run();
+}
+
+bool
+CloudWorker::IsOwner(const GeoPoint &location) const noexcept
+{
+  return cluster.GetShardMap().GetShard(location) == index;
+}
+
+CloudShardMap::Mask
+CloudWorker::GetRouteShards(uint64_t key) const noexcept
+{
+  auto i = routes.find(key);
+  return i != routes.end()
+    ? i->second.shards
+    : cluster.GetShardMap().All();
+}
+
+void
+CloudWorker::Dispatch(CloudShardMap::Mask shards, const CloudMessage &message)
+{
+  CloudShardMap::ForEach(shards, [this, &message](unsigned i){
+    if (i == index)
+      Handle(message);
+    else
+      cluster.GetWorker(i).Push(std::make_unique<CloudMessage>(message));
+  });
+}
+
+void
+CloudWorker::Handle(const CloudMessage &message) noexcept
+try {
+  switch (message.type) {
+  case CloudMessage::Type::FIX:
+    HandleFix(message);
+    break;
+
+  case CloudMessage::Type::REMOVE:
+    if (auto *client = data.clients.Find(message.key))
+      data.clients.Remove(*client);
+    break;
+
+  case CloudMessage::Type::TRAFFIC_REQUEST:
+    HandleTrafficRequest(message);
+    break;
+
+  case CloudMessage::Type::THERMAL_SUBMIT:
+    HandleThermalSubmit(message);
+    break;
+
+  case CloudMessage::Type::THERMAL_REQUEST:
+    HandleThermalRequest(message);
+    break;
+  }
+} catch (...) {
+  cerr << GetFullMessage(std::current_exception()) << std::endl;
+}
+
+void
+CloudWorker::HandleFix(const CloudMessage &m)
+{
+  CloudClient *client;
+  if (m.location.IsValid()) {
+    client = &data.clients.Make(m.address, m.key, m.id,
+                                m.location, m.altitude);
+
+    if (!expire_timer.IsPending())
+      ScheduleExpire();
+  } else {
+    client = data.clients.Find(m.key);
+    if (client == nullptr)
+      return;
+
+    data.clients.Refresh(*client, m.address);
+  }
+
+  /* send this new traffic location to all interested clients; it is
+     queued for CloudCluster::GetTrafficDelay() (and sent by
+     OnTrafficTimer()) unless that is zero */
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto &i : data.clients.QueryWithinRange(client->location,
+                                                     TRAFFIC_RANGE)) {
+    if (i->key == m.key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (now > i->wants_traffic)
+      /* not interested (anymore) */
+      continue;
+
+    if (!IsOwner(i->location))
+      /* this is a copy; the owner of that client sends it */
+      continue;
+
+    if (cluster.GetTrafficDelay().count() > 0) {
+      AddPendingTraffic(i->key, *client);
+      continue;
+    }
+
+    TrafficResponseSender s(*this, i->address, i->key);
+    s.Add(client->id, 0, //TODO: time?
+          client->location, client->altitude);
+    s.Flush();
+  }
+}
+
+void
+CloudWorker::AddPendingTraffic(uint64_t key,
+                               const CloudClient &traffic)
+{
+  const PendingTraffic item{traffic.id, traffic.location, traffic.altitude};
+
+  auto &list = pending_traffic[key];
+  auto i = std::lower_bound(list.begin(), list.end(), item.id,
+                            [](const auto &j, unsigned id){
+                              return j.id < id;
+                            });
+  if (i != list.end() && i->id == item.id)
+    /* replace the older location of this pilot */
+    *i = item;
+  else
+    list.insert(i, item);
+
+  if (!traffic_timer.IsPending())
+    traffic_timer.Schedule(cluster.GetTrafficDelay());
+}
+
+void
+CloudWorker::OnTrafficTimer() noexcept
+{
+  for (const auto &[key, list] : pending_traffic) {
+    const auto *client = data.clients.Find(key);
+    if (client == nullptr || !IsOwner(client->location))
+      /* the subscriber is gone or has moved to another shard */
+      continue;
+
+    /* the sender fills each datagram before it sends it */
+    TrafficResponseSender s(*this, client->address, key);
+    for (const auto &i : list)
+      s.Add(i.id, 0, //TODO: time?
+            i.location, i.altitude);
+    s.Flush();
+  }
+
+  pending_traffic.clear();
+}
+
+void
+CloudWorker::HandleTrafficRequest(const CloudMessage &m)
+{
+  auto *client = data.clients.Find(m.key);
+  if (client == nullptr)
+    /* we don't send our data to clients who didn't sent anything to
+       us yet */
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+
+  /* all copies remember the request, because the client may move
+     to another shard */
+  client->wants_traffic = now + REQUEST_EXPIRY;
+
+  if (!IsOwner(client->location))
+    return;
+
+  const auto min_stamp = now - MAX_TRAFFIC_AGE;
+
+  TrafficResponseSender s(*this, m.address, m.key);
+
+  unsigned n = 0;
+  for (const auto &traffic : data.clients.QueryWithinRange(client->location,
+                                                           TRAFFIC_RANGE)) {
+    if (traffic.get() == client)
+      continue;
+
+    if (traffic->stamp < min_stamp)
+      /* don't send stale traffic, it's probably not there anymore */
+      continue;
+
+    s.Add(traffic->id, 0, //TODO: time?
+          traffic->location, traffic->altitude);
+
+    if (++n > 64)
+      break;
+  }
+
+  s.Flush();
+}
+
+void
+CloudWorker::HandleThermalSubmit(const CloudMessage &m)
+{
+  const auto &thermal =
+    data.thermals.Make(m.key,
+                       AGeoPoint(m.bottom_location, m.bottom_altitude),
+                       AGeoPoint(m.location, m.altitude),
+                       m.lift);
+
+  /* send this new thermal to all interested clients immediately */
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto &i : data.clients.QueryWithinRange(m.bottom_location,
+                                                     THERMAL_RANGE)) {
+    if (i->key == m.key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (now > i->wants_thermals)
+      /* not interested (anymore) */
+      continue;
+
+    if (!IsOwner(i->location))
+      /* this is a copy; the owner of that client sends it */
+      continue;
+
+    ThermalResponseSender s(*this, i->address, i->key);
+    s.Add(thermal.Pack());
+    s.Flush();
+  }
+}
+
+void
+CloudWorker::HandleThermalRequest(const CloudMessage &m)
+{
+  auto *client = data.clients.Find(m.key);
+  if (client == nullptr)
+    /* we don't send our data to clients who didn't sent anything to
+       us yet */
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+
+  client->wants_thermals = now + REQUEST_EXPIRY;
+
+  if (!IsOwner(client->location))
+    return;
+
+  const auto min_time = now - MAX_THERMAL_AGE;
+
+  ThermalResponseSender s(*this, m.address, m.key);
+
+  unsigned n = 0;
+  for (const auto &thermal : data.thermals.QueryWithinRange(client->location,
+                                                            THERMAL_RANGE)) {
+    if (thermal->client_key == m.key)
+      /* ignore this client's own submissions - he knows them
+         already */
+      continue;
+
+    if (thermal->time < min_time)
+      /* don't send old thermals, they're useless */
+      continue;
+
+    s.Add(thermal->Pack());
+
+    if (++n > 256)
+      break;
+  }
+
+  s.Flush();
+}
+
+void
+CloudWorker::OnInbox() noexcept
+{
+  inbox.Consume([this](const CloudMessage &m){
+    Handle(m);
+  });
+}
+
+void
+CloudWorker::OnPause() noexcept
+{
+  /* wait until no worker receives datagrams anymore */
+  cluster.ArriveAndWait();
+
+  /* now no new messages can arrive; handle the pending ones */
+  OnInbox();
+  cluster.ArriveAndWait();
+
+  /* wait until the main thread has copied the data */
+  cluster.ArriveAndWait();
+}
+
+void
+CloudWorker::OnExpireTimer() noexcept
+{
+  const auto before = GetEventLoop().SteadyNow() - CLIENT_EXPIRY;
+
+  data.clients.Expire(before);
+
+  std::erase_if(routes, [before](const auto &i){
+    return i.second.stamp < before;
+  });
+
+  if (!data.clients.empty() || !routes.empty())
+    ScheduleExpire();
+}
+
+void
+CloudWorker::OnFix(const Client &c,
+                   std::chrono::milliseconds time_of_day,
+                   const ::GeoPoint &location, int altitude)
+{
+  (void)time_of_day; // TODO: use this parameter
+
+  CloudMessage m(CloudMessage::Type::FIX, c.address, c.key);
+
+  if (!location.IsValid()) {
+    /* only refresh the client's address; the shards send its
+       previous location to the others */
+    Dispatch(GetRouteShards(c.key), m);
+    return;
+  }
+
+  const auto shards = cluster.GetShardMap().GetShards(location);
+
+  auto i = routes.find(c.key);
+  if (i == routes.end()) {
+    i = routes.emplace(c.key, Route{cluster.GetId(c.key), 0, {}}).first;
+
+    if (!expire_timer.IsPending())
+      ScheduleExpire();
+  }
+
+  auto &route = i->second;
+
+  if (const auto left = route.shards & ~shards; left != 0)
+    /* the client has moved away from these shards */
+    Dispatch(left,
+             CloudMessage(CloudMessage::Type::REMOVE, c.address, c.key));
+
+  route.shards = shards;
+  route.stamp = std::chrono::steady_clock::now();
+
+  std::ostringstream line;
+  line << "FIX\t"
+       << SocketAddress{c.address} << '\t'
+       << std::hex << c.key << std::dec << '\t'
+       << route.id << '\t'
+       << location << '\t'
+       << altitude << 'm';
+  WriteLine(cout, line);
+
+  m.id = route.id;
+  m.location = location;
+  m.altitude = altitude;
+  Dispatch(shards, m);
+}
+
+void
+CloudWorker::OnTrafficRequest(const Client &c, bool near)
+{
+  if (!near)
+    /* "near" is the only selection flag we know */
+    return;
+
+  Dispatch(GetRouteShards(c.key),
+           CloudMessage(CloudMessage::Type::TRAFFIC_REQUEST,
+                        c.address, c.key));
+}
+
+void
+CloudWorker::OnWaveSubmit(const Client &c,
+                          [[maybe_unused]] std::chrono::milliseconds time_of_day,
+                          const ::GeoPoint &a, const ::GeoPoint &b,
+                          int bottom_altitude,
+                          int top_altitude,
+                          double lift)
+{
+  auto i = routes.find(c.key);
+  if (i == routes.end())
+    /* we don't trust the client if he didn't sent anything to us
+       yet */
+    return;
+
+  std::ostringstream line;
+  line << "WAVE\t"
+       << SocketAddress{c.address} << '\t'
+       << std::hex << c.key << std::dec << '\t'
+       << i->second.id << '\t'
+       << a << '\t'
+       << b << '\t'
+       << bottom_altitude << '-' << top_altitude << "m\t"
+       << lift << "m/s";
+  WriteLine(cout, line);
+}
+
+void
+CloudWorker::OnThermalSubmit(const Client &c,
+                             [[maybe_unused]] std::chrono::milliseconds time_of_day,
+                             const ::GeoPoint &bottom_location,
+                             int bottom_altitude,
+                             const ::GeoPoint &top_location,
+                             int top_altitude,
+                             double lift)
+{
+  auto i = routes.find(c.key);
+  if (i == routes.end())
+    /* we don't trust the client if he didn't sent anything to us
+       yet */
+    return;
+
+  std::ostringstream line;
+  line << "THERMAL\t"
+       << SocketAddress{c.address} << '\t'
+       << std::hex << c.key << std::dec << '\t'
+       << i->second.id << '\t'
+       << top_location << '\t'
+       << bottom_altitude << '-' << top_altitude << "m\t"
+       << lift << "m/s";
+  WriteLine(cout, line);
+
+  CloudMessage m(CloudMessage::Type::THERMAL_SUBMIT, c.address, c.key);
+  m.location = top_location;
+  m.altitude = top_altitude;
+  m.bottom_location = bottom_location;
+  m.bottom_altitude = bottom_altitude;
+  m.lift = lift;
+
+  /* the shards near the top answer thermal requests, the shards
+     near the bottom notify the clients there */
+  const auto &shard_map = cluster.GetShardMap();
+  Dispatch(shard_map.GetShards(top_location) |
+           shard_map.GetShards(bottom_location),
+           m);
+}
+
+void
+CloudWorker::OnThermalRequest(const Client &c)
+{
+  Dispatch(GetRouteShards(c.key),
+           CloudMessage(CloudMessage::Type::THERMAL_REQUEST,
+                        c.address, c.key));
+}
+
+void
+CloudWorker::OnSendError(SocketAddress address,
+                         std::exception_ptr e) noexcept
+{
+  std::ostringstream line;
+  line << "Failed to send to " << address
+       << ": " << GetFullMessage(e);
+  WriteLine(cerr, line);
+}
+
+void
+CloudWorker::OnError(std::exception_ptr e)
+{
+  std::ostringstream line;
+  line << GetFullMessage(e);
+  WriteLine(cerr, line);
+
+  /* keep this thread running (it still handles messages from other
+     shards), but shut down the server */
+  cluster.GetMainLoop().InjectBreak();
+}
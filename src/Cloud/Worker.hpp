@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Data.hpp"
+#include "Inbox.hpp"
+#include "Shard.hpp"
+#include "Tracking/SkyLines/Server.hpp"
+#include "event/Loop.hxx"
+#include "event/InjectEvent.hxx"
+#include "event/CoarseTimerEvent.hxx"
+#include "event/FineTimerEvent.hxx"
+#include "thread/Thread.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class CloudCluster;
+
+/**
+ * Holds the #EventLoop of a #CloudWorker.  This is a base class,
+ * because the #EventLoop must be constructed before the
+ * #SkyLinesTracking::Server.
+ */
+struct CloudWorkerLoop {
+  EventLoop event_loop{ThreadId::Null()};
+};
+
+/**
+ * One thread of the cloud server.
+ *
+ * All workers receive datagrams on the same UDP port (with
+ * SO_REUSEPORT), and the kernel delivers all datagrams from one
+ * client address to the same worker.  That worker remembers where
+ * the client is and hands its requests to the shards which are
+ * responsible (see #CloudShardMap).
+ *
+ * Each worker is also one shard: it owns the clients and thermals in
+ * its strips, and keeps copies of those of other shards nearby.  Only
+ * the owner sends traffic and thermal information to a client.
+ *
+ * The #CloudData may only be accessed by this thread, or while the
+ * #CloudCluster is paused.
+ */
+class CloudWorker final
+  : CloudWorkerLoop, Thread, public SkyLinesTracking::Server
+{
+public:
+  // TODO: review these settings
+  static constexpr double TRAFFIC_RANGE = 50000;
+  static constexpr double THERMAL_RANGE = 50000;
+
+  /**
+   * Clients and thermals are copied to all shards within this range
+   * (m).  It is a bit larger than the query ranges, because the
+   * query boxes of two points are not exactly symmetric.
+   */
+  static constexpr double SHARD_RANGE =
+    1.2 * (TRAFFIC_RANGE > THERMAL_RANGE ? TRAFFIC_RANGE : THERMAL_RANGE);
+
+  /**
+   * New traffic is collected for this duration and then sent to each
+   * subscriber in as few datagrams as possible.
+   */
+  static constexpr std::chrono::milliseconds DEFAULT_TRAFFIC_DELAY{250};
+
+private:
+  CloudCluster &cluster;
+
+  /**
+   * The index of this worker, which is also its shard number.
+   */
+  const unsigned index;
+
+  CloudData data;
+
+  /**
+   * What this worker knows about a client whose datagrams it
+   * receives.
+   */
+  struct Route {
+    /**
+     * The public id of the client.
+     */
+    unsigned id;
+
+    /**
+     * The shards which have a copy of this client.
+     */
+    CloudShardMap::Mask shards;
+
+    std::chrono::steady_clock::time_point stamp;
+  };
+
+  std::unordered_map<uint64_t, Route> routes;
+
+  struct PendingTraffic {
+    unsigned id;
+    GeoPoint location;
+    int altitude;
+  };
+
+  /**
+   * Traffic which will be sent to subscribers (by key) when
+   * #traffic_timer expires.  Each list is sorted by the pilot id and
+   * has at most one item per pilot, so a new fix can find (and
+   * replace) the pilot's older location with a binary search.
+   */
+  std::unordered_map<uint64_t, std::vector<PendingTraffic>> pending_traffic;
+
+  CloudInbox inbox;
+
+  InjectEvent pause_event;
+
+  CoarseTimerEvent expire_timer;
+
+  /**
+   * Sends #pending_traffic.
+   */
+  FineTimerEvent traffic_timer;
+
+public:
+  /**
+   * Throws on error.
+   */
+  CloudWorker(CloudCluster &_cluster, unsigned _index,
+              SocketAddress bind_address);
+
+  ~CloudWorker() noexcept;
+
+  /**
+   * Start the thread.
+   *
+   * Throws on error.
+   */
+  void Start();
+
+  /**
+   * Stop the thread and wait for it to finish.
+   */
+  void Stop() noexcept;
+
+  /**
+   * Hand a message to this shard.
+   *
+   * This method is thread-safe.
+   */
+  void Push(std::unique_ptr<CloudMessage> message) noexcept {
+    inbox.Push(std::move(message));
+  }
+
+  /**
+   * Ask the thread to take part in CloudCluster::Snapshot().
+   *
+   * This method is thread-safe.
+   */
+  void SchedulePause() noexcept {
+    pause_event.Schedule();
+  }
+
+  /**
+   * Access the data of this shard.  This may only be called before
+   * the thread is started or while the #CloudCluster is paused.
+   */
+  CloudData &GetData() noexcept {
+    return data;
+  }
+
+  /**
+   * Does this worker currently receive datagrams from the given
+   * client?  This may only be called while the #CloudCluster is
+   * paused.
+   */
+  [[gnu::pure]]
+  bool HasRoute(uint64_t key) const noexcept {
+    return routes.contains(key);
+  }
+
+private:
+  [[gnu::pure]]
+  bool IsOwner(const GeoPoint &location) const noexcept;
+
+  /**
+   * Determine the shards which have a copy of the given client.  If
+   * it is unknown (e.g. after a restart, or because the client's
+   * address has changed), all shards are asked.
+   */
+  [[gnu::pure]]
+  CloudShardMap::Mask GetRouteShards(uint64_t key) const noexcept;
+
+  void ScheduleExpire() noexcept {
+    expire_timer.Schedule(std::chrono::minutes(5));
+  }
+
+  /**
+   * Hand a message to all of the given shards; this worker's own
+   * shard handles it immediately.
+   */
+  void Dispatch(CloudShardMap::Mask shards, const CloudMessage &message);
+
+  /**
+   * Queue traffic for the given subscriber; it will be sent by
+   * OnTrafficTimer().
+   */
+  void AddPendingTraffic(uint64_t key, const CloudClient &traffic);
+
+  void Handle(const CloudMessage &message) noexcept;
+  void HandleFix(const CloudMessage &message);
+  void HandleTrafficRequest(const CloudMessage &message);
+  void HandleThermalSubmit(const CloudMessage &message);
+  void HandleThermalRequest(const CloudMessage &message);
+
+  void OnInbox() noexcept;
+  void OnPause() noexcept;
+  void OnExpireTimer() noexcept;
+  void OnTrafficTimer() noexcept;
+
+  /* virtual methods from class Thread */
+  void Run() noexcept override;
+
+protected:
+  /* virtual methods from class SkyLinesTracking::Server */
+  void OnFix(const Client &client,
+             std::chrono::milliseconds time_of_day,
+             const ::GeoPoint &location, int altitude) override;
+
+  void OnTrafficRequest(const Client &client,
+                        bool near) override;
+
+  void OnWaveSubmit(const Client &client,
+                    std::chrono::milliseconds time_of_day,
+                    const ::GeoPoint &a, const ::GeoPoint &b,
+                    int bottom_altitude,
+                    int top_altitude,
+                    double lift) override;
+
+  void OnThermalSubmit(const Client &client,
+                       std::chrono::milliseconds time_of_day,
+                       const ::GeoPoint &bottom_location,
+                       int bottom_altitude,
+                       const ::GeoPoint &top_location,
+                       int top_altitude,
+                       double lift) override;
+
+  void OnThermalRequest(const Client &client) override;
+
+  void OnSendError(SocketAddress address,
+                   std::exception_ptr e) noexcept override;
+
+  void OnError(std::exception_ptr e) override;
+};
@@ -0,0 +1,401 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ContestCheckpoint.hpp"
+#include "ContestComputer.hpp"
+#include "TraceComputer.hpp"
+#include "Cloud/Serialiser.hpp"
+#include "Engine/Contest/Settings.hpp"
+#include "Engine/Trace/Vector.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/FileReader.hxx"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+static constexpr uint32_t CHECKPOINT_MAGIC = 0x58434350;
+static constexpr uint32_t CHECKPOINT_VERSION = 2;
+
+/**
+ * A checkpoint is only restored if the flight was interrupted for at
+ * most this duration.
+ */
+static constexpr std::chrono::duration<unsigned> MAX_GAP =
+  std::chrono::minutes{10};
+
+static void
+Save(Serialiser &s, const GeoPoint &location)
+{
+  s.WriteDouble(location.longitude.Native());
+  s.WriteDouble(location.latitude.Native());
+}
+
+static GeoPoint
+LoadGeoPoint(Deserialiser &s)
+{
+  const auto longitude = Angle::Native(s.ReadDouble());
+  const auto latitude = Angle::Native(s.ReadDouble());
+  const GeoPoint location(longitude, latitude);
+  if (!location.Check())
+    throw std::runtime_error("Malformed location");
+
+  return location;
+}
+
+static void
+Save(Serialiser &s, const TracePointVector &points)
+{
+  s.Write32(points.size());
+
+  for (const auto &i : points) {
+    s.Write32(i.GetTime().count());
+    Save(s, i.GetLocation());
+    s.Write16(i.GetIntegerAltitude());
+    s.WriteFloat(i.GetVario());
+    s.Write16(i.GetDriftFactor());
+  }
+}
+
+static TracePointVector
+LoadTracePoints(Deserialiser &s, unsigned max_size)
+{
+  const unsigned n = s.Read32();
+  if (n > max_size)
+    throw std::runtime_error("Malformed trace");
+
+  TracePointVector points;
+  points.reserve(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const TracePoint::Time time{s.Read32()};
+    const GeoPoint location = LoadGeoPoint(s);
+    const int altitude = (int16_t)s.Read16();
+    const double vario = s.ReadFloat();
+    const unsigned drift_factor = s.Read16();
+    points.emplace_back(location, time, altitude, vario, drift_factor);
+  }
+
+  return points;
+}
+
+static void
+Save(Serialiser &s, const ContestResult &result)
+{
+  s.WriteDouble(result.score);
+  s.WriteDouble(result.distance);
+  s.WriteDouble(result.time.count());
+}
+
+static ContestResult
+LoadContestResult(Deserialiser &s)
+{
+  ContestResult result;
+  result.score = s.ReadDouble();
+  result.distance = s.ReadDouble();
+  result.time = FloatDuration{s.ReadDouble()};
+  return result;
+}
+
+static void
+Save(Serialiser &s, const ContestTraceVector &solution)
+{
+  s.Write8(solution.size());
+
+  for (const auto &i : solution) {
+    s.Write32(i.GetTime().count());
+    Save(s, i.GetLocation());
+  }
+}
+
+static ContestTraceVector
+LoadContestTraceVector(Deserialiser &s)
+{
+  const unsigned n = s.Read8();
+
+  ContestTraceVector solution;
+  if (n > solution.capacity())
+    throw std::runtime_error("Malformed contest solution");
+
+  for (unsigned i = 0; i < n; ++i) {
+    auto &point = solution.append();
+    point.time = ContestTracePoint::Duration{s.Read32()};
+    point.location = LoadGeoPoint(s);
+  }
+
+  return solution;
+}
+
+static void
+Save(Serialiser &s, const std::map<unsigned, unsigned> &pairs)
+{
+  s.Write32(pairs.size());
+
+  for (const auto &[first, last] : pairs) {
+    s.Write32(first);
+    s.Write32(last);
+  }
+}
+
+static std::map<unsigned, unsigned>
+LoadPairs(Deserialiser &s, unsigned n_points)
+{
+  const unsigned n = s.Read32();
+  if (n > n_points)
+    throw std::runtime_error("Malformed closing pairs");
+
+  std::map<unsigned, unsigned> pairs;
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned first = s.Read32(), last = s.Read32();
+    if (first > last || last >= n_points)
+      throw std::runtime_error("Malformed closing pairs");
+
+    pairs.emplace(first, last);
+  }
+
+  return pairs;
+}
+
+static void
+Save(Serialiser &s,
+     const std::map<unsigned, TriangleContest::SolvedRange> &ranges)
+{
+  s.Write32(ranges.size());
+
+  for (const auto &[first, range] : ranges) {
+    s.Write32(first);
+    s.Write32(range.last);
+    s.Write32(range.bound);
+    s.Write32(range.best.tp1);
+    s.Write32(range.best.tp2);
+    s.Write32(range.best.tp3);
+    s.Write32(range.best.distance);
+  }
+}
+
+static std::map<unsigned, TriangleContest::SolvedRange>
+LoadSolvedRanges(Deserialiser &s, unsigned n_points)
+{
+  const unsigned n = s.Read32();
+  if (n > n_points)
+    throw std::runtime_error("Malformed solved ranges");
+
+  std::map<unsigned, TriangleContest::SolvedRange> ranges;
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned first = s.Read32();
+
+    TriangleContest::SolvedRange range;
+    range.last = s.Read32();
+    range.bound = s.Read32();
+    range.best.tp1 = s.Read32();
+    range.best.tp2 = s.Read32();
+    range.best.tp3 = s.Read32();
+    range.best.distance = s.Read32();
+
+    if (first > range.last || range.last >= n_points ||
+        (range.best.distance > 0 &&
+         (range.best.tp1 < first || range.best.tp1 > range.best.tp2 ||
+          range.best.tp2 > range.best.tp3 ||
+          range.best.tp3 > range.last)))
+      throw std::runtime_error("Malformed solved ranges");
+
+    ranges.emplace(first, range);
+  }
+
+  return ranges;
+}
+
+static void
+Save(Serialiser &s, const TriangleContest::Checkpoint &checkpoint)
+{
+  s.Write32(checkpoint.n_points);
+  if (checkpoint.n_points == 0)
+    return;
+
+  s.Write32(checkpoint.last_location.x);
+  s.Write32(checkpoint.last_location.y);
+  s.Write32(checkpoint.best_d);
+  Save(s, checkpoint.solution);
+  Save(s, checkpoint.closing_pairs);
+  Save(s, checkpoint.solved_ranges);
+}
+
+static TriangleContest::Checkpoint
+LoadTriangleCheckpoint(Deserialiser &s)
+{
+  TriangleContest::Checkpoint checkpoint;
+  checkpoint.n_points = s.Read32();
+  if (checkpoint.n_points == 0)
+    return checkpoint;
+
+  checkpoint.last_location.x = (int32_t)s.Read32();
+  checkpoint.last_location.y = (int32_t)s.Read32();
+  checkpoint.best_d = s.Read32();
+  checkpoint.solution = LoadContestTraceVector(s);
+  checkpoint.closing_pairs = LoadPairs(s, checkpoint.n_points);
+  checkpoint.solved_ranges = LoadSolvedRanges(s, checkpoint.n_points);
+  return checkpoint;
+}
+
+namespace {
+
+/**
+ * The state of one solver, read from the checkpoint before it gets
+ * applied.
+ */
+struct SolverCheckpoint {
+  ContestResult result;
+  ContestTraceVector solution;
+
+  std::optional<TriangleContest::Checkpoint> triangle;
+};
+
+struct SaveSolver {
+  Serialiser &s;
+
+  void operator()(const AbstractContest &solver) const {
+    Save(s, solver.GetBestResult());
+    Save(s, solver.GetBestSolution());
+  }
+
+  void operator()(const TriangleContest &solver) const {
+    (*this)(static_cast<const AbstractContest &>(solver));
+    Save(s, solver.GetCheckpoint());
+  }
+};
+
+struct LoadSolver {
+  Deserialiser &s;
+  std::vector<SolverCheckpoint> &solvers;
+
+  void operator()(const AbstractContest &) const {
+    auto &solver = solvers.emplace_back();
+    solver.result = LoadContestResult(s);
+    solver.solution = LoadContestTraceVector(s);
+  }
+
+  void operator()(const TriangleContest &solver) const {
+    (*this)(static_cast<const AbstractContest &>(solver));
+    solvers.back().triangle = LoadTriangleCheckpoint(s);
+  }
+};
+
+struct RestoreSolver {
+  std::vector<SolverCheckpoint>::iterator i;
+
+  void operator()(AbstractContest &solver) {
+    /* this only restores what gets reported; the Dijkstra solvers
+       have no search state in the checkpoint and start over */
+    solver.RestoreBest(i->result, i->solution);
+    ++i;
+  }
+
+  void operator()(TriangleContest &solver) {
+    /* this resets the solver, therefore it must be called before
+       restoring the best result */
+    solver.RestoreCheckpoint(std::move(*i->triangle));
+    (*this)(static_cast<AbstractContest &>(solver));
+  }
+};
+
+} // anonymous namespace
+
+void
+SaveContestCheckpoint(Path path, const ContestSettings &settings,
+                      BrokenDate date, const TraceComputer &trace,
+                      const ContestComputer &contest)
+{
+  const ContestManager &manager = contest.GetManager();
+
+  TracePointVector full, triangle, sprint;
+  trace.GetFull().GetPoints(full);
+  trace.GetContest().GetPoints(triangle);
+  trace.GetSprint().GetPoints(sprint);
+
+  FileOutputStream fos(path);
+
+  {
+    Serialiser s(fos);
+    s.Write32(CHECKPOINT_MAGIC);
+    s.Write32(CHECKPOINT_VERSION);
+    s.Write8((uint8_t)settings.contest);
+    s.Write32(settings.handicap);
+    s.Write16(date.year);
+    s.Write8(date.month);
+    s.Write8(date.day);
+
+    Save(s, full);
+    Save(s, triangle);
+    Save(s, sprint);
+
+    const auto &stats = manager.GetStats();
+    for (std::size_t i = 0; i < ContestStatistics::N; ++i) {
+      Save(s, stats.result[i]);
+      Save(s, stats.solution[i]);
+    }
+
+    manager.ForEachSolver(SaveSolver{s});
+    s.Flush();
+  }
+
+  fos.Commit();
+}
+
+bool
+LoadContestCheckpoint(Path path, const ContestSettings &settings,
+                      BrokenDate date, std::chrono::duration<unsigned> now,
+                      TraceComputer &trace, ContestComputer &contest)
+{
+  if (!File::Exists(path))
+    return false;
+
+  FileReader fr(path);
+  Deserialiser s(fr);
+
+  if (s.Read32() != CHECKPOINT_MAGIC ||
+      s.Read32() != CHECKPOINT_VERSION)
+    /* written by another version */
+    return false;
+
+  if (s.Read8() != (uint8_t)settings.contest ||
+      s.Read32() != settings.handicap)
+    return false;
+
+  BrokenDate saved_date;
+  saved_date.year = s.Read16();
+  saved_date.month = s.Read8();
+  saved_date.day = s.Read8();
+  if (!(saved_date == date))
+    return false;
+
+  auto full = LoadTracePoints(s, trace.GetFull().GetMaxSize());
+  auto triangle = LoadTracePoints(s, trace.GetContest().GetMaxSize());
+  auto sprint = LoadTracePoints(s, trace.GetSprint().GetMaxSize());
+
+  /* only resume the flight which was interrupted a moment ago */
+  if (full.empty() || now < full.back().GetTime() ||
+      now - full.back().GetTime() > MAX_GAP)
+    return false;
+
+  ContestStatistics stats;
+  for (std::size_t i = 0; i < ContestStatistics::N; ++i) {
+    stats.result[i] = LoadContestResult(s);
+    stats.solution[i] = LoadContestTraceVector(s);
+  }
+
+  ContestManager &manager = contest.GetManager();
+
+  std::vector<SolverCheckpoint> solvers;
+  manager.ForEachSolver(LoadSolver{s, solvers});
+
+  /* the whole file has been parsed successfully; now apply it */
+
+  trace.Restore(full, triangle, sprint);
+  manager.Reset();
+  manager.RestoreStats(stats);
+  manager.ForEachSolver(RestoreSolver{solvers.begin()});
+  return true;
+}
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "time/BrokenDate.hpp"
+
+#include <chrono>
+
+class Path;
+struct ContestSettings;
+class TraceComputer;
+class ContestComputer;
+
+/**
+ * Write the flight traces and the state of the contest solvers to a
+ * file, which allows resuming the contest optimisation after XCSoar
+ * has been restarted during the flight.
+ *
+ * Throws on error.
+ *
+ * @param date the current date
+ */
+void
+SaveContestCheckpoint(Path path, const ContestSettings &settings,
+                      BrokenDate date, const TraceComputer &trace,
+                      const ContestComputer &contest);
+
+/**
+ * Restore a checkpoint written by SaveContestCheckpoint(), unless it
+ * belongs to another flight or to other contest settings.
+ *
+ * Throws on error.
+ *
+ * @param date the current date
+ * @param now the current time of day (see TracePoint::GetTime())
+ * @return true if the checkpoint has been restored
+ */
+bool
+LoadContestCheckpoint(Path path, const ContestSettings &settings,
+                      BrokenDate date, std::chrono::duration<unsigned> now,
+                      TraceComputer &trace, ContestComputer &contest);
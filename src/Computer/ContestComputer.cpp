@@ -3,6 +3,15 @@
 
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
+#include "thread/ThreadPool.hpp"
+#include "LogFile.hpp"
+
+#include <algorithm> // for std::min()
+
+/**
+ * No contest has more than this number of independent solvers.
+ */
+static constexpr unsigned MAX_CONTEST_THREADS = 3;
 
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
@@ -10,8 +19,21 @@ ContestComputer::ContestComputer(const Trace &trace_full,
   :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+
+  const unsigned n = std::min(ThreadPool::GetProcessorCount(),
+                              MAX_CONTEST_THREADS);
+  if (n > 1) {
+    try {
+      thread_pool = std::make_unique<ThreadPool>("Contest", n - 1);
+      contest_manager.SetThreadPool(thread_pool.get());
+    } catch (...) {
+      LogError(std::current_exception(), "Failed to create contest threads");
+    }
+  }
 }
 
+ContestComputer::~ContestComputer() noexcept = default;
+
 void
 ContestComputer::Solve(const ContestSettings &settings,
                        ContestStatistics &contest_stats)
@@ -5,17 +5,27 @@
 
 #include "Engine/Contest/ContestManager.hpp"
 
+#include <memory>
+
 struct ContestSettings;
 struct ContestStatistics;
 class Trace;
+class ThreadPool;
 
 class ContestComputer {
+  /**
+   * Worker threads for the #contest_manager; nullptr on single-core
+   * machines or if the threads could not be created.
+   */
+  std::unique_ptr<ThreadPool> thread_pool;
+
   ContestManager contest_manager;
 
 public:
   ContestComputer(const Trace &trace_full,
                   const Trace &trace_triangle,
                   const Trace &trace_sprint);
+  ~ContestComputer() noexcept;
 
   void SetIncremental(bool incremental) {
     contest_manager.SetIncremental(incremental);
@@ -25,6 +35,14 @@ public:
     contest_manager.Reset();
   }
 
+  const ContestManager &GetManager() const {
+    return contest_manager;
+  }
+
+  ContestManager &GetManager() {
+    return contest_manager;
+  }
+
   /**
    * @see ContestDijkstra::SetPredicted()
    */
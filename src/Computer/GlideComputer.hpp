@@ -65,6 +65,13 @@ public:
     log_computer.SetLogger(logger);
   }
 
+  /**
+   * @see TaskComputer::SetCheckpointPath()
+   */
+  void SetContestCheckpointPath(AllocatedPath &&path) {
+    task_computer.SetCheckpointPath(std::move(path));
+  }
+
   /**
    * Resets the GlideComputer data
    * @param full Reset all data?
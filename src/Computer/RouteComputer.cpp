@@ -7,21 +7,46 @@
 #include "NMEA/Derived.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "thread/ThreadPool.hpp"
+#include "LogFile.hpp"
 
 #include <algorithm>
 
+/**
+ * More threads don't help with the few dozen rays of a reach fan or
+ * the handful of alternates.
+ */
+static constexpr unsigned MAX_ROUTE_THREADS = 4;
+
 RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
   :protected_route_planner(route_planner, airspace_database, warnings),
+   alternate_planner(airspace_database, warnings),
    terrain(NULL)
-{}
+{
+  const unsigned n = std::min(ThreadPool::GetProcessorCount(),
+                              MAX_ROUTE_THREADS);
+  if (n > 1) {
+    try {
+      thread_pool = std::make_unique<ThreadPool>("Route", n - 1);
+      route_planner.SetThreadPool(thread_pool.get());
+      alternate_planner.SetThreadPool(thread_pool.get());
+    } catch (...) {
+      LogError(std::current_exception(), "Failed to create route threads");
+    }
+  }
+}
+
+RouteComputer::~RouteComputer() noexcept = default;
 
 void
 RouteComputer::ResetFlight()
 {
   route_clock.Reset();
   reach_clock.Reset();
+  alternate_clock.Reset();
   protected_route_planner.Reset();
+  alternate_planner.Reset();
 
   last_task_type = TaskType::NONE;
   last_active_tp = 0;
@@ -32,7 +57,8 @@ RouteComputer::ProcessRoute(const MoreData &basic, DerivedInfo &calculated,
                             const GlideSettings &settings,
                             const RoutePlannerConfig &config,
                             const GlidePolar &glide_polar,
-                            const GlidePolar &safety_polar)
+                            const GlidePolar &safety_polar,
+                            const AlternateRoutePlanner::DestinationList &alternates)
 {
   if (!basic.location_available || !basic.NavAltitudeAvailable())
     return;
@@ -44,6 +70,7 @@ RouteComputer::ProcessRoute(const MoreData &basic, DerivedInfo &calculated,
 
   Reach(basic, calculated, config);
   TerrainWarning(basic, calculated, config);
+  Alternates(basic, calculated, settings, config, glide_polar, alternates);
 }
 
 inline void
@@ -133,8 +160,34 @@ RouteComputer::Reach(const MoreData &basic, DerivedInfo &calculated,
   }
 }
 
+inline void
+RouteComputer::Alternates(const MoreData &basic, DerivedInfo &calculated,
+                          const GlideSettings &settings,
+                          const RoutePlannerConfig &config,
+                          const GlidePolar &glide_polar,
+                          const AlternateRoutePlanner::DestinationList &alternates)
+{
+  if (terrain == nullptr || alternates.empty()) {
+    calculated.alternate_routes.clear();
+    return;
+  }
+
+  if (!alternate_clock.CheckAdvance(basic.time, PERIOD))
+    return;
+
+  const AircraftState state = ToAircraftState(basic, calculated);
+  const AGeoPoint start(state.location, state.altitude);
+  const int h_ceiling(std::max((int)basic.nav_altitude + 500,
+                               (int)calculated.common_stats.height_max_working));
+
+  alternate_planner.Update(start, alternates, settings, config, glide_polar,
+                           calculated.GetWindOrZero(), h_ceiling,
+                           calculated.alternate_routes);
+}
+
 void
 RouteComputer::set_terrain(const RasterTerrain* _terrain) {
   terrain = _terrain;
   protected_route_planner.SetTerrain(terrain);
+  alternate_planner.SetTerrain(terrain);
 }
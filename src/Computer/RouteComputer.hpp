@@ -4,10 +4,13 @@
 #pragma once
 
 #include "Task/ProtectedRoutePlanner.hpp"
+#include "Task/AlternateRoutePlanner.hpp"
 #include "Engine/Task/TaskType.hpp"
 #include "Engine/Route/RoutePlanner.hpp"
 #include "time/GPSClock.hpp"
 
+#include <memory>
+
 struct MoreData;
 struct DerivedInfo;
 struct GlideSettings;
@@ -15,15 +18,25 @@ struct RoutePlannerConfig;
 class ProtectedAirspaceWarningManager;
 class RasterTerrain;
 class GlidePolar;
+class ThreadPool;
 
 class RouteComputer {
   static constexpr std::chrono::steady_clock::duration PERIOD = std::chrono::seconds(5);
 
+  /**
+   * Calculates the reach and the routes to the alternates in
+   * parallel on multi-core machines.
+   */
+  std::unique_ptr<ThreadPool> thread_pool;
+
   RoutePlannerGlue route_planner;
   ProtectedRoutePlanner protected_route_planner;
 
+  AlternateRoutePlanner alternate_planner;
+
   GPSClock route_clock;
   GPSClock reach_clock;
+  GPSClock alternate_clock;
 
   const RasterTerrain *terrain;
 
@@ -33,6 +46,7 @@ class RouteComputer {
 public:
   RouteComputer(const Airspaces &airspace_database,
                 const ProtectedAirspaceWarningManager *warnings);
+  ~RouteComputer() noexcept;
 
   const ProtectedRoutePlanner &GetProtectedRoutePlanner() const {
     return protected_route_planner;
@@ -44,14 +58,21 @@ public:
    */
   void ClearAirspaces() {
     route_planner.Reset();
+    alternate_planner.Reset();
   }
 
   void ResetFlight();
+
+  /**
+   * @param alternates the destinations for
+   * DerivedInfo::alternate_routes
+   */
   void ProcessRoute(const MoreData &basic, DerivedInfo &calculated,
                     const GlideSettings &settings,
                     const RoutePlannerConfig &config,
                     const GlidePolar &glide_polar,
-                    const GlidePolar &safety_polar);
+                    const GlidePolar &safety_polar,
+                    const AlternateRoutePlanner::DestinationList &alternates);
 
   void set_terrain(const RasterTerrain* _terrain);
 
@@ -62,4 +83,10 @@ private:
 
   void Reach(const MoreData &basic, DerivedInfo &calculated,
              const RoutePlannerConfig &config);
+
+  void Alternates(const MoreData &basic, DerivedInfo &calculated,
+                  const GlideSettings &settings,
+                  const RoutePlannerConfig &config,
+                  const GlidePolar &glide_polar,
+                  const AlternateRoutePlanner::DestinationList &alternates);
 };
@@ -5,16 +5,25 @@
 #include "Task/ProtectedTaskManager.hpp"
 #include "Engine/Task/TaskManager.hpp"
 #include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Engine/Task/Unordered/AlternateList.hpp"
+#include "Engine/Waypoint/Waypoint.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
 #include "Settings.hpp"
+#include "ContestCheckpoint.hpp"
+#include "LogFile.hpp"
 
 #include <algorithm>
 
 using std::max;
 using namespace std::chrono;
 
+/**
+ * How often is the contest checkpoint written during the flight?
+ */
+static constexpr auto CHECKPOINT_PERIOD = minutes{1};
+
 // JMW TODO: abstract up to higher layer so a base copy of this won't
 // call any event
 
@@ -40,6 +49,7 @@ TaskComputer::ResetFlight([[maybe_unused]] const bool full)
   last_flying = false;
 
   last_location_available.Clear();
+  alternates.clear();
 }
 
 void
@@ -48,6 +58,10 @@ TaskComputer::ProcessBasicTask(const MoreData &basic,
                                const ComputerSettings &settings_computer,
                                bool force)
 {
+  if (checkpoint_pending && calculated.flight.flying &&
+      basic.time_available && settings_computer.contest.enable)
+    LoadCheckpoint(basic, settings_computer.contest);
+
   trace.Update(settings_computer, basic, calculated);
 
   ProtectedTaskManager::ExclusiveLease _task(task);
@@ -79,6 +93,18 @@ TaskComputer::ProcessBasicTask(const MoreData &basic,
   calculated.ordered_task_stats = _task->GetOrderedTask().GetStats();
   calculated.common_stats = _task->GetCommonStats();
   calculated.glide_polar_safety = _task->GetSafetyPolar();
+
+  alternates.clear();
+  for (const auto &i : _task->GetAlternates()) {
+    if (alternates.full())
+      break;
+
+    if (i.solution.IsDefined())
+      alternates.push_back({
+          i.waypoint->id,
+          AGeoPoint(i.waypoint->location, i.solution.min_arrival_altitude),
+        });
+  }
 }
 
 void
@@ -92,7 +118,7 @@ TaskComputer::ProcessMoreTask(const MoreData &basic,
   route.ProcessRoute(basic, calculated,
                      settings_computer.task.glide,
                      settings_computer.task.route_planner,
-                     glide_polar, safety_polar);
+                     glide_polar, safety_polar, alternates);
 
   if (settings_computer.features.block_stf_enabled)
     calculated.V_stf = calculated.common_stats.V_block;
@@ -139,12 +165,46 @@ TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
   else
     contest.Solve(settings_computer.contest, calculated.contest_stats);
 
+  if (checkpoint_path != nullptr && !checkpoint_pending && !exhaustive &&
+      calculated.flight.flying && settings_computer.contest.enable &&
+      checkpoint_clock.CheckUpdate(CHECKPOINT_PERIOD))
+    SaveCheckpoint(basic, settings_computer.contest);
+
   const AircraftState as = ToAircraftState(basic, calculated);
 
   ProtectedTaskManager::ExclusiveLease _task(task);
   _task->UpdateIdle(as);
 }
 
+void
+TaskComputer::LoadCheckpoint(const MoreData &basic,
+                             const ContestSettings &settings) noexcept
+{
+  checkpoint_pending = false;
+
+  try {
+    if (LoadContestCheckpoint(checkpoint_path, settings,
+                              basic.date_time_utc,
+                              basic.time.Cast<duration<unsigned>>(),
+                              trace, contest))
+      LogFormat("Restored contest checkpoint");
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load contest checkpoint");
+  }
+}
+
+void
+TaskComputer::SaveCheckpoint(const MoreData &basic,
+                             const ContestSettings &settings) noexcept
+{
+  try {
+    SaveContestCheckpoint(checkpoint_path, settings, basic.date_time_utc,
+                          trace, contest);
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to save contest checkpoint");
+  }
+}
+
 void 
 TaskComputer::ProcessAutoTask([[maybe_unused]] const NMEAInfo &basic,
                               const DerivedInfo &calculated)
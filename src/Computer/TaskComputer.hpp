@@ -8,8 +8,11 @@
 #include "ContestComputer.hpp"
 #include "Engine/Navigation/Aircraft.hpp"
 #include "NMEA/Validity.hpp"
+#include "system/Path.hpp"
+#include "time/PeriodClock.hpp"
 
 struct NMEAInfo;
+struct ContestSettings;
 class ProtectedTaskManager;
 class ProtectedAirspaceWarningManager;
 
@@ -30,6 +33,26 @@ class TaskComputer
 
   Validity last_location_available;
 
+  /**
+   * The nearest alternates, copied from the #TaskManager for
+   * RouteComputer::ProcessRoute().
+   */
+  AlternateRoutePlanner::DestinationList alternates;
+
+  /**
+   * The file which stores the trace and the contest solver state
+   * during the flight; nullptr if disabled.
+   */
+  AllocatedPath checkpoint_path = nullptr;
+
+  /**
+   * Shall the checkpoint be restored on the next fix during the
+   * flight?  This is only done once after startup.
+   */
+  bool checkpoint_pending = false;
+
+  PeriodClock checkpoint_clock;
+
 public:
   TaskComputer(ProtectedTaskManager &_task,
                const Airspaces &airspace_database,
@@ -76,6 +99,16 @@ public:
     contest.SetIncremental(incremental);
   }
 
+  /**
+   * Write the trace and the contest solver state to the given file
+   * periodically, and restore it if XCSoar gets restarted during the
+   * flight.
+   */
+  void SetCheckpointPath(AllocatedPath &&path) {
+    checkpoint_path = std::move(path);
+    checkpoint_pending = true;
+  }
+
   /**
    * Auto-create a task on takeoff that leads back home.
    */
@@ -84,4 +117,10 @@ public:
   void ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
                    const ComputerSettings &settings_computer,
                    bool exhaustive=false);
+
+private:
+  void LoadCheckpoint(const MoreData &basic,
+                      const ContestSettings &settings) noexcept;
+  void SaveCheckpoint(const MoreData &basic,
+                      const ContestSettings &settings) noexcept;
 };
@@ -31,6 +31,29 @@ TraceComputer::Reset()
   sprint.clear();
 }
 
+static void
+Restore(Trace &trace, const TracePointVector &points)
+{
+  trace.clear();
+
+  for (const auto &i : points)
+    trace.push_back(i);
+}
+
+void
+TraceComputer::Restore(const TracePointVector &_full,
+                       const TracePointVector &_contest,
+                       const TracePointVector &_sprint)
+{
+  {
+    const std::lock_guard lock{mutex};
+    ::Restore(full, _full);
+  }
+
+  ::Restore(contest, _contest);
+  ::Restore(sprint, _sprint);
+}
+
 void
 TraceComputer::LockedCopyTo(TracePointVector &v) const
 {
@@ -5,6 +5,7 @@
 
 #include "thread/Mutex.hxx"
 #include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/Vector.hpp"
 
 struct ComputerSettings;
 struct MoreData;
@@ -56,6 +57,14 @@ public:
 
   void Reset();
 
+  /**
+   * Replace all traces with the given points, e.g. from a
+   * checkpoint.
+   */
+  void Restore(const TracePointVector &_full,
+               const TracePointVector &_contest,
+               const TracePointVector &_sprint);
+
   /**
    * Extract all trace points.  The trace is locked, and the method
    * may be called from any thread.
@@ -30,6 +30,7 @@ enum ControlIndex {
   TerrainContrast,
   TerrainBrightness,
   TerrainContours,
+  TerrainThreads,
   TerrainPreview,
 };
 
@@ -87,6 +88,7 @@ TerrainDisplayConfigPanel::ShowTerrainControls()
   SetRowVisible(TerrainContrast, show);
   SetRowVisible(TerrainBrightness, show);
   SetRowVisible(TerrainContours, show);
+  SetRowVisible(TerrainThreads, show);
   if (have_terrain_preview)
     SetRowVisible(TerrainPreview, show);
 }
@@ -114,6 +116,7 @@ TerrainDisplayConfigPanel::UpdateTerrainPreview()
   terrain_settings.ramp = GetValueEnum(TerrainColors);
   terrain_settings.contours = (Contours)
     GetValueEnum(TerrainContours);
+  terrain_settings.threads = GetValueEnum(TerrainThreads);
 
   // Invalidate terrain preview
   if (have_terrain_preview)
@@ -252,6 +255,21 @@ TerrainDisplayConfigPanel::Prepare(ContainerWindow &parent,
   GetDataField(TerrainContours).SetListener(this);
   SetExpertRow(TerrainContours);
 
+  static constexpr StaticEnumChoice threads_list[] = {
+    { 0u, N_("Auto"), },
+    { 1u, _T("1"), },
+    { 2u, _T("2"), },
+    { 3u, _T("3"), },
+    { 4u, _T("4"), },
+    nullptr
+  };
+
+  AddEnum(_("Terrain threads"),
+          _("The maximum number of CPU cores used to draw the terrain.  Reduce this on devices which get hot or drain the battery quickly."),
+          threads_list, terrain.threads);
+  GetDataField(TerrainThreads).SetListener(this);
+  SetExpertRow(TerrainThreads);
+
   have_terrain_preview = data_components->terrain != nullptr;
   if (have_terrain_preview) {
     WindowStyle style;
@@ -282,6 +300,7 @@ TerrainDisplayConfigPanel::Save(bool &_changed) noexcept
   Profile::Set(ProfileKeys::TerrainRamp, terrain_settings.ramp);
   Profile::SetEnum(ProfileKeys::SlopeShadingType, terrain_settings.slope_shading);
   Profile::SetEnum(ProfileKeys::TerrainContours, terrain_settings.contours);
+  Profile::Set(ProfileKeys::TerrainThreads, terrain_settings.threads);
 
   changed |= SaveValue(EnableTopography, ProfileKeys::DrawTopography,
                        settings_map.topography_enabled);
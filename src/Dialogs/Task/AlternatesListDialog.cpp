@@ -18,7 +18,9 @@
 #include "Renderer/TwoTextRowsRenderer.hpp"
 #include "Language/Language.hpp"
 #include "ActionInterface.hpp"
+#include "NMEA/Derived.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 class AlternatesListWidget final
@@ -82,8 +84,25 @@ public:
     const Waypoint &waypoint = *alternates[index].waypoint;
     const GlideResult& solution = alternates[index].solution;
 
-    WaypointListRenderer::Draw(canvas, rc, waypoint, solution.vector.distance,
-                               solution.SelectAltitudeDifference(settings.task.glide),
+    double distance = solution.vector.distance;
+    double altitude_difference =
+      solution.SelectAltitudeDifference(settings.task.glide);
+
+    /* prefer the arrival along the route around obstacles, if one
+       was planned */
+    const auto &routes = CommonInterface::Calculated().alternate_routes;
+    if (const auto route = std::find_if(routes.begin(), routes.end(),
+                                        [&waypoint](const auto &r){
+                                          return r.id == waypoint.id;
+                                        });
+        route != routes.end() && route->detour) {
+      distance = route->distance;
+      altitude_difference = std::min(altitude_difference,
+                                     double(route->altitude_difference));
+    }
+
+    WaypointListRenderer::Draw(canvas, rc, waypoint, distance,
+                               altitude_difference,
                                row_renderer,
                                UIGlobals::GetMapLook().waypoint,
                                CommonInterface::GetMapSettings().waypoint);
@@ -181,6 +181,21 @@ public:
    */
   void SetFlightLevel(AtmosphericPressure press) noexcept;
 
+  /**
+   * Is it necessary to call SetFlightLevel() for this AbstractAirspace?
+   */
+  bool NeedFlightLevel() const noexcept {
+    return altitude_base.NeedFlightLevel() || altitude_top.NeedFlightLevel();
+  }
+
+  /**
+   * Does SetActivity() need to be called for this AbstractAirspace,
+   * i.e. is it not active on all days?
+   */
+  bool NeedActivity() const noexcept {
+    return !days_of_operation.equals(AirspaceActivity{});
+  }
+
   /**
    * Set activity based on day mask
    *
@@ -226,6 +241,10 @@ public:
     days_of_operation = mask;
   }
 
+  const AirspaceActivity &GetDays() const noexcept {
+    return days_of_operation;
+  }
+
   /**
    * Get asclass of airspace
    *
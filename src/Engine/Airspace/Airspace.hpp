@@ -44,6 +44,14 @@ public:
   Airspace(AirspacePtr _airspace,
            const FlatProjection &projection) noexcept;
 
+  /**
+   * Constructor for airspaces whose border has already been
+   * projected, and whose bounding box is known (e.g. loaded from a
+   * cache).
+   */
+  Airspace(AirspacePtr _airspace, const FlatBoundingBox &box) noexcept
+    :FlatBoundingBox(box), airspace(std::move(_airspace)) {}
+
   /**
    * Checks whether an aircraft is inside the airspace.
    *
@@ -90,6 +90,13 @@ struct AirspaceAltitude
    */
   void SetFlightLevel(AtmosphericPressure press) noexcept;
 
+  /**
+   * Is it necessary to call SetFlightLevel() for this AirspaceAltitude?
+   */
+  constexpr bool NeedFlightLevel() const noexcept {
+    return reference == AltitudeReference::STD;
+  }
+
   static constexpr bool SortHighest(const AirspaceAltitude &a,
                                     const AirspaceAltitude &b) noexcept {
     return a.altitude > b.altitude;
@@ -6,6 +6,9 @@
 #include "Geo/Flat/FlatRay.hpp"
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
+#include "Geo/ConvexHull/PolygonInterior.hpp"
+
+#include <algorithm>
 
 AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts) noexcept
   :AbstractAirspace(Shape::POLYGON)
@@ -24,6 +27,20 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts) noexcept
     m_border.emplace_back(p_start);
 
   is_convex = TriState::UNKNOWN;
+
+  edge_index.Build(m_border);
+}
+
+AirspacePolygon::AirspacePolygon(SearchPointVector &&border) noexcept
+  :AbstractAirspace(Shape::POLYGON)
+{
+  assert(border.size() >= 3);
+  assert(border.front().GetLocation() == border.back().GetLocation());
+
+  m_border = std::move(border);
+  is_convex = TriState::UNKNOWN;
+
+  edge_index.Build(m_border);
 }
 
 const GeoPoint
@@ -55,6 +72,9 @@ AirspacePolygon::GetCenter() const noexcept
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const noexcept
 {
+  if (edge_index.IsDefined())
+    return PolygonInterior(loc, m_border, edge_index);
+
   return m_border.IsInside(loc);
 }
 
@@ -67,13 +87,42 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
-  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
+  if (!edge_index.IsDefined()) {
+    for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
+
+      const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+      auto t = ray.DistinctIntersection(r_seg);
+      if (t >= 0)
+        sorter.add(t, projection.Unproject(ray.Parametric(t)));
+    }
 
-    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+    return sorter.all();
+  }
+
+  /* an edge can only intersect the ray if the bounding boxes
+     overlap; convert the ray's y range to a latitude range for the
+     index, with a margin for the rounding in ProjectInteger() */
+  const FlatGeoPoint ray_end = ray.point + ray.vector;
+  const int min_x = std::min(ray.point.x, ray_end.x);
+  const int max_x = std::max(ray.point.x, ray_end.x);
+  const int min_y = std::min(ray.point.y, ray_end.y);
+  const int max_y = std::max(ray.point.y, ray_end.y);
+
+  const Angle south = projection.Unproject(FlatGeoPoint(0, min_y - 1)).latitude;
+  const Angle north = projection.Unproject(FlatGeoPoint(0, max_y + 1)).latitude;
+
+  edge_index.VisitEdges(south, north, [&](std::size_t i){
+    const FlatGeoPoint &a = m_border[i].GetFlatLocation();
+    const FlatGeoPoint &b = m_border[i + 1].GetFlatLocation();
+    if (std::max(a.x, b.x) < min_x || std::min(a.x, b.x) > max_x ||
+        std::max(a.y, b.y) < min_y || std::min(a.y, b.y) > max_y)
+      return;
+
+    const FlatRay r_seg(a, b);
     auto t = ray.DistinctIntersection(r_seg);
     if (t >= 0)
       sorter.add(t, projection.Unproject(ray.Parametric(t)));
-  }
+  });
 
   return sorter.all();
 }
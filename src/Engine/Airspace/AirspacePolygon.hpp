@@ -4,6 +4,8 @@
 #pragma once
 
 #include "AbstractAirspace.hpp"
+#include "Geo/PolygonEdgeIndex.hpp"
+
 #include <vector>
 
 #ifdef DO_PRINT
@@ -12,6 +14,12 @@
 
 /** General polygon form airspace */
 class AirspacePolygon final : public AbstractAirspace {
+  /**
+   * Speeds up Inside() and Intersects() for large polygons; not
+   * defined for small ones.
+   */
+  PolygonEdgeIndex edge_index;
+
 public:
   /**
    * Constructor.  For testing, pts vector is a cloud of points,
@@ -23,12 +31,27 @@ public:
    */
   explicit AirspacePolygon(const std::vector<GeoPoint> &pts) noexcept;
 
+  /**
+   * Construct from a border which is already closed and projected
+   * (e.g. loaded from a cache).
+   */
+  explicit AirspacePolygon(SearchPointVector &&border) noexcept;
+
   /**
    * Converts border to convex hull of points (for testing only).
    */
   void MakeConvex() noexcept {
     m_border.PruneInterior();
     is_convex = TriState::TRUE;
+    edge_index.Build(m_border);
+  }
+
+  /**
+   * Discard the edge index, which makes Inside() and Intersects()
+   * scan the whole border (for testing only).
+   */
+  void ClearEdgeIndex() noexcept {
+    edge_index.Clear();
   }
 
   /* virtual methods from class AbstractAirspace */
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AirspaceWarningCandidates.hpp"
+#include "AirspaceWarningConfig.hpp"
+#include "Airspaces.hpp"
+#include "AbstractAirspace.hpp"
+#include "Navigation/Aircraft.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+
+#include <boost/geometry/algorithms/intersects.hpp>
+#include <boost/geometry/strategies/strategies.hpp>
+#include <boost/geometry/geometries/segment.hpp>
+
+#include <cassert>
+
+void
+AirspaceWarningCandidates::Clear() noexcept
+{
+  airspaces.clear();
+  left.clear();
+  bottom.clear();
+  right.clear();
+  top.clear();
+  eligible.clear();
+  inside.clear();
+
+  for (auto &i : hits)
+    i.clear();
+}
+
+void
+AirspaceWarningCandidates::Update(const Airspaces &database,
+                                  const AircraftState &state,
+                                  std::span<const GeoPoint> vectors,
+                                  const AirspaceWarningConfig &config,
+                                  double ceiling) noexcept
+{
+  assert(vectors.size() <= MAX_VECTORS);
+
+  Clear();
+
+  if (database.IsEmpty())
+    return;
+
+  const FlatProjection &projection = database.GetProjection();
+  const FlatGeoPoint origin = projection.ProjectInteger(state.location);
+
+  std::array<FlatGeoPoint, MAX_VECTORS> ends;
+  FlatBoundingBox box(origin);
+  for (std::size_t v = 0; v < vectors.size(); ++v) {
+    ends[v] = projection.ProjectInteger(vectors[v]);
+    box.Expand(ends[v]);
+  }
+
+  /* gather all airspaces which may be touched by any of the vectors
+     with just one r-tree query */
+
+  for (const auto &i : database.QueryIntersecting(box)) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+
+    airspaces.emplace_back(i.GetAirspacePtr());
+    left.push_back(i.GetLeft());
+    bottom.push_back(i.GetBottom());
+    right.push_back(i.GetRight());
+    top.push_back(i.GetTop());
+
+    eligible.push_back(airspace.IsActive() &&
+                       config.IsClassEnabled(airspace.GetClass()) &&
+                       (ceiling <= 0 ||
+                        airspace.GetBaseAltitude(state) <= ceiling));
+
+    const FlatBoundingBox &airspace_box = i;
+    inside.push_back(airspace_box.IsInside(origin) &&
+                     airspace.Inside(state.location));
+  }
+
+  const std::size_t n = airspaces.size();
+
+  /* check the bounding boxes of all vectors; these loops operate on
+     plain integer arrays, and can be vectorised by the compiler */
+
+  for (std::size_t v = 0; v < vectors.size(); ++v) {
+    const int min_x = std::min(origin.x, ends[v].x);
+    const int max_x = std::max(origin.x, ends[v].x);
+    const int min_y = std::min(origin.y, ends[v].y);
+    const int max_y = std::max(origin.y, ends[v].y);
+
+    auto &o = overlap[v];
+    o.resize(n);
+    for (std::size_t i = 0; i < n; ++i)
+      o[i] = (left[i] <= max_x) & (right[i] >= min_x) &
+        (bottom[i] <= max_y) & (top[i] >= min_y);
+  }
+
+  /* calculate the intersections of all vectors in one pass over the
+     airspaces; the exact segment test is the one used by
+     Airspaces::QueryIntersecting() */
+
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!eligible[i])
+      continue;
+
+    const FlatBoundingBox airspace_box({left[i], bottom[i]},
+                                       {right[i], top[i]});
+
+    for (std::size_t v = 0; v < vectors.size(); ++v) {
+      if (!overlap[v][i])
+        continue;
+
+      const boost::geometry::model::segment line{origin, ends[v]};
+      if (!boost::geometry::intersects(airspace_box, line))
+        continue;
+
+      auto intersections = airspaces[i]->Intersects(state.location,
+                                                    vectors[v],
+                                                    projection);
+      if (!intersections.empty())
+        hits[v].emplace_back(airspaces[i], std::move(intersections));
+    }
+  }
+}
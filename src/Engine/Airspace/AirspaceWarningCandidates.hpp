@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Ptr.hpp"
+#include "AirspaceIntersectionVector.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+struct AircraftState;
+struct AirspaceWarningConfig;
+class Airspaces;
+
+/**
+ * The airspaces which may be relevant for one
+ * AirspaceWarningManager::Update() call, gathered with a single
+ * #Airspaces query into parallel arrays.  The flat bounding boxes
+ * can then be tested against all prediction vectors in tight loops,
+ * and everything which does not depend on the prediction (the
+ * lateral "inside" test and the filters of
+ * AirspaceIntersectionWarningVisitor) is evaluated only once.
+ *
+ * The airspaces are stored in the order in which the #Airspaces
+ * r-tree returns them, which is the same order as in the individual
+ * queries, so the warnings are generated in the same order.
+ */
+class AirspaceWarningCandidates {
+public:
+  /**
+   * The maximum number of prediction vectors (glide, filter, task).
+   */
+  static constexpr std::size_t MAX_VECTORS = 3;
+
+  using Hit = std::pair<ConstAirspacePtr, AirspaceIntersectionVector>;
+
+private:
+  std::vector<ConstAirspacePtr> airspaces;
+
+  /**
+   * The flat bounding boxes of #airspaces.
+   */
+  std::vector<int> left, bottom, right, top;
+
+  /**
+   * Is the airspace active, is its class enabled and is its base
+   * below the ceiling of predicted intrusions?  The warning visitor
+   * ignores all others, so their intersections need not be
+   * calculated.
+   */
+  std::vector<uint8_t> eligible;
+
+  /**
+   * Does the (lateral) boundary of the airspace contain the aircraft
+   * location?
+   */
+  std::vector<uint8_t> inside;
+
+  /**
+   * Temporary buffer for each vector: does its bounding box overlap
+   * the airspace's?
+   */
+  std::array<std::vector<uint8_t>, MAX_VECTORS> overlap;
+
+  /**
+   * The intersections of each vector, in the order of #airspaces.
+   */
+  std::array<std::vector<Hit>, MAX_VECTORS> hits;
+
+public:
+  /**
+   * Query all airspaces which may intersect the given vectors, all
+   * of which start at the aircraft location, and calculate the
+   * intersections.
+   *
+   * @param ceiling the maximum base altitude of airspaces to be
+   * examined for predicted intrusions; non-positive to disable
+   */
+  void Update(const Airspaces &airspaces, const AircraftState &state,
+              std::span<const GeoPoint> vectors,
+              const AirspaceWarningConfig &config,
+              double ceiling) noexcept;
+
+  std::size_t size() const noexcept {
+    return airspaces.size();
+  }
+
+  const ConstAirspacePtr &GetAirspace(std::size_t i) const noexcept {
+    return airspaces[i];
+  }
+
+  /**
+   * See Airspaces::QueryInside(const GeoPoint &).
+   */
+  bool IsInside(std::size_t i) const noexcept {
+    return inside[i];
+  }
+
+  /**
+   * Returns the airspaces intersected by the given vector (index
+   * into the #vectors parameter of Update()), together with the
+   * result of Airspace::Intersects().  The caller may move the
+   * intersection vectors.
+   */
+  std::span<Hit> GetHits(std::size_t vector) noexcept {
+    return hits[vector];
+  }
+
+private:
+  void Clear() noexcept;
+};
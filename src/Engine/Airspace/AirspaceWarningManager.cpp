@@ -9,8 +9,21 @@
 #include "AirspaceAircraftPerformance.hpp"
 #include "Task/Stats/TaskStats.hpp"
 
+#include <optional>
+
 static constexpr double CRUISE_FILTER_FACT = 0.5;
 
+/**
+ * A vector from the aircraft location along which intrusions are
+ * predicted.
+ */
+struct AirspaceWarningPrediction {
+  GeoPoint location;
+  AirspaceAircraftPerformance perf;
+  AirspaceWarning::State warning_state;
+  FloatDuration max_time;
+};
+
 AirspaceWarningManager::AirspaceWarningManager(const AirspaceWarningConfig &_config,
                                                const Airspaces &_airspaces)
   :airspaces(_airspaces)
@@ -118,11 +131,19 @@ AirspaceWarningManager::Update(const AircraftState& state,
   for (auto &w : warnings)
     w.SaveState();
 
+  // update both filters even though we are using only one
+  cruise_filter.Update(state);
+  circling_filter.Update(state);
+
   // check from strongest to weakest alerts
-  UpdateInside(state, glide_polar);
-  UpdateGlide(state, glide_polar);
-  UpdateFilter(state, circling);
-  UpdateTask(state, glide_polar, task_stats);
+  if (batch) {
+    UpdateBatch(state, glide_polar, task_stats, circling);
+  } else {
+    UpdateInside(state, glide_polar);
+    UpdateGlide(state, glide_polar);
+    UpdateFilter(state, circling);
+    UpdateTask(state, glide_polar, task_stats);
+  }
 
   // action changes
   for (auto it = warnings.begin(), end = warnings.end(); it != end;) {
@@ -254,6 +275,21 @@ private:
 };
 
 
+double
+AirspaceWarningManager::GetPredictionCeiling(const AircraftState &state) const noexcept
+{
+  // the ceiling is the max height for predicted intrusions, given
+  // that you may be climbing.  the ceiling is nominally set at 1000m
+  // above the current altitude, but the 1000m margin should be at
+  // least as big as config.AltWarningMargin since if the airspace is
+  // visible according to that display mode, it should have warnings
+  // collected for it.  It is very unlikely users will have more than 1000m
+  // in AltWarningMargin anyway.
+
+  return state.altitude
+    + std::max((unsigned)1000, config.altitude_warning_margin);
+}
+
 bool 
 AirspaceWarningManager::UpdatePredicted(const AircraftState& state, 
                                         const GeoPoint &location_predicted,
@@ -268,21 +304,10 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
   const auto max_time_limit = std::min(FloatDuration{config.warning_time},
                                        max_time);
 
-  // the ceiling is the max height for predicted intrusions, given
-  // that you may be climbing.  the ceiling is nominally set at 1000m
-  // above the current altitude, but the 1000m margin should be at
-  // least as big as config.AltWarningMargin since if the airspace is
-  // visible according to that display mode, it should have warnings
-  // collected for it.  It is very unlikely users will have more than 1000m
-  // in AltWarningMargin anyway.
-
-  const auto ceiling = state.altitude
-    + std::max((unsigned)1000, config.altitude_warning_margin);
-
   AirspaceIntersectionWarningVisitor visitor(state, perf, 
                                              *this, 
                                              warning_state, max_time_limit,
-                                             ceiling);
+                                             GetPredictionCeiling(state));
 
   airspaces.VisitIntersecting(state.location, location_predicted, visitor);
 
@@ -296,23 +321,51 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
 }
 
 
-bool 
-AirspaceWarningManager::UpdateTask(const AircraftState &state,
-                                   const GlidePolar &glide_polar,
-                                   const TaskStats &task_stats)
+bool
+AirspaceWarningManager::UpdatePredicted(const AircraftState &state,
+                                        const AirspaceWarningPrediction &prediction,
+                                        std::span<AirspaceWarningCandidates::Hit> hits) noexcept
+{
+  const auto max_time_limit = std::min(FloatDuration{config.warning_time},
+                                       prediction.max_time);
+
+  AirspaceIntersectionWarningVisitor visitor(state, prediction.perf,
+                                             *this,
+                                             prediction.warning_state,
+                                             max_time_limit,
+                                             GetPredictionCeiling(state));
+
+  for (auto &[airspace, intersections] : hits) {
+    visitor.SetIntersections(std::move(intersections));
+    visitor.Visit(airspace);
+  }
+
+  visitor.SetMode(true);
+
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+    if (candidates.IsInside(i))
+      visitor.Visit(candidates.GetAirspace(i));
+
+  return visitor.Found();
+}
+
+static std::optional<AirspaceWarningPrediction>
+PredictTask(const AircraftState &state, const GlidePolar &glide_polar,
+            const TaskStats &task_stats,
+            const AirspaceWarningConfig &config) noexcept
 {
   if (!glide_polar.IsValid())
-    return false;
+    return std::nullopt;
 
   const ElementStat &current_leg = task_stats.current_leg;
 
   if (!task_stats.task_valid || !current_leg.location_remaining.IsValid())
-    return false;
+    return std::nullopt;
 
   const GlideResult &solution = current_leg.solution_remaining;
   if (!solution.IsOk() || !solution.IsAchievable())
     /* glide solver failed, cannot continue */
-    return false;
+    return std::nullopt;
 
   const AirspaceAircraftPerformance perf_task(glide_polar,
                                               current_leg.solution_remaining);
@@ -326,30 +379,61 @@ AirspaceWarningManager::UpdateTask(const AircraftState &state,
        the configured warning time */
     location_tp = state.location.IntermediatePoint(location_tp, max_distance);
 
-  return UpdatePredicted(state, location_tp, perf_task,
-                          AirspaceWarning::WARNING_TASK, time_remaining);
+  return AirspaceWarningPrediction{
+    location_tp, perf_task, AirspaceWarning::WARNING_TASK, time_remaining,
+  };
+}
+
+static AirspaceWarningPrediction
+PredictFilter(const AircraftStateFilter &filter,
+              FloatDuration prediction_time) noexcept
+{
+  return {
+    filter.GetPredictedState(prediction_time).location,
+    AirspaceAircraftPerformance(filter),
+    AirspaceWarning::WARNING_FILTER,
+    prediction_time,
+  };
+}
+
+static std::optional<AirspaceWarningPrediction>
+PredictGlide(const AircraftState &state, const GlidePolar &glide_polar,
+             FloatDuration prediction_time) noexcept
+{
+  if (!glide_polar.IsValid())
+    return std::nullopt;
+
+  return AirspaceWarningPrediction{
+    state.GetPredictedState(prediction_time).location,
+    AirspaceAircraftPerformance(glide_polar),
+    AirspaceWarning::WARNING_GLIDE,
+    prediction_time,
+  };
+}
+
+bool 
+AirspaceWarningManager::UpdateTask(const AircraftState &state,
+                                   const GlidePolar &glide_polar,
+                                   const TaskStats &task_stats)
+{
+  const auto prediction = PredictTask(state, glide_polar, task_stats, config);
+  if (!prediction)
+    return false;
+
+  return UpdatePredicted(state, prediction->location, prediction->perf,
+                         prediction->warning_state, prediction->max_time);
 }
 
 
 bool 
 AirspaceWarningManager::UpdateFilter(const AircraftState& state, const bool circling)
 {
-  // update both filters even though we are using only one
-  cruise_filter.Update(state);
-  circling_filter.Update(state);
+  const auto prediction =
+    PredictFilter(circling ? circling_filter : cruise_filter,
+                  prediction_time_filter);
 
-  const GeoPoint location_predicted = circling?
-    circling_filter.GetPredictedState(prediction_time_filter).location:
-    cruise_filter.GetPredictedState(prediction_time_filter).location;
-
-  if (circling) 
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(circling_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
-  else
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(cruise_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
+  return UpdatePredicted(state, prediction.location, prediction.perf,
+                         prediction.warning_state, prediction.max_time);
 }
 
 
@@ -357,16 +441,13 @@ bool
 AirspaceWarningManager::UpdateGlide(const AircraftState &state,
                                     const GlidePolar &glide_polar)
 {
-  if (!glide_polar.IsValid())
+  const auto prediction = PredictGlide(state, glide_polar,
+                                       prediction_time_glide);
+  if (!prediction)
     return false;
 
-  const GeoPoint location_predicted = 
-    state.GetPredictedState(prediction_time_glide).location;
-
-  const AirspaceAircraftPerformance perf_glide(glide_polar);
-  return UpdatePredicted(state, location_predicted,
-                          perf_glide,
-                          AirspaceWarning::WARNING_GLIDE, prediction_time_glide);
+  return UpdatePredicted(state, prediction->location, prediction->perf,
+                         prediction->warning_state, prediction->max_time);
 }
 
 bool
@@ -378,34 +459,79 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   bool found = false;
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const auto airspace = i.GetAirspacePtr();
+  for (const auto &i : airspaces.QueryInside(state.location))
+    if (UpdateInside(state, glide_polar, i.GetAirspacePtr()))
+      found = true;
+
+  return found;
+}
 
-    const AltitudeState &altitude = state;
-    if (// ignore inactive airspaces
-        !airspace->IsActive() ||
-        !config.IsClassEnabled(airspace->GetClass()) ||
-        !airspace->Inside(altitude))
-      continue;
+bool
+AirspaceWarningManager::UpdateInside(const AircraftState &state,
+                                     const GlidePolar &glide_polar,
+                                     ConstAirspacePtr airspace) noexcept
+{
+  const AltitudeState &altitude = state;
+  if (// ignore inactive airspaces
+      !airspace->IsActive() ||
+      !config.IsClassEnabled(airspace->GetClass()) ||
+      !airspace->Inside(altitude))
+    return false;
 
-    AirspaceWarning *warning = GetWarningPtr(*airspace);
+  AirspaceWarning *warning = GetWarningPtr(*airspace);
 
-    if (warning == nullptr ||
-        warning->IsStateAccepted(AirspaceWarning::WARNING_INSIDE)) {
-      GeoPoint c = airspace->ClosestPoint(state.location, GetProjection());
-      const AirspaceAircraftPerformance perf_glide(glide_polar);
-      const AirspaceInterceptSolution solution =
-        airspace->Intercept(state, c, GetProjection(), perf_glide);
+  if (warning == nullptr ||
+      warning->IsStateAccepted(AirspaceWarning::WARNING_INSIDE)) {
+    GeoPoint c = airspace->ClosestPoint(state.location, GetProjection());
+    const AirspaceAircraftPerformance perf_glide(glide_polar);
+    const AirspaceInterceptSolution solution =
+      airspace->Intercept(state, c, GetProjection(), perf_glide);
 
-      if (warning == nullptr)
-        warning = GetNewWarningPtr(airspace);
+    if (warning == nullptr)
+      warning = GetNewWarningPtr(std::move(airspace));
 
-      warning->UpdateSolution(AirspaceWarning::WARNING_INSIDE, solution);
-      found = true;
-    }
+    warning->UpdateSolution(AirspaceWarning::WARNING_INSIDE, solution);
+    return true;
   }
 
-  return found;
+  return false;
+}
+
+void
+AirspaceWarningManager::UpdateBatch(const AircraftState &state,
+                                    const GlidePolar &glide_polar,
+                                    const TaskStats &task_stats,
+                                    const bool circling) noexcept
+{
+  const std::optional<AirspaceWarningPrediction> predictions[] = {
+    PredictGlide(state, glide_polar, prediction_time_glide),
+    PredictFilter(circling ? circling_filter : cruise_filter,
+                  prediction_time_filter),
+    PredictTask(state, glide_polar, task_stats, config),
+  };
+
+  static_assert(std::size(predictions) == AirspaceWarningCandidates::MAX_VECTORS);
+
+  std::array<GeoPoint, AirspaceWarningCandidates::MAX_VECTORS> vectors;
+  std::size_t n_vectors = 0;
+  for (const auto &i : predictions)
+    if (i)
+      vectors[n_vectors++] = i->location;
+
+  candidates.Update(airspaces, state, {vectors.data(), n_vectors},
+                    config, GetPredictionCeiling(state));
+
+  // check from strongest to weakest alerts
+
+  if (glide_polar.IsValid())
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+      if (candidates.IsInside(i))
+        UpdateInside(state, glide_polar, candidates.GetAirspace(i));
+
+  std::size_t vector = 0;
+  for (const auto &i : predictions)
+    if (i)
+      UpdatePredicted(state, *i, candidates.GetHits(vector++));
 }
 
 void
@@ -5,6 +5,7 @@
 
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
+#include "AirspaceWarningCandidates.hpp"
 #include "Util/AircraftStateFilter.hpp"
 #include "time/FloatDuration.hxx"
 #include "util/Serial.hpp"
@@ -16,6 +17,7 @@ class GlidePolar;
 class Airspaces;
 class FlatProjection;
 class AirspaceAircraftPerformance;
+struct AirspaceWarningPrediction;
 
 /**
  * Class to detect and track airspace warnings
@@ -48,6 +50,18 @@ class AirspaceWarningManager {
    */
   Serial serial;
 
+  /**
+   * Buffer for the batched evaluation in Update().
+   */
+  AirspaceWarningCandidates candidates;
+
+  /**
+   * Gather the airspaces for all predictions with one query and
+   * evaluate them in one batch?  If false, each prediction queries
+   * the #Airspaces separately.
+   */
+  bool batch = true;
+
 public:
   using const_iterator = AirspaceWarningList::const_iterator;
 
@@ -111,6 +125,14 @@ public:
    */
   void SetPredictionTimeGlide(FloatDuration time) noexcept;
 
+  /**
+   * Enable or disable the batched evaluation (for testing and
+   * benchmarking only).  Both modes generate the same warnings.
+   */
+  void SetBatch(bool _batch) noexcept {
+    batch = _batch;
+  }
+
   /**
    * Adjust time of state predictor.  Also updates filter time constant
    *
@@ -250,6 +272,18 @@ private:
   bool UpdateFilter(const AircraftState& state, const bool circling);
   bool UpdateGlide(const AircraftState& state, const GlidePolar &glide_polar);
   bool UpdateInside(const AircraftState& state, const GlidePolar &glide_polar);
+  bool UpdateInside(const AircraftState &state, const GlidePolar &glide_polar,
+                    ConstAirspacePtr airspace) noexcept;
+
+  void UpdateBatch(const AircraftState &state, const GlidePolar &glide_polar,
+                   const TaskStats &task_stats, bool circling) noexcept;
+
+  [[gnu::pure]]
+  double GetPredictionCeiling(const AircraftState &state) const noexcept;
+
+  bool UpdatePredicted(const AircraftState &state,
+                       const AirspaceWarningPrediction &prediction,
+                       std::span<AirspaceWarningCandidates::Hit> hits) noexcept;
 
   bool UpdatePredicted(const AircraftState& state, 
                        const GeoPoint &location_predicted,
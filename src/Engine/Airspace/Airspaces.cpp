@@ -41,6 +41,16 @@ Airspaces::QueryIntersecting(const GeoPoint &a, const GeoPoint &b) const noexcep
   return {airspace_tree.qbegin(bgi::intersects(line)), airspace_tree.qend()};
 }
 
+Airspaces::const_iterator_range
+Airspaces::QueryIntersecting(const FlatBoundingBox &box) const noexcept
+{
+  if (IsEmpty())
+    // nothing to do
+    return {airspace_tree.qend(), airspace_tree.qend()};
+
+  return {airspace_tree.qbegin(bgi::intersects(box)), airspace_tree.qend()};
+}
+
 void
 Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
                              bool include_inside,
@@ -90,6 +100,31 @@ Airspaces::Optimise() noexcept
 
   tmp_as.clear();
 
+  UpdateSubsets();
+
+  ++serial;
+}
+
+void
+Airspaces::Restore(const GeoBounds &projection_bounds,
+                   const AirspaceVector &airspaces) noexcept
+{
+  Clear();
+
+  if (airspaces.empty())
+    return;
+
+  /* see Add() */
+  qnh = AtmosphericPressure::Zero();
+  activity_mask.SetAll();
+
+  task_projection = TaskProjection(projection_bounds);
+
+  /* the range constructor uses the packing algorithm */
+  airspace_tree = AirspaceTree(airspaces);
+
+  UpdateSubsets();
+
   ++serial;
 }
 
@@ -124,6 +159,9 @@ Airspaces::Clear() noexcept
 
   // then delete the tree
   airspace_tree.clear();
+
+  flight_level_airspaces.clear();
+  day_airspaces.clear();
 }
 
 unsigned
@@ -138,14 +176,34 @@ Airspaces::IsEmpty() const noexcept
   return airspace_tree.empty() && tmp_as.empty();
 }
 
+void
+Airspaces::UpdateSubsets() noexcept
+{
+  flight_level_airspaces.clear();
+  day_airspaces.clear();
+
+  for (const auto &i : QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+
+    if (airspace.NeedFlightLevel())
+      flight_level_airspaces.push_back(i.GetAirspacePtr());
+
+    if (airspace.NeedActivity())
+      day_airspaces.push_back(i.GetAirspacePtr());
+  }
+}
+
 void
 Airspaces::SetFlightLevels(const AtmosphericPressure press) noexcept
 {
   if ((int)press.GetHectoPascal() != (int)qnh.GetHectoPascal()) {
     qnh = press;
 
-    for (auto &v : QueryAll())
-      v.SetFlightLevel(press);
+    for (const auto &i : flight_level_airspaces)
+      i->SetFlightLevel(press);
+
+    if (!flight_level_airspaces.empty())
+      ++levels_serial;
   }
 }
 
@@ -155,8 +213,15 @@ Airspaces::SetActivity(const AirspaceActivity mask) noexcept
   if (!mask.equals(activity_mask)) {
     activity_mask = mask;
 
-    for (auto &v : QueryAll())
-      v.SetActivity(mask);
+    bool modified = false;
+    for (const auto &i : day_airspaces) {
+      const bool was_active = i->IsActive();
+      i->SetActivity(mask);
+      modified |= i->IsActive() != was_active;
+    }
+
+    if (modified)
+      ++activity_serial;
   }
 }
 
@@ -220,6 +285,8 @@ Airspaces::SynchroniseInRange(const Airspaces &master,
   for (const auto &i : contents_master)
     airspace_tree.insert(i);
 
+  UpdateSubsets();
+
   ++serial;
 
   return true;
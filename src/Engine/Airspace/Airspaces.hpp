@@ -12,6 +12,7 @@
 #include "Atmosphere/Pressure.hpp"
 
 #include <deque>
+#include <vector>
 
 class RasterTerrain;
 class AirspaceIntersectionVisitor;
@@ -29,12 +30,36 @@ class Airspaces : public AirspacesInterface {
 
   std::deque<AirspacePtr> tmp_as;
 
+  /**
+   * The airspaces in #airspace_tree with a flight level boundary;
+   * only these need to be updated by SetFlightLevels().
+   */
+  std::vector<AirspacePtr> flight_level_airspaces;
+
+  /**
+   * The airspaces in #airspace_tree which are not active on all
+   * days; only these need to be updated by SetActivity().
+   */
+  std::vector<AirspacePtr> day_airspaces;
+
   /**
    * This attribute keeps track of changes to this project.  It is
    * used by the renderer cache.
    */
   Serial serial;
 
+  /**
+   * Incremented whenever the altitudes of airspaces are modified by
+   * SetFlightLevels() or SetGroundLevels().
+   */
+  Serial levels_serial;
+
+  /**
+   * Incremented whenever SetActivity() modifies the activity of an
+   * airspace.
+   */
+  Serial activity_serial;
+
 public:
   /**
    * Constructor.
@@ -49,10 +74,22 @@ public:
   Airspaces(const Airspaces &) = delete;
   Airspaces &operator=(const Airspaces &) = delete;
 
+  /**
+   * Returns a serial which changes when airspaces are added or
+   * removed.
+   */
   const Serial &GetSerial() const noexcept {
     return serial;
   }
 
+  const Serial &GetLevelsSerial() const noexcept {
+    return levels_serial;
+  }
+
+  const Serial &GetActivitySerial() const noexcept {
+    return activity_serial;
+  }
+
   /**
    * Add airspace to the internal airspace tree.
    * The airspace is not copied; ownership is transferred to this class if
@@ -69,6 +106,16 @@ public:
    */
   void Optimise() noexcept;
 
+  /**
+   * Replace all airspaces with the given ones, whose borders have
+   * already been projected with a #TaskProjection constructed from
+   * the given bounds (e.g. loaded from a cache).  Unlike Optimise(),
+   * this bulk-loads the tree, which may therefore return the
+   * airspaces in a different order than the one it was saved from.
+   */
+  void Restore(const GeoBounds &projection_bounds,
+               const AirspaceVector &airspaces) noexcept;
+
   /**
    * Clear the airspace store, deleting airspace objects if m_owner is true
    */
@@ -139,6 +186,14 @@ public:
   const_iterator_range QueryIntersecting(const GeoPoint &a,
                                          const GeoPoint &b) const noexcept;
 
+  /**
+   * Query airspaces whose bounding box intersects the given box.
+   * The result is in no specific order, but it is the same order as
+   * in other queries.
+   */
+  [[gnu::pure]]
+  const_iterator_range QueryIntersecting(const FlatBoundingBox &box) const noexcept;
+
   /**
    * Call visitor class on airspaces intersected by vector.
    * Note that the visitor is not instantiated separately for each match
@@ -179,6 +234,14 @@ public:
     return task_projection;
   }
 
+  /**
+   * Returns the bounds the projection was constructed from, to be
+   * passed to Restore().  Only valid after Optimise().
+   */
+  const GeoBounds &GetProjectionBounds() const noexcept {
+    return task_projection.GetBounds();
+  }
+
   /**
    * Empty clearance polygons of all airspaces in this database
    */
@@ -201,4 +264,10 @@ public:
 private:
   [[gnu::pure]]
   AirspaceVector AsVector() const noexcept;
+
+  /**
+   * Rebuild #flight_level_airspaces and #day_airspaces after
+   * #airspace_tree has been modified.
+   */
+  void UpdateSubsets() noexcept;
 };
@@ -16,5 +16,7 @@ Airspaces::SetGroundLevels(const RasterTerrain &terrain) noexcept
     GeoPoint g = task_projection.Unproject(c_flat);
     v.SetGroundLevel(terrain.GetTerrainHeight(g).GetValueOr0());
   }
+
+  ++levels_serial;
 }
 
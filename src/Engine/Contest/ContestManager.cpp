@@ -2,6 +2,12 @@
 // Copyright The XCSoar Project
 
 #include "ContestManager.hpp"
+#include "thread/ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <span>
 
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
@@ -140,6 +146,47 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+namespace {
+
+/**
+ * A solver which does not depend on the results of the other
+ * solvers of the same contest.
+ */
+struct ContestJob {
+  AbstractContest &contest;
+  ContestResult &result;
+  ContestTraceVector &solution;
+};
+
+} // anonymous namespace
+
+/**
+ * Run all solvers, concurrently if a #ThreadPool is available.
+ *
+ * @return true if at least one of them has found a new solution
+ */
+static bool
+RunContests(ThreadPool *thread_pool, std::span<const ContestJob> jobs,
+            bool exhaustive) noexcept
+{
+  std::array<bool, 3> modified{};
+  assert(jobs.size() <= modified.size());
+
+  const auto f = [&](unsigned i){
+    const ContestJob &job = jobs[i];
+    modified[i] = RunContest(job.contest, job.result, job.solution,
+                             exhaustive);
+  };
+
+  if (thread_pool != nullptr)
+    thread_pool->Run(jobs.size(), f);
+  else
+    for (unsigned i = 0; i < jobs.size(); ++i)
+      f(i);
+
+  return std::find(modified.begin(), modified.end(), true) != modified.end();
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive) noexcept
 {
@@ -174,12 +221,13 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
                          stats.solution[0], exhaustive);
     break;
 
-  case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
+  case Contest::OLC_PLUS: {
+    const ContestJob jobs[] = {
+      {olc_classic, stats.result[0], stats.solution[0]},
+      {olc_fai, stats.result[1], stats.solution[1]},
+    };
 
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunContests(thread_pool, jobs, exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -190,25 +238,32 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
     }
 
     break;
+  }
 
   case Contest::DMST:
     retval = RunContest(dmst_quad, stats.result[0],
                         stats.solution[0], exhaustive);
     break;
 
-  case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::XCONTEST: {
+    const ContestJob jobs[] = {
+      {xcontest_free, stats.result[0], stats.solution[0]},
+      {xcontest_triangle, stats.result[1], stats.solution[1]},
+    };
+
+    retval = RunContests(thread_pool, jobs, exhaustive);
     break;
+  }
 
-  case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::DHV_XC: {
+    const ContestJob jobs[] = {
+      {dhv_xc_free, stats.result[0], stats.solution[0]},
+      {dhv_xc_triangle, stats.result[1], stats.solution[1]},
+    };
+
+    retval = RunContests(thread_pool, jobs, exhaustive);
     break;
+  }
 
   case Contest::SIS_AT:
     retval = RunContest(sis_at, stats.result[0],
@@ -220,15 +275,14 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
                         stats.solution[0], exhaustive);
     break;
 
-  case Contest::WEGLIDE_FREE:
-    retval = RunContest(weglide_distance, stats.result[0],
-                        stats.solution[0], exhaustive);
+  case Contest::WEGLIDE_FREE: {
+    const ContestJob jobs[] = {
+      {weglide_distance, stats.result[0], stats.solution[0]},
+      {weglide_fai, stats.result[1], stats.solution[1]},
+      {weglide_or, stats.result[2], stats.solution[2]},
+    };
 
-    retval |= RunContest(weglide_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
-
-    retval |= RunContest(weglide_or, stats.result[2],
-                         stats.solution[2], exhaustive);
+    retval = RunContests(thread_pool, jobs, exhaustive);
 
     if (retval) {
       weglide_free.Feed(stats.result[0], stats.solution[0],
@@ -239,6 +293,7 @@ ContestManager::UpdateIdle(bool exhaustive) noexcept
                  stats.solution[3], exhaustive);
     }
     break;
+  }
 
   case Contest::WEGLIDE_DISTANCE:
     retval = RunContest(weglide_distance, stats.result[0],
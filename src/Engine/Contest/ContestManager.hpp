@@ -22,6 +22,7 @@
 #include "ContestStatistics.hpp"
 
 class Trace;
+class ThreadPool;
 
 /**
  * Special task holder for Online Contest calculations
@@ -53,6 +54,12 @@ class ContestManager
   Charron charron_small;
   Charron charron_large;
 
+  /**
+   * Worker threads for running independent solvers of one contest
+   * concurrently; nullptr runs them one after another.
+   */
+  ThreadPool *thread_pool = nullptr;
+
 public:
   /**
    * Base constructor.
@@ -87,6 +94,19 @@ public:
 
   void SetHandicap(unsigned handicap) noexcept;
 
+  /**
+   * Run the solvers of contests which consist of several
+   * independent parts (e.g. OLC-Plus, XContest, WeGlide Free) on the
+   * given #ThreadPool.  Each solver works on its own copy of the
+   * #Trace and writes to its own result slot, and UpdateIdle()
+   * returns only after all of them have finished, therefore the
+   * results do not depend on the number of threads.  The pool must
+   * remain valid as long as it is registered here.
+   */
+  void SetThreadPool(ThreadPool *_thread_pool) noexcept {
+    thread_pool = _thread_pool;
+  }
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
@@ -121,6 +141,46 @@ public:
    */
   void Reset() noexcept;
 
+  /**
+   * Restore the statistics from a checkpoint.
+   */
+  void RestoreStats(const ContestStatistics &_stats) noexcept {
+    stats = _stats;
+  }
+
+  /**
+   * Invoke the given function for each solver.  The order never
+   * changes, which allows writing and reading checkpoints.
+   */
+  template<typename F>
+  void ForEachSolver(F &&f) {
+    f(olc_sprint);
+    f(olc_fai);
+    f(olc_classic);
+    f(olc_league);
+    f(olc_plus);
+    f(dmst_quad);
+    f(xcontest_free);
+    f(xcontest_triangle);
+    f(dhv_xc_free);
+    f(dhv_xc_triangle);
+    f(sis_at);
+    f(net_coupe);
+    f(weglide_free);
+    f(weglide_distance);
+    f(weglide_fai);
+    f(weglide_or);
+    f(charron_small);
+    f(charron_large);
+  }
+
+  template<typename F>
+  void ForEachSolver(F &&f) const {
+    const_cast<ContestManager *>(this)->ForEachSolver([&f](const auto &solver){
+      f(solver);
+    });
+  }
+
   const ContestStatistics &GetStats() const noexcept {
     return stats;
   }
@@ -52,6 +52,17 @@ public:
     return best_solution;
   }
 
+  /**
+   * Restore the best result from a checkpoint.  It is reported until
+   * the solver finds a better one; this does not limit the search,
+   * which starts over on the restored trace.
+   */
+  void RestoreBest(const ContestResult &result,
+                   const ContestTraceVector &solution) noexcept {
+    best_result = result;
+    best_solution = solution;
+  }
+
 protected:
   /**
    * Calculate the result.
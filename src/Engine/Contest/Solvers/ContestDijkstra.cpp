@@ -277,30 +277,23 @@ ContestDijkstra::AddIncrementalEdges(unsigned first_point) noexcept
   finished = false;
   first_finish_candidate = first_point;
 
-  /* we need a copy of the current edge map, because the following
-     loop will modify it, invalidating the iterator */
-#if GCC_VERSION < 40800 || GCC_VERSION > 40802
-  const Dijkstra::EdgeMap edges = dijkstra.GetEdgeMap();
-#else
-  // workaround for http://gcc.gnu.org/bugzilla/show_bug.cgi?id=59548
-  Dijkstra::EdgeMap edges;
-  edges = dijkstra.GetEdgeMap();
-#endif
-
   /* establish links between each old node and each new node, to
      initiate the follow-up search, hoping a better solution will be
-     found here */
-  for (const auto &i : edges) {
-    if (IsFinal(i.first))
+     found here; the following loop appends the new nodes to the
+     list, which must not be visited, therefore the old size is
+     remembered */
+  for (std::size_t i = 0, n = dijkstra.GetNodes().size(); i < n; ++i) {
+    const ScanTaskPoint node = dijkstra.GetNodes()[i];
+    if (IsFinal(node))
       /* ignore final nodes */
       continue;
 
     /* "seek" the Dijkstra object to the current "old" node */
-    dijkstra.SetCurrentValue(i.second.value);
+    dijkstra.SetCurrentValue(dijkstra.GetValue(node));
 
     /* add edges from the current "old" node to all "new" nodes
        (first_point .. n_points-1) */
-    AddEdges(i.first, first_point);
+    AddEdges(node, first_point);
   }
 
   /* see if new start points are possible now (due to relaxed start
@@ -57,6 +57,7 @@ TriangleContest::Reset() noexcept
   tick_iterations = 1000;
 
   closing_pairs.Clear();
+  solved_ranges.clear();
   ClearTrace();
 
   ResetBranchAndBound();
@@ -67,6 +68,7 @@ void
 TriangleContest::ResetBranchAndBound() noexcept
 {
   running = false;
+  mixed_selection = false;
   branch_and_bound.clear();
 }
 
@@ -91,6 +93,12 @@ TriangleContest::UpdateTrace(bool force) noexcept
   if (IsMasterAppended()) return; /* unmodified */
 
   if (force || IsMasterUpdated(false)) {
+    /* if points were only appended, the indices of the old points
+       remain valid, and so does solved_ranges; an exhaustive run
+       starts from scratch */
+    if (force || CheckMasterSerial())
+      solved_ranges.clear();
+
     UpdateTraceFull();
 
     is_complete = false;
@@ -118,6 +126,56 @@ TriangleContest::UpdateTrace(bool force) noexcept
   tick_iterations = n_points * n_points / 8;
 }
 
+TriangleContest::Checkpoint
+TriangleContest::GetCheckpoint() const
+{
+  Checkpoint checkpoint;
+
+  if (n_points == 0 || CheckMasterSerial())
+    /* the indices of our working copy are not valid in the master
+       trace */
+    return checkpoint;
+
+  checkpoint.n_points = n_points;
+  checkpoint.last_location = GetPoint(n_points - 1).GetFlatLocation();
+  checkpoint.best_d = best_d;
+  checkpoint.solution = solution;
+  checkpoint.closing_pairs = closing_pairs.closing_pairs;
+  checkpoint.solved_ranges = solved_ranges;
+  return checkpoint;
+}
+
+bool
+TriangleContest::RestoreCheckpoint(Checkpoint &&checkpoint) noexcept
+{
+  Reset();
+
+  if (checkpoint.n_points == 0 ||
+      checkpoint.n_points > trace_master.size())
+    return false;
+
+  UpdateTraceFull();
+
+  if (GetPoint(checkpoint.n_points - 1).GetFlatLocation() !=
+      checkpoint.last_location) {
+    Reset();
+    return false;
+  }
+
+  best_d = checkpoint.best_d;
+  solution = checkpoint.solution;
+  closing_pairs.closing_pairs = std::move(checkpoint.closing_pairs);
+  solved_ranges = std::move(checkpoint.solved_ranges);
+
+  /* look for closing pairs among the points which were added after
+     the checkpoint was taken */
+  FindClosingPairs(checkpoint.n_points);
+  is_closed = !closing_pairs.closing_pairs.empty();
+  is_complete = false;
+  tick_iterations = n_points * n_points / 8;
+  return true;
+}
+
 SolverResult
 TriangleContest::Solve(bool exhaustive) noexcept
 {
@@ -196,10 +254,8 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
 #endif
 
     for (const auto relaxed_pair : relaxed_pairs.closing_pairs) {
-
-      const auto triangle = RunBranchAndBound(relaxed_pair.first,
-                                              relaxed_pair.second,
-                                              best_triangle.distance, exhaustive);
+      const auto triangle = SearchRange(relaxed_pair,
+                                        best_triangle.distance, exhaustive);
 
       if (triangle.distance > best_triangle.distance) {
         // solution is better than best_triangle
@@ -223,9 +279,8 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
     }
 
     for (const auto &close_look_pair : close_look.closing_pairs) {
-      const auto triangle = RunBranchAndBound(close_look_pair.first,
-                                              close_look_pair.second,
-                                              best_triangle.distance, exhaustive);
+      const auto triangle = SearchRange(close_look_pair,
+                                        best_triangle.distance, exhaustive);
 
       if (triangle.distance > best_triangle.distance) {
         // solution is better than best_triangle
@@ -252,7 +307,7 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
     }
   }
 
-  if (best_triangle.distance > 0) {
+  if (best_triangle.distance > best_d) {
     solution.resize(5);
 
     solution[0] = TraceManager::GetPoint(best_closing_pair.first);
@@ -261,11 +316,33 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
     solution[3] = TraceManager::GetPoint(best_triangle.tp3);
     solution[4] = TraceManager::GetPoint(best_closing_pair.second);
     best_d = best_triangle.distance;
+  }
 
+  if (best_d > 0)
     is_complete = true;
-  }
 }
 
+TriangleContest::Candidate
+TriangleContest::SearchRange(const ClosingPair p, unsigned worst_d,
+                             bool exhaustive) noexcept
+{
+  if (!running) {
+    const auto i = solved_ranges.find(p.first);
+    if (i != solved_ranges.end() && i->second.last == p.second &&
+        i->second.bound == worst_d)
+      return i->second.best;
+  }
+
+  const bool was_running = running;
+  const auto result = RunBranchAndBound(p.first, p.second, worst_d,
+                                        exhaustive);
+
+  if (!was_running && !running && !mixed_selection)
+    solved_ranges.insert_or_assign(p.first,
+                                   SolvedRange{p.second, worst_d, result});
+
+  return result;
+}
 
 TriangleContest::Candidate
 TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
@@ -300,6 +377,7 @@ TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
   if (!running) {
     // initiate algorithm. otherwise continue unfinished run
     running = true;
+    mixed_selection = false;
 
     // initialize bound-and-branch tree with root node (note: Candidate set interval is [min, max))
     CandidateSet root_candidates(*this, from, to + 1);
@@ -338,6 +416,7 @@ TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
     std::multimap<unsigned, CandidateSet>::iterator node;
 
     if (branch_and_bound.size() > n_points * 4 && iterations % 16 != 0) {
+      mixed_selection = true;
       node = branch_and_bound.upper_bound(branch_and_bound.rbegin()->first / 2);
       if (node == branch_and_bound.end()) --node;
     } else {
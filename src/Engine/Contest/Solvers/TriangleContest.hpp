@@ -59,6 +59,12 @@ private:
    */
   bool running;
 
+  /**
+   * True if the running branch and bound algorithm has switched to
+   * the memory efficient node selection, which depends on #n_points.
+   */
+  bool mixed_selection;
+
   /**
    * Number of iterations per tick (only for non-exhaustive,
    * predictive runs)
@@ -120,6 +126,7 @@ private:
 
   ClosingPairs closing_pairs;
 
+public:
   struct Candidate {
     unsigned tp1, tp2, tp3;
     unsigned distance;
@@ -132,8 +139,46 @@ private:
       if (tp1 > tp2)
         std::swap(tp1, tp2);
     }
+
+    bool operator==(const Candidate &) const noexcept = default;
+  };
+
+  /**
+   * The result of a complete RunBranchAndBound() run over a range of
+   * trace points.
+   */
+  struct SolvedRange {
+    /**
+     * The last point of the range; the first one is the key of the
+     * map.
+     */
+    unsigned last;
+
+    /**
+     * The lower bound the search was started with.
+     */
+    unsigned bound;
+
+    /**
+     * The triangle which was found; its distance is zero if there was
+     * none.
+     */
+    Candidate best;
+
+    bool operator==(const SolvedRange &) const noexcept = default;
   };
 
+private:
+  /**
+   * Results of RunBranchAndBound() by the first point of the range.
+   * A search over the same range with the same bound yields the same
+   * result, as long as it did not use the node selection which
+   * depends on #n_points.  Appending points to the trace does not
+   * change them, therefore they remain valid until the master trace
+   * gets modified (e.g. thinned).
+   */
+  std::map<unsigned, SolvedRange> solved_ranges;
+
   /**
    * A bounding box around a range of trace points.
    */
@@ -266,8 +311,52 @@ public:
     incremental = _incremental;
   }
 
+  /**
+   * The search state which can be restored after the master #Trace
+   * has been restored, e.g. after a restart.
+   */
+  struct Checkpoint {
+    /**
+     * The number of trace points this state refers to; zero if there
+     * is no usable state.
+     */
+    unsigned n_points = 0;
+
+    /**
+     * The projected location of the last of these points, to verify
+     * that the restored #Trace is the same.
+     */
+    FlatGeoPoint last_location;
+
+    unsigned best_d;
+
+    ContestTraceVector solution;
+
+    std::map<unsigned, unsigned> closing_pairs;
+
+    std::map<unsigned, SolvedRange> solved_ranges;
+  };
+
+  Checkpoint GetCheckpoint() const;
+
+  /**
+   * Restore the state obtained by GetCheckpoint().  Call this after
+   * the master #Trace has been restored.
+   *
+   * @return false if the master #Trace does not match the checkpoint
+   */
+  bool RestoreCheckpoint(Checkpoint &&checkpoint) noexcept;
+
 private:
   bool FindClosingPairs(unsigned old_size) noexcept;
+
+  /**
+   * Run RunBranchAndBound() over the given range, unless
+   * #solved_ranges has the result of the same search.
+   */
+  Candidate SearchRange(ClosingPair p, unsigned worst_d,
+                        bool exhaustive) noexcept;
+
   void SolveTriangle(bool exhaustive) noexcept;
 
   Candidate RunBranchAndBound(unsigned from, unsigned to, unsigned best_d,
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A list of glide targets which share the aircraft altitude and the
+ * wind, to be solved by MacCready::Solve(const GlideBatch &).  Each
+ * attribute is stored in a separate array, which allows the solver to
+ * vectorise its loops.
+ */
+struct GlideBatch {
+  /** Altitude of the aircraft [m] */
+  double altitude;
+
+  SpeedVector wind;
+
+  /** Distance from the aircraft to each target [m] */
+  std::vector<double> distances;
+
+  /** Bearing from the aircraft to each target */
+  std::vector<Angle> bearings;
+
+  /** Minimum arrival altitude at each target [m] */
+  std::vector<double> min_arrival_altitudes;
+
+  GlideBatch(double _altitude, SpeedVector _wind) noexcept
+    :altitude(_altitude), wind(_wind) {}
+
+  [[gnu::pure]]
+  std::size_t size() const noexcept {
+    return distances.size();
+  }
+
+  [[gnu::pure]]
+  bool empty() const noexcept {
+    return distances.empty();
+  }
+
+  void reserve(std::size_t n) {
+    distances.reserve(n);
+    bearings.reserve(n);
+    min_arrival_altitudes.reserve(n);
+  }
+
+  void clear() noexcept {
+    distances.clear();
+    bearings.clear();
+    min_arrival_altitudes.clear();
+  }
+
+  void push_back(const GeoVector &vector, double min_arrival_altitude) {
+    distances.push_back(vector.distance);
+    bearings.push_back(vector.bearing);
+    min_arrival_altitudes.push_back(min_arrival_altitude);
+  }
+};
@@ -242,6 +242,7 @@ GlidePolar::IsGlidePossible(const GlideState &task) const noexcept
   return true;
 }
 
+#if 0
 /**
  * Finds speed to fly for a given MacCready setting
  * Intended to be used temporarily.
@@ -301,14 +302,37 @@ public:
     return Vopt + m_head_wind;
   }
 };
+#endif
 
 double
 GlidePolar::SpeedToFly(const double stf_sink_rate,
                        const double head_wind) const noexcept
 {
   assert(IsValid());
+
+#if 0
+  // this method to be used if polar is not parabolic
   GlidePolarSpeedToFly gp_stf(*this, stf_sink_rate, head_wind, Vmin, Vmax);
   return gp_stf.solve(Vmax);
+#else
+  /* the speed over ground V which minimises
+     (MSinkRate(V + head_wind) + stf_sink_rate) / V solves
+     a*V^2 = a*head_wind^2 + b*head_wind + c + mc + stf_sink_rate */
+
+  const auto v_min = std::max(1., Vmin - head_wind);
+  const auto v_max = Vmax - head_wind;
+
+  const auto s = Square(head_wind) +
+    (polar.c + mc + stf_sink_rate + polar.b * head_wind) / polar.a;
+
+  /* if s is not positive, the function rises over the whole range,
+     and the minimum is at the lower bound */
+  const auto v = s > 0
+    ? std::max(v_min, std::min(sqrt(s), v_max))
+    : v_min;
+
+  return v + head_wind;
+#endif
 }
 
 double
@@ -59,6 +59,19 @@ GlideState::GlideState(const GeoVector &vector, const double htarget,
   CalcSpeedups(wind);
 }
 
+GlideState::GlideState(const GeoVector &_vector, double htarget,
+                       double altitude, SpeedVector _wind,
+                       Angle _effective_wind_angle, double _head_wind) noexcept
+  :vector(_vector),
+   min_arrival_altitude(htarget),
+   wind(_wind),
+   altitude_difference(altitude - min_arrival_altitude),
+   effective_wind_angle(_effective_wind_angle),
+   head_wind(_head_wind),
+   wind_speed_squared(Square(wind.norm))
+{
+}
+
 void
 GlideState::CalcSpeedups(const SpeedVector _wind)
 {
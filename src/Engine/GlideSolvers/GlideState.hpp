@@ -53,6 +53,20 @@ public:
   GlideState(const GeoVector &vector, const double htarget,
              double altitude, const SpeedVector wind);
 
+  /**
+   * Constructor for batch calculations, which takes the wind terms
+   * already calculated by the caller, see CalcSpeedups().
+   *
+   * @param wind the wind vector; must be SpeedVector::Zero() if there
+   * is no wind
+   * @param effective_wind_angle the reciprocal wind bearing minus
+   * the bearing to the target
+   * @param head_wind the head wind component [m/s]
+   */
+  GlideState(const GeoVector &vector, double htarget, double altitude,
+             SpeedVector wind, Angle effective_wind_angle,
+             double head_wind) noexcept;
+
   [[gnu::pure]]
   static GlideState Remaining(const TaskPoint &tp,
                               const AircraftState &aircraft,
@@ -5,10 +5,19 @@
 #include "GlideState.hpp"
 #include "GlidePolar.hpp"
 #include "GlideResult.hpp"
+#include "GlideBatch.hpp"
 #include "Math/ZeroFinder.hpp"
+#include "Math/Quadratic.hpp"
 
+#include <algorithm>
 #include <cassert>
 
+/**
+ * The number of targets processed by one iteration of the batch
+ * solver.  This limits the size of its temporary arrays.
+ */
+static constexpr std::size_t BATCH_CHUNK = 64;
+
 MacCready::MacCready(const GlideSettings &_settings,
                      const GlidePolar &_glide_polar,
                      const double _cruise_efficiency)
@@ -42,6 +51,7 @@ MacCready::SolveVertical(const GlideState &task) const
     result.height_climb = 0;
     result.height_glide = 0;
     result.time_elapsed = {};
+    result.time_virtual = {};
     result.validity = GlideResult::Validity::OK;
     return result;
   }
@@ -82,6 +92,110 @@ MacCready::Solve(const GlideSettings &settings, const GlidePolar &glide_polar,
   return mac.Solve(task);
 }
 
+/**
+ * Same as GlideState::CalcAverageSpeed() with wind, but with the wind
+ * terms passed as parameters.  It is inline and has no branches,
+ * which allows vectorising the loop which calls it.
+ */
+static inline double
+CalcAverageSpeed(double head_wind, double wind_speed_squared,
+                 double v_eff) noexcept
+{
+  const Quadratic q(2 * head_wind, wind_speed_squared - Square(v_eff));
+  return q.Check() ? q.SolutionMax() : -1;
+}
+
+void
+MacCready::SolveBatch(const GlideBatch &batch,
+                      std::span<GlideResult> results,
+                      const bool straight) const noexcept
+{
+  assert(results.size() == batch.size());
+
+  if (!glide_polar.IsValid()) {
+    /* can't solve without a valid GlidePolar() */
+    for (auto &result : results)
+      result.Reset();
+    return;
+  }
+
+  /* these depend only on the polar and the wind */
+
+  const bool has_wind = batch.wind.IsNonZero();
+  const SpeedVector wind = has_wind ? batch.wind : SpeedVector::Zero();
+  const Angle reciprocal_wind_bearing = wind.bearing.Reciprocal();
+  const auto wind_speed_squared = Square(wind.norm);
+
+  const bool positive_mc = glide_polar.GetMC() > 0;
+  const auto v_glide = glide_polar.GetVBestLD();
+  const auto v_glide_air = v_glide * cruise_efficiency;
+  const auto sink_glide = glide_polar.SinkRate(v_glide);
+  const auto v_cruise_air = positive_mc ? GetCruiseAirSpeed() : 0.;
+
+  const std::size_t n = batch.size();
+  for (std::size_t offset = 0; offset < n; offset += BATCH_CHUNK) {
+    const std::size_t m = std::min(BATCH_CHUNK, n - offset);
+    const Angle *const bearings = batch.bearings.data() + offset;
+
+    Angle effective_wind_angles[BATCH_CHUNK];
+    double head_winds[BATCH_CHUNK];
+    double glide_speeds[BATCH_CHUNK], cruise_speeds[BATCH_CHUNK];
+
+    if (has_wind) {
+      /* the wind terms of GlideState::CalcSpeedups() and the average
+         speeds of GlideState::CalcAverageSpeed() */
+      for (std::size_t i = 0; i < m; ++i) {
+        effective_wind_angles[i] = reciprocal_wind_bearing - bearings[i];
+        head_winds[i] = -wind.norm * effective_wind_angles[i].cos();
+        glide_speeds[i] = CalcAverageSpeed(head_winds[i], wind_speed_squared,
+                                           v_glide_air);
+        cruise_speeds[i] = CalcAverageSpeed(head_winds[i], wind_speed_squared,
+                                            v_cruise_air);
+      }
+    } else {
+      std::fill_n(effective_wind_angles, m, Angle::Zero());
+      std::fill_n(head_winds, m, 0.);
+      std::fill_n(glide_speeds, m, v_glide_air);
+      std::fill_n(cruise_speeds, m, v_cruise_air);
+    }
+
+    /* the remaining calculations depend on the altitude difference
+       and can't be vectorised */
+    for (std::size_t i = 0; i < m; ++i) {
+      const std::size_t j = offset + i;
+      const GlideState task(GeoVector(batch.distances[j], bearings[i]),
+                            batch.min_arrival_altitudes[j], batch.altitude,
+                            wind, effective_wind_angles[i], head_winds[i]);
+
+      if (task.vector.distance <= 0)
+        results[j] = SolveVertical(task);
+      else if (!positive_mc)
+        // whole task must be glide
+        results[j] = OptimiseGlide(task, false);
+      else if (straight)
+        results[j] = SolveGlide(task, v_glide, sink_glide, glide_speeds[i],
+                                false);
+      else
+        results[j] = SolveGlideCruise(task, glide_speeds[i],
+                                      cruise_speeds[i]);
+    }
+  }
+}
+
+void
+MacCready::Solve(const GlideBatch &batch,
+                 std::span<GlideResult> results) const noexcept
+{
+  SolveBatch(batch, results, false);
+}
+
+void
+MacCready::SolveStraight(const GlideBatch &batch,
+                         std::span<GlideResult> results) const noexcept
+{
+  SolveBatch(batch, results, true);
+}
+
 GlideResult
 MacCready::SolveSink(const GlideSettings &settings,
                      const GlidePolar &glide_polar, const GlideState &task,
@@ -91,8 +205,24 @@ MacCready::SolveSink(const GlideSettings &settings,
   return mac.SolveSink(task, sink_rate);
 }
 
+double
+MacCready::GetCruiseAirSpeed() const noexcept
+{
+  // Sink rate divided by MC value, see SolveCruise()
+  const auto rho = glide_polar.GetSBestLD() * glide_polar.GetInvMC();
+
+  return glide_polar.GetVBestLD() * cruise_efficiency * (1. / (1 + rho));
+}
+
 GlideResult
 MacCready::SolveCruise(const GlideState &task) const
+{
+  return SolveCruise(task, task.CalcAverageSpeed(GetCruiseAirSpeed()));
+}
+
+GlideResult
+MacCready::SolveCruise(const GlideState &task,
+                       const double estimated_speed) const
 {
   // cruise speed for current MC (m/s)
   const auto mc_speed = glide_polar.GetVBestLD();
@@ -132,8 +262,6 @@ MacCready::SolveCruise(const GlideState &task) const
   // quotient of resulting speed over cruise speed (0 .. 1)
   const auto inv_rho_plus_one = 1. / rho_plus_one;
 
-  const auto estimated_speed =
-      task.CalcAverageSpeed(mc_speed * cruise_efficiency * inv_rho_plus_one);
   if (estimated_speed <= 0) {
     result.validity = GlideResult::Validity::WIND_EXCESSIVE;
     result.vector.distance = 0;
@@ -177,15 +305,24 @@ GlideResult
 MacCready::SolveGlide(const GlideState &task, const double v_set,
                       const double sink_rate, const bool allow_partial) const
 {
-  // spend a lot of time in this function, so it should be quick!
-
-  GlideResult result(task, v_set);
-
   // distance relation
   //   V*V=Vn*Vn+W*W-2*Vn*W*cos(theta)
   //     Vn*Vn-2*Vn*W*cos(theta)+W*W-V*V=0  ... (1)
 
-  const auto estimated_speed = task.CalcAverageSpeed(v_set * cruise_efficiency);
+  return SolveGlide(task, v_set, sink_rate,
+                    task.CalcAverageSpeed(v_set * cruise_efficiency),
+                    allow_partial);
+}
+
+GlideResult
+MacCready::SolveGlide(const GlideState &task, const double v_set,
+                      const double sink_rate, const double estimated_speed,
+                      const bool allow_partial) const
+{
+  // spend a lot of time in this function, so it should be quick!
+
+  GlideResult result(task, v_set);
+
   if (estimated_speed <= 0) {
     result.validity = GlideResult::Validity::WIND_EXCESSIVE;
     result.vector.distance = 0;
@@ -273,14 +410,26 @@ MacCready::Solve(const GlideState &task) const
     // whole task must be glide
     return OptimiseGlide(task, false);
 
+  return SolveGlideCruise(task,
+                          task.CalcAverageSpeed(glide_polar.GetVBestLD() *
+                                                cruise_efficiency),
+                          task.CalcAverageSpeed(GetCruiseAirSpeed()));
+}
+
+GlideResult
+MacCready::SolveGlideCruise(const GlideState &task, const double glide_speed,
+                            const double cruise_speed) const
+{
   if (task.altitude_difference < 0)
     // whole task climb-cruise
-    return SolveCruise(task);
+    return SolveCruise(task, cruise_speed);
 
   // task partial climb-cruise, partial glide
 
   // calc first final glide part
-  GlideResult result_fg = SolveGlide(task, glide_polar.GetVBestLD(), true);
+  const auto v = glide_polar.GetVBestLD();
+  GlideResult result_fg = SolveGlide(task, v, glide_polar.SinkRate(v),
+                                     glide_speed, true);
   if (result_fg.validity == GlideResult::Validity::OK &&
       task.vector.distance - result_fg.vector.distance <= 0)
     // whole task final glided
@@ -292,7 +441,7 @@ MacCready::Solve(const GlideState &task) const
   sub_task.vector.distance -= result_fg.vector.distance;
   sub_task.altitude_difference -= result_fg.height_glide;
 
-  GlideResult result_cc = SolveCruise(sub_task);
+  GlideResult result_cc = SolveCruise(sub_task, cruise_speed);
   result_fg.Add(result_cc);
 
   return result_fg;
@@ -5,9 +5,12 @@
 
 #include "util/Compiler.h"
 
+#include <span>
+
 struct GlideSettings;
 struct GlideState;
 struct GlideResult;
+struct GlideBatch;
 class GlidePolar;
 
 /**
@@ -85,6 +88,24 @@ public:
                            const GlidePolar &glide_polar,
                            const GlideState &task);
 
+  /**
+   * Solve all targets of a #GlideBatch, with the same results as
+   * Solve() for each of them.  The polar is evaluated only once, and
+   * the wind terms are calculated in a loop over all targets which
+   * can be vectorised.
+   *
+   * @param results an array which receives one result per target
+   */
+  void Solve(const GlideBatch &batch,
+             std::span<GlideResult> results) const noexcept;
+
+  /**
+   * Like Solve(const GlideBatch &), but always assume straight
+   * glide, see SolveStraight().
+   */
+  void SolveStraight(const GlideBatch &batch,
+                     std::span<GlideResult> results) const noexcept;
+
   /**
    * Calculates the glide solution for a classical MacCready theory task
    * with no climb component (pure glide).  This is used internally to
@@ -124,6 +145,18 @@ private:
              const double sink_rate,
              const bool allow_partial = false) const;
 
+  /**
+   * Like SolveGlide(), but with the average speed over ground already
+   * calculated.
+   *
+   * @param estimated_speed the average speed over ground at v_set,
+   * see GlideState::CalcAverageSpeed()
+   */
+  [[gnu::pure]]
+  GlideResult
+  SolveGlide(const GlideState &task, double v_set, double sink_rate,
+             double estimated_speed, bool allow_partial) const;
+
   /**
    * Solve a task which is known to be pure glide,
    * seeking optimal speed to fly.
@@ -161,4 +194,38 @@ private:
    */
   [[gnu::pure]]
   GlideResult SolveCruise(const GlideState &task) const;
+
+  /**
+   * Like SolveCruise(), but with the average speed over ground
+   * already calculated.
+   *
+   * @param estimated_speed the average speed over ground at
+   * GetCruiseAirSpeed(), see GlideState::CalcAverageSpeed()
+   */
+  [[gnu::pure]]
+  GlideResult SolveCruise(const GlideState &task,
+                          double estimated_speed) const;
+
+  /**
+   * The part of Solve() for a task with a distance and a positive
+   * MacCready setting: glide as far as possible, and climb-cruise
+   * for the remainder.
+   *
+   * @param glide_speed the average speed over ground during glide
+   * @param cruise_speed the average speed over ground during
+   * climb-cruise
+   */
+  [[gnu::pure]]
+  GlideResult SolveGlideCruise(const GlideState &task, double glide_speed,
+                               double cruise_speed) const;
+
+  /**
+   * Returns the average speed through the air during climb-cruise,
+   * i.e. the cruise speed reduced by the time spent climbing.
+   */
+  [[gnu::pure]]
+  double GetCruiseAirSpeed() const noexcept;
+
+  void SolveBatch(const GlideBatch &batch, std::span<GlideResult> results,
+                  bool straight) const noexcept;
 };
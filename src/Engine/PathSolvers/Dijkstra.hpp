@@ -3,7 +3,12 @@
 
 #pragma once
 
-#include "util/ReservablePriorityQueue.hpp"
+#include "ScanTaskPoint.hpp"
+#include "util/DaryHeap.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
 
 #define DIJKSTRA_MINMAX_OFFSET 134217727
 
@@ -11,11 +16,18 @@
  * Dijkstra search algorithm.
  * Modifications by John Wharington to track optimal solution
  * @see http://en.giswiki.net/wiki/Dijkstra%27s_algorithm
+ *
+ * The nodes are #ScanTaskPoint instances; since their point indices
+ * are dense, the edges are stored in a flat array indexed by stage and
+ * point index, which grows as needed and is kept by Clear().  The
+ * queue refers to nodes, not to edges, therefore growing the array
+ * does not invalidate it.
  */
-template<typename Node, typename MapTemplate, typename ValueType=unsigned>
+template<typename ValueType=unsigned>
 class Dijkstra
 {
 public:
+  using Node = ScanTaskPoint;
   using value_type = ValueType;
 
   struct Edge
@@ -28,19 +40,28 @@ public:
       :parent(_parent), value(_value) {}
   };
 
-  using EdgeMap = typename MapTemplate::template Bind<Edge>;
-  using edge_iterator = typename EdgeMap::iterator;
-  using edge_const_iterator = typename EdgeMap::const_iterator;
-
 private:
+  /**
+   * The "parent" of array elements which do not contain an edge.
+   * There is no such stage number.
+   */
+  static constexpr Node UNUSED{0xffff, 0xffff};
+
+  /**
+   * Nodes with a point index at or above this value are stored in
+   * #sparse_edges.  This is used by ContestDijkstra's special index
+   * for the predicted point.
+   */
+  static constexpr unsigned MAX_DENSE_POINTS = 4096;
+
   struct Value
   {
     value_type edge_value;
 
-    edge_iterator iterator;
+    Node node;
 
-    constexpr Value(value_type _edge_value, edge_iterator _iterator) noexcept
-      :edge_value(_edge_value), iterator(_iterator) {}
+    constexpr Value(value_type _edge_value, Node _node) noexcept
+      :edge_value(_edge_value), node(_node) {}
   };
 
   struct Rank {
@@ -51,35 +72,43 @@ private:
   };
 
   /**
-   * Stores the predecessor and value of each node.  It is updated by
-   * push(), if a value lower than the current one is found.
+   * Stores the predecessor and value of each node at index
+   * "stage * stride + point".  It is updated by push(), if a value
+   * lower than the current one is found.
+   */
+  std::vector<Edge> dense_edges;
+
+  /**
+   * The number of stages and the number of points per stage (a power
+   * of two) in #dense_edges.
+   */
+  unsigned n_stages = 0, stride = 0;
+
+  /**
+   * Edges with a point index which is too large for #dense_edges.
    */
-  EdgeMap edges;
+  std::vector<std::pair<Node, Edge>> sparse_edges;
+
+  /**
+   * All nodes which have an edge, in the order they were reached
+   * first.  This allows clearing and iterating without scanning the
+   * whole array.
+   */
+  std::vector<Node> nodes;
 
   /**
    * A sorted list of all possible node paths, lowest distance first.
    */
-  reservable_priority_queue<Value, std::vector<Value>, Rank> q;
+  DaryHeap<Value, Rank> q;
 
   /**
    * The value of the current edge, i.e. the one that was consumed by
    * pop().
    */
-  value_type current_value;
+  value_type current_value = 0;
 
 public:
-  /**
-   * Default constructor
-   */
-  Dijkstra() noexcept {
-    /* this is a kludge to prevent rehashing, because rehashing would
-       invalidate all iterators stored inside the priority queue
-       "q", and would thus lead to use-after-free crashes */
-    // TODO this hard-codes the use of std::unordered_map
-    // TODO come up with a better solution
-    edges.reserve(4093);
-    edges.max_load_factor(1e10);
-  }
+  Dijkstra() noexcept = default;
 
   Dijkstra(const Dijkstra &) = delete;
   Dijkstra &operator=(const Dijkstra &) = delete;
@@ -91,19 +120,35 @@ public:
     // Clear the search queue
     q.clear();
 
-    // Clear EdgeMap
-    edges.clear();
+    // Clear the edges
+    for (const Node node : nodes)
+      if (node.GetPointIndex() < MAX_DENSE_POINTS)
+        dense_edges[GetDenseIndex(node)].parent = UNUSED;
+
+    sparse_edges.clear();
+    nodes.clear();
 
     current_value = 0;
   }
 
   /**
-   * Return a reference to the current edge map.  This hack is needed
-   * for "continuous" search, see
+   * Return the list of all nodes which have been reached so far.
+   * This hack is needed for "continuous" search, see
    * ContestDijkstra::AddIncrementalEdges().
    */
-  const EdgeMap &GetEdgeMap() const noexcept {
-    return edges;
+  const std::vector<Node> &GetNodes() const noexcept {
+    return nodes;
+  }
+
+  /**
+   * Return the value of the best path to the specified node found so
+   * far.  The node must have been reached already.
+   */
+  [[gnu::pure]]
+  value_type GetValue(const Node node) const noexcept {
+    const Edge *edge = Find(node);
+    assert(edge != nullptr);
+    return edge->value;
   }
 
   /**
@@ -140,14 +185,14 @@ public:
    * @return Node for processing
    */
   Node Pop() noexcept {
-    edge_const_iterator cur(q.top().iterator);
-    current_value = cur->second.value;
+    const Node node = q.top().node;
+    current_value = GetValue(node);
 
     do {
       q.pop();
-    } while (!q.empty() && q.top().iterator->second.value < q.top().edge_value);
+    } while (!q.empty() && GetValue(q.top().node) < q.top().edge_value);
 
-    return cur->first;
+    return node;
   }
 
   /**
@@ -171,9 +216,8 @@ public:
    */
   [[gnu::pure]]
   Node GetPredecessor(const Node node) const noexcept {
-    // Try to find the given node in the node_parent_map
-    edge_const_iterator it = edges.find(node);
-    if (it == edges.end())
+    const Edge *edge = Find(node);
+    if (edge == nullptr)
       // first entry
       // If the node wasn't found
       // -> Return the given node itself
@@ -181,7 +225,7 @@ public:
     else
       // If the node was found
       // -> Return the parent node
-      return it->second.parent;
+      return edge->parent;
   }
 
   /**
@@ -189,6 +233,7 @@ public:
    */
   void Reserve(std::size_t size) noexcept {
     q.reserve(size);
+    nodes.reserve(size);
   }
 
   /**
@@ -198,11 +243,80 @@ public:
     // Clear the search queue
     q.clear();
 
-    for (const auto &i : edges)
-      q.emplace(i.second.value, i);
+    for (const Node node : nodes)
+      q.emplace(GetValue(node), node);
   }
 
 private:
+  [[gnu::pure]]
+  std::size_t GetDenseIndex(const Node node) const noexcept {
+    assert(node.GetStageNumber() < n_stages);
+    assert(node.GetPointIndex() < stride);
+
+    return node.GetStageNumber() * stride + node.GetPointIndex();
+  }
+
+  [[gnu::pure]]
+  const Edge *Find(const Node node) const noexcept {
+    if (node.GetPointIndex() >= MAX_DENSE_POINTS) {
+      for (const auto &[key, edge] : sparse_edges)
+        if (key == node)
+          return &edge;
+
+      return nullptr;
+    }
+
+    if (node.GetStageNumber() >= n_stages || node.GetPointIndex() >= stride)
+      return nullptr;
+
+    const Edge &edge = dense_edges[GetDenseIndex(node)];
+    return edge.parent == UNUSED ? nullptr : &edge;
+  }
+
+  /**
+   * Grow #dense_edges so it has room for the specified node.
+   */
+  void Grow(const Node node) noexcept {
+    const unsigned point = node.GetPointIndex();
+    if (point >= stride) {
+      unsigned new_stride = std::max(stride, 64U);
+      while (new_stride <= point)
+        new_stride *= 2;
+
+      std::vector<Edge> new_edges(n_stages * new_stride, Edge(UNUSED, 0));
+      for (unsigned i = 0; i < n_stages; ++i)
+        std::copy_n(std::next(dense_edges.begin(), i * stride), stride,
+                    std::next(new_edges.begin(), i * new_stride));
+
+      dense_edges = std::move(new_edges);
+      stride = new_stride;
+    }
+
+    if (node.GetStageNumber() >= n_stages) {
+      n_stages = node.GetStageNumber() + 1;
+      dense_edges.resize(n_stages * stride, Edge(UNUSED, 0));
+    }
+  }
+
+  /**
+   * Look up the edge of the specified node, and create an unused one
+   * if there is none.
+   */
+  Edge &Obtain(const Node node) noexcept {
+    if (node.GetPointIndex() >= MAX_DENSE_POINTS) {
+      for (auto &[key, edge] : sparse_edges)
+        if (key == node)
+          return edge;
+
+      return sparse_edges.emplace_back(node, Edge(UNUSED, 0)).second;
+    }
+
+    if (node.GetStageNumber() >= n_stages || node.GetPointIndex() >= stride)
+      Grow(node);
+
+    return dense_edges[GetDenseIndex(node)];
+  }
+
   /**
    * Add node to search queue
    *
@@ -213,20 +327,21 @@ private:
    */
   bool Push(const Node node, const Node parent,
             value_type edge_value = {}) noexcept {
-    // Try to find the given node n in the EdgeMap
-    const auto [it, inserted] = edges.try_emplace(node, parent, edge_value);
-    if (inserted) {
+    assert(!(parent == UNUSED));
+
+    Edge &edge = Obtain(node);
+    if (edge.parent == UNUSED) {
       // first entry
-    } else if (it->second.value > edge_value)
-      // If the node was found and the new value is smaller
-      // -> Replace the value with the new one
-      it->second = Edge(parent, edge_value);
-    else
+      nodes.push_back(node);
+    } else if (edge.value <= edge_value)
       // If the node was found but the new value is higher or equal
       // -> Don't use this new leg
       return false;
 
-    q.emplace(edge_value, it);
+    // Replace the value with the new one
+    edge = Edge(parent, edge_value);
+
+    q.emplace(edge_value, node);
     return true;
   }
 };
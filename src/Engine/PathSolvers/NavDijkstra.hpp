@@ -7,7 +7,6 @@
 #include "ScanTaskPoint.hpp"
 #include "SolverResult.hpp"
 
-#include <unordered_map>
 #include <cassert>
 
 /**
@@ -23,27 +22,7 @@ class NavDijkstra {
 protected:
   static constexpr unsigned MAX_STAGES = 32;
 
-  struct DijkstraMap {
-    struct Hash {
-      constexpr std::size_t operator()(ScanTaskPoint p) const noexcept {
-        return p.Key();
-      }
-    };
-
-    struct Equal {
-      constexpr bool operator()(ScanTaskPoint a,
-                                ScanTaskPoint b) const noexcept {
-        return a.Key() == b.Key();
-      }
-    };
-
-    template<typename Value>
-    struct Bind : public std::unordered_map<ScanTaskPoint, Value,
-                                            Hash, Equal> {
-    };
-  };
-
-  using Dijkstra = ::Dijkstra<ScanTaskPoint, DijkstraMap, ValueType>;
+  using Dijkstra = ::Dijkstra<ValueType>;
   using value_type = typename Dijkstra::value_type;
 
   Dijkstra dijkstra;
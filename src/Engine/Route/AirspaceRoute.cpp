@@ -206,6 +206,13 @@ AirspaceRoute::Synchronise(const Airspaces &master,
   }
 }
 
+void
+AirspaceRoute::UpdateClearances() const noexcept
+{
+  for (const auto &i : m_airspaces.QueryAll())
+    i.GetAirspace().GetClearance(m_airspaces.GetProjection());
+}
+
 inline void
 AirspaceRoute::AddNearbyAirspace(const RouteAirspaceIntersection &inx,
                                  const RouteLink &e) noexcept
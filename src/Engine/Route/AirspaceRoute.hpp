@@ -34,6 +34,14 @@ public:
                    const AGeoPoint &origin,
                    const AGeoPoint &destination) noexcept;
 
+  /**
+   * Calculate the clearance of all airspaces selected by
+   * Synchronise().  Solve() does this on demand, but the
+   * #AbstractAirspace objects are shared with other planners; call
+   * this before solving concurrently with them.
+   */
+  void UpdateClearances() const noexcept;
+
   void Reset() noexcept override;
 
   [[gnu::pure]]
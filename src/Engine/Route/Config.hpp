@@ -42,6 +42,8 @@ struct RoutePlannerConfig
 
   void SetDefaults();
 
+  bool operator==(const RoutePlannerConfig &) const noexcept = default;
+
   bool IsTerrainEnabled() const {
     return mode == Mode::TERRAIN || mode == Mode::BOTH;
   }
@@ -8,6 +8,9 @@
 #include "ReachFanParms.hpp"
 #include "util/GlobalSliceAllocator.hxx"
 #include "Geo/Flat/FlatProjection.hpp"
+#include "thread/ThreadPool.hpp"
+
+#include <vector>
 
 #define REACH_SWEEP (ROUTEPOLAR_Q1-BUFFER)
 
@@ -105,9 +108,12 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
       return false;
   }
 
-  fan.AddOrigin(origin, index_high - index_low);
-  for (int index = index_low; index < index_high; ++index) {
-    FlatGeoPoint x = parms.ReachIntercept(index, origin, geo_origin);
+  const unsigned n = index_high - index_low;
+  assert(n <= ROUTEPOLAR_POINTS);
+
+  FlatGeoPoint intercepts[ROUTEPOLAR_POINTS];
+  const auto calc = [&](unsigned i){
+    FlatGeoPoint x = parms.ReachIntercept(index_low + i, origin, geo_origin);
     /* if ReachIntercept() did not find anything reasonable it returns
        a FlatGeoPoint that is almost the same as origin, but differs
        +/- 1 due to conversion errors. The resulting polygon can have
@@ -115,8 +121,20 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
     if (AlmostTheSame(origin, x))
       x = origin;
 
-    fan.AddPoint(x);
-  }
+    intercepts[i] = x;
+  };
+
+  /* the rays are independent; only the root fan is big enough to be
+     worth distributing them */
+  if (parms.thread_pool != nullptr && IsRoot())
+    parms.thread_pool->Run(n, calc);
+  else
+    for (unsigned i = 0; i < n; ++i)
+      calc(i);
+
+  fan.AddOrigin(origin, n);
+  for (unsigned i = 0; i < n; ++i)
+    fan.AddPoint(intercepts[i]);
 
   return fan.CommitPoints(IsRoot());
 }
@@ -130,6 +148,7 @@ FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin,
       vertices.size() > 2 && parms.rpolars.IsTurningReachEnabled()) {
 
     // now check gaps
+    std::vector<std::pair<RouteLink, RouteLink>> gaps;
     RouteLink e_last(RoutePoint(vertices.front(), 0),
                      origin, parms.projection);
     for (auto x_last = vertices.begin(), end = vertices.end(),
@@ -138,11 +157,33 @@ FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin,
         continue;
 
       const RouteLink e(RoutePoint(*x, 0), origin, parms.projection);
-      // check if children need to be added
-      CheckGap(origin, e_last, e, parms);
+      gaps.emplace_back(e_last, e);
 
       e_last = e;
     }
+
+    /* the gaps are independent of each other; the children are
+       added in the same order as a serial search would add them */
+    std::vector<std::optional<FlatTriangleFanTree>> new_children(gaps.size());
+    const auto check = [&](unsigned i){
+      new_children[i] = CheckGap(origin, gaps[i].first, gaps[i].second,
+                                 parms);
+    };
+
+    if (parms.thread_pool != nullptr && gaps.size() > 1)
+      parms.thread_pool->Run(gaps.size(), check);
+    else
+      for (unsigned i = 0; i < gaps.size(); ++i)
+        check(i);
+
+    for (auto &child : new_children) {
+      if (!child)
+        continue;
+
+      parms.vertex_counter += child->fan.GetVertices().size();
+      parms.fan_counter++;
+      children.emplace_front(std::move(*child));
+    }
   }
 }
 
@@ -173,22 +214,19 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
     parms.terrain_base /= parms.terrain_counter;
 }
 
-bool
+std::optional<FlatTriangleFanTree>
 FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
                               const RouteLink &e_2,
-                              ReachFanParms &parms) noexcept
+                              const ReachFanParms &parms) const noexcept
 {
   const bool side = (e_1.d > e_2.d);
   const RouteLink &e_long = (side ? e_1 : e_2);
   const RouteLink &e_short = (side ? e_2 : e_1);
   if (e_short.d >= e_long.d)
-    return false;
+    return std::nullopt;
 
   const FlatGeoPoint &p_long = e_long.first;
 
-  // return true if this gap was caught (applicable) whether or not it generated
-  // a change
-
   const auto f0 = e_short.d * e_long.inv_d;
   const int h_loss =
     parms.rpolars.CalcGlideArrival(n, p_long, parms.projection) - n.altitude;
@@ -215,15 +253,11 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     const AFlatGeoPoint x(px, h);
 
     FlatTriangleFanTree child(depth + 1);
-    if (child.FillReach(x, index_left, index_right, parms)) {
-      parms.vertex_counter += child.fan.GetVertices().size();
-      parms.fan_counter++;
-      children.emplace_front(std::move(child));
-      return true;
-    }
+    if (child.FillReach(x, index_left, index_right, parms))
+      return child;
   }
 
-  return false;
+  return std::nullopt;
 }
 
 int
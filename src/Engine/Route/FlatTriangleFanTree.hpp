@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <optional>
 
 class FlatProjection;
 struct GeoPoint;
@@ -110,6 +111,12 @@ private:
   bool FillDepth(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
   void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms) noexcept;
 
-  bool CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
-                const RouteLink &e_2, ReachFanParms &parms) noexcept;
+  /**
+   * @return the child fan which fills the gap between the two
+   * links, or std::nullopt if there is none
+   */
+  std::optional<FlatTriangleFanTree> CheckGap(const AFlatGeoPoint &n,
+                                              const RouteLink &e_1,
+                                              const RouteLink &e_2,
+                                              const ReachFanParms &parms) const noexcept;
 };
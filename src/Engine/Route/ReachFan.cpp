@@ -16,11 +16,19 @@ ReachFan::Reset() noexcept
 }
 
 bool
-ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-                const RasterMap* terrain, const bool do_solve) noexcept
+ReachFan::Solve(const AGeoPoint _origin, const RoutePolars &_rpolars,
+                const RasterMap *_terrain, const bool do_solve,
+                ThreadPool *thread_pool) noexcept
 {
   Reset();
 
+  origin = _origin;
+  rpolars = _rpolars;
+  terrain = _terrain;
+  if (terrain != nullptr)
+    terrain_serial = terrain->GetSerial();
+  solved = do_solve;
+
   // initialise projection
   projection = FlatProjection(origin);
 
@@ -30,6 +38,7 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
   const int h2 = h.GetValueOr0();
 
   ReachFanParms parms(rpolars, projection, terrain_base, terrain);
+  parms.thread_pool = thread_pool;
   const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
 
   // immediate exit if starting below terrain, or starting below floor
@@ -62,6 +71,36 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
   return true;
 }
 
+bool
+ReachFan::IsReusable(const AGeoPoint new_origin,
+                     const RoutePolars &new_rpolars,
+                     const RasterMap *new_terrain,
+                     const bool do_solve) const noexcept
+{
+  if (root.IsEmpty() || do_solve != solved || new_terrain != terrain ||
+      (terrain != nullptr && terrain->GetSerial() != terrain_serial) ||
+      !new_rpolars.IsReachEqual(rpolars))
+    return false;
+
+  if (new_origin.altitude < origin.altitude ||
+      new_origin.altitude > origin.altitude + MAX_REUSE_CLIMB ||
+      new_origin.Distance(origin) > MAX_REUSE_DISTANCE)
+    return false;
+
+  // glide back to the old origin
+  const AFlatGeoPoint p(projection.ProjectInteger(new_origin),
+                        new_origin.altitude);
+  const int arrival =
+    rpolars.CalcGlideArrival(p, projection.ProjectInteger(origin), projection);
+  if (arrival < origin.altitude)
+    return false;
+
+  return terrain == nullptr || !terrain->IsDefined() ||
+    !terrain->FirstIntersection(new_origin, p.altitude, origin, arrival,
+                                p.altitude - arrival, INT_MAX,
+                                rpolars.GetSafetyHeight());
+}
+
 std::optional<ReachResult>
 ReachFan::FindPositiveArrival(const AGeoPoint dest,
                               const RoutePolars &rpolars) const noexcept
@@ -4,21 +4,44 @@
 #pragma once
 
 #include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/GeoPoint.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "RoutePolars.hpp"
+#include "util/Serial.hpp"
 
 #include <optional>
 
-class RoutePolars;
 class RasterMap;
 class GeoBounds;
+class ThreadPool;
 struct ReachResult;
 
 class ReachFan
 {
+  /**
+   * The maximum distance and climb between the origin of this reach
+   * and the aircraft for IsReusable().
+   */
+  static constexpr double MAX_REUSE_DISTANCE = 300;
+  static constexpr double MAX_REUSE_CLIMB = 30;
+
   FlatProjection projection;
   FlatTriangleFanTree root;
   int terrain_base = 0;
 
+  /** The parameters of the last Solve() call */
+  AGeoPoint origin{GeoPoint::Invalid(), 0};
+  RoutePolars rpolars;
+  const RasterMap *terrain = nullptr;
+
+  /**
+   * The RasterMap::GetSerial() value of #terrain; if it has changed,
+   * new tiles have been loaded and this reach may be too optimistic.
+   */
+  Serial terrain_serial;
+
+  bool solved = false;
+
 public:
   friend class PrintHelper;
 
@@ -32,8 +55,28 @@ public:
 
   void Reset() noexcept;
 
+  /**
+   * @param thread_pool an optional #ThreadPool which calculates
+   * parts of the reach in parallel; the result is the same as
+   * without it
+   */
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-             const RasterMap *terrain, const bool do_solve = true) noexcept;
+             const RasterMap *terrain, const bool do_solve = true,
+             ThreadPool *thread_pool = nullptr) noexcept;
+
+  /**
+   * Can this reach be used instead of calling Solve() with the
+   * given parameters?  This is the case if the aircraft can glide
+   * back to the origin of this reach, arriving at or above the old
+   * altitude: then everything in this reach can still be reached,
+   * and the arrival heights are only lower than those of a new
+   * calculation.  The aircraft must be close to the old origin and
+   * may have climbed only a little, which limits that error.
+   */
+  [[gnu::pure]]
+  bool IsReusable(const AGeoPoint new_origin, const RoutePolars &new_rpolars,
+                  const RasterMap *new_terrain,
+                  bool do_solve) const noexcept;
 
   /**
    * Find arrival height at destination.
@@ -7,11 +7,19 @@
 
 class FlatProjection;
 class RasterMap;
+class ThreadPool;
 
 struct ReachFanParms {
   const RoutePolars &rpolars;
   const FlatProjection &projection;
   const RasterMap *terrain;
+
+  /**
+   * If set, then the rays of the root fan and the gaps of each fan
+   * are calculated in parallel.
+   */
+  ThreadPool *thread_pool = nullptr;
+
   int terrain_base;
   unsigned terrain_counter = 0;
   unsigned fan_counter = 0;
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "util/TrivialArray.hxx"
+
+/**
+ * The arrival at a destination when gliding along a planned route
+ * (see RoutePlanner::CalcSolutionArrival()).
+ */
+struct RouteArrival {
+  /**
+   * Identifies the destination, e.g. the Waypoint::id.
+   */
+  unsigned id;
+
+  /**
+   * The length of the route (m).
+   */
+  double distance;
+
+  /**
+   * The arrival altitude minus the altitude required at the
+   * destination (m).  Negative if the destination cannot be reached
+   * on this route without climbing.
+   */
+  int altitude_difference;
+
+  /**
+   * Does the route deviate from the straight line to avoid an
+   * obstacle?
+   */
+  bool detour;
+};
+
+/**
+ * A list of #RouteArrival objects, e.g. for the alternates.
+ */
+using RouteArrivalList = TrivialArray<RouteArrival, 8>;
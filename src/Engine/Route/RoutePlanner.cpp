@@ -5,6 +5,8 @@
 #include "ReachResult.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 
+#include <iterator>
+
 RoutePlanner::RoutePlanner() noexcept
 {
   Reset();
@@ -190,6 +192,25 @@ RoutePlanner::FindSolution(const RoutePoint &final_point,
   return planner.GetNodeValue(final_point).h;
 }
 
+int
+RoutePlanner::CalcSolutionArrival(const AGeoPoint &destination) const noexcept
+{
+  assert(solution_route.size() >= 2);
+
+  /* the solution is ordered from the origin to the destination; walk
+     it backwards, skipping the old destination */
+  AFlatGeoPoint p(projection.ProjectInteger(destination),
+                  destination.altitude);
+  for (auto i = std::next(solution_route.rbegin()),
+         end = solution_route.rend(); i != end; ++i) {
+    const FlatGeoPoint next = projection.ProjectInteger(*i);
+    p = AFlatGeoPoint(next,
+                      rpolars_route.CalcGlideArrival(p, next, projection));
+  }
+
+  return p.altitude;
+}
+
 bool
 RoutePlanner::LinkCleared(const RouteLink &e) noexcept
 {
@@ -155,6 +155,19 @@ public:
     return solution_route;
   }
 
+  /**
+   * Calculate the altitude at the origin of the current solution when
+   * gliding along it.  The glide starts at the given point, which
+   * replaces the solution's destination (usually the aircraft, which
+   * may have moved since the solution was found).  Climbs are not
+   * taken into account, therefore the result may be below the
+   * altitude required at the origin.
+   *
+   * Must not be called before a solution exists.
+   */
+  [[gnu::pure]]
+  int CalcSolutionArrival(const AGeoPoint &destination) const noexcept;
+
   /**
    * Update aircraft performance model used for path planning.
    *
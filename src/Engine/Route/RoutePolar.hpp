@@ -48,6 +48,8 @@ class RoutePolar
       else
         inv_gradient = 0;
     };
+
+    bool operator==(const RoutePolarPoint &) const noexcept = default;
   };
 
   RoutePolarPoint points[ROUTEPOLAR_POINTS];
@@ -72,6 +74,8 @@ public:
    *
    * @return RoutePolarPoint data corresponding to this direction index
    */
+  bool operator==(const RoutePolar &) const noexcept = default;
+
   const RoutePolarPoint& GetPoint(const int index) const {
     return points[index];
   }
@@ -235,6 +235,19 @@ public:
     return height_min_working;
   }
 
+  /**
+   * Check whether a reach calculated with the other object is the
+   * same as with this one.  The cruise altitude and the climb ceiling
+   * are not used by the reach calculation.
+   */
+  [[gnu::pure]]
+  bool IsReachEqual(const RoutePolars &other) const noexcept {
+    return polar_glide == other.polar_glide &&
+      height_min_working == other.height_min_working &&
+      GetSafetyHeight() == other.GetSafetyHeight() &&
+      IsTurningReachEnabled() == other.IsTurningReachEnabled();
+  }
+
   [[gnu::pure]]
   FlatGeoPoint ReachIntercept(int index, const AFlatGeoPoint &flat_origin,
                               const GeoPoint &origin,
@@ -42,11 +42,35 @@ TerrainRoute::SolveReach(const AGeoPoint &origin,
   auto &rpolars = working ? rpolars_reach_working : rpolars_reach;
   rpolars.SetConfig(config, origin.altitude, h_ceiling);
 
+  const auto start = std::chrono::steady_clock::now();
+
   ReachFan reach;
-  reach.Solve(origin, rpolars, terrain, do_solve);
+  reach.Solve(origin, rpolars, terrain, do_solve, thread_pool);
+
+  ++reach_statistics.solved;
+  reach_statistics.solve_time += std::chrono::steady_clock::now() - start;
   return reach;
 }
 
+std::optional<ReachFan>
+TerrainRoute::UpdateReach(const ReachFan &previous,
+                          const AGeoPoint &origin,
+                          const RoutePlannerConfig &config,
+                          const int h_ceiling,
+                          const bool do_solve,
+                          const bool working) noexcept
+{
+  auto &rpolars = working ? rpolars_reach_working : rpolars_reach;
+  rpolars.SetConfig(config, origin.altitude, h_ceiling);
+
+  if (previous.IsReusable(origin, rpolars, terrain, do_solve)) {
+    ++reach_statistics.reused;
+    return std::nullopt;
+  }
+
+  return SolveReach(origin, config, h_ceiling, do_solve, working);
+}
+
 /*
   @todo:
   - check wind directions are correct
@@ -5,7 +5,11 @@
 
 #include "RoutePlanner.hpp"
 
+#include <chrono>
+#include <optional>
+
 class ReachFan;
+class ThreadPool;
 
 /**
  * Specialization of #RoutePlanner which implements terrain avoidance.
@@ -27,6 +31,25 @@ class TerrainRoute: public RoutePlanner
 
   mutable RoutePoint m_inx_terrain;
 
+  /** Calculates the reach in parallel if set */
+  ThreadPool *thread_pool = nullptr;
+
+public:
+  /** Counters of the reach calculations */
+  struct ReachStatistics {
+    /** Number of SolveReach() calls */
+    unsigned solved = 0;
+
+    /** Number of UpdateReach() calls which kept the previous reach */
+    unsigned reused = 0;
+
+    /** Time spent in SolveReach() */
+    std::chrono::steady_clock::duration solve_time{};
+  };
+
+private:
+  ReachStatistics reach_statistics;
+
 public:
   friend class PrintHelper;
 
@@ -38,6 +61,14 @@ public:
     terrain = _terrain;
   }
 
+  /**
+   * Use the given #ThreadPool for the reach calculation (nullptr
+   * disables it).
+   */
+  void SetThreadPool(ThreadPool *_thread_pool) noexcept {
+    thread_pool = _thread_pool;
+  }
+
   const auto &GetReachPolar() const noexcept {
     return rpolars_reach;
   }
@@ -55,12 +86,29 @@ public:
    * @param origin The start of the search (current aircraft location)
    * @param do_solve actually solve or just perform minimal calculations
    */
-  [[gnu::pure]]
   ReachFan SolveReach(const AGeoPoint &origin,
                       const RoutePlannerConfig &config,
                       int h_ceiling, bool do_solve,
                       bool working) noexcept;
 
+  /**
+   * Like SolveReach(), but keep the previous reach if it can still
+   * be used for the new origin (see ReachFan::IsReusable()).
+   *
+   * @param previous The last result for the same #working flag
+   * @return the new reach, or std::nullopt if #previous is still
+   * valid
+   */
+  std::optional<ReachFan> UpdateReach(const ReachFan &previous,
+                                      const AGeoPoint &origin,
+                                      const RoutePlannerConfig &config,
+                                      int h_ceiling, bool do_solve,
+                                      bool working) noexcept;
+
+  const ReachStatistics &GetReachStatistics() const noexcept {
+    return reach_statistics;
+  }
+
   /**
    * Determine if intersection with terrain occurs in forwards direction from
    * origin to destination, with cruise-climb and glide segments.
@@ -4,6 +4,8 @@
 #include "TaskDijkstra.hpp"
 #include "Geo/SearchPointVector.hpp"
 
+#include <algorithm>
+
 TaskDijkstra::TaskDijkstra(bool _is_min) noexcept
   :NavDijkstra(0),
    is_min(_is_min)
@@ -76,3 +78,135 @@ TaskDijkstra::Run() noexcept
   dijkstra.Clear();
   return retval;
 }
+
+bool
+TaskDijkstra::RunFull(const SearchPoint &location) noexcept
+{
+  dijkstra.Clear();
+  dijkstra.Reserve(256);
+
+  if (location.IsValid())
+    AddStartEdges(0, location);
+  else
+    AddZeroStartEdges();
+
+  return Run();
+}
+
+TaskDijkstra::value_type
+TaskDijkstra::CalcSolutionValue(const SearchPoint &location) const noexcept
+{
+  value_type value = CalcStartValue(solution[0], location);
+  for (unsigned stage = 1; stage < num_stages; ++stage)
+    value += CalcEdgeValue(ScanTaskPoint(stage - 1, solution[stage - 1]),
+                           ScanTaskPoint(stage, solution[stage]));
+  return value;
+}
+
+bool
+TaskDijkstra::IsResultValid(unsigned i) const noexcept
+{
+  assert(i < num_stages);
+
+  if (i >= n_results)
+    return false;
+
+  const SearchPointVector &boundary = *boundaries[num_stages - 1 - i];
+  const auto &locations = results[i].locations;
+  return std::equal(boundary.begin(), boundary.end(),
+                    locations.begin(), locations.end(),
+                    [](const SearchPoint &a, const GeoPoint &b){
+                      return a.GetLocation() == b;
+                    });
+}
+
+void
+TaskDijkstra::UpdateResult(unsigned i) noexcept
+{
+  assert(i < num_stages);
+
+  const unsigned stage = num_stages - 1 - i;
+  const SearchPointVector &boundary = *boundaries[stage];
+  const unsigned size = boundary.size();
+
+  StageResult &result = results[i];
+  result.locations.clear();
+  for (const auto &point : boundary)
+    result.locations.push_back(point.GetLocation());
+
+  result.values.assign(size, 0);
+  result.next.assign(size, 0);
+
+  if (i == 0)
+    /* this is the finish */
+    return;
+
+  const StageResult &following = results[i - 1];
+  const unsigned following_size = following.values.size();
+
+  for (unsigned j = 0; j < size; ++j) {
+    const ScanTaskPoint origin(stage, j);
+
+    for (unsigned k = 0; k < following_size; ++k) {
+      const value_type value = CalcEdgeValue(origin,
+                                             ScanTaskPoint(stage + 1, k)) +
+        following.values[k];
+      if (k == 0 || value < result.values[j]) {
+        result.values[j] = value;
+        result.next[j] = k;
+      }
+    }
+  }
+}
+
+bool
+TaskDijkstra::RunIncremental(const SearchPoint &location) noexcept
+{
+  for (unsigned stage = 0; stage < num_stages; ++stage)
+    if (GetStageSize(stage) == 0)
+      return false;
+
+  /* find the first stage (counting from the finish) which has
+     changed; it and all stages before it need to be recalculated */
+  unsigned i = 0;
+  while (i < num_stages && IsResultValid(i))
+    ++i;
+
+  if (i < num_stages) {
+    for (; i < num_stages; ++i)
+      UpdateResult(i);
+
+    n_results = num_stages;
+  }
+
+  /* choose the best start */
+
+  const StageResult &start = results[num_stages - 1];
+  value_type best_value = 0;
+  for (unsigned j = 0, size = start.values.size(); j < size; ++j) {
+    const value_type value = CalcStartValue(j, location) + start.values[j];
+    if (j == 0 || value < best_value) {
+      best_value = value;
+      solution[0] = j;
+    }
+  }
+
+  for (unsigned stage = 1; stage < num_stages; ++stage)
+    solution[stage] =
+      results[num_stages - stage].next[solution[stage - 1]];
+
+#ifndef NDEBUG
+  if (verify) {
+    unsigned incremental_solution[MAX_STAGES];
+    std::copy_n(solution, num_stages, incremental_solution);
+
+    [[maybe_unused]] const bool found = RunFull(location);
+    assert(found);
+    assert(CalcSolutionValue(location) == best_value);
+
+    std::copy_n(incremental_solution, num_stages, solution);
+  }
+#endif
+
+  return true;
+}
@@ -6,7 +6,9 @@
 #include "PathSolvers/NavDijkstra.hpp"
 #include "Geo/SearchPoint.hpp"
 
+#include <array>
 #include <cassert>
+#include <vector>
 
 class OrderedTask;
 class SearchPointVector;
@@ -29,14 +31,59 @@ class SearchPointVector;
  * Before each calculation, set up this object with SetTaskSize() and
  * call SetBoundary() for each task point.
  *
- * This uses a Dijkstra search and so is O(N log(N)).
+ * The search graph is layered (each stage is only linked to the
+ * next one), therefore the best path from each point to the finish is
+ * calculated stage by stage, from the finish backwards.  These values
+ * are kept, and the next search recalculates only the stages whose
+ * boundary has changed and the stages before them.  When only the
+ * aircraft has moved, this leaves just the start edges.
  */
 class TaskDijkstra : protected NavDijkstra<>
 {
   const SearchPointVector *boundaries[MAX_STAGES];
 
+  /**
+   * The best path from each point of a stage to the finish.
+   */
+  struct StageResult {
+    /**
+     * The boundary these values were calculated for.
+     */
+    std::vector<GeoPoint> locations;
+
+    /**
+     * The value of the best path from each point to the finish.
+     */
+    std::vector<value_type> values;
+
+    /**
+     * The index of the next point on that path.
+     */
+    std::vector<unsigned> next;
+  };
+
+  /**
+   * The results of the previous search, indexed by the number of
+   * stages following the stage.  This way, they remain valid when
+   * stages are removed from the front, i.e. when the next turn point
+   * becomes active.
+   */
+  std::array<StageResult, MAX_STAGES> results;
+
+  /**
+   * The number of valid elements in #results.
+   */
+  unsigned n_results = 0;
+
   const bool is_min;
 
+#ifndef NDEBUG
+  /**
+   * Check each incremental result against a full Dijkstra search?
+   */
+  bool verify = false;
+#endif
+
 public:
   /**
    * Constructor
@@ -65,12 +112,42 @@ public:
     return GetPoint(ScanTaskPoint(stage, solution[stage]));
   }
 
+#ifndef NDEBUG
+  /**
+   * Enable a full Dijkstra search after each incremental one, and
+   * assert that both found a path with the same value.  This is
+   * only available in debug builds.
+   */
+  void SetVerify(bool _verify) noexcept {
+    verify = _verify;
+  }
+#endif
+
 protected:
   [[gnu::pure]]
   const SearchPoint &GetPoint(ScanTaskPoint sp) const noexcept;
 
   bool Run() noexcept;
 
+  /**
+   * Find the best path, reusing the results of the previous call for
+   * all stages which have not changed.
+   *
+   * @param location the origin of the start edges; if it is invalid,
+   * each point of the first stage is a start
+   * @return true if a path was found
+   */
+  bool RunIncremental(const SearchPoint &location) noexcept;
+
+  /**
+   * Find the best path with a new Dijkstra search.
+   *
+   * @param location the origin of the start edges; if it is invalid,
+   * each point of the first stage is a start
+   * @return true if a path was found
+   */
+  bool RunFull(const SearchPoint &location) noexcept;
+
   bool Link(const ScanTaskPoint node, const ScanTaskPoint parent,
             value_type value) noexcept {
     if (!is_min)
@@ -128,6 +205,46 @@ private:
   [[gnu::pure]]
   unsigned GetStageSize(const unsigned stage) const noexcept;
 
+  /**
+   * Calculate the value of the edge between two points, like Link()
+   * does.
+   */
+  [[gnu::pure]]
+  value_type CalcEdgeValue(ScanTaskPoint origin,
+                           ScanTaskPoint destination) const noexcept {
+    const value_type value = CalcDistance(origin, destination);
+    return is_min ? value : DIJKSTRA_MINMAX_OFFSET - value;
+  }
+
+  /**
+   * Calculate the value of the start edge to the specified point of
+   * the first stage, like AddStartEdges() and AddZeroStartEdges() do.
+   */
+  [[gnu::pure]]
+  value_type CalcStartValue(unsigned index,
+                            const SearchPoint &location) const noexcept {
+    return location.IsValid()
+      ? CalcDistance(ScanTaskPoint(0, index), location)
+      : index;
+  }
+
+  /**
+   * Calculate the value of the path in #solution.
+   */
+  [[gnu::pure]]
+  value_type CalcSolutionValue(const SearchPoint &location) const noexcept;
+
+  /**
+   * Is the stage with the specified index in #results still valid?
+   */
+  [[gnu::pure]]
+  bool IsResultValid(unsigned i) const noexcept;
+
+  /**
+   * Calculate the element of #results with the specified index.
+   */
+  void UpdateResult(unsigned i) noexcept;
+
 protected:
   /* methods from NavDijkstra */
   virtual void AddEdges(ScanTaskPoint curNode) noexcept final;
@@ -6,8 +6,9 @@
 #include "AlternateList.hpp"
 #include "Navigation/Aircraft.hpp"
 #include "Task/Visitors/TaskPointVisitor.hpp"
-#include "Task/Solvers/TaskSolution.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/GlideBatch.hpp"
+#include "GlideSolvers/MacCready.hpp"
 #include "Waypoint/Waypoints.hpp"
 
 /** min search range in m */
@@ -97,17 +98,39 @@ IsReachable(const GlideResult &result, bool final_glide) noexcept
     : result.IsAchievable();
 }
 
+/**
+ * Calculate the glide solution of all candidates at once.  This is
+ * the same as TaskSolution::GlideSolutionRemaining() with an
+ * #UnorderedTaskPoint.
+ */
+static void
+SolveAlternates(AlternateList &alternates, const AircraftState &state,
+                const TaskBehaviour &task_behaviour,
+                const GlidePolar &polar) noexcept
+{
+  GlideBatch batch(state.altitude, state.wind);
+  batch.reserve(alternates.size());
+
+  for (const auto &i : alternates)
+    batch.push_back(GeoVector(state.location, i.waypoint->location),
+                    std::max(0., i.waypoint->GetElevationOrZero() +
+                             task_behaviour.safety_height_arrival));
+
+  std::vector<GlideResult> results(alternates.size());
+  MacCready(task_behaviour.glide, polar).Solve(batch, results);
+
+  for (std::size_t i = 0; i < alternates.size(); ++i)
+    alternates[i].solution = results[i];
+}
+
 bool
-AbortTask::FillReachable(const AircraftState &state,
-                         AlternateList &approx_waypoints,
-                         const GlidePolar &polar, bool only_airfield,
+AbortTask::FillReachable(AlternateList &approx_waypoints,
+                         bool only_airfield,
                          bool final_glide, [[maybe_unused]] bool safety) noexcept
 {
   if (IsTaskFull() || approx_waypoints.empty())
     return false;
 
-  const AGeoPoint p_start(state.location, state.altitude);
-
   bool found_final_glide = false;
   AlternateList q;
   q.reserve(32);
@@ -118,10 +141,7 @@ AbortTask::FillReachable(const AircraftState &state,
       continue;
     }
 
-    UnorderedTaskPoint t(v->waypoint, task_behaviour);
-    GlideResult result =
-        TaskSolution::GlideSolutionRemaining(t, state,
-                                             task_behaviour.glide, polar);
+    const GlideResult &result = v->solution;
 
     if (IsReachable(result, final_glide)) {
       bool intersects = false;
@@ -209,19 +229,21 @@ AbortTask::UpdateSample(const AircraftState &state,
     return false;
   }
 
+  SolveAlternates(approx_waypoints, state, task_behaviour, glide_polar);
+
   // sort by arrival time
 
   // first try with final glide only
-  reachable_landable |=  FillReachable(state, approx_waypoints, glide_polar,
+  reachable_landable |=  FillReachable(approx_waypoints,
                                        true, true, true);
-  reachable_landable |=  FillReachable(state, approx_waypoints, glide_polar,
+  reachable_landable |=  FillReachable(approx_waypoints,
                                        false, true, true);
 
   // inform clients that the landable reachable scan has been performed 
   ClientUpdate(state, true);
 
   // now try without final glide constraint and not preferring airports
-  FillReachable(state, approx_waypoints, glide_polar, false, false, false);
+  FillReachable(approx_waypoints, false, false, false);
 
   // inform clients that the landable unreachable scan has been performed 
   ClientUpdate(state, false);
@@ -140,18 +140,16 @@ protected:
    * waypoints satisfying approximate range queries.  Can be used
    * to add airfields only, or landpoints.
    *
-   * @param state Aircraft state
-   * @param approx_waypoints List of candidate waypoints
-   * @param polar Polar used for tests
+   * @param approx_waypoints List of candidate waypoints, with their
+   * solutions
    * @param only_airfield If true, only add waypoints that are airfields.
    * @param final_glide Whether solution must be glide only or climb allowed
    * @param safety Whether solution uses safety polar
    *
    * @return True if a landpoint within final glide was found
    */
-  bool FillReachable(const AircraftState &state,
-                     AlternateList &approx_waypoints,
-                     const GlidePolar &polar, bool only_airfield,
+  bool FillReachable(AlternateList &approx_waypoints,
+                     bool only_airfield,
                      bool final_glide, bool safety) noexcept;
 
 protected:
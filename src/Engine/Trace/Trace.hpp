@@ -185,8 +185,8 @@ class Trace : private NonCopyable
   const unsigned max_size;
   const unsigned opt_size;
 
-  Time average_delta_time;
-  unsigned average_delta_distance;
+  Time average_delta_time{};
+  unsigned average_delta_distance = 0;
 
   Serial append_serial, modify_serial;
 
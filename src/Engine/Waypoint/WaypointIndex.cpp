@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "WaypointIndex.hpp"
+#include "Waypoint.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+static constexpr uint64_t
+SquareDistance(FlatGeoPoint a, int x, int y) noexcept
+{
+  const int64_t dx = int64_t(x) - a.x;
+  const int64_t dy = int64_t(y) - a.y;
+  return dx * dx + dy * dy;
+}
+
+void
+WaypointIndex::Clear() noexcept
+{
+  nodes.clear();
+  xs.clear();
+  ys.clear();
+  flags.clear();
+  waypoints.clear();
+  n_indexed = 0;
+}
+
+WaypointIndex::Entry
+WaypointIndex::MakeEntry(const WaypointPtr &waypoint) noexcept
+{
+  assert(waypoint->flat_location_initialised);
+
+  uint8_t flags = 0;
+  if (waypoint->IsLandable())
+    flags |= LANDABLE;
+  if (waypoint->IsAirport())
+    flags |= AIRPORT;
+
+  return {waypoint->flat_location, flags, waypoint};
+}
+
+void
+WaypointIndex::Build(std::vector<Entry> &&entries) noexcept
+{
+  Clear();
+
+  if (entries.empty())
+    return;
+
+  /* a balanced tree with leaves of at least LEAF_SIZE/2 points has
+     fewer than 4n/LEAF_SIZE nodes */
+  nodes.reserve(4 * entries.size() / LEAF_SIZE + 1);
+  nodes.emplace_back();
+  BuildNode(0, entries, 0, entries.size());
+
+  xs.reserve(entries.size());
+  ys.reserve(entries.size());
+  flags.reserve(entries.size());
+  waypoints.reserve(entries.size());
+
+  for (auto &i : entries) {
+    xs.push_back(i.location.x);
+    ys.push_back(i.location.y);
+    flags.push_back(i.flags);
+    waypoints.push_back(std::move(i.waypoint));
+  }
+
+  n_indexed = waypoints.size();
+}
+
+void
+WaypointIndex::Append(const WaypointPtr &waypoint) noexcept
+{
+  assert(!IsEmpty());
+
+  const Entry entry = MakeEntry(waypoint);
+  xs.push_back(entry.location.x);
+  ys.push_back(entry.location.y);
+  flags.push_back(entry.flags);
+  waypoints.push_back(entry.waypoint);
+
+  if (waypoints.size() - n_indexed > MAX_APPENDED) {
+    /* the appended points are searched linearly; move them into the
+       tree */
+    std::vector<Entry> entries;
+    entries.reserve(waypoints.size());
+    for (std::size_t i = 0; i < waypoints.size(); ++i)
+      entries.push_back({FlatGeoPoint(xs[i], ys[i]), flags[i],
+                         std::move(waypoints[i])});
+
+    Build(std::move(entries));
+  }
+}
+
+void
+WaypointIndex::BuildNode(unsigned node_index, std::vector<Entry> &entries,
+                         unsigned begin, unsigned end) noexcept
+{
+  assert(begin < end);
+
+  const auto first = std::next(entries.begin(), begin);
+  const auto last = std::next(entries.begin(), end);
+
+  Node node;
+  node.left = node.right = first->location.x;
+  node.top = node.bottom = first->location.y;
+  for (auto i = first; i != last; ++i) {
+    node.left = std::min(node.left, i->location.x);
+    node.right = std::max(node.right, i->location.x);
+    node.top = std::min(node.top, i->location.y);
+    node.bottom = std::max(node.bottom, i->location.y);
+  }
+
+  node.begin = begin;
+  node.end = end;
+  node.children = 0;
+
+  if (end - begin > LEAF_SIZE &&
+      (node.left != node.right || node.top != node.bottom)) {
+    /* split at the median of the longer axis */
+    const bool split_x = node.right - node.left >= node.bottom - node.top;
+    const unsigned middle = begin + (end - begin) / 2;
+    std::nth_element(first, std::next(entries.begin(), middle), last,
+                     [split_x](const Entry &a, const Entry &b){
+                       return split_x
+                         ? a.location.x < b.location.x
+                         : a.location.y < b.location.y;
+                     });
+
+    node.children = nodes.size();
+    nodes.emplace_back();
+    nodes.emplace_back();
+
+    BuildNode(node.children, entries, begin, middle);
+    BuildNode(node.children + 1, entries, middle, end);
+  }
+
+  /* assign after the recursion, because it may reallocate the
+     vector */
+  nodes[node_index] = node;
+}
+
+template<typename P>
+inline void
+WaypointIndex::FindNearestIndex(const Node &node, FlatGeoPoint location,
+                                P &predicate, unsigned &nearest,
+                                uint64_t &nearest_square_distance) const noexcept
+{
+  if (node.IsLeaf()) {
+    for (unsigned i = node.begin; i < node.end; ++i) {
+      const uint64_t square_distance = SquareDistance(location, xs[i], ys[i]);
+      if ((square_distance < nearest_square_distance ||
+           (square_distance == nearest_square_distance && nearest == NONE)) &&
+          predicate(i)) {
+        nearest = i;
+        nearest_square_distance = square_distance;
+      }
+    }
+
+    return;
+  }
+
+  /* visit the nearer child first; this allows pruning the other one
+     in most cases */
+  const Node *a = &nodes[node.children], *b = &nodes[node.children + 1];
+  uint64_t da = a->SquareDistanceTo(location);
+  uint64_t db = b->SquareDistanceTo(location);
+  if (db < da) {
+    std::swap(a, b);
+    std::swap(da, db);
+  }
+
+  if (da <= nearest_square_distance)
+    FindNearestIndex(*a, location, predicate, nearest,
+                     nearest_square_distance);
+
+  if (db <= nearest_square_distance)
+    FindNearestIndex(*b, location, predicate, nearest,
+                     nearest_square_distance);
+}
+
+template<typename P>
+inline unsigned
+WaypointIndex::FindNearestIndex(FlatGeoPoint location, unsigned range,
+                                P &&predicate) const noexcept
+{
+  if (IsEmpty())
+    return NONE;
+
+  unsigned nearest = NONE;
+  uint64_t nearest_square_distance = uint64_t(range) * range;
+  if (nodes.front().SquareDistanceTo(location) <= nearest_square_distance)
+    FindNearestIndex(nodes.front(), location, predicate, nearest,
+                     nearest_square_distance);
+
+  for (unsigned i = n_indexed; i < waypoints.size(); ++i) {
+    const uint64_t square_distance = SquareDistance(location, xs[i], ys[i]);
+    if ((square_distance < nearest_square_distance ||
+         (square_distance == nearest_square_distance && nearest == NONE)) &&
+        predicate(i)) {
+      nearest = i;
+      nearest_square_distance = square_distance;
+    }
+  }
+
+  return nearest;
+}
+
+WaypointPtr
+WaypointIndex::FindNearest(FlatGeoPoint location,
+                           unsigned range) const noexcept
+{
+  const unsigned i = FindNearestIndex(location, range,
+                                      [](unsigned){ return true; });
+  return i != NONE ? waypoints[i] : nullptr;
+}
+
+WaypointPtr
+WaypointIndex::FindNearestFlags(FlatGeoPoint location, unsigned range,
+                                uint8_t mask) const noexcept
+{
+  const unsigned i = FindNearestIndex(location, range,
+                                      [this, mask](unsigned j){
+                                        return (flags[j] & mask) == mask;
+                                      });
+  return i != NONE ? waypoints[i] : nullptr;
+}
+
+WaypointPtr
+WaypointIndex::FindNearestIf(FlatGeoPoint location, unsigned range,
+                             bool (*predicate)(const Waypoint &)) const noexcept
+{
+  const unsigned i = FindNearestIndex(location, range,
+                                      [this, predicate](unsigned j){
+                                        return predicate(*waypoints[j]);
+                                      });
+  return i != NONE ? waypoints[i] : nullptr;
+}
+
+void
+WaypointIndex::VisitWithinRange(const Node &node, FlatGeoPoint location,
+                                uint64_t square_range,
+                                const std::function<void(const WaypointPtr &)> &visitor) const
+{
+  if (node.SquareDistanceTo(location) > square_range)
+    return;
+
+  if (node.IsLeaf()) {
+    for (unsigned i = node.begin; i < node.end; ++i)
+      if (SquareDistance(location, xs[i], ys[i]) <= square_range)
+        visitor(waypoints[i]);
+  } else {
+    VisitWithinRange(nodes[node.children], location, square_range, visitor);
+    VisitWithinRange(nodes[node.children + 1], location, square_range,
+                     visitor);
+  }
+}
+
+void
+WaypointIndex::VisitWithinRange(FlatGeoPoint location, unsigned range,
+                                const std::function<void(const WaypointPtr &)> &visitor) const
+{
+  if (IsEmpty())
+    return;
+
+  const uint64_t square_range = uint64_t(range) * range;
+  VisitWithinRange(nodes.front(), location, square_range, visitor);
+
+  for (unsigned i = n_indexed; i < waypoints.size(); ++i)
+    if (SquareDistance(location, xs[i], ys[i]) <= square_range)
+      visitor(waypoints[i]);
+}
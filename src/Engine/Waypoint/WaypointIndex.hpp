@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Ptr.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct Waypoint;
+
+/**
+ * A read-only spatial index of #Waypoint objects, optimised for
+ * lookups in large waypoint files.
+ *
+ * The waypoints are kept in a static k-d tree whose leaves are
+ * contiguous ranges of packed arrays holding the projected
+ * coordinates and the most important flags ("structure of arrays").
+ * A search only touches these arrays and the small node array; the
+ * #Waypoint objects are dereferenced only for matches (and for custom
+ * predicates).
+ *
+ * Unlike #QuadTree, square distances are calculated with 64 bit
+ * integers, which do not overflow for worldwide waypoint files.
+ *
+ * Waypoints which are added later (see Append()) are kept in a small
+ * unsorted tail of the packed arrays, which every search scans
+ * linearly.  After other modifications, the index has to be rebuilt.
+ */
+class WaypointIndex {
+  /**
+   * Stop splitting nodes at this number of points.
+   */
+  static constexpr unsigned LEAF_SIZE = 32;
+
+  /**
+   * Rebuild the tree when more than this number of points have been
+   * appended.
+   */
+  static constexpr unsigned MAX_APPENDED = LEAF_SIZE;
+
+  static constexpr unsigned NONE = unsigned(-1);
+
+public:
+  enum Flags : uint8_t {
+    LANDABLE = 0x1,
+    AIRPORT = 0x2,
+  };
+
+private:
+  struct Node {
+    /**
+     * The bounding box of all points in this node.
+     */
+    int left, top, right, bottom;
+
+    /**
+     * The range of points (in the packed arrays) in this node.
+     */
+    unsigned begin, end;
+
+    /**
+     * The index of the first child node; the second one follows
+     * immediately.  0 if this is a leaf.
+     */
+    unsigned children;
+
+    constexpr bool IsLeaf() const noexcept {
+      return children == 0;
+    }
+
+    /**
+     * Calculate the square distance from the given point to the
+     * nearest point of the bounding box.
+     */
+    constexpr uint64_t SquareDistanceTo(FlatGeoPoint p) const noexcept {
+      const int64_t dx = p.x < left
+        ? left - p.x
+        : (p.x > right ? p.x - right : 0);
+      const int64_t dy = p.y < top
+        ? top - p.y
+        : (p.y > bottom ? p.y - bottom : 0);
+      return dx * dx + dy * dy;
+    }
+  };
+
+  /**
+   * Temporary storage during Build().
+   */
+  struct Entry {
+    FlatGeoPoint location;
+    uint8_t flags;
+    WaypointPtr waypoint;
+  };
+
+  std::vector<Node> nodes;
+
+  /* the packed arrays, ordered by leaf */
+  std::vector<int> xs, ys;
+  std::vector<uint8_t> flags;
+  std::vector<WaypointPtr> waypoints;
+
+  /**
+   * The number of points in the tree; the following ones were added
+   * by Append().
+   */
+  unsigned n_indexed = 0;
+
+public:
+  [[gnu::pure]]
+  bool IsEmpty() const noexcept {
+    return nodes.empty();
+  }
+
+  void Clear() noexcept;
+
+  /**
+   * Rebuild the index from the given waypoints.  Their
+   * #Waypoint::flat_location must be up to date.
+   */
+  template<typename R>
+  void Build(const R &range) noexcept {
+    std::vector<Entry> entries;
+    for (const WaypointPtr &i : range)
+      entries.push_back(MakeEntry(i));
+    Build(std::move(entries));
+  }
+
+  /**
+   * Add a waypoint to a non-empty index.  Its
+   * #Waypoint::flat_location must be up to date.
+   */
+  void Append(const WaypointPtr &waypoint) noexcept;
+
+  /**
+   * Find the nearest waypoint within the given (projected) range.
+   */
+  [[gnu::pure]]
+  WaypointPtr FindNearest(FlatGeoPoint location,
+                          unsigned range) const noexcept;
+
+  /**
+   * Like FindNearest(), but consider only waypoints which have all of
+   * the given #Flags.  This does not dereference the #Waypoint
+   * objects.
+   */
+  [[gnu::pure]]
+  WaypointPtr FindNearestFlags(FlatGeoPoint location, unsigned range,
+                               uint8_t mask) const noexcept;
+
+  /**
+   * Like FindNearest(), but consider only waypoints which match the
+   * predicate.  The predicate is only invoked for waypoints which
+   * are nearer than the best match so far.
+   */
+  [[gnu::pure]]
+  WaypointPtr FindNearestIf(FlatGeoPoint location, unsigned range,
+                            bool (*predicate)(const Waypoint &)) const noexcept;
+
+  void VisitWithinRange(FlatGeoPoint location, unsigned range,
+                        const std::function<void(const WaypointPtr &)> &visitor) const;
+
+private:
+  static Entry MakeEntry(const WaypointPtr &waypoint) noexcept;
+
+  void Build(std::vector<Entry> &&entries) noexcept;
+
+  /**
+   * Build the node #node_index from the given entries (which are
+   * reordered) and its children.
+   */
+  void BuildNode(unsigned node_index, std::vector<Entry> &entries,
+                 unsigned begin, unsigned end) noexcept;
+
+  /**
+   * @param predicate invoked with the point index
+   * @return the point index or #NONE
+   */
+  template<typename P>
+  [[gnu::pure]]
+  unsigned FindNearestIndex(FlatGeoPoint location, unsigned range,
+                            P &&predicate) const noexcept;
+
+  template<typename P>
+  void FindNearestIndex(const Node &node, FlatGeoPoint location,
+                        P &predicate,
+                        unsigned &nearest,
+                        uint64_t &nearest_square_distance) const noexcept;
+
+  void VisitWithinRange(const Node &node, FlatGeoPoint location,
+                        uint64_t square_range,
+                        const std::function<void(const WaypointPtr &)> &visitor) const;
+};
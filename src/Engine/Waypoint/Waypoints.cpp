@@ -76,19 +76,23 @@ Waypoints::Waypoints() noexcept = default;
 void
 Waypoints::Optimise() noexcept
 {
-  if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
-    /* empty or already optimised */
+  if (waypoint_tree.IsEmpty())
     return;
 
-  task_projection.Update();
+  if (!waypoint_tree.HaveBounds()) {
+    task_projection.Update();
 
-  for (auto &i : waypoint_tree) {
-    // TODO: eliminate this const_cast hack
-    Waypoint &w = const_cast<Waypoint &>(*i);
-    w.Project(task_projection);
+    for (auto &i : waypoint_tree) {
+      // TODO: eliminate this const_cast hack
+      Waypoint &w = const_cast<Waypoint &>(*i);
+      w.Project(task_projection);
+    }
+
+    waypoint_tree.Optimise();
   }
 
-  waypoint_tree.Optimise();
+  if (index.IsEmpty())
+    index.Build(waypoint_tree);
 }
 
 void
@@ -110,6 +114,10 @@ Waypoints::Append(WaypointPtr wp) noexcept
   w.id = next_id++;
 
   waypoint_tree.Add(wp);
+  if (!index.IsEmpty())
+    /* the bounds were kept (see above), so the waypoint has been
+       projected */
+    index.Append(wp);
   name_tree.Add(wp);
 
   ++serial;
@@ -124,6 +132,9 @@ Waypoints::GetNearest(const GeoPoint &loc, double range) const noexcept
   const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
   const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+  if (!index.IsEmpty())
+    return index.FindNearest(flat_location, mrange);
+
   const auto found = waypoint_tree.FindNearest(point, mrange);
 
   if (found.first == waypoint_tree.end())
@@ -141,6 +152,13 @@ IsLandable(const Waypoint &wp) noexcept
 WaypointPtr
 Waypoints::GetNearestLandable(const GeoPoint &loc, double range) const noexcept
 {
+  if (!index.IsEmpty()) {
+    const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
+    const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+    return index.FindNearestFlags(flat_location, mrange,
+                                  WaypointIndex::LANDABLE);
+  }
+
   return GetNearestIf(loc, range, IsLandable);
 }
 
@@ -154,6 +172,9 @@ Waypoints::GetNearestIf(const GeoPoint &loc, double range,
   const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
   const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+  if (!index.IsEmpty())
+    return index.FindNearestIf(flat_location, mrange, predicate);
+
   const auto found = waypoint_tree.FindNearestIf(point, mrange,
                                                  [predicate](const WaypointPtr &ptr){
                                                    return predicate(*ptr);
@@ -233,7 +254,10 @@ Waypoints::VisitWithinRange(const GeoPoint &loc, const double range,
   const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
 
-  waypoint_tree.VisitWithinRange(point, mrange, visitor);
+  if (!index.IsEmpty())
+    index.VisitWithinRange(flat_location, mrange, visitor);
+  else
+    waypoint_tree.VisitWithinRange(point, mrange, visitor);
 }
 
 void
@@ -250,6 +274,7 @@ Waypoints::Clear() noexcept
   home = nullptr;
   name_tree.Clear();
   waypoint_tree.clear();
+  index.Clear();
   next_id = 1;
 }
 
@@ -267,24 +292,32 @@ Waypoints::Erase(WaypointPtr &&wp) noexcept
 
   name_tree.Remove(std::move(wp));
   waypoint_tree.erase(f.first);
+  index.Clear();
   ++serial;
 }
 
 void
 Waypoints::EraseUserMarkers() noexcept
 {
-  waypoint_tree.EraseIf([this](const WaypointPtr &wp){
+  bool erased = false;
+  waypoint_tree.EraseIf([this, &erased](const WaypointPtr &wp){
       if (wp->origin == WaypointOrigin::USER &&
           wp->type == Waypoint::Type::MARKER) {
         if (home == wp)
           home = nullptr;
 
         name_tree.Remove(wp);
+        erased = true;
         ++serial;
         return true;
       } else
         return false;
     });
+
+  if (erased && !index.IsEmpty())
+    /* nobody calls Optimise() after this; the remaining waypoints
+       are still projected */
+    index.Build(waypoint_tree);
 }
 
 void
@@ -315,6 +348,7 @@ Waypoints::Replace(const WaypointPtr &orig, Waypoint &&replacement) noexcept
   assert(f.first != waypoint_tree.end());
 
   waypoint_tree.Replace(f.first, std::move(new_ptr));
+  index.Clear();
 
   ++serial;
 }
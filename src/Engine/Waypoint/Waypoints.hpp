@@ -5,6 +5,7 @@
 
 #include "Ptr.hpp"
 #include "Waypoint.hpp"
+#include "WaypointIndex.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "util/RadixTree.hpp"
 #include "util/QuadTree.hxx"
@@ -61,6 +62,16 @@ class Waypoints {
   unsigned next_id = 1;
 
   WaypointTree waypoint_tree;
+
+  /**
+   * A packed copy of #waypoint_tree for fast lookups, built by
+   * Optimise().  Append() adds to it as long as the bounds of
+   * #waypoint_tree are kept, and EraseUserMarkers() rebuilds it; all
+   * other modifications clear it.  While it is empty, lookups fall
+   * back to #waypoint_tree.
+   */
+  WaypointIndex index;
+
   WaypointNameTree name_tree;
   TaskProjection task_projection;
 
@@ -85,6 +96,13 @@ public:
     return serial;
   }
 
+  /**
+   * Returns the projection of Waypoint::flat_location.
+   */
+  const TaskProjection &GetProjection() const noexcept {
+    return task_projection;
+  }
+
   /**
    * Add this waypoint to internal store.
    * Optimise() must be called after inserting waypoints prior to
@@ -157,6 +175,7 @@ public:
   void ScheduleOptimise() noexcept {
     waypoint_tree.Flatten();
     waypoint_tree.ClearBounds();
+    index.Clear();
   }
 
   /**
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "PolygonInterior.hpp"
+#include "Geo/PolygonEdgeIndex.hpp"
 #include "Math/Line2D.hpp"
 
 static constexpr Point2D<double>
@@ -38,6 +39,35 @@ isLeft( const FlatGeoPoint &P0, const FlatGeoPoint &P1, const FlatGeoPoint &P2 )
   return Line2D<FlatGeoPoint>(P0, P1).LocatePoint(P2);
 }
 
+// Winding(): the contribution of the edge from P0 to P1 to the
+//      winding number of P
+inline static int
+Winding(const GeoPoint &P0, const GeoPoint &P1, const GeoPoint &P)
+{
+  // edge from current to next
+  if (P0.latitude <= P.latitude) {
+    // start y <= P.latitude
+
+    if (P1.latitude > P.latitude)
+      // an upward crossing
+      if (isLeft(P0, P1, P) > 0)
+        // P left of edge
+        // have a valid up intersect
+        return 1;
+  } else {
+    // start y > P.latitude (no test needed)
+
+    if (P1.latitude <= P.latitude)
+      // a downward crossing
+      if (isLeft(P0, P1, P) < 0)
+        // P right of edge
+        // have a valid down intersect
+        return -1;
+  }
+
+  return 0;
+}
+
 //===================================================================
 
 // PolygonInterior(): winding number interior test for a point in a polygon
@@ -57,28 +87,23 @@ PolygonInterior(const GeoPoint &P,
 
   // loop through all edges of the polygon
   for (auto i = begin, next = std::next(i); next != end;
-       i = next, next = std::next(i)) {
-    // edge from current to next
-    if (i->GetLocation().latitude <= P.latitude) {
-      // start y <= P.latitude
+       i = next, next = std::next(i))
+    wn += Winding(i->GetLocation(), next->GetLocation(), P);
 
-      if (next->GetLocation().latitude > P.latitude)
-        // an upward crossing
-        if (isLeft(i->GetLocation(), next->GetLocation(), P) > 0)
-          // P left of edge
-          // have a valid up intersect
-          ++wn;
-    } else {
-      // start y > P.latitude (no test needed)
+  return wn != 0;
+}
+
+bool
+PolygonInterior(const GeoPoint &P, const SearchPointVector &polygon,
+                const PolygonEdgeIndex &index) noexcept
+{
+  int    wn = 0;    // the winding number counter
+
+  // loop through the edges near P
+  index.VisitEdges(P.latitude, [&](std::size_t i){
+    wn += Winding(polygon[i].GetLocation(), polygon[i + 1].GetLocation(), P);
+  });
 
-      if (next->GetLocation().latitude <= P.latitude)
-        // a downward crossing
-        if (isLeft(i->GetLocation(), next->GetLocation(), P) < 0)
-          // P right of edge
-          // have a valid down intersect
-          --wn;
-    }
-  }
   return wn != 0;
 }
 
@@ -8,6 +8,7 @@
 struct GeoPoint;
 struct FlatGeoPoint;
 class SearchPoint;
+class PolygonEdgeIndex;
 
 /**
  * Note that this expects the vector to be closed, that is, starting point
@@ -24,3 +25,14 @@ bool
 PolygonInterior(const FlatGeoPoint &p,
                 SearchPointVector::const_iterator begin,
                 SearchPointVector::const_iterator end);
+
+/**
+ * Like PolygonInterior(), but examine only the edges which the index
+ * lists near the point.  The result is the same.
+ *
+ * @param index an index built for this (closed) polygon
+ */
+[[gnu::pure]]
+bool
+PolygonInterior(const GeoPoint &p, const SearchPointVector &polygon,
+                const PolygonEdgeIndex &index) noexcept;
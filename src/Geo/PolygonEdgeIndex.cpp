@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "PolygonEdgeIndex.hpp"
+#include "SearchPointVector.hpp"
+
+#include <cassert>
+
+/**
+ * The average number of edges per band.  Fewer means faster queries
+ * but more memory for edges which span several bands.
+ */
+static constexpr std::size_t EDGES_PER_BAND = 4;
+
+static constexpr std::size_t MAX_BANDS = 4096;
+
+void
+PolygonEdgeIndex::Build(const SearchPointVector &polygon) noexcept
+{
+  Clear();
+
+  if (polygon.size() < MIN_EDGES + 1)
+    return;
+
+  const std::size_t n_edges = polygon.size() - 1;
+
+  double north = south = polygon.front().GetLocation().latitude.Native();
+  for (const auto &i : polygon) {
+    const double latitude = i.GetLocation().latitude.Native();
+    south = std::min(south, latitude);
+    north = std::max(north, latitude);
+  }
+
+  const std::size_t n_bands =
+    std::clamp<std::size_t>(n_edges / EDGES_PER_BAND, 1, MAX_BANDS);
+  scale = north > south ? n_bands / (north - south) : 0;
+
+  /* GetBand() needs the number of bands */
+  offsets.assign(n_bands + 1, 0);
+  first_band.resize(n_edges);
+
+  /* first pass: count the edges of each band */
+
+  std::vector<uint32_t> last_band(n_edges);
+  for (std::size_t i = 0; i < n_edges; ++i) {
+    const Angle a = polygon[i].GetLocation().latitude;
+    const Angle b = polygon[i + 1].GetLocation().latitude;
+    first_band[i] = GetBand(std::min(a, b));
+    last_band[i] = GetBand(std::max(a, b));
+
+    for (unsigned band = first_band[i]; band <= last_band[i]; ++band)
+      ++offsets[band + 1];
+  }
+
+  for (std::size_t band = 0; band < n_bands; ++band)
+    offsets[band + 1] += offsets[band];
+
+  /* second pass: fill the bands */
+
+  edges.resize(offsets.back());
+
+  std::vector<uint32_t> position(offsets.begin(), offsets.end() - 1);
+  for (std::size_t i = 0; i < n_edges; ++i)
+    for (unsigned band = first_band[i]; band <= last_band[i]; ++band)
+      edges[position[band]++] = i;
+
+  assert(position.back() == offsets.back());
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Math/Angle.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+class SearchPointVector;
+
+/**
+ * An index of the edges of a closed polygon (a #SearchPointVector
+ * whose last point equals the first one), sorted into horizontal
+ * latitude bands of equal height.  Each edge is listed in all bands
+ * it touches.  This allows point-in-polygon and ray intersection
+ * tests on large polygons to examine only the edges near the query
+ * instead of the whole border.
+ *
+ * Edges are identified by the index of their first point, i.e. edge
+ * i goes from polygon[i] to polygon[i + 1].  The index refers to
+ * geodetic coordinates only, and therefore does not need to be
+ * rebuilt when the polygon is projected.
+ */
+class PolygonEdgeIndex {
+  /**
+   * The southern edge of the first band [radians].
+   */
+  double south;
+
+  /**
+   * The number of bands per radian.
+   */
+  double scale;
+
+  /**
+   * The position of each band's first entry in #edges, plus one
+   * final element pointing to the end.
+   */
+  std::vector<uint32_t> offsets;
+
+  /**
+   * The edge indices of all bands.
+   */
+  std::vector<uint32_t> edges;
+
+  /**
+   * The first band of each edge.
+   */
+  std::vector<uint32_t> first_band;
+
+public:
+  /**
+   * Polygons with fewer edges are not worth indexing; a linear scan
+   * is faster.
+   */
+  static constexpr std::size_t MIN_EDGES = 32;
+
+  bool IsDefined() const noexcept {
+    return !offsets.empty();
+  }
+
+  void Clear() noexcept {
+    offsets.clear();
+    edges.clear();
+    first_band.clear();
+  }
+
+  /**
+   * Build the index for the given closed polygon.  Polygons with
+   * fewer than #MIN_EDGES edges are not indexed, and IsDefined()
+   * returns false afterwards.
+   */
+  void Build(const SearchPointVector &polygon) noexcept;
+
+  /**
+   * Invoke the function for each edge which may touch the given
+   * latitude.
+   */
+  template<typename F>
+  void VisitEdges(Angle latitude, F &&f) const {
+    const unsigned band = GetBand(latitude);
+    for (unsigned i = offsets[band]; i != offsets[band + 1]; ++i)
+      f(edges[i]);
+  }
+
+  /**
+   * Invoke the function for each edge which may touch the given
+   * latitude range.  Each edge is visited only once.
+   */
+  template<typename F>
+  void VisitEdges(Angle min_latitude, Angle max_latitude, F &&f) const {
+    const unsigned min_band = GetBand(min_latitude);
+    const unsigned max_band = GetBand(max_latitude);
+
+    for (unsigned band = min_band; band <= max_band; ++band) {
+      for (unsigned i = offsets[band]; i != offsets[band + 1]; ++i) {
+        const unsigned edge = edges[i];
+
+        /* visit edges spanning several bands only in the first band
+           of the range */
+        if (band == std::max(first_band[edge], min_band))
+          f(edge);
+      }
+    }
+  }
+
+private:
+  unsigned GetNumberOfBands() const noexcept {
+    return offsets.size() - 1;
+  }
+
+  /**
+   * Determine the band containing the given latitude.  Latitudes
+   * outside of the polygon are clamped to the first or last band.
+   * This function is monotonic, which guarantees that an edge is
+   * listed in the band of each latitude it touches.
+   */
+  [[gnu::pure]]
+  unsigned GetBand(Angle latitude) const noexcept {
+    const double band = (latitude.Native() - south) * scale;
+    if (!(band > 0))
+      return 0;
+
+    const unsigned last = GetNumberOfBands() - 1;
+    if (band >= last)
+      return last;
+
+    return unsigned(band);
+  }
+};
@@ -76,6 +76,7 @@ DerivedInfo::Reset()
   airspace_warnings.Clear();
 
   planned_route.clear();
+  alternate_routes.clear();
 }
 
 void
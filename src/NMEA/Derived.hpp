@@ -23,6 +23,7 @@
 #include "Engine/GlideSolvers/GlidePolar.hpp"
 #include "Atmosphere/Pressure.hpp"
 #include "Engine/Route/Route.hpp"
+#include "Engine/Route/RouteArrival.hpp"
 #include "Computer/WaveResult.hpp"
 
 #include <type_traits>
@@ -229,6 +230,9 @@ struct DerivedInfo:
   /** Route plan for current leg avoiding airspace */
   StaticRoute planned_route;
 
+  /** Arrival at the nearest alternates along routes avoiding obstacles */
+  RouteArrivalList alternate_routes;
+
   /**
    * Thermal value of next leg that is equivalent (gives the same average
    * speed) to the current MacCready setting. A negative value should be
@@ -141,6 +141,7 @@ constexpr std::string_view MenuTimeout = "MenuTimeout";
 constexpr std::string_view TerrainContrast = "TerrainContrast";
 constexpr std::string_view TerrainBrightness = "TerrainBrightness";
 constexpr std::string_view TerrainRamp = "TerrainRamp";
+constexpr std::string_view TerrainThreads = "TerrainThreads";
 constexpr std::string_view EnableFLARMMap = "EnableFLARMDisplay";
 constexpr std::string_view FadeTraffic = "FadeTraffic";
 constexpr std::string_view EnableFLARMGauge = "EnableFLARMGauge";
@@ -32,4 +32,6 @@ Profile::LoadTerrainRendererSettings(const ProfileMap &map,
   uint8_t contours = (uint8_t)settings.contours;
   if (map.Get(ProfileKeys::TerrainContours, contours))
     settings.contours = (Contours)contours;
+
+  map.Get(ProfileKeys::TerrainThreads, settings.threads);
 }
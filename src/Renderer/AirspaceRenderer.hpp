@@ -40,6 +40,13 @@ class AirspaceRenderer
   TransparentRendererCache fill_cache;
 
   Serial last_warning_serial;
+
+  /**
+   * The #Airspaces serials the #fill_cache was drawn with.  QNH and
+   * activity changes modify the fill without changing the set of
+   * airspaces.
+   */
+  Serial last_airspaces_serial, last_levels_serial, last_activity_serial;
 #endif
 
 public:
@@ -224,8 +224,14 @@ AirspaceRenderer::DrawFillCached(Canvas &canvas, Canvas &stencil_canvas,
                                  const AirspacePredicate &visible)
 {
   if (awc.GetSerial() != last_warning_serial ||
+      airspaces->GetSerial() != last_airspaces_serial ||
+      airspaces->GetLevelsSerial() != last_levels_serial ||
+      airspaces->GetActivitySerial() != last_activity_serial ||
       !fill_cache.Check(projection)) {
     last_warning_serial = awc.GetSerial();
+    last_airspaces_serial = airspaces->GetSerial();
+    last_levels_serial = airspaces->GetLevelsSerial();
+    last_activity_serial = airspaces->GetActivitySerial();
 
     Canvas &buffer_canvas = fill_cache.Begin(canvas, projection);
     if (DrawFill(buffer_canvas, stencil_canvas,
@@ -11,8 +11,8 @@
 #include "Engine/Util/Gradient.hpp"
 #include "Engine/Waypoint/Waypoint.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
-#include "Engine/GlideSolvers/GlideState.hpp"
 #include "Engine/GlideSolvers/GlideResult.hpp"
+#include "Engine/GlideSolvers/GlideBatch.hpp"
 #include "Engine/GlideSolvers/MacCready.hpp"
 #include "Engine/Task/TaskManager.hpp"
 #include "Engine/Task/AbstractTask.hpp"
@@ -30,6 +30,7 @@
 #include "Engine/Route/ReachResult.hpp"
 #include "Look/WaypointLook.hpp"
 
+#include <array>
 #include <cassert>
 #include <stdio.h>
 
@@ -60,22 +61,7 @@ struct VisibleWaypoint {
     return ::IsReachable(reachable);
   }
 
-  void CalculateReachabilityDirect(const MoreData &basic,
-                                   const SpeedVector &wind,
-                                   const MacCready &mac_cready,
-                                   const TaskBehaviour &task_behaviour) noexcept {
-    assert(basic.location_available);
-    assert(basic.NavAltitudeAvailable());
-
-    if (!waypoint->has_elevation)
-      return;
-
-    const auto elevation = waypoint->elevation +
-      task_behaviour.safety_height_arrival;
-    const GlideState state(GeoVector(basic.location, waypoint->location),
-                           elevation, basic.nav_altitude, wind);
-
-    const GlideResult result = mac_cready.SolveStraight(state);
+  void SetReachabilityDirect(const GlideResult &result) noexcept {
     if (!result.IsOk())
       return;
 
@@ -419,13 +405,33 @@ public:
       : calculated.glide_polar_safety;
     const MacCready mac_cready(task_behaviour.glide, glide_polar);
 
+    /* solve all candidates at once, which is cheaper than one
+       GlideState per waypoint */
+    GlideBatch batch(basic.nav_altitude, calculated.GetWindOrZero());
+    batch.reserve(waypoints.size());
+    StaticArray<VisibleWaypoint *, 256> targets;
+
     for (VisibleWaypoint &vwp : waypoints) {
       const Waypoint &way_point = *vwp.waypoint;
 
-      if (way_point.IsLandable() || way_point.flags.watched)
-        vwp.CalculateReachabilityDirect(basic, calculated.GetWindOrZero(),
-                                        mac_cready, task_behaviour);
+      if ((way_point.IsLandable() || way_point.flags.watched) &&
+          way_point.has_elevation) {
+        batch.push_back(GeoVector(basic.location, way_point.location),
+                        way_point.elevation +
+                        task_behaviour.safety_height_arrival);
+        targets.push_back(&vwp);
+      }
     }
+
+    if (batch.empty())
+      return;
+
+    std::array<GlideResult, 256> results;
+    mac_cready.SolveStraight(batch,
+                             std::span{results.data(), batch.size()});
+
+    for (std::size_t i = 0; i < targets.size(); ++i)
+      targets[i]->SetReachabilityDirect(results[i]);
   }
 
   void Calculate(const ProtectedRoutePlanner *route_planner,
@@ -374,6 +374,7 @@ Startup(UI::Display &display)
                                      *task_events);
   glide_computer->SetTerrain(data_components->terrain.get());
   glide_computer->SetLogger(logger);
+  glide_computer->SetContestCheckpointPath(LocalPath(_T("contest.ckp")));
   glide_computer->Initialise();
 
   replay = new Replay(logger, *protected_task_manager);
@@ -442,7 +443,7 @@ Startup(UI::Display &display)
   // Reads the airspace files
   {
     SubOperationEnvironment sub_env(operation, 768, 1024);
-    ReadAirspace(*data_components->airspaces,
+    ReadAirspace(*data_components->airspaces, file_cache,
                  computer_settings.pressure,
                  sub_env);
   }
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AlternateRoutePlanner.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "thread/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+inline bool
+AlternateRoutePlanner::Slot::IsDirty(const Destination &d,
+                                     const AGeoPoint &new_origin) const noexcept
+{
+  return !valid || d.id != destination.id ||
+    d.location != destination.location ||
+    d.location.altitude != destination.location.altitude ||
+    std::fabs(new_origin.altitude - origin.altitude) > MAX_MOVE_HEIGHT ||
+    new_origin.DistanceS(origin) > MAX_MOVE_DISTANCE;
+}
+
+inline bool
+AlternateRoutePlanner::Parameters::IsSimilar(const Parameters &other) const noexcept
+{
+  if (config != other.config || mc != other.mc ||
+      best_ld != other.best_ld || v_best_ld != other.v_best_ld)
+    return false;
+
+  const auto [sin_a, cos_a] = wind.bearing.SinCos();
+  const auto [sin_b, cos_b] = other.wind.bearing.SinCos();
+  return std::hypot(wind.norm * sin_a - other.wind.norm * sin_b,
+                    wind.norm * cos_a - other.wind.norm * cos_b)
+    <= MAX_WIND_CHANGE;
+}
+
+void
+AlternateRoutePlanner::SetTerrain(const RasterTerrain *_terrain) noexcept
+{
+  terrain = _terrain;
+
+  for (auto &slot : slots) {
+    slot.planner.SetTerrain(terrain);
+    slot.valid = false;
+  }
+}
+
+void
+AlternateRoutePlanner::Reset() noexcept
+{
+  for (auto &slot : slots) {
+    slot.planner.Reset();
+    slot.valid = false;
+  }
+}
+
+/**
+ * Calculate the length of the route, with its last point (the old
+ * aircraft position) replaced by the given one.
+ */
+[[gnu::pure]]
+static double
+RouteDistance(const Route &route, const GeoPoint &origin) noexcept
+{
+  assert(route.size() >= 2);
+
+  double distance = origin.DistanceS(route[route.size() - 2]);
+  for (std::size_t i = 1; i + 1 < route.size(); ++i)
+    distance += route[i - 1].DistanceS(route[i]);
+  return distance;
+}
+
+void
+AlternateRoutePlanner::Update(const AGeoPoint &origin,
+                              const DestinationList &destinations,
+                              const GlideSettings &settings,
+                              const RoutePlannerConfig &config,
+                              const GlidePolar &polar,
+                              const SpeedVector &wind,
+                              const int h_ceiling,
+                              RouteArrivalList &result) noexcept
+{
+  assert(terrain != nullptr);
+
+  const Parameters new_parameters{
+    config, polar.GetMC(), polar.GetBestLD(), polar.GetVBestLD(), wind,
+  };
+  if (!parameters.IsSimilar(new_parameters)) {
+    for (auto &slot : slots)
+      slot.valid = false;
+    parameters = new_parameters;
+  }
+
+  /* assign a slot to each destination, preferring the one which
+     already has a solution for it */
+
+  const unsigned n = std::min(destinations.size(), slots.size());
+  std::array<Slot *, MAX_DESTINATIONS> assigned{};
+  std::array<bool, MAX_DESTINATIONS> used{};
+
+  for (unsigned i = 0; i < n; ++i) {
+    for (unsigned j = 0; j < slots.size(); ++j) {
+      if (!used[j] && slots[j].valid &&
+          slots[j].destination.id == destinations[i].id) {
+        assigned[i] = &slots[j];
+        used[j] = true;
+        break;
+      }
+    }
+  }
+
+  for (unsigned i = 0, j = 0; i < n; ++i) {
+    if (assigned[i] != nullptr)
+      continue;
+
+    while (used[j])
+      ++j;
+
+    assigned[i] = &slots[j];
+    used[j] = true;
+  }
+
+  /* prepare the slots which need a new solution; this accesses the
+     shared airspace database and is therefore done serially */
+
+  StaticArray<Slot *, MAX_DESTINATIONS> dirty;
+  for (unsigned i = 0; i < n; ++i) {
+    Slot &slot = *assigned[i];
+    const Destination &d = destinations[i];
+
+    slot.planner.UpdatePolar(settings, config, polar, polar, wind, 0);
+
+    if (!slot.IsDirty(d, origin)) {
+      ++statistics.reused;
+      continue;
+    }
+
+    slot.destination = d;
+    slot.origin = origin;
+    slot.valid = true;
+    slot.planner.Synchronise(airspaces, warnings, d.location, origin);
+    dirty.push_back(&slot);
+  }
+
+  /* the searches share the airspace objects, whose clearance is
+     calculated on demand; do that now, after Synchronise() (which
+     may discard clearances) has been called for all slots */
+
+  if (config.IsAirspaceEnabled())
+    for (const Slot *slot : dirty)
+      slot->planner.UpdateClearances();
+
+  /* the expensive part: each search has its own A* state and only
+     reads terrain and airspaces, so they can run concurrently */
+
+  const auto f = [&](unsigned i){
+    Slot &slot = *dirty[i];
+    slot.planner.Solve(slot.destination.location, slot.origin,
+                       config, h_ceiling);
+  };
+
+  if (thread_pool != nullptr)
+    thread_pool->Run(dirty.size(), f);
+  else
+    for (unsigned i = 0; i < dirty.size(); ++i)
+      f(i);
+
+  statistics.solved += dirty.size();
+
+  result.clear();
+  for (unsigned i = 0; i < n; ++i) {
+    const Slot &slot = *assigned[i];
+    const Route &route = slot.planner.GetSolution();
+
+    const int arrival = slot.planner.CalcSolutionArrival(origin);
+    result.push_back({
+        slot.destination.id,
+        RouteDistance(route, origin),
+        arrival - int(slot.destination.location.altitude),
+        route.size() > 2,
+      });
+  }
+}
@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RoutePlannerGlue.hpp"
+#include "Engine/Route/Config.hpp"
+#include "Engine/Route/RouteArrival.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "util/StaticArray.hxx"
+
+#include <array>
+
+struct GlideSettings;
+class GlidePolar;
+class RasterTerrain;
+class Airspaces;
+class ProtectedAirspaceWarningManager;
+class ThreadPool;
+
+/**
+ * Plans routes from the aircraft to several destinations (e.g. the
+ * nearest landable alternates).  Each destination has its own
+ * #RoutePlannerGlue (and therefore its own A* state), which allows
+ * solving them concurrently on a #ThreadPool; terrain and airspaces
+ * are shared read-only (the airspace clearances are calculated
+ * before the concurrent part).
+ *
+ * A route is only planned again when the destination, the aircraft
+ * position or the polar has changed significantly.  In between, the
+ * arrival altitude is calculated along the previous route from the
+ * current aircraft position, which is cheap.
+ *
+ * This class is not thread-safe; it is used only by the calculation
+ * thread.
+ */
+class AlternateRoutePlanner {
+public:
+  static constexpr unsigned MAX_DESTINATIONS = 6;
+
+  struct Destination {
+    /**
+     * Identifies the destination, e.g. the Waypoint::id.
+     */
+    unsigned id;
+
+    /**
+     * The location and the minimum arrival altitude.
+     */
+    AGeoPoint location;
+  };
+
+  using DestinationList = StaticArray<Destination, MAX_DESTINATIONS>;
+
+  /** Counters for diagnostics */
+  struct Statistics {
+    /** Number of routes which were planned */
+    unsigned solved = 0;
+
+    /** Number of routes which were reused */
+    unsigned reused = 0;
+  };
+
+private:
+  /**
+   * Plan the route again after the aircraft has moved this far from
+   * the point where it was planned (m).
+   */
+  static constexpr double MAX_MOVE_DISTANCE = 1000;
+
+  /**
+   * Plan the route again after the aircraft altitude has changed by
+   * this much, because obstacles may have appeared or disappeared
+   * (m).
+   */
+  static constexpr double MAX_MOVE_HEIGHT = 50;
+
+  /**
+   * Plan all routes again after the wind has changed by this much
+   * (m/s).
+   */
+  static constexpr double MAX_WIND_CHANGE = 1;
+
+  const Airspaces &airspaces;
+  const ProtectedAirspaceWarningManager *const warnings;
+
+  const RasterTerrain *terrain = nullptr;
+
+  ThreadPool *thread_pool = nullptr;
+
+  struct Slot {
+    RoutePlannerGlue planner;
+
+    /**
+     * The destination of the current solution.
+     */
+    Destination destination;
+
+    /**
+     * The aircraft position when the current solution was planned.
+     */
+    AGeoPoint origin;
+
+    /**
+     * Does #planner contain a solution for #destination?
+     */
+    bool valid = false;
+
+    /**
+     * Does the solution need to be planned again for the given
+     * aircraft position?
+     */
+    [[gnu::pure]]
+    bool IsDirty(const Destination &d,
+                 const AGeoPoint &new_origin) const noexcept;
+  };
+
+  std::array<Slot, MAX_DESTINATIONS> slots;
+
+  /**
+   * The parameters which were used for the current solutions.
+   */
+  struct Parameters {
+    RoutePlannerConfig config;
+    double mc, best_ld, v_best_ld;
+    SpeedVector wind;
+
+    [[gnu::pure]]
+    bool IsSimilar(const Parameters &other) const noexcept;
+  } parameters{};
+
+  Statistics statistics;
+
+public:
+  AlternateRoutePlanner(const Airspaces &_airspaces,
+                        const ProtectedAirspaceWarningManager *_warnings) noexcept
+    :airspaces(_airspaces), warnings(_warnings) {}
+
+  void SetTerrain(const RasterTerrain *_terrain) noexcept;
+
+  /**
+   * Use the given #ThreadPool for planning routes concurrently
+   * (nullptr disables it).
+   */
+  void SetThreadPool(ThreadPool *_thread_pool) noexcept {
+    thread_pool = _thread_pool;
+  }
+
+  /**
+   * Forget all solutions.  Call this before modifying the airspace
+   * database.
+   */
+  void Reset() noexcept;
+
+  /**
+   * Plan the routes to the given destinations (unless the previous
+   * solutions are still usable) and calculate the arrival at each of
+   * them.  Must not be called without terrain.
+   *
+   * @param origin the aircraft location and altitude
+   * @param destinations the destinations; only the first
+   * #MAX_DESTINATIONS are used
+   * @param h_ceiling imposed absolute ceiling (m)
+   * @param result receives one item per destination
+   */
+  void Update(const AGeoPoint &origin, const DestinationList &destinations,
+              const GlideSettings &settings,
+              const RoutePlannerConfig &config,
+              const GlidePolar &polar, const SpeedVector &wind,
+              int h_ceiling, RouteArrivalList &result) noexcept;
+
+  const Statistics &GetStatistics() const noexcept {
+    return statistics;
+  }
+};
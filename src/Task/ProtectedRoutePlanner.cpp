@@ -43,20 +43,38 @@ ProtectedRoutePlanner::SolveReach(const AGeoPoint &origin,
 {
   /* these local variables help avoid locking both mutexes at the same
      time */
-  ReachFan rt, rw;
+  std::optional<ReachFan> rt, rw;
 
   {
     const std::scoped_lock lock{route_mutex};
-    rt = route_planner.SolveReach(origin, config, h_ceiling, do_solve, false);
-    rw = route_planner.SolveReach(origin, config, h_ceiling, do_solve, true);
+
+    /* this is the only thread which modifies the reach fields,
+       therefore it may read them without locking reach_mutex */
+    rt = route_planner.UpdateReach(reach_terrain, origin, config, h_ceiling,
+                                   do_solve, false);
+    rw = route_planner.UpdateReach(reach_working, origin, config, h_ceiling,
+                                   do_solve, true);
     rpolars_reach = route_planner.GetReachPolar();
   }
 
+  if (!rt && !rw)
+    /* both are still valid */
+    return;
+
   /* we lock this mutex not during the expensive reach calculation,
      but only for moving the result to the mutex-protected fields */
   const std::scoped_lock lock{reach_mutex};
-  reach_terrain = std::move(rt);
-  reach_working = std::move(rw);
+  if (rt)
+    reach_terrain = std::move(*rt);
+  if (rw)
+    reach_working = std::move(*rw);
+}
+
+TerrainRoute::ReachStatistics
+ProtectedRoutePlanner::GetReachStatistics() const noexcept
+{
+  const std::scoped_lock lock{route_mutex};
+  return route_planner.GetReachStatistics();
 }
 
 const FlatProjection
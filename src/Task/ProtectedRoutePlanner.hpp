@@ -74,9 +74,16 @@ public:
                   const RoutePlannerConfig &config,
                   int h_ceiling) noexcept;
 
+  /**
+   * Calculate the reach of the aircraft, unless the previous reach
+   * can still be used (see ReachFan::IsReusable()).
+   */
   void SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
                   int h_ceiling, bool do_solve) noexcept;
 
+  [[gnu::pure]]
+  TerrainRoute::ReachStatistics GetReachStatistics() const noexcept;
+
   [[gnu::pure]]
   const FlatProjection GetTerrainReachProjection() const noexcept;
 
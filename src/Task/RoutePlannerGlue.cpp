@@ -59,6 +59,23 @@ RoutePlannerGlue::SolveReach(const AGeoPoint &origin,
   }
 }
 
+std::optional<ReachFan>
+RoutePlannerGlue::UpdateReach(const ReachFan &previous,
+                              const AGeoPoint &origin,
+                              const RoutePlannerConfig &config,
+                              const int h_ceiling, const bool do_solve,
+                              const bool working) noexcept
+{
+  if (terrain) {
+    RasterTerrain::Lease lease(*terrain);
+    return planner.UpdateReach(previous, origin, config, h_ceiling, do_solve,
+                               working);
+  } else {
+    return planner.UpdateReach(previous, origin, config, h_ceiling, do_solve,
+                               working);
+  }
+}
+
 GeoPoint
 RoutePlannerGlue::Intersection(const AGeoPoint &origin,
                                const AGeoPoint &destination) const
@@ -8,6 +8,7 @@
 struct GlideSettings;
 class RasterTerrain;
 class ProtectedAirspaceWarningManager;
+class ThreadPool;
 
 class RoutePlannerGlue {
   const RasterTerrain *terrain = nullptr;
@@ -16,6 +17,10 @@ class RoutePlannerGlue {
 public:
   void SetTerrain(const RasterTerrain *terrain);
 
+  void SetThreadPool(ThreadPool *thread_pool) noexcept {
+    planner.SetThreadPool(thread_pool);
+  }
+
   void UpdatePolar(const GlideSettings &settings,
                    const RoutePlannerConfig &config,
                    const GlidePolar &polar,
@@ -31,6 +36,10 @@ public:
                    const AGeoPoint &origin,
                    const AGeoPoint &destination);
 
+  void UpdateClearances() const noexcept {
+    planner.UpdateClearances();
+  }
+
   void Reset() {
     planner.Reset();
   }
@@ -44,9 +53,23 @@ public:
   }
 
   [[gnu::pure]]
+  int CalcSolutionArrival(const AGeoPoint &destination) const noexcept {
+    return planner.CalcSolutionArrival(destination);
+  }
+
   ReachFan SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
                       int h_ceiling, bool do_solve, bool working) noexcept;
 
+  std::optional<ReachFan> UpdateReach(const ReachFan &previous,
+                                      const AGeoPoint &origin,
+                                      const RoutePlannerConfig &config,
+                                      int h_ceiling, bool do_solve,
+                                      bool working) noexcept;
+
+  const auto &GetReachStatistics() const noexcept {
+    return planner.GetReachStatistics();
+  }
+
   const auto &GetReachPolar() const noexcept {
     return planner.GetReachPolar();
   }
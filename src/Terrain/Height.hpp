@@ -18,8 +18,15 @@ enum class TerrainType : uint8_t {
 class TerrainHeight {
   /** invalid value for terrain */
   static constexpr int16_t INVALID = -32768;
+
+public:
+  /**
+   * All values up to this one are "special" (see IsSpecial()).  This
+   * is public for vectorised code which cannot use the methods.
+   */
   static constexpr int16_t WATER_THRESHOLD = -30000;
 
+private:
   int16_t value;
 
 public:
@@ -3,14 +3,13 @@
 
 #include "HeightMatrix.hpp"
 #include "RasterMap.hpp"
+#include "thread/ThreadPool.hpp"
 
-#ifdef ENABLE_OPENGL
-#include "Geo/GeoBounds.hpp"
-#else
-#include "Projection/WindowProjection.hpp"
-#endif
-
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
 
 void
 HeightMatrix::SetSize(std::size_t _size) noexcept
@@ -40,41 +39,361 @@ HeightMatrix::SetSize(UnsignedPoint2D _size,
   SetSize((_size + round_up) / quantisation_pixels);
 }
 
+void
+HeightMatrix::Shift(int dx, int dy) noexcept
+{
+  assert(unsigned(std::abs(dx)) < size.x);
+  assert(unsigned(std::abs(dy)) < size.y);
+
+  const unsigned n = size.x - std::abs(dx);
+  const unsigned src_x = std::max(dx, 0), dest_x = std::max(-dx, 0);
+
+  const auto move_row = [&](unsigned y){
+    const TerrainHeight *src = GetRow(y + dy) + src_x;
+    TerrainHeight *dest = GetWritableRow(y) + dest_x;
+
+    /* the source and destination may overlap only if dy==0 */
+    if (dx < 0)
+      std::copy_backward(src, src + n, dest + n);
+    else
+      std::copy(src, src + n, dest);
+  };
+
+  if (dy >= 0) {
+    for (unsigned y = 0, end = size.y - dy; y < end; ++y)
+      move_row(y);
+  } else {
+    for (unsigned y = size.y; y-- > unsigned(-dy);)
+      move_row(y);
+  }
+}
+
+/**
+ * Splitting a scan into smaller bands than this is not worth the
+ * synchronisation overhead.
+ */
+static constexpr unsigned MIN_BAND_ROWS = 8;
+
+template<typename F>
+inline void
+HeightMatrix::ForEachRowBand(unsigned y_begin, unsigned y_end,
+                             F &&f) noexcept
+{
+  assert(y_begin <= y_end);
+
+  const unsigned n_rows = y_end - y_begin;
+  const unsigned n_bands = thread_pool != nullptr
+    ? std::min(thread_pool->GetConcurrency(), n_rows / MIN_BAND_ROWS)
+    : 1;
+
+  if (n_bands <= 1) {
+    f(y_begin, y_end);
+    return;
+  }
+
+  thread_pool->Run(n_bands, [&](unsigned i){
+    f(y_begin + n_rows * i / n_bands,
+      y_begin + n_rows * (i + 1) / n_bands);
+  });
+}
+
+template<typename R, typename C>
+inline void
+HeightMatrix::ScanExposed(int dx, int dy,
+                          R &&scan_rows, C &&scan_columns) noexcept
+{
+  /* complete rows at the top or the bottom */
+
+  unsigned y_begin = 0, y_end = size.y;
+  if (dy > 0) {
+    y_end = size.y - dy;
+    scan_rows(y_end, size.y);
+  } else if (dy < 0) {
+    y_begin = -dy;
+    scan_rows(0, y_begin);
+  }
+
+  statistics.rows += std::abs(dy);
+
+  /* columns at the left or the right of the remaining rows */
+
+  unsigned x_begin = 0, x_end = 0;
+  if (dx > 0) {
+    x_begin = size.x - dx;
+    x_end = size.x;
+  } else if (dx < 0) {
+    x_end = -dx;
+  }
+
+  if (x_begin < x_end && y_begin < y_end) {
+    scan_columns(x_begin, x_end, y_begin, y_end);
+    statistics.columns += x_end - x_begin;
+  }
+}
+
 #ifdef ENABLE_OPENGL
 
+/**
+ * Calculate the line through the centers of the given row.
+ * RasterMap::ScanLine() places the last sample at the end point.
+ */
+static std::pair<GeoPoint, GeoPoint>
+GetRowLine(const GeoBounds &bounds, UnsignedPoint2D size, unsigned y) noexcept
+{
+  const Angle delta_x = bounds.GetWidth() / size.x;
+  const Angle delta_y = bounds.GetHeight() / size.y;
+  const Angle latitude = bounds.GetNorth() - delta_y * y;
+
+  return {
+    GeoPoint(bounds.GetWest(), latitude),
+    GeoPoint(bounds.GetWest() + delta_x * (size.x - 1), latitude),
+  };
+}
+
+void
+HeightMatrix::ScanRows(const RasterMap &map, const GeoBounds &bounds,
+                       unsigned y_begin, unsigned y_end,
+                       bool interpolate) noexcept
+{
+  assert(y_end <= size.y);
+
+  ForEachRowBand(y_begin, y_end, [&](unsigned band_begin, unsigned band_end){
+    for (unsigned y = band_begin; y < band_end; ++y) {
+      const auto [start, end] = GetRowLine(bounds, size, y);
+      map.ScanLine(start, end, GetWritableRow(y), size.x, interpolate);
+    }
+  });
+}
+
+void
+HeightMatrix::ScanColumns(const RasterMap &map, const GeoBounds &bounds,
+                          unsigned x_begin, unsigned x_end,
+                          unsigned y_begin, unsigned y_end,
+                          bool interpolate) noexcept
+{
+  assert(x_end <= size.x);
+  assert(y_end <= size.y);
+
+  for (unsigned y = y_begin; y < y_end; ++y) {
+    const auto [start, end] = GetRowLine(bounds, size, y);
+    map.ScanLineRange(start, end, GetWritableRow(y), size.x,
+                      x_begin, x_end, interpolate);
+  }
+}
+
 void
 HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
                    const UnsignedPoint2D _size, bool interpolate) noexcept
 {
   SetSize(_size);
 
-  const Angle delta_y = bounds.GetHeight() / _size.y;
-  Angle latitude = bounds.GetNorth();
-  for (auto p = data.data(), end = p + _size.Area();
-       p != end; p += _size.x, latitude -= delta_y) {
-    map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
-                 GeoPoint(bounds.GetEast(), latitude),
-                 p, _size.x, interpolate);
+  ScanRows(map, bounds, 0, size.y, interpolate);
+
+  ++statistics.full_scans;
+
+  filled_map = &map;
+  filled_serial = map.GetSerial();
+  filled_interpolate = interpolate;
+  filled_bounds = bounds;
+}
+
+void
+HeightMatrix::Update(const RasterMap &map, GeoBounds &bounds,
+                     const UnsignedPoint2D _size, bool interpolate) noexcept
+{
+  if (filled_map != &map || filled_serial != map.GetSerial() ||
+      filled_interpolate != interpolate || _size != size || size.x < 2 ||
+      !map.GetBounds().IsInside(bounds)) {
+    Fill(map, bounds, _size, interpolate);
+    return;
+  }
+
+  const Angle width = filled_bounds.GetWidth();
+  const Angle height = filled_bounds.GetHeight();
+  const Angle delta_x = width / size.x;
+  const Angle delta_y = height / size.y;
+
+  /* the previous grid can only be reused if the new area has (almost)
+     the same dimensions */
+  if ((bounds.GetWidth() - width).Absolute() * 2 > delta_x ||
+      (bounds.GetHeight() - height).Absolute() * 2 > delta_y) {
+    Fill(map, bounds, _size, interpolate);
+    return;
+  }
+
+  const int dx =
+    (int)std::lround((bounds.GetWest() - filled_bounds.GetWest()) / delta_x);
+  const int dy =
+    (int)std::lround((filled_bounds.GetNorth() - bounds.GetNorth()) / delta_y);
+
+  /* align the new area with the previous grid */
+  const GeoPoint north_west(filled_bounds.GetWest() + delta_x * dx,
+                            filled_bounds.GetNorth() - delta_y * dy);
+  bounds = GeoBounds(north_west,
+                     GeoPoint(north_west.longitude + width,
+                              north_west.latitude - height));
+
+  if (unsigned(std::abs(dx)) >= size.x || unsigned(std::abs(dy)) >= size.y ||
+      !map.GetBounds().IsInside(bounds)) {
+    Fill(map, bounds, _size, interpolate);
+    return;
   }
+
+  Shift(dx, dy);
+  ScanExposed(dx, dy,
+              [&](unsigned y_begin, unsigned y_end){
+                ScanRows(map, bounds, y_begin, y_end, interpolate);
+              },
+              [&](unsigned x_begin, unsigned x_end,
+                  unsigned y_begin, unsigned y_end){
+                ScanColumns(map, bounds, x_begin, x_end, y_begin, y_end,
+                            interpolate);
+              });
+
+  ++statistics.updates;
+
+  filled_bounds = bounds;
 }
 
 #else
 
+/**
+ * Calculate the line through the centers of the given row.
+ * RasterMap::ScanLine() places the last sample at the end point.
+ */
+static std::pair<GeoPoint, GeoPoint>
+GetRowLine(const WindowProjection &projection, unsigned quantisation_pixels,
+           UnsignedPoint2D size, unsigned y) noexcept
+{
+  const int screen_y = y * quantisation_pixels;
+  const int right = (size.x - 1) * quantisation_pixels;
+
+  return {
+    projection.ScreenToGeo({0, screen_y}),
+    projection.ScreenToGeo({right, screen_y}),
+  };
+}
+
+void
+HeightMatrix::ScanRows(const RasterMap &map,
+                       const WindowProjection &projection,
+                       unsigned quantisation_pixels,
+                       unsigned y_begin, unsigned y_end,
+                       bool interpolate) noexcept
+{
+  assert(y_end <= size.y);
+
+  ForEachRowBand(y_begin, y_end, [&](unsigned band_begin, unsigned band_end){
+    for (unsigned y = band_begin; y < band_end; ++y) {
+      const auto [start, end] =
+        GetRowLine(projection, quantisation_pixels, size, y);
+      map.ScanLine(start, end, GetWritableRow(y), size.x, interpolate);
+    }
+  });
+}
+
+void
+HeightMatrix::ScanColumns(const RasterMap &map,
+                          const WindowProjection &projection,
+                          unsigned quantisation_pixels,
+                          unsigned x_begin, unsigned x_end,
+                          unsigned y_begin, unsigned y_end,
+                          bool interpolate) noexcept
+{
+  assert(x_end <= size.x);
+  assert(y_end <= size.y);
+
+  for (unsigned y = y_begin; y < y_end; ++y) {
+    const auto [start, end] =
+      GetRowLine(projection, quantisation_pixels, size, y);
+    map.ScanLineRange(start, end, GetWritableRow(y), size.x,
+                      x_begin, x_end, interpolate);
+  }
+}
+
 void
 HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
                    unsigned quantisation_pixels, bool interpolate) noexcept
+{
+  SetSize((UnsignedPoint2D)projection.GetScreenSize(), quantisation_pixels);
+
+  ScanRows(map, projection, quantisation_pixels, 0, size.y, interpolate);
+
+  ++statistics.full_scans;
+
+  filled_map = &map;
+  filled_serial = map.GetSerial();
+  filled_interpolate = interpolate;
+  filled_projection = projection;
+  filled_quantisation_pixels = quantisation_pixels;
+}
+
+void
+HeightMatrix::Update(const RasterMap &map, const WindowProjection &projection,
+                     unsigned quantisation_pixels, bool interpolate) noexcept
 {
   const auto screen_size = projection.GetScreenSize();
 
-  SetSize((UnsignedPoint2D)screen_size, quantisation_pixels);
+  if (filled_map != &map || filled_serial != map.GetSerial() ||
+      filled_interpolate != interpolate ||
+      quantisation_pixels != filled_quantisation_pixels ||
+      screen_size != filled_projection.GetScreenSize() || size.x < 2 ||
+      projection.GetScale() != filled_projection.GetScale() ||
+      projection.GetScreenAngle() != filled_projection.GetScreenAngle() ||
+      projection.GetScreenOrigin() != filled_projection.GetScreenOrigin() ||
+      !map.GetBounds().IsInside(projection.GetScreenBounds())) {
+    Fill(map, projection, quantisation_pixels, interpolate);
+    return;
+  }
+
+  /* where is the new location in the previous image?  Since
+     GeoToScreen() truncates, look for the nearest cell around its
+     result */
+  const GeoPoint location = projection.GetGeoLocation();
+  const auto origin = filled_projection.GetScreenOrigin();
+  const auto offset = filled_projection.GeoToScreen(location) - origin;
 
-  auto p = data.data();
-  for (unsigned y = 0; y < screen_size.height;
-       y += quantisation_pixels, p += size.x) {
-    map.ScanLine(projection.ScreenToGeo({0, (int)y}),
-                 projection.ScreenToGeo({(int)screen_size.width, (int)y}),
-                 p, size.x, interpolate);
+  const int q = quantisation_pixels;
+  const int rough_dx = (int)std::lround(double(offset.x) / q);
+  const int rough_dy = (int)std::lround(double(offset.y) / q);
+
+  int dx = rough_dx, dy = rough_dy;
+  GeoPoint aligned_location = location;
+  double best_distance = -1;
+  for (int i = rough_dy - 1; i <= rough_dy + 1; ++i) {
+    for (int j = rough_dx - 1; j <= rough_dx + 1; ++j) {
+      const GeoPoint p =
+        filled_projection.ScreenToGeo(origin + PixelPoint{j * q, i * q});
+      const double distance = p.DistanceS(location);
+      if (best_distance < 0 || distance < best_distance) {
+        best_distance = distance;
+        dx = j;
+        dy = i;
+        aligned_location = p;
+      }
+    }
+  }
+
+  if (unsigned(std::abs(dx)) >= size.x || unsigned(std::abs(dy)) >= size.y) {
+    Fill(map, projection, quantisation_pixels, interpolate);
+    return;
   }
+
+  filled_projection.SetGeoLocation(aligned_location);
+
+  Shift(dx, dy);
+  ScanExposed(dx, dy,
+              [&](unsigned y_begin, unsigned y_end){
+                ScanRows(map, filled_projection, quantisation_pixels,
+                         y_begin, y_end, interpolate);
+              },
+              [&](unsigned x_begin, unsigned x_end,
+                  unsigned y_begin, unsigned y_end){
+                ScanColumns(map, filled_projection, quantisation_pixels,
+                            x_begin, x_end, y_begin, y_end, interpolate);
+              });
+
+  ++statistics.updates;
 }
 
 #endif
@@ -6,19 +6,86 @@
 #include "Height.hpp"
 #include "Math/Point2D.hpp"
 #include "util/AllocatedArray.hxx"
-
-class RasterMap;
+#include "util/Serial.hpp"
 
 #ifdef ENABLE_OPENGL
-class GeoBounds;
+#include "Geo/GeoBounds.hpp"
 #else
-class WindowProjection;
+#include "Projection/WindowProjection.hpp"
 #endif
 
+class RasterMap;
+class ThreadPool;
+
 class HeightMatrix {
   AllocatedArray<TerrainHeight> data;
   UnsignedPoint2D size;
 
+public:
+  /**
+   * Counters describing how much work Fill() and Update() have
+   * done.
+   */
+  struct Statistics {
+    /**
+     * The number of complete scans.
+     */
+    unsigned long full_scans = 0;
+
+    /**
+     * The number of Update() calls which have reused the previous
+     * matrix.
+     */
+    unsigned long updates = 0;
+
+    /**
+     * The number of complete rows scanned by those updates.
+     */
+    unsigned long rows = 0;
+
+    /**
+     * The number of columns scanned by those updates (each spanning
+     * all rows which were not scanned completely).
+     */
+    unsigned long columns = 0;
+  };
+
+private:
+  Statistics statistics;
+
+  /**
+   * If set, then large scans are split into bands of rows which are
+   * scanned in parallel.
+   */
+  ThreadPool *thread_pool = nullptr;
+
+  /**
+   * The map which was scanned by the last Fill() / Update() call, or
+   * nullptr if the matrix cannot be reused.
+   */
+  const RasterMap *filled_map = nullptr;
+
+  /**
+   * The RasterMap::GetSerial() value of #filled_map; if it has
+   * changed, new tiles have been loaded and the whole matrix needs
+   * to be scanned again.
+   */
+  Serial filled_serial;
+
+  bool filled_interpolate;
+
+#ifdef ENABLE_OPENGL
+  GeoBounds filled_bounds;
+#else
+  /**
+   * The projection which was scanned.  Its location may differ
+   * slightly from the one passed to Update(), see there.
+   */
+  WindowProjection filled_projection;
+
+  unsigned filled_quantisation_pixels;
+#endif
+
 public:
   HeightMatrix() noexcept = default;
 
@@ -38,14 +105,65 @@ public:
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
             UnsignedPoint2D _size, bool interpolate) noexcept;
+
+  /**
+   * Like Fill(), but if the previous call scanned the same map with
+   * the same size and resolution, shift the existing values and scan
+   * only the newly exposed rows and columns.
+   *
+   * To be able to reuse the existing values, the bounds are moved by
+   * up to half a cell so they align with the previous grid.
+   *
+   * @param bounds the area to be scanned; on return, it contains the
+   * area which was actually scanned
+   */
+  void Update(const RasterMap &map, GeoBounds &bounds,
+              UnsignedPoint2D _size, bool interpolate) noexcept;
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
             unsigned quantisation_pixels, bool interpolate) noexcept;
+
+  /**
+   * Like Fill(), but if the previous call scanned the same map with
+   * the same scale, screen angle and resolution, shift the existing
+   * values and scan only the newly exposed rows and columns.
+   *
+   * To be able to reuse the existing values, the map is scanned at a
+   * location which may be off by up to half a quantisation step.
+   */
+  void Update(const RasterMap &map, const WindowProjection &map_projection,
+              unsigned quantisation_pixels, bool interpolate) noexcept;
 #endif
 
+  /**
+   * Use the given #ThreadPool for scanning (nullptr disables
+   * multi-threading).  The pool must remain valid as long as it is
+   * registered here.  Each row is scanned by one thread, therefore
+   * the result does not depend on the number of threads.
+   */
+  void SetThreadPool(ThreadPool *_thread_pool) noexcept {
+    thread_pool = _thread_pool;
+  }
+
+  /**
+   * Forget the previously scanned area, i.e. let the next Update()
+   * call scan everything.
+   */
+  void Invalidate() noexcept {
+    filled_map = nullptr;
+  }
+
+  const Statistics &GetStatistics() const noexcept {
+    return statistics;
+  }
+
+  void ResetStatistics() noexcept {
+    statistics = {};
+  }
+
   UnsignedPoint2D GetSize() const noexcept {
     return size;
   }
@@ -61,4 +179,61 @@ public:
   const TerrainHeight *GetDataEnd() const noexcept {
     return GetRow(size.y);
   }
+
+private:
+  TerrainHeight *GetWritableRow(unsigned y) noexcept {
+    return data.data() + y * size.x;
+  }
+
+  /**
+   * Move all values by the given number of cells, i.e. the new cell
+   * (x,y) gets the value of the old cell (x+dx,y+dy).  Cells which
+   * have no source are left undefined.
+   */
+  void Shift(int dx, int dy) noexcept;
+
+  /**
+   * Invoke f(y_begin, y_end) for bands of the given rows, on the
+   * #thread_pool if there are enough rows.
+   */
+  template<typename F>
+  void ForEachRowBand(unsigned y_begin, unsigned y_end, F &&f) noexcept;
+
+  /**
+   * After Shift(), scan the rows and columns which have become
+   * undefined.
+   */
+  template<typename R, typename C>
+  void ScanExposed(int dx, int dy,
+                   R &&scan_rows, C &&scan_columns) noexcept;
+
+#ifdef ENABLE_OPENGL
+  /**
+   * Scan the rows [y_begin, y_end) with RasterMap::ScanLine().
+   */
+  void ScanRows(const RasterMap &map, const GeoBounds &bounds,
+                unsigned y_begin, unsigned y_end,
+                bool interpolate) noexcept;
+
+  /**
+   * Scan the columns [x_begin, x_end) of the rows [y_begin, y_end)
+   * with RasterMap::ScanLineRange(), which yields the same values as
+   * a scan of the whole row.
+   */
+  void ScanColumns(const RasterMap &map, const GeoBounds &bounds,
+                   unsigned x_begin, unsigned x_end,
+                   unsigned y_begin, unsigned y_end,
+                   bool interpolate) noexcept;
+#else
+  void ScanRows(const RasterMap &map, const WindowProjection &projection,
+                unsigned quantisation_pixels,
+                unsigned y_begin, unsigned y_end,
+                bool interpolate) noexcept;
+
+  void ScanColumns(const RasterMap &map, const WindowProjection &projection,
+                   unsigned quantisation_pixels,
+                   unsigned x_begin, unsigned x_end,
+                   unsigned y_begin, unsigned y_end,
+                   bool interpolate) noexcept;
+#endif
 };
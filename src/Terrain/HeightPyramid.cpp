@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "HeightPyramid.hpp"
+#include "RasterBuffer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+static constexpr int16_t
+ToMaximum(TerrainHeight h, int16_t invalid) noexcept
+{
+  return h.IsInvalid() ? invalid : h.GetValueOr0();
+}
+
+/**
+ * Determine the size of the first level for a buffer of the given
+ * size.
+ */
+static constexpr RasterLocation
+FirstLevelSize(RasterLocation size, unsigned min_level) noexcept
+{
+  const unsigned block = 1u << min_level;
+  return {(size.x + block - 1) >> min_level, (size.y + block - 1) >> min_level};
+}
+
+static constexpr RasterLocation
+NextLevelSize(RasterLocation size) noexcept
+{
+  return {(size.x + 1) / 2, (size.y + 1) / 2};
+}
+
+/**
+ * Calculate the next level, i.e. the maximum of each 2x2 block.
+ */
+static void
+Reduce(const int16_t *src, RasterLocation src_size, int16_t *dest) noexcept
+{
+  const auto size = NextLevelSize(src_size);
+
+  for (unsigned y = 0; y < size.y; ++y) {
+    const unsigned y0 = y * 2, y1 = std::min(y0 + 1, src_size.y - 1);
+    const int16_t *row0 = src + y0 * src_size.x;
+    const int16_t *row1 = src + y1 * src_size.x;
+
+    for (unsigned x = 0; x < size.x; ++x) {
+      const unsigned x0 = x * 2, x1 = std::min(x0 + 1, src_size.x - 1);
+
+      *dest++ = std::max({row0[x0], row0[x1], row1[x0], row1[x1]});
+    }
+  }
+}
+
+std::size_t
+HeightPyramid::GetCellCount(RasterLocation size) noexcept
+{
+  if (size.x == 0 || size.y == 0)
+    return 0;
+
+  size = FirstLevelSize(size, MIN_LEVEL);
+  std::size_t n = size.Area();
+
+  while (size.x > 1 || size.y > 1) {
+    size = NextLevelSize(size);
+    n += size.Area();
+  }
+
+  return n;
+}
+
+void
+HeightPyramid::Generate(const TerrainHeight *src, RasterLocation size,
+                        int16_t *dest) noexcept
+{
+  if (size.x == 0 || size.y == 0)
+    return;
+
+  auto level_size = FirstLevelSize(size, MIN_LEVEL);
+  std::fill_n(dest, level_size.Area(), INT16_MIN);
+
+  for (unsigned y = 0; y < size.y; ++y, src += size.x) {
+    int16_t *row = dest + (y >> MIN_LEVEL) * level_size.x;
+
+    for (unsigned x = 0; x < size.x; ++x) {
+      int16_t &cell = row[x >> MIN_LEVEL];
+      cell = std::max(cell, ToMaximum(src[x], INVALID));
+    }
+  }
+
+  while (level_size.x > 1 || level_size.y > 1) {
+    int16_t *next = dest + level_size.Area();
+    Reduce(dest, level_size, next);
+    dest = next;
+    level_size = NextLevelSize(level_size);
+  }
+}
+
+inline void
+HeightPyramid::SetLevels(const int16_t *cells, RasterLocation size) noexcept
+{
+  levels.clear();
+
+  if (size.x == 0 || size.y == 0)
+    return;
+
+  size = FirstLevelSize(size, MIN_LEVEL);
+  levels.push_back({cells, size.x, size.y});
+
+  while (size.x > 1 || size.y > 1) {
+    cells += size.Area();
+    size = NextLevelSize(size);
+    levels.push_back({cells, size.x, size.y});
+  }
+}
+
+void
+HeightPyramid::Build(const RasterBuffer &buffer) noexcept
+{
+  Reset();
+
+  if (!buffer.IsDefined())
+    return;
+
+  const auto size = buffer.GetSize();
+  storage.ResizeDiscard(GetCellCount(size));
+  Generate(buffer.GetData(), size, storage.data());
+  SetLevels(storage.data(), size);
+}
+
+void
+HeightPyramid::SetExternal(const int16_t *cells,
+                           RasterLocation size) noexcept
+{
+  storage = nullptr;
+  SetLevels(cells, size);
+}
+
+std::optional<int>
+HeightPyramid::GetMaximum(RasterLocation min,
+                          RasterLocation max) const noexcept
+{
+  assert(min.x <= max.x);
+  assert(min.y <= max.y);
+
+  if (levels.empty())
+    return std::nullopt;
+
+  /* the smallest level where the rectangle covers at most 2x2
+     cells: above the highest bit in which "min" and "max" differ,
+     they are equal, and in this bit, "max" has a 1 and "min" a 0 */
+  const unsigned diff = (min.x ^ max.x) | (min.y ^ max.y);
+  const unsigned bits = std::max<unsigned>(std::bit_width(diff), 1) - 1;
+  const unsigned level = std::min<std::size_t>(std::max(bits, MIN_LEVEL) - MIN_LEVEL,
+                                               levels.size() - 1);
+  const unsigned shift = MIN_LEVEL + level;
+
+  const auto &grid = levels[level];
+  const unsigned x0 = std::min(min.x >> shift, grid.width - 1);
+  const unsigned x1 = std::min(max.x >> shift, grid.width - 1);
+  const unsigned y0 = std::min(min.y >> shift, grid.height - 1);
+  const unsigned y1 = std::min(max.y >> shift, grid.height - 1);
+
+  int16_t result = INT16_MIN;
+  for (unsigned y = y0; y <= y1; ++y)
+    for (unsigned x = x0; x <= x1; ++x)
+      result = std::max(result, grid.Get(x, y));
+
+  if (result == INVALID)
+    return std::nullopt;
+
+  return result;
+}
@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RasterLocation.hpp"
+#include "util/AllocatedArray.hxx"
+#include "util/StaticArray.hxx"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+class RasterBuffer;
+class TerrainHeight;
+
+/**
+ * A pyramid of maximum heights over a #RasterBuffer.  The first level
+ * stores the maximum of each block of 2^#MIN_LEVEL by 2^#MIN_LEVEL
+ * pixels, and each following level the maximum of 2x2 cells of the
+ * previous one, up to a level with just one cell.
+ *
+ * This allows RasterTileCache::FirstIntersection() and
+ * RasterTileCache::GroundIntersection() to skip whole areas which
+ * are known to be below the glide path.  Heights are those returned
+ * by TerrainHeight::GetValueOr0().
+ *
+ * All levels are stored in one array of cells (see GetCellCount()),
+ * which is either owned by this object (Build()) or refers to
+ * pre-calculated data (SetExternal(), e.g. from a #RawTileStore).
+ */
+class HeightPyramid {
+  /**
+   * The size of the smallest cells (as a power of two).  Smaller
+   * cells would be more precise, but cost more memory: with 4x4
+   * pixels, the pyramid needs 1/15 of the size of the buffer.
+   */
+  static constexpr unsigned MIN_LEVEL = 2;
+
+  /**
+   * The value of a cell which contains an invalid height.
+   */
+  static constexpr int16_t INVALID = INT16_MAX;
+
+  struct Level {
+    const int16_t *cells;
+    unsigned width, height;
+
+    constexpr int16_t Get(unsigned x, unsigned y) const noexcept {
+      return cells[y * width + x];
+    }
+  };
+
+  /**
+   * The cells of all levels, unless they are external.
+   */
+  AllocatedArray<int16_t> storage;
+
+  StaticArray<Level, 32> levels;
+
+  void SetLevels(const int16_t *cells, RasterLocation size) noexcept;
+
+public:
+  HeightPyramid() noexcept = default;
+
+  HeightPyramid(HeightPyramid &&src) noexcept
+    :storage(std::move(src.storage)), levels(src.levels) {
+    src.levels.clear();
+  }
+
+  HeightPyramid &operator=(HeightPyramid &&src) noexcept {
+    storage = std::move(src.storage);
+    levels = src.levels;
+    src.Reset();
+    return *this;
+  }
+
+  bool IsDefined() const noexcept {
+    return !levels.empty();
+  }
+
+  void Reset() noexcept {
+    levels.clear();
+    storage = nullptr;
+  }
+
+  /**
+   * Determine the number of cells of a pyramid for a buffer of the
+   * given size.
+   */
+  [[gnu::const]]
+  static std::size_t GetCellCount(RasterLocation size) noexcept;
+
+  /**
+   * Calculate the cells of a pyramid.
+   *
+   * @param src the heights, row by row, without padding
+   * @param dest an array of GetCellCount() cells
+   */
+  static void Generate(const TerrainHeight *src, RasterLocation size,
+                       int16_t *dest) noexcept;
+
+  /**
+   * Build the pyramid for the contents of the given buffer.  This
+   * must be called again after the buffer has been modified.
+   */
+  void Build(const RasterBuffer &buffer) noexcept;
+
+  /**
+   * Refer to cells which were calculated by Generate().  The memory
+   * must remain valid until Reset() is called.
+   */
+  void SetExternal(const int16_t *cells, RasterLocation size) noexcept;
+
+  /**
+   * Determine an upper bound for the heights within the given
+   * rectangle (inclusive).  It is at most a few cells larger than
+   * the rectangle, so the result may be larger than the real
+   * maximum, but never smaller.
+   *
+   * @return the maximum height, or std::nullopt if the pyramid is
+   * not defined or if there is an invalid height nearby
+   */
+  [[gnu::pure]]
+  std::optional<int> GetMaximum(RasterLocation min,
+                                RasterLocation max) const noexcept;
+};
@@ -6,12 +6,260 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <climits>
+#include <cstdint>
 
 //#define DEBUG_TILE
 #ifdef DEBUG_TILE
 #include <stdio.h>
 #endif
 
+/**
+ * Closed-form evaluation of the line algorithm used by
+ * FirstIntersection() and GroundIntersection(): in each iteration,
+ * the position advances by one pixel on the major axis, and after n
+ * iterations, it has advanced by (2*n*minor + major - 1) / (2*major)
+ * pixels on the minor axis.  This allows jumping directly to a
+ * distant sample instead of walking pixel by pixel.
+ */
+class RasterTileCache::LineSteps {
+  SignedRasterLocation origin;
+  int dx, dy, sx, sy;
+  int major, minor;
+
+public:
+  constexpr LineSteps(SignedRasterLocation _origin,
+                      int _dx, int _dy, int _sx, int _sy) noexcept
+    :origin(_origin), dx(_dx), dy(_dy), sx(_sx), sy(_sy),
+     major(std::max(dx, dy)), minor(std::min(dx, dy)) {}
+
+  /**
+   * Returns the number of iterations which lead to the given
+   * location.
+   */
+  constexpr int GetIteration(SignedRasterLocation p) const noexcept {
+    return dx >= dy ? abs(p.x - origin.x) : abs(p.y - origin.y);
+  }
+
+  /**
+   * Returns the number of steps on the minor axis after the given
+   * number of iterations.
+   */
+  constexpr int GetMinor(int n) const noexcept {
+    assert(major > 0);
+
+    return int((2 * int64_t(n) * minor + major - 1) / (2 * major));
+  }
+
+  constexpr int GetTotalSteps(int n) const noexcept {
+    return n + GetMinor(n);
+  }
+
+  constexpr SignedRasterLocation GetLocation(int n) const noexcept {
+    const int m = GetMinor(n);
+    return dx >= dy
+      ? SignedRasterLocation(origin.x + sx * n, origin.y + sy * m)
+      : SignedRasterLocation(origin.x + sx * m, origin.y + sy * n);
+  }
+
+  /**
+   * Returns the first iteration with at least the given total number
+   * of steps.
+   */
+  constexpr int FindIteration(int total_steps) const noexcept {
+    if (total_steps <= 0)
+      return 0;
+
+    int n = int(int64_t(total_steps) * major / (major + minor));
+    while (GetTotalSteps(n) < total_steps)
+      ++n;
+    while (n > 0 && GetTotalSteps(n - 1) >= total_steps)
+      --n;
+    return n;
+  }
+
+  /**
+   * Returns the last iteration whose location is inside the given
+   * rectangle (inclusive), assuming the given one is.
+   */
+  constexpr int FindLastInside(RasterLocation min,
+                               RasterLocation max) const noexcept {
+    const int to_x = sx > 0 ? (int)max.x - origin.x : origin.x - (int)min.x;
+    const int to_y = sy > 0 ? (int)max.y - origin.y : origin.y - (int)min.y;
+    const int to_major = dx >= dy ? to_x : to_y;
+    const int to_minor = dx >= dy ? to_y : to_x;
+
+    if (minor == 0)
+      return to_major;
+
+    /* the last iteration where GetMinor() does not exceed the
+       distance to the edge */
+    const int64_t n_minor =
+      (2 * int64_t(major) * (to_minor + 1) - major) / (2 * minor);
+    return (int)std::min<int64_t>(to_major, n_minor);
+  }
+
+  /**
+   * Advance by one iteration, exactly like the loops in
+   * FirstIntersection() and GroundIntersection().
+   */
+  template<typename L>
+  void Step(L &location, int &err, int &total_steps,
+            unsigned &step_counter) const noexcept {
+    const int e2 = 2*err;
+    if (e2 > -dy) {
+      err -= dy;
+      location.x += sx;
+      if (step_counter)
+        step_counter--;
+      total_steps++;
+    }
+    if (e2 < dx) {
+      err += dx;
+      location.y += sy;
+      if (step_counter)
+        step_counter--;
+      total_steps++;
+    }
+  }
+
+  /**
+   * Set the state of the line algorithm to the given (later)
+   * iteration.  The step counter is decremented like the line
+   * algorithm would do it.
+   */
+  template<typename L>
+  void MoveTo(int n, L &location, int &err, int &total_steps,
+              unsigned &step_counter) const noexcept {
+    const int m = GetMinor(n);
+    const int new_total_steps = n + m;
+    assert(new_total_steps >= total_steps);
+
+    const unsigned delta = new_total_steps - total_steps;
+    step_counter = step_counter > delta ? step_counter - delta : 0;
+
+    const int64_t steps_x = dx >= dy ? n : m;
+    const int64_t steps_y = dx >= dy ? m : n;
+    location = L(SignedRasterLocation(origin.x + sx * (int)steps_x,
+                                      origin.y + sy * (int)steps_y));
+    err = int(dx - dy - steps_x * dy + steps_y * dx);
+    total_steps = new_total_steps;
+  }
+
+  /**
+   * Returns the last iteration before the next sample, given the
+   * total number of steps so far and the remaining steps to the next
+   * sample, but not more than the given limit.
+   */
+  constexpr int FindLastBeforeSample(int total_steps, unsigned step,
+                                     int limit) const noexcept {
+    return std::min(FindIteration(total_steps + step) - 1, limit);
+  }
+};
+
+/**
+ * Jump directly to the next sample only if it is at least this many
+ * steps away; for shorter distances, walking is cheaper.
+ */
+static constexpr unsigned MIN_JUMP_STEPS = 32;
+
+/**
+ * The maximum number of iterations to be skipped at a time by
+ * SkipClearSamples().
+ */
+static constexpr unsigned MAX_SKIP_SPAN = 1024;
+
+std::optional<int>
+RasterTileCache::GetMaximumHeight(RasterLocation min,
+                                  RasterLocation max) const noexcept
+{
+  assert(max.x < size.x);
+  assert(max.y < size.y);
+
+  const RasterTile &tile = tiles.Get(min.x / tile_size.x, min.y / tile_size.y);
+  if (tile.IsLoaded())
+    return tile.GetMaximumHeight(min, max);
+
+  /* same as the overview lookup in GetFieldDirect() */
+  const auto overview_size = overview.GetSize();
+  min = min >> RasterTraits::OVERVIEW_BITS;
+  max = max >> RasterTraits::OVERVIEW_BITS;
+  return overview_pyramid.GetMaximum({std::min(min.x, overview_size.x - 1),
+                                      std::min(min.y, overview_size.y - 1)},
+                                     {std::min(max.x, overview_size.x - 1),
+                                      std::min(max.y, overview_size.y - 1)});
+}
+
+template<typename L, typename F>
+bool
+RasterTileCache::SkipClearSamples(const LineSteps &line, L &location,
+                                  int &err, int &total_steps,
+                                  unsigned &step_counter,
+                                  const unsigned step, const int limit,
+                                  unsigned &span,
+                                  RasterLocation &last_location,
+                                  int &last_steps,
+                                  F &&clear) const noexcept
+{
+  if (span < 2 * step) {
+    /* the terrain was close recently; try again after a few
+       samples */
+    span += step / 2 + 1;
+    return false;
+  }
+
+  /* all samples must be in the same tile, because they need to have
+     the same distance (fine or coarse) */
+  const RasterLocation p = SignedRasterLocation(location);
+  const RasterLocation tile_min{
+    p.x / tile_size.x * tile_size.x,
+    p.y / tile_size.y * tile_size.y,
+  };
+  const RasterLocation tile_max{
+    std::min(tile_min.x + tile_size.x, size.x) - 1,
+    std::min(tile_min.y + tile_size.y, size.y) - 1,
+  };
+
+  int n = line.GetIteration(p);
+  const int n_end = std::min({n + (int)span,
+                              line.FindLastInside(tile_min, tile_max),
+                              limit});
+  if (n_end - n < int(2 * step))
+    /* too close to the edge of the tile or to the end of the line */
+    return false;
+
+  /* the rectangle spanned by the two ends contains all locations in
+     between */
+  const SignedRasterLocation end = line.GetLocation(n_end);
+  const auto h_max =
+    GetMaximumHeight(RasterLocation(std::min<int>(p.x, end.x),
+                                    std::min<int>(p.y, end.y)),
+                     RasterLocation(std::max<int>(p.x, end.x),
+                                    std::max<int>(p.y, end.y)));
+  if (!h_max || !clear(total_steps, line.GetTotalSteps(n_end), *h_max)) {
+    span /= 4;
+    return false;
+  }
+
+  span = std::min(span * 2, MAX_SKIP_SPAN);
+
+  /* walk without looking up the terrain */
+  bool found = false;
+  do {
+    line.Step(location, err, total_steps, step_counter);
+    ++n;
+
+    if (!step_counter) {
+      last_location = location;
+      last_steps = total_steps;
+      step_counter = step;
+      found = true;
+    }
+  } while (n < n_end);
+
+  return found;
+}
+
 std::optional<RasterTileCache::Intersection>
 RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
                                    const SignedRasterLocation destination,
@@ -84,6 +332,21 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   RasterLocation last_clear_location = location;
   int last_clear_h = h_origin;
 
+  const bool fast = fast_intersection && max_steps > 0;
+  const LineSteps line(origin, dx, dy, sx, sy);
+
+  // the iteration which reaches the destination
+  const int end_iteration = std::max(dx, dy);
+
+  // the number of iterations to be skipped by SkipClearSamples()
+  unsigned skip_span = MAX_SKIP_SPAN;
+
+  // aircraft height after the given number of steps (without jumps)
+  const auto GetGlideHeight = [&](int steps){
+    const int h = ((steps * slope_fact) >> RASTER_SLOPE_FACT) + h_origin;
+    return can_climb ? std::min(h, h_dest) : h;
+  };
+
   while (true) {
 
     if (!step_counter) {
@@ -159,6 +422,38 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
           last_clear_h = h_int;
         }
       }
+
+      if (fast) {
+        if (!intersect_counter) {
+          /* skip the following samples if the terrain is known to be
+             below them */
+          RasterLocation last_location;
+          int last_steps;
+          if (SkipClearSamples(line, location, err, total_steps,
+                               step_counter, step_counter,
+                               end_iteration - 1, skip_span,
+                               last_location, last_steps,
+                               [&](int first, int last, int h_max){
+                                 const int h_first = GetGlideHeight(first);
+                                 const int h_last = GetGlideHeight(last);
+                                 return h_max + h_safety <= std::min(h_first, h_last) &&
+                                   std::max(h_first, h_last) <= h_ceiling;
+                               })) {
+            last_clear_location = last_location;
+            last_clear_h = GetGlideHeight(last_steps);
+          }
+        }
+
+        if (step_counter >= MIN_JUMP_STEPS)
+          /* jump to the last iteration before the next sample; don't
+             jump over the destination, where the loop ends unless
+             we're intersecting */
+          line.MoveTo(line.FindLastBeforeSample(total_steps, step_counter,
+                                                intersect_counter
+                                                ? INT_MAX
+                                                : end_iteration),
+                      location, err, total_steps, step_counter);
+      }
     }
 
     if (!intersect_counter && (total_steps == max_steps)) {
@@ -267,6 +562,20 @@ RasterTileCache::GroundIntersection(const SignedRasterLocation origin,
   RasterLocation last_clear_location = location;
   int last_clear_h = h_origin;
 
+  const bool fast = fast_intersection && max_steps > 0;
+  const LineSteps line(origin, dx, dy, sx, sy);
+
+  // the first iteration beyond the destination, where the loop ends
+  const int end_iteration = std::max(dx, dy) + 1;
+
+  // the number of iterations to be skipped by SkipClearSamples()
+  unsigned skip_span = MAX_SKIP_SPAN;
+
+  // aircraft height after the given number of steps
+  const auto GetGlideHeight = [&](int steps){
+    return h_origin - ((steps * slope_fact) >> RASTER_SLOPE_FACT);
+  };
+
   while (true) {
 
     if (!step_counter) {
@@ -301,6 +610,33 @@ RasterTileCache::GroundIntersection(const SignedRasterLocation origin,
 
       last_clear_location = location;
       last_clear_h = h_int;
+
+      if (fast && total_steps <= max_steps) {
+        /* skip the following samples if the terrain is known to be
+           below them */
+        RasterLocation last_location;
+        int last_steps;
+        if (SkipClearSamples(line, location, err, total_steps,
+                             step_counter, step_counter,
+                             end_iteration - 1, skip_span,
+                             last_location, last_steps,
+                             [&](int first, int last, int h_max){
+                               const int h_min = std::min(GetGlideHeight(first),
+                                                          GetGlideHeight(last));
+                               return h_min >= std::max(h_max, height_floor) &&
+                                 h_min > 0;
+                             })) {
+          last_clear_location = last_location;
+          last_clear_h = GetGlideHeight(last_steps);
+        }
+
+        if (step_counter >= MIN_JUMP_STEPS)
+          /* jump to the last iteration before the next sample; don't
+             jump over the end of the loop */
+          line.MoveTo(line.FindLastBeforeSample(total_steps, step_counter,
+                                                end_iteration),
+                      location, err, total_steps, step_counter);
+      }
     }
 
     if (total_steps > max_steps)
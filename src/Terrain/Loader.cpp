@@ -4,10 +4,12 @@
 #include "Loader.hpp"
 #include "RasterTileCache.hpp"
 #include "RasterProjection.hpp"
+#include "RawTileStore.hpp"
 #include "ZzipStream.hpp"
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "system/ConvertPathName.hpp"
+#include "thread/ThreadPool.hpp"
 #include "util/ScopeExit.hxx"
 
 extern "C" {
@@ -16,8 +18,24 @@ extern "C" {
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <vector>
+
 #include <string.h>
 
+inline bool
+TerrainLoader::IsWanted(unsigned tile) const noexcept
+{
+  if (!raster_tile_cache.tiles.GetLinear(tile).IsRequested())
+    return false;
+
+  return assigned_tiles.empty() ||
+    std::binary_search(assigned_tiles.begin(), assigned_tiles.end(),
+                       tile);
+}
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
@@ -40,8 +58,7 @@ TerrainLoader::SkipMarkerSegment(long file_offset) const
     return 0;
 
   long skip_to = segment->file_offset;
-  while (segment->IsTileSegment() &&
-         !raster_tile_cache.tiles.GetLinear(segment->tile).IsRequested()) {
+  while (segment->IsTileSegment() && !IsWanted(segment->tile)) {
     ++segment;
     if (segment >= raster_tile_cache.segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -150,6 +167,9 @@ TerrainLoader::SetSize(unsigned _width, unsigned _height,
   if (scan_overview)
     raster_tile_cache.SetSize({_width, _height}, {_tile_width, _tile_height},
                               {tile_columns, tile_rows});
+
+  if (raw_writer != nullptr)
+    raw_writer->SetSize({_width, _height}, {tile_columns, tile_rows});
 }
 
 void
@@ -160,9 +180,22 @@ TerrainLoader::PutTileData(unsigned index,
   if (scan_overview)
     raster_tile_cache.PutOverviewTile(index, start, end, m);
 
-  if (scan_tiles) {
+  if (raw_writer != nullptr)
+    raw_writer->PutTile(index, start, end, m);
+
+  if (scan_tiles && IsWanted(index)) {
+    /* convert outside of the lock, which is then held only for
+       installing the new buffer */
+    auto buffer = raster_tile_cache.ConvertTileData(index, m);
+    if (!buffer.IsDefined())
+      return;
+
+    HeightPyramid pyramid;
+    pyramid.Build(buffer);
+
     const std::lock_guard lock{mutex};
-    raster_tile_cache.PutTileData(index, m);
+    raster_tile_cache.PutTileData(index, std::move(buffer),
+                                  std::move(pyramid));
   }
 }
 
@@ -213,7 +246,10 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   /* allow really large maps, but specify a reasonable limit */
   opts.max_samples = size_t(1) << 31;
 
-  jpc_initluts();
+  /* the lookup tables are global; initialise them only once,
+     because several threads may be decoding at the same time */
+  static std::once_flag luts_initialised;
+  std::call_once(luts_initialised, jpc_initluts);
 
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
@@ -227,7 +263,7 @@ LoadJPG2000(jas_stream_t *in, void *loader)
     throw std::runtime_error("jpc_dec_decode() failed");
 }
 
-inline void
+void
 TerrainLoader::LoadJPG2000(struct zzip_dir *dir, const char *path)
 {
   const auto in = OpenJasperZzipStream(dir, path);
@@ -269,6 +305,8 @@ TerrainLoader::LoadOverview(struct zzip_dir *dir,
       /* that failed: without bounds, we can't do anything; give up,
          discard the whole file */
       throw std::runtime_error("No bounds found");
+
+    raster_tile_cache.FinishOverview();
   } catch (...) {
     raster_tile_cache.Reset();
     throw;
@@ -289,12 +327,77 @@ LoadTerrainOverview(struct zzip_dir *dir,
   loader.LoadOverview(dir, path, world_file);
 }
 
+void
+ConvertTerrainTiles(struct zzip_dir *dir,
+                    RasterTileCache &raster_tile_cache,
+                    RawTileWriter &writer,
+                    OperationEnvironment &env)
+{
+  SharedMutex mutex;
+
+  /* the overview scan decodes all tiles at full resolution, which is
+     exactly what we need */
+  TerrainLoader loader(mutex, raster_tile_cache, true, false, env);
+  loader.SetRawTileWriter(writer);
+  loader.LoadOverview(dir, "terrain.jp2", "terrain.j2w");
+  writer.Finish();
+}
+
+inline bool
+TerrainLoader::PollTiles(SignedRasterLocation p, unsigned radius) noexcept
+{
+  assert(!scan_overview);
+
+  /* this write lock is necessary because
+     RasterTileCache::PollTiles() calls RasterTile::Unload() */
+  const std::lock_guard lock{mutex};
+
+  return raster_tile_cache.PollTiles(p, radius);
+}
+
 inline void
-TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
-                           SignedRasterLocation p, unsigned radius)
+TerrainLoader::LoadRequestedTiles(struct zzip_dir *dir, const char *path)
 {
   assert(!scan_overview);
 
+  AtScopeExit(this) { raster_tile_cache.FinishTileUpdate(); };
+  LoadJPG2000(dir, path);
+}
+
+void
+UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   SignedRasterLocation p, unsigned radius)
+{
+  if (!raster_tile_cache.IsValid())
+    return;
+
+  NullOperationEnvironment env;
+  TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
+  if (loader.PollTiles(p, radius))
+    loader.LoadRequestedTiles(dir, path);
+}
+
+void
+LoadRequestedTerrainTiles(struct zzip_dir *dir, const char *path,
+                          RasterTileCache &raster_tile_cache,
+                          SharedMutex &mutex)
+{
+  NullOperationEnvironment env;
+  TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
+  loader.LoadRequestedTiles(dir, path);
+}
+
+void
+UpdateTerrainTiles(ThreadPool &pool, std::span<struct zzip_dir *const> dirs,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   SignedRasterLocation p, unsigned radius)
+{
+  assert(!dirs.empty());
+
+  if (!raster_tile_cache.IsValid())
+    return;
+
   {
     /* this write lock is necessary because
        RasterTileCache::PollTiles() calls RasterTile::Unload() */
@@ -305,21 +408,64 @@ TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
       return;
   }
 
-  AtScopeExit(this) { raster_tile_cache.FinishTileUpdate(); };
-  LoadJPG2000(dir, path);
+  LoadRequestedTerrainTiles(pool, dirs, raster_tile_cache, mutex);
 }
 
 void
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
-                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   SignedRasterLocation p, unsigned radius)
+LoadRequestedTerrainTiles(ThreadPool &pool,
+                          std::span<struct zzip_dir *const> dirs,
+                          RasterTileCache &raster_tile_cache,
+                          SharedMutex &mutex)
 {
-  if (!raster_tile_cache.IsValid())
+  assert(!dirs.empty());
+
+  AtScopeExit(&raster_tile_cache) { raster_tile_cache.FinishTileUpdate(); };
+
+  const auto requested = raster_tile_cache.GetRequestedTiles();
+  if (requested.empty())
     return;
 
-  NullOperationEnvironment env;
-  TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
-  loader.UpdateTiles(dir, path, p, radius);
+  const unsigned n_workers =
+    std::min<std::size_t>({pool.GetConcurrency(), dirs.size(),
+                           requested.size()});
+
+  /* distribute the tiles round-robin (in file order), so each
+     worker skips over roughly the same amount of data */
+  std::vector<std::vector<uint16_t>> assigned(n_workers);
+  for (std::size_t i = 0; i < requested.size(); ++i)
+    assigned[i % n_workers].push_back(requested[i]);
+
+  std::exception_ptr error;
+  Mutex error_mutex;
+
+  pool.Run(n_workers, [&](unsigned i){
+    try {
+      NullOperationEnvironment env;
+      TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
+      loader.SetAssignedTiles(assigned[i]);
+      loader.LoadJPG2000(dirs[i], "terrain.jp2");
+    } catch (...) {
+      const std::lock_guard lock{error_mutex};
+      if (!error)
+        error = std::current_exception();
+    }
+  });
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+void
+UpdateTerrainTiles(ThreadPool &pool, std::span<struct zzip_dir *const> dirs,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius)
+{
+  const auto raster_location = projection.ProjectCoarse(location);
+
+  UpdateTerrainTiles(pool, dirs, raster_tile_cache, mutex,
+                     raster_location,
+                     projection.DistancePixelsCoarse(radius));
 }
 
 void
@@ -7,11 +7,14 @@
 #include "thread/SharedMutex.hpp"
 
 #include <cstdint>
+#include <span>
 
 struct zzip_dir;
 struct GeoPoint;
 class RasterTileCache;
 class RasterProjection;
+class RawTileWriter;
+class ThreadPool;
 class OperationEnvironment;
 
 class TerrainLoader {
@@ -23,6 +26,19 @@ class TerrainLoader {
 
   OperationEnvironment &env;
 
+  /**
+   * If set, then all decoded tiles are passed to this object.  This
+   * is used to generate a #RawTileStore.
+   */
+  RawTileWriter *raw_writer = nullptr;
+
+  /**
+   * If not empty, then this loader decodes only these tiles (sorted
+   * ascending); the other requested tiles are decoded by other
+   * loaders running in parallel.
+   */
+  std::span<const uint16_t> assigned_tiles;
+
   /**
    * The number of remaining segments after the current one.
    */
@@ -37,6 +53,14 @@ public:
      scan_tiles(!_scan_overview || _scan_all),
      env(_env) {}
 
+  void SetRawTileWriter(RawTileWriter &_raw_writer) noexcept {
+    raw_writer = &_raw_writer;
+  }
+
+  void SetAssignedTiles(std::span<const uint16_t> _tiles) noexcept {
+    assigned_tiles = _tiles;
+  }
+
   /**
    * Throws on error.
    */
@@ -44,10 +68,19 @@ public:
                     const char *path, const char *world_file);
 
   /**
+   * Request the tiles around the given location.
+   *
+   * @return true if there are tiles to be loaded with
+   * LoadRequestedTiles()
+   */
+  bool PollTiles(SignedRasterLocation p, unsigned radius) noexcept;
+
+  /**
+   * Decode all tiles which are currently requested.
+   *
    * Throws on error.
    */
-  void UpdateTiles(struct zzip_dir *dir, const char *path,
-                   SignedRasterLocation p, unsigned radius);
+  void LoadRequestedTiles(struct zzip_dir *dir, const char *path);
 
   /* callback methods for libjasper (via jas_rtc.cpp) */
 
@@ -66,12 +99,18 @@ public:
                    RasterLocation start, RasterLocation end,
                    const struct jas_matrix &m);
 
-private:
   /**
    * Throws on error.
    */
   void LoadJPG2000(struct zzip_dir *dir, const char *path);
 
+private:
+  /**
+   * Shall this loader decode the given (requested) tile?
+   */
+  [[gnu::pure]]
+  bool IsWanted(unsigned tile) const noexcept;
+
   void ParseBounds(const char *data);
 };
 
@@ -98,6 +137,19 @@ LoadTerrainOverview(struct zzip_dir *dir,
                       tile_cache, false, env);
 }
 
+/**
+ * Load the overview (like LoadTerrainOverview()) and pass all
+ * decoded tiles to the #RawTileWriter.  This decodes the whole file
+ * and is therefore expensive.
+ *
+ * Throws on error.
+ */
+void
+ConvertTerrainTiles(struct zzip_dir *dir,
+                    RasterTileCache &raster_tile_cache,
+                    RawTileWriter &writer,
+                    OperationEnvironment &env);
+
 /**
  * Throws on error.
  */
@@ -114,6 +166,58 @@ UpdateTerrainTiles(struct zzip_dir *dir,
   UpdateTerrainTiles(dir, "terrain.jp2", tile_cache, mutex, p, radius);
 }
 
+/**
+ * Decode the tiles which are still requested, without calling
+ * RasterTileCache::PollTiles() again.  This loads the tiles which
+ * were missing in the #RawTileStore (see the #RawTileStore overload
+ * of UpdateTerrainTiles()).
+ *
+ * Throws on error.
+ */
+void
+LoadRequestedTerrainTiles(struct zzip_dir *dir, const char *path,
+                          RasterTileCache &raster_tile_cache,
+                          SharedMutex &mutex);
+
+static inline void
+LoadRequestedTerrainTiles(struct zzip_dir *dir,
+                          RasterTileCache &tile_cache, SharedMutex &mutex)
+{
+  LoadRequestedTerrainTiles(dir, "terrain.jp2", tile_cache, mutex);
+}
+
+/**
+ * Like UpdateTerrainTiles(), but distribute the requested tiles over
+ * the threads of the #ThreadPool, each decoding its share in a
+ * separate pass over the JPEG2000 file.  Each thread needs its own
+ * #zzip_dir instance (libzzip is not thread-safe), therefore the
+ * concurrency is limited by the size of #dirs.
+ *
+ * Throws on error.
+ */
+void
+UpdateTerrainTiles(ThreadPool &pool, std::span<struct zzip_dir *const> dirs,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   SignedRasterLocation p, unsigned radius);
+
+/**
+ * Like LoadRequestedTerrainTiles(), but distribute the tiles over
+ * the threads of the #ThreadPool.
+ *
+ * Throws on error.
+ */
+void
+LoadRequestedTerrainTiles(ThreadPool &pool,
+                          std::span<struct zzip_dir *const> dirs,
+                          RasterTileCache &raster_tile_cache,
+                          SharedMutex &mutex);
+
+void
+UpdateTerrainTiles(ThreadPool &pool, std::span<struct zzip_dir *const> dirs,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius);
+
 void
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
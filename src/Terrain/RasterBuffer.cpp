@@ -13,9 +13,23 @@ RasterBuffer::Resize(RasterLocation _size) noexcept
   assert(_size.x > 0);
   assert(_size.y > 0);
 
+  external = nullptr;
   data.GrowDiscard(_size.x, _size.y);
 }
 
+void
+RasterBuffer::SetExternal(const TerrainHeight *_data,
+                          RasterLocation _size) noexcept
+{
+  assert(_data != nullptr);
+  assert(_size.x > 0);
+  assert(_size.y > 0);
+
+  data.Reset();
+  external = _data;
+  external_size = _size;
+}
+
 TerrainHeight
 RasterBuffer::GetInterpolated(unsigned lx, unsigned ly,
                               unsigned ix, unsigned iy) const noexcept
@@ -239,11 +253,111 @@ RasterBuffer::ScanLineChecked(RasterLocation a, RasterLocation b,
   ScanLine(a, b, buffer, size, interpolate);
 }
 
+void
+RasterBuffer::ScanLineRange(RasterLocation a, RasterLocation b,
+                            TerrainHeight *buffer, unsigned size,
+                            unsigned begin, unsigned end,
+                            bool interpolate) const noexcept
+{
+  assert(a.x < GetFineSize().x);
+  assert(a.y < GetFineSize().y);
+  assert(b.x < GetFineSize().x);
+  assert(b.y < GetFineSize().y);
+  assert(buffer != nullptr);
+  assert(begin < end);
+  assert(end <= size);
+
+  /* this follows the code paths of ScanLine() and
+     ScanHorizontalLine(), calculating the position of each sample
+     directly */
+
+  if (size == 1) {
+    buffer[0] = Get(a >> RasterTraits::SUBPIXEL_BITS);
+    return;
+  }
+
+  const int n = size - 1;
+  const IntPoint2D d(b.x - a.x, b.y - a.y);
+
+  if (a.y == b.y) {
+    if (interpolate &&
+        (unsigned)abs(d.x) < (2 * size << RasterTraits::SUBPIXEL_BITS)) {
+      const auto [cy, iy] = RasterTraits::CalcSubpixel(a.y);
+
+      for (int i = begin; (unsigned)i < end; ++i) {
+        const auto [cx, ix] =
+          RasterTraits::CalcSubpixel(a.x + (i * d.x) / n);
+
+        buffer[i] = GetInterpolated(cx, cy, ix, iy);
+      }
+    } else if (d.x > 0) {
+      /* PixelIterator advances by (i * src_size / size) pixels
+         after i samples */
+      const TerrainHeight *src = GetDataAt(a >> RasterTraits::SUBPIXEL_BITS);
+      const unsigned src_size = d.x >> RasterTraits::SUBPIXEL_BITS;
+
+      for (unsigned i = begin; i < end; ++i)
+        buffer[i] = src[i * src_size / size];
+    } else {
+      const TerrainHeight *src =
+        GetDataAt({0, a.y >> RasterTraits::SUBPIXEL_BITS});
+
+      for (int i = begin; (unsigned)i < end; ++i) {
+        unsigned cx = a.x + (i * d.x) / n;
+
+        buffer[i] = src[cx >> RasterTraits::SUBPIXEL_BITS];
+      }
+    }
+
+    return;
+  }
+
+  if (interpolate &&
+      (unsigned)(abs(d.x) + abs(d.y)) < (2 * unsigned(n) << RasterTraits::SUBPIXEL_BITS)) {
+    for (int i = begin; (unsigned)i < end; ++i) {
+      const auto [cx, ix] =
+        RasterTraits::CalcSubpixel(a.x + (i * d.x) / n);
+      const auto [cy, iy] =
+        RasterTraits::CalcSubpixel(a.y + (i * d.y) / n);
+
+      buffer[i] = GetInterpolated(cx, cy, ix, iy);
+    }
+  } else {
+    for (int i = begin; (unsigned)i < end; ++i) {
+      const RasterLocation c(a.x + (i * d.x) / n,
+                             a.y + (i * d.y) / n);
+
+      buffer[i] = Get(c >> RasterTraits::SUBPIXEL_BITS);
+    }
+  }
+}
+
+void
+RasterBuffer::ScanLineRangeChecked(RasterLocation a, RasterLocation b,
+                                   TerrainHeight *buffer, unsigned size,
+                                   unsigned begin, unsigned end,
+                                   bool interpolate) const noexcept
+{
+  if (a.x >= GetFineSize().x)
+    a.x = GetFineSize().x - 1;
+
+  if (a.y >= GetFineSize().y)
+    a.y = GetFineSize().y - 1;
+
+  if (b.x >= GetFineSize().x)
+    b.x = GetFineSize().x - 1;
+
+  if (b.y >= GetFineSize().y)
+    b.y = GetFineSize().y - 1;
+
+  ScanLineRange(a, b, buffer, size, begin, end, interpolate);
+}
+
 TerrainHeight
 RasterBuffer::GetMaximum() const noexcept
 {
   return IsDefined()
-    ? *std::max_element(data.begin(), data.end(),
+    ? *std::max_element(GetData(), GetData() + GetSize().Area(),
                         [](TerrainHeight a, TerrainHeight b) {
                           return a.GetValue() < b.GetValue();
                         })
@@ -9,22 +9,35 @@
 #include "util/AllocatedGrid.hxx"
 #include "util/Compiler.h"
 
+#include <cassert>
+
 class RasterBuffer {
   AllocatedGrid<TerrainHeight> data;
 
+  /**
+   * If this is set, then the buffer does not own its data; it refers
+   * to read-only memory managed by somebody else (e.g. a mapped
+   * #RawTileStore), and #data is empty.
+   */
+  const TerrainHeight *external = nullptr;
+  RasterLocation external_size{0, 0};
+
 public:
   RasterBuffer() noexcept = default;
   RasterBuffer(unsigned _width, unsigned _height) noexcept
     :data(_width, _height) {}
 
-  RasterBuffer(const RasterBuffer &) = delete;
-  RasterBuffer &operator=(const RasterBuffer &) = delete;
+  RasterBuffer(RasterBuffer &&) noexcept = default;
+  RasterBuffer &operator=(RasterBuffer &&) noexcept = default;
 
   bool IsDefined() const noexcept {
-    return data.IsDefined();
+    return external != nullptr || data.IsDefined();
   }
 
   RasterLocation GetSize() const noexcept {
+    if (external != nullptr)
+      return external_size;
+
     return {data.GetWidth(), data.GetHeight()};
   }
 
@@ -33,23 +46,44 @@ public:
   }
 
   TerrainHeight *GetData() noexcept {
+    assert(external == nullptr);
+
     return data.begin();
   }
 
   const TerrainHeight *GetData() const noexcept {
+    if (external != nullptr)
+      return external;
+
     return data.begin();
   }
 
   const TerrainHeight *GetDataAt(RasterLocation p) const noexcept {
+    if (external != nullptr) {
+      assert(p.x < external_size.x);
+      assert(p.y < external_size.y);
+
+      return external + p.y * external_size.x + p.x;
+    }
+
     return data.GetPointerAt(p.x, p.y);
   }
 
   void Reset() noexcept {
     data.Reset();
+    external = nullptr;
   }
 
   void Resize(RasterLocation _size) noexcept;
 
+  /**
+   * Refer to external read-only data instead of owning a copy.  The
+   * caller is responsible for keeping the memory valid until
+   * Reset() or Resize() gets called.
+   */
+  void SetExternal(const TerrainHeight *_data,
+                   RasterLocation _size) noexcept;
+
   [[gnu::pure]]
   TerrainHeight GetInterpolated(unsigned lx, unsigned ly,
                                 unsigned ix, unsigned iy) const noexcept;
@@ -82,6 +116,26 @@ public:
                        TerrainHeight *buffer, unsigned size,
                        bool interpolate) const noexcept;
 
+  /**
+   * Calculate only the samples [begin, end) of ScanLine(), with
+   * exactly the same values.  They are written to buffer[begin] to
+   * buffer[end-1], the rest of the buffer is not touched.  Each
+   * sample is calculated separately, so this is only efficient for
+   * small ranges.
+   */
+  void ScanLineRange(RasterLocation a, RasterLocation b,
+                     TerrainHeight *buffer, unsigned size,
+                     unsigned begin, unsigned end,
+                     bool interpolate) const noexcept;
+
+  /**
+   * Wrapper for ScanLineRange() with basic range checks.
+   */
+  void ScanLineRangeChecked(RasterLocation a, RasterLocation b,
+                            TerrainHeight *buffer, unsigned size,
+                            unsigned begin, unsigned end,
+                            bool interpolate) const noexcept;
+
   [[gnu::pure]]
   TerrainHeight GetMaximum() const noexcept;
 };
@@ -36,18 +36,30 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const noexcept
 }
 
 void
-RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
-                    TerrainHeight *buffer, unsigned size,
-                    bool interpolate) const noexcept
+RasterMap::ScanLineRange(const GeoPoint &start, const GeoPoint &end,
+                         TerrainHeight *buffer, unsigned size,
+                         unsigned begin, unsigned end_index,
+                         bool interpolate) const noexcept
 {
   assert(buffer != nullptr);
   assert(size > 0);
+  assert(begin < end_index);
+  assert(end_index <= size);
 
   constexpr TerrainHeight invalid = TerrainHeight::Invalid();
 
+  /* fill the requested part of the buffer range [first, last) with
+     invalid values */
+  const auto fill_invalid = [=](unsigned first, unsigned last){
+    first = std::max(first, begin);
+    last = std::min(last, end_index);
+    if (first < last)
+      std::fill(buffer + first, buffer + last, invalid);
+  };
+
   const double total_distance = start.DistanceS(end);
   if (total_distance <= 0) {
-    std::fill_n(buffer, size, invalid);
+    fill_invalid(0, size);
     return;
   }
 
@@ -56,7 +68,7 @@ RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
   GeoPoint clipped_start = start, clipped_end = end;
   const GeoClip clip(GetBounds());
   if (!clip.ClipLine(clipped_start, clipped_end)) {
-    std::fill_n(buffer, size, invalid);
+    fill_invalid(0, size);
     return;
   }
 
@@ -74,7 +86,7 @@ RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
   if (clipped_end_offset > size)
     clipped_end_offset = size;
   if (clipped_start_offset + 2 > clipped_end_offset) {
-    std::fill_n(buffer, size, invalid);
+    fill_invalid(0, size);
     return;
   }
 
@@ -83,8 +95,12 @@ RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
 
   /* fill the two regions which are outside the map  */
 
-  std::fill(buffer, buffer + clipped_start_offset, invalid);
-  std::fill(buffer + clipped_end_offset, buffer + size, invalid);
+  fill_invalid(0, clipped_start_offset);
+  fill_invalid(clipped_end_offset, size);
+
+  if (end_index <= clipped_start_offset || begin >= clipped_end_offset)
+    /* the requested range is completely outside the map */
+    return;
 
   /* now scan the middle part which is within the map */
 
@@ -102,10 +118,12 @@ RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
   if (raster_end.y >= fine_size.y)
     raster_end.y = fine_size.y - 1;
 
-  raster_tile_cache.ScanLine(raster_start, raster_end,
-                             buffer + clipped_start_offset,
-                             clipped_end_offset - clipped_start_offset,
-                             interpolate);
+  raster_tile_cache.ScanLineRange(raster_start, raster_end,
+                                  buffer + clipped_start_offset,
+                                  clipped_end_offset - clipped_start_offset,
+                                  std::max(begin, clipped_start_offset) - clipped_start_offset,
+                                  std::min(end_index, clipped_end_offset) - clipped_start_offset,
+                                  interpolate);
 }
 
 RasterMap::Intersection
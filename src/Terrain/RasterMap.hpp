@@ -101,7 +101,19 @@ public:
    */
   void ScanLine(const GeoPoint &start, const GeoPoint &end,
                 TerrainHeight *buffer, unsigned size,
-                bool interpolate) const noexcept;
+                bool interpolate) const noexcept {
+    ScanLineRange(start, end, buffer, size, 0, size, interpolate);
+  }
+
+  /**
+   * Like ScanLine(), but calculate only the samples [begin,
+   * end_index), with exactly the same values.  The rest of the
+   * buffer is not touched.
+   */
+  void ScanLineRange(const GeoPoint &start, const GeoPoint &end,
+                     TerrainHeight *buffer, unsigned size,
+                     unsigned begin, unsigned end_index,
+                     bool interpolate) const noexcept;
 
   struct Intersection {
     GeoPoint location;
@@ -3,6 +3,7 @@
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/RasterShading.hpp"
 #include "Math/Constants.hpp"
 #include "Screen/Layout.hpp"
 #include "ui/canvas/Ramp.hpp"
@@ -11,6 +12,8 @@
 #include "Renderer/GeoBitmapRenderer.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "ui/event/Idle.hpp"
+#include "thread/ThreadPool.hpp"
+#include "LogFile.hpp"
 
 #include <algorithm> // for std::clamp()
 #include <cassert>
@@ -59,32 +62,46 @@ TerrainShading(const int illum, RGB8Color color) noexcept
     return RawColor(color.Red(), color.Green(), color.Blue());
 }
 
-static constexpr unsigned
-ContourInterval(unsigned h, unsigned contour_height_scale) noexcept
+RasterRenderer::RasterRenderer() noexcept = default;
+
+RasterRenderer::~RasterRenderer() noexcept
 {
-  return std::min(254u, h >> contour_height_scale);
+  delete[] color_table;
+  delete image;
+  delete[] contour_column_base;
 }
 
-[[gnu::const]]
-static unsigned
-ContourInterval(const TerrainHeight h, const unsigned contour_height_scale)
+/**
+ * The number of threads used by SetScanThreads(0).  More rarely helps,
+ * because the scan competes with other threads for memory bandwidth.
+ */
+static constexpr unsigned MAX_AUTO_SCAN_THREADS = 4;
+
+void
+RasterRenderer::SetScanThreads(unsigned n) noexcept
 {
-  if (h.IsSpecial()) [[unlikely]]
-    return 0;
+  if (n == scan_threads)
+    /* unchanged */
+    return;
 
-  if (h.GetValue() <= 0)
-    return 0;
+  scan_threads = n;
 
-  return ContourInterval(h.GetValue(), contour_height_scale);
-}
+  if (n == 0)
+    n = std::min(ThreadPool::GetProcessorCount(), MAX_AUTO_SCAN_THREADS);
 
-RasterRenderer::RasterRenderer() noexcept = default;
+  height_matrix.SetThreadPool(nullptr);
+  scan_pool.reset();
 
-RasterRenderer::~RasterRenderer() noexcept
-{
-  delete[] color_table;
-  delete image;
-  delete[] contour_column_base;
+  if (n <= 1)
+    return;
+
+  try {
+    scan_pool = std::make_unique<ThreadPool>("TerrainScan", n - 1);
+    height_matrix.SetThreadPool(scan_pool.get());
+  } catch (...) {
+    /* fall back to scanning in the calling thread */
+    LogError(std::current_exception(), "Failed to create terrain threads");
+  }
 }
 
 #ifdef ENABLE_OPENGL
@@ -160,13 +177,21 @@ RasterRenderer::ScanMap(const RasterMap &map,
   bounds = projection.GetScreenBounds().Scale(1.5);
   bounds.IntersectWith(map.GetBounds());
 
-  height_matrix.Fill(map, bounds,
-                     (UnsignedPoint2D)projection.GetScreenSize() / quantisation_pixels,
-                     true);
+  const UnsignedPoint2D size =
+    (UnsignedPoint2D)projection.GetScreenSize() / quantisation_pixels;
+  if (incremental_scan)
+    /* this may move the bounds slightly to align them with the
+       previous ones */
+    height_matrix.Update(map, bounds, size, true);
+  else
+    height_matrix.Fill(map, bounds, size, true);
 
   last_quantisation_pixels = quantisation_pixels;
 #else
-  height_matrix.Fill(map, projection, quantisation_pixels, true);
+  if (incremental_scan)
+    height_matrix.Update(map, projection, quantisation_pixels, true);
+  else
+    height_matrix.Fill(map, projection, quantisation_pixels, true);
 #endif
 }
 
@@ -205,73 +230,29 @@ RasterRenderer::GenerateImage(bool do_shading,
   image->SetDirty();
 }
 
-void
-RasterRenderer::GenerateUnshadedImage(const unsigned height_scale,
-                                      const unsigned contour_height_scale) noexcept
+inline RasterShading
+RasterRenderer::MakeShading(unsigned height_scale,
+                            unsigned contour_height_scale) noexcept
 {
-  const auto *src = height_matrix.GetData();
-  const RawColor *oColorBuf = color_table + 64 * 256;
-  RawColor *dest = image->GetTopRow();
-
-  for (unsigned y = height_matrix.GetSize().y; y > 0; --y) {
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
-
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
-
-    for (unsigned x = height_matrix.GetSize().x; x > 0; --x) {
-      const auto e = *src++;
-      if (!e.IsSpecial()) [[likely]] {
-        unsigned h = std::max(0, (int)e.GetValue());
-
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
-
-        h = std::min(254u, h >> height_scale);
-        if (contour_interval != contour_row_base ||
-            contour_interval != *contour_this_column_base) [[unlikely]] {
-          *p++ = oColorBuf[(int)h - 64 * 256];
-          *contour_this_column_base = contour_row_base = contour_interval;
-        } else {
-          *p++ = oColorBuf[h];
-        }
-      } else if (e.IsWater()) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = RawColor(0xff, 0xff, 0xff);
-      }
-      contour_this_column_base++;
-
-    }
-  }
+  RawColor *top_row = image->GetTopRow();
+
+  return {
+    height_matrix.GetData(), height_matrix.GetSize(),
+    color_table,
+    top_row, image->GetNextRow(top_row) - top_row,
+    contour_column_base,
+    height_scale, contour_height_scale,
+    RasterShading::IsSIMDAvailable(),
+  };
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-static constexpr int
-ClipHeightDelta(int d) noexcept
-{
-  return std::clamp(d, -512, 512);
-}
-
-static constexpr int
-ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
+void
+RasterRenderer::GenerateUnshadedImage(const unsigned height_scale,
+                                      const unsigned contour_height_scale) noexcept
 {
-  return ClipHeightDelta(a.GetValue() - b.GetValue());
+  MakeShading(height_scale, contour_height_scale).GenerateUnshadedImage();
 }
 
-// JMW: if zoomed right in (e.g. one unit is larger than terrain
-// grid), then increase the step size to be equal to the terrain
-// grid for purposes of calculating slope, to avoid shading problems
-// (gridding of display) This is why quantisation_effective is used instead of 1
-// previously.  for large zoom levels, quantisation_effective=1
 void
 RasterRenderer::GenerateSlopeImage(unsigned height_scale,
                                    int contrast,
@@ -280,122 +261,16 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 {
   assert(quantisation_effective > 0);
 
-  const auto border = PixelRect{PixelSize{height_matrix.GetSize()}}
-    .WithPadding(quantisation_effective);
-
   const unsigned height_slope_factor =
     std::clamp((unsigned)pixel_size, 1u,
                /* this upper limit avoids integer overflows in the
                   "mag" formula; it effectively limits "dd2" so
                   calculating its square will not overflow */
                8192u / (quantisation_effective * quantisation_effective));
-  
-  const auto *src = height_matrix.GetData();
-  const RawColor *oColorBuf = color_table + 64 * 256;
-
-  RawColor *dest = image->GetTopRow();
-
-  for (unsigned y = 0; y < height_matrix.GetSize().y; ++y) {
-    const unsigned row_plus_index = y < (unsigned)border.bottom
-      ? quantisation_effective
-      : height_matrix.GetSize().y - 1 - y;
-    const unsigned row_plus_offset = height_matrix.GetSize().x * row_plus_index;
-
-    const unsigned row_minus_index = y >= quantisation_effective
-      ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.GetSize().x * row_minus_index;
-
-    const unsigned p31 = row_plus_index + row_minus_index;
-
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
-
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
-
-    for (unsigned x = 0; x < height_matrix.GetSize().x; ++x, ++src) {
-      const auto e = *src;
-      if (!e.IsSpecial()) [[likely]] {
-        unsigned h = std::max(0, (int)e.GetValue());
-
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
-
-        h = std::min(254u, h >> height_scale);
 
-        // no need to calculate slope if undefined height or sea level
-
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
-
-        // X direction
-
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetSize().x - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
-
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
-
-        const auto h_above = src[-(int)row_minus_offset];
-        const auto h_below = src[row_plus_offset];
-        const auto h_left = src[-(int)column_minus_index];
-        const auto h_right = src[column_plus_index];
-
-        if (h_above.IsSpecial() || h_below.IsSpecial() ||
-            h_left.IsSpecial() || h_right.IsSpecial()) [[unlikely]] {
-          /* some "special" terrain value surrounding us (water or
-             invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
-          contour_this_column_base++;
-          continue;
-        }
-
-        if (contour_interval != contour_row_base ||
-            contour_interval != *contour_this_column_base) [[unlikely]] {
-
-          *contour_this_column_base++ = contour_row_base = contour_interval;
-          *p++ = oColorBuf[int(h) - 64 * 256];
-          continue;
-        }
-
-        const int p32 = ClipHeightDelta(h_above, h_below);
-        const int p22 = ClipHeightDelta(h_right, h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-        const unsigned mag = (unsigned)sqrt(square_mag);
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[int(h) + 256 * std::clamp(sindex, -63, 63)];
-      } else if (e.IsWater()) {
-        // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
-      } else {
-        /* outside the terrain file bounds: white background */
-        *p++ = RawColor(0xff, 0xff, 0xff);
-      }
-      contour_this_column_base++;
-
-    }
-  }
+  MakeShading(height_scale, contour_height_scale)
+    .GenerateSlopeImage(contrast, sx, sy, sz,
+                        quantisation_effective, height_slope_factor);
 }
 
 void
@@ -452,11 +327,7 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
 void
 RasterRenderer::ContourStart(const unsigned contour_height_scale) noexcept
 {
-  // initialise column to first row
-  const auto *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetSize().x; x > 0; --x)
-    *col_base++ = ContourInterval(*src++, contour_height_scale);
+  MakeShading(0, contour_height_scale).ContourStart();
 }
 
 void
@@ -5,6 +5,8 @@
 
 #include "Terrain/HeightMatrix.hpp"
 
+#include <memory>
+
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
 #endif
@@ -18,6 +20,8 @@ class WindowProjection;
 class RawBitmap;
 struct RawColor;
 struct ColorRamp;
+struct RasterShading;
+class ThreadPool;
 
 #ifdef ENABLE_OPENGL
 class GLTexture;
@@ -51,6 +55,26 @@ class RasterRenderer {
 #endif
 
   HeightMatrix height_matrix;
+
+  /**
+   * Reuse the previous #height_matrix in ScanMap() and scan only the
+   * newly exposed parts, see HeightMatrix::Update().
+   */
+  bool incremental_scan = false;
+
+  /**
+   * Worker threads for scanning the #height_matrix; nullptr if the
+   * map is scanned only by the calling thread.
+   */
+  std::unique_ptr<ThreadPool> scan_pool;
+
+  /**
+   * The value which was last passed to SetScanThreads().  It is
+   * remembered even if #scan_pool could not be created, so a failure
+   * is not retried (and logged) on every frame.
+   */
+  unsigned scan_threads = 1;
+
   RawBitmap *image = nullptr;
 
   unsigned char *contour_column_base = nullptr;
@@ -74,9 +98,27 @@ public:
     return height_matrix.GetSize();
   }
 
+  /**
+   * Enable incremental updates of the height matrix.  This is only
+   * safe if the #RasterMap passed to ScanMap() increments its serial
+   * whenever its contents change.
+   */
+  void SetIncrementalScan(bool _incremental_scan) noexcept {
+    incremental_scan = _incremental_scan;
+  }
+
+  /**
+   * Set the maximum number of threads used by ScanMap(), including
+   * the calling thread.
+   *
+   * @param n the number of threads; 0 chooses automatically
+   */
+  void SetScanThreads(unsigned n) noexcept;
+
 #ifdef ENABLE_OPENGL
   void Invalidate() noexcept {
     bounds.SetInvalid();
+    height_matrix.Invalidate();
   }
 
   /**
@@ -146,5 +188,8 @@ protected:
                           unsigned contour_height_scale) noexcept;
 
 private:
+  RasterShading MakeShading(unsigned height_scale,
+                            unsigned contour_height_scale) noexcept;
+
   void ContourStart(unsigned contour_height_scale) noexcept;
 };
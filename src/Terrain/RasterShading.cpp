@@ -0,0 +1,556 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "RasterShading.hpp"
+#include "ui/canvas/RawBitmap.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm> // for std::clamp()
+#include <cassert>
+#include <cmath>
+
+#include <string.h>
+
+/**
+ * The number of pixels processed in one batch by the vectorised
+ * implementation.
+ */
+static constexpr unsigned CHUNK = 256;
+
+static constexpr unsigned
+ContourInterval(unsigned h, unsigned contour_height_scale) noexcept
+{
+  return std::min(254u, h >> contour_height_scale);
+}
+
+[[gnu::const]]
+static unsigned
+ContourInterval(const TerrainHeight h, const unsigned contour_height_scale)
+{
+  if (h.IsSpecial()) [[unlikely]]
+    return 0;
+
+  if (h.GetValue() <= 0)
+    return 0;
+
+  return ContourInterval(h.GetValue(), contour_height_scale);
+}
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the
+ * GenerateSlopeImage() formula when the map file is broken, avoiding
+ * the sqrt() call with a negative argument.
+ */
+static constexpr int
+ClipHeightDelta(int d) noexcept
+{
+  return std::clamp(d, -512, 512);
+}
+
+static constexpr int
+ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
+{
+  return ClipHeightDelta(a.GetValue() - b.GetValue());
+}
+
+/**
+ * The slope shading parameters which are constant within one row.
+ */
+struct SlopeRow {
+  int sx, sy, sz, contrast;
+
+  /**
+   * The horizontal and vertical distance of the neighbours used for
+   * the gradient (interior pixels only).
+   */
+  unsigned p20, p31;
+
+  unsigned height_slope_factor;
+
+  /**
+   * The "dd2" term for interior pixels.
+   */
+  unsigned dd2;
+};
+
+/**
+ * Calculate the illumination level (-63..63) of one pixel.
+ *
+ * @param p22 the clipped horizontal height delta
+ * @param p32 the clipped vertical height delta
+ */
+static int
+SlopeIndex(const SlopeRow &row, unsigned p20, int p22, int p32) noexcept
+{
+  const int dd0 = p22 * int(row.p31);
+  const int dd1 = int(p20) * p32;
+  const unsigned dd2 = p20 * row.p31 * row.height_slope_factor;
+  const int num = (int(dd2) * row.sz + dd0 * row.sx + dd1 * row.sy);
+  const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
+  const unsigned mag = (unsigned)sqrt(square_mag);
+  /* this is a workaround for a SIGFPE (division by zero)
+     observed by our users on some Android devices (e.g. Nexus
+     7), even though we did our best to make sure that the
+     integer arithmetics above can't overflow */
+  /* TODO: debug this problem and replace this workaround */
+  const int sval = num / int(mag|1);
+  const int sindex = (sval - row.sz) * row.contrast / 128;
+  return std::clamp(sindex, -63, 63);
+}
+
+/*
+ * The vectorised implementation.  It uses gcc vector extensions,
+ * which the compiler translates to SSE2 or NEON instructions.  Only
+ * the square root needs explicit intrinsics.
+ *
+ * The square root and the division are done in double precision,
+ * which is exact for these 32 bit integers: the truncated results
+ * are the same as those of the scalar integer implementation.
+ */
+
+using Int8x4 [[gnu::vector_size(4)]] = int8_t;
+using UInt8x4 [[gnu::vector_size(4)]] = uint8_t;
+using Int16x4 [[gnu::vector_size(8)]] = int16_t;
+using Int32x2 [[gnu::vector_size(8)]] = int32_t;
+using UInt32x2 [[gnu::vector_size(8)]] = uint32_t;
+using Int32x4 [[gnu::vector_size(16)]] = int32_t;
+using UInt32x4 [[gnu::vector_size(16)]] = uint32_t;
+using Float64x2 [[gnu::vector_size(16)]] = double;
+
+static constexpr Int32x4
+Splat(int32_t value) noexcept
+{
+  return Int32x4{value, value, value, value};
+}
+
+[[gnu::always_inline]]
+static inline Int32x4
+LoadHeights(const TerrainHeight *p) noexcept
+{
+  static_assert(sizeof(TerrainHeight) == sizeof(int16_t));
+
+  Int16x4 v;
+  memcpy(&v, p, sizeof(v));
+  return __builtin_convertvector(v, Int32x4);
+}
+
+[[gnu::always_inline]]
+static inline Int32x4
+Clamp(Int32x4 v, int32_t lo, int32_t hi) noexcept
+{
+  v = v < Splat(lo) ? Splat(lo) : v;
+  return v > Splat(hi) ? Splat(hi) : v;
+}
+
+[[gnu::always_inline]]
+static inline Float64x2
+Sqrt(Float64x2 v) noexcept
+{
+#ifdef __SSE2__
+  return (Float64x2)_mm_sqrt_pd((__m128d)v);
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  return (Float64x2)vsqrtq_f64((float64x2_t)v);
+#else
+  for (unsigned i = 0; i < 2; ++i)
+    v[i] = std::sqrt(v[i]);
+  return v;
+#endif
+}
+
+/**
+ * Calculate "num / (sqrt(square_mag) | 1)" for two pixels.
+ */
+[[gnu::always_inline]]
+static inline Int32x2
+SlopeValue(Int32x2 num, UInt32x2 square_mag) noexcept
+{
+  /* the square root of a 32 bit integer is below 2^16 */
+  const Int32x2 mag =
+    __builtin_convertvector(Sqrt(__builtin_convertvector(square_mag,
+                                                         Float64x2)),
+                            Int32x2);
+
+  return __builtin_convertvector(__builtin_convertvector(num, Float64x2) /
+                                 __builtin_convertvector(mag | 1, Float64x2),
+                                 Int32x2);
+}
+
+[[gnu::always_inline]]
+static inline Int32x4
+SlopeValue(Int32x4 num, UInt32x4 square_mag) noexcept
+{
+  Int32x2 num_half[2];
+  UInt32x2 square_mag_half[2];
+  memcpy(num_half, &num, sizeof(num));
+  memcpy(square_mag_half, &square_mag, sizeof(square_mag));
+
+  const Int32x2 result_half[2]{
+    SlopeValue(num_half[0], square_mag_half[0]),
+    SlopeValue(num_half[1], square_mag_half[1]),
+  };
+
+  Int32x4 result;
+  memcpy(&result, result_half, sizeof(result));
+  return result;
+}
+
+/**
+ * A value for the SlopeIndex4() result which means that at least one
+ * of the neighbours is "special".
+ */
+static constexpr int8_t SPECIAL_NEIGHBOUR = -128;
+
+/**
+ * Vectorised version of SlopeIndex() for four interior pixels.  For
+ * pixels with a "special" neighbour, the result is
+ * #SPECIAL_NEIGHBOUR.
+ *
+ * @param p the first of the four pixels
+ * @param above the distance to the upper neighbour
+ * @param below the distance to the lower neighbour
+ * @param q the distance to the left/right neighbours
+ */
+[[gnu::always_inline]]
+static inline void
+SlopeIndex4(const SlopeRow &row, const TerrainHeight *p,
+            std::ptrdiff_t above, std::ptrdiff_t below, unsigned q,
+            int8_t *result) noexcept
+{
+  const Int32x4 h_above = LoadHeights(p - above);
+  const Int32x4 h_below = LoadHeights(p + below);
+  const Int32x4 h_left = LoadHeights(p - q);
+  const Int32x4 h_right = LoadHeights(p + q);
+
+  constexpr int32_t threshold = TerrainHeight::WATER_THRESHOLD;
+  const Int32x4 special_neighbour =
+    (h_above <= threshold) | (h_below <= threshold) |
+    (h_left <= threshold) | (h_right <= threshold);
+
+  const Int32x4 p32 = Clamp(h_above - h_below, -512, 512);
+  const Int32x4 p22 = Clamp(h_right - h_left, -512, 512);
+
+  const Int32x4 dd0 = p22 * int(row.p31);
+  const Int32x4 dd1 = int(row.p20) * p32;
+  const Int32x4 num = int(row.dd2) * row.sz + dd0 * row.sx + dd1 * row.sy;
+  const UInt32x4 square_mag = (UInt32x4)(dd0 * dd0 + dd1 * dd1)
+    + row.dd2 * row.dd2;
+  const Int32x4 sval = SlopeValue(num, square_mag);
+
+  /* division by 128, rounded towards zero */
+  const Int32x4 t = (sval - row.sz) * row.contrast;
+  Int32x4 sindex = Clamp((t + ((t >> 31) & 127)) >> 7, -63, 63);
+  sindex = special_neighbour ? Splat(SPECIAL_NEIGHBOUR) : sindex;
+
+  const Int8x4 v = __builtin_convertvector(sindex, Int8x4);
+  memcpy(result, &v, sizeof(v));
+}
+
+/**
+ * Vectorised version of ContourInterval().
+ */
+[[gnu::always_inline]]
+static inline void
+ContourInterval4(const TerrainHeight *p, unsigned contour_height_scale,
+                 uint8_t *result) noexcept
+{
+  const Int32x4 h = LoadHeights(p);
+
+  /* special values are negative, and thus map to 0 */
+  Int32x4 c = h >> contour_height_scale;
+  c = h > 0 ? c : Int32x4{};
+  c = c > 254 ? Splat(254) : c;
+
+  const UInt8x4 v = __builtin_convertvector(c, UInt8x4);
+  memcpy(result, &v, sizeof(v));
+}
+
+static void
+ContourIntervals(const TerrainHeight *p, unsigned n,
+                 unsigned contour_height_scale,
+                 uint8_t *result) noexcept
+{
+  unsigned i = 0;
+  for (; i + 4 <= n; i += 4)
+    ContourInterval4(p + i, contour_height_scale, result + i);
+
+  for (; i < n; ++i)
+    result[i] = ContourInterval(p[i], contour_height_scale);
+}
+
+bool
+RasterShading::IsSIMDAvailable() noexcept
+{
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+RasterShading::ContourStart() const noexcept
+{
+  // initialise column to first row
+  if (simd) {
+    ContourIntervals(src, size.x, contour_height_scale,
+                     contour_column_base);
+    return;
+  }
+
+  const auto *p = src;
+  uint8_t *col_base = contour_column_base;
+  for (unsigned x = size.x; x > 0; --x)
+    *col_base++ = ContourInterval(*p++, contour_height_scale);
+}
+
+template<bool SIMD>
+static void
+GenerateUnshadedImage(const RasterShading &s) noexcept
+{
+  const auto *src = s.src;
+  const RawColor *oColorBuf = s.color_table + 64 * 256;
+  RawColor *dest = s.dest;
+
+  uint8_t intervals[CHUNK];
+
+  for (unsigned y = s.size.y; y > 0; --y) {
+    RawColor *p = dest;
+    dest += s.dest_pitch;
+
+    unsigned contour_row_base = ContourInterval(*src, s.contour_height_scale);
+    uint8_t *contour_this_column_base = s.contour_column_base;
+
+    for (unsigned x0 = 0; x0 < s.size.x; x0 += CHUNK) {
+      const unsigned n = std::min(CHUNK, s.size.x - x0);
+      if constexpr (SIMD)
+        ContourIntervals(src, n, s.contour_height_scale, intervals);
+
+      for (unsigned i = 0; i < n; ++i) {
+        const auto e = *src++;
+        if (!e.IsSpecial()) [[likely]] {
+          unsigned h = std::max(0, (int)e.GetValue());
+
+          const unsigned contour_interval = SIMD
+            ? intervals[i]
+            : ContourInterval(h, s.contour_height_scale);
+
+          h = std::min(254u, h >> s.height_scale);
+          if (contour_interval != contour_row_base ||
+              contour_interval != *contour_this_column_base) [[unlikely]] {
+            *p++ = oColorBuf[(int)h - 64 * 256];
+            *contour_this_column_base = contour_row_base = contour_interval;
+          } else {
+            *p++ = oColorBuf[h];
+          }
+        } else if (e.IsWater()) {
+          // we're in the water, so look up the color for water
+          *p++ = oColorBuf[255];
+        } else {
+          /* outside the terrain file bounds: white background */
+          *p++ = RawColor(0xff, 0xff, 0xff);
+        }
+        contour_this_column_base++;
+      }
+    }
+  }
+}
+
+void
+RasterShading::GenerateUnshadedImage() const noexcept
+{
+  if (simd)
+    ::GenerateUnshadedImage<true>(*this);
+  else
+    ::GenerateUnshadedImage<false>(*this);
+}
+
+// JMW: if zoomed right in (e.g. one unit is larger than terrain
+// grid), then increase the step size to be equal to the terrain
+// grid for purposes of calculating slope, to avoid shading problems
+// (gridding of display) This is why quantisation_effective is used instead of 1
+// previously.  for large zoom levels, quantisation_effective=1
+template<bool SIMD>
+static void
+GenerateSlopeImage(const RasterShading &s, int contrast,
+                   const int sx, const int sy, const int sz,
+                   const unsigned quantisation_effective,
+                   const unsigned height_slope_factor) noexcept
+{
+  assert(quantisation_effective > 0);
+
+  const auto size = s.size;
+
+  /* the interior, i.e. the pixels which have neighbours in the full
+     distance (these may wrap around if the image is very small,
+     which is handled below) */
+  const unsigned border_left = quantisation_effective;
+  const unsigned border_right = size.x - quantisation_effective;
+  const unsigned border_bottom = size.y - quantisation_effective;
+
+  /* the pixels handled by the vector code; their neighbours must be
+     inside the matrix */
+  const unsigned simd_right = size.x > 2 * quantisation_effective
+    ? border_right
+    : 0;
+
+  const auto *src = s.src;
+  const RawColor *oColorBuf = s.color_table + 64 * 256;
+
+  RawColor *dest = s.dest;
+
+  uint8_t intervals[CHUNK];
+  int8_t slopes[CHUNK];
+
+  for (unsigned y = 0; y < size.y; ++y) {
+    const unsigned row_plus_index = y < border_bottom
+      ? quantisation_effective
+      : size.y - 1 - y;
+    const unsigned row_plus_offset = size.x * row_plus_index;
+
+    const unsigned row_minus_index = y >= quantisation_effective
+      ? quantisation_effective : y;
+    const unsigned row_minus_offset = size.x * row_minus_index;
+
+    const unsigned p31 = row_plus_index + row_minus_index;
+
+    const SlopeRow row{
+      sx, sy, sz, contrast,
+      2 * quantisation_effective, p31,
+      height_slope_factor,
+      2 * quantisation_effective * p31 * height_slope_factor,
+    };
+
+    RawColor *p = dest;
+    dest += s.dest_pitch;
+
+    unsigned contour_row_base = ContourInterval(*src, s.contour_height_scale);
+    uint8_t *contour_this_column_base = s.contour_column_base;
+
+    for (unsigned x0 = 0; x0 < size.x; x0 += CHUNK) {
+      const unsigned n = std::min(CHUNK, size.x - x0);
+
+      /* the interior pixels of this chunk which are calculated by
+         the vector code */
+      unsigned simd_begin = 0, simd_end = 0;
+
+      if constexpr (SIMD) {
+        ContourIntervals(src, n, s.contour_height_scale, intervals);
+
+        simd_begin = std::max(x0, border_left);
+        simd_end = std::min(x0 + n, simd_right);
+        if (simd_begin < simd_end) {
+          simd_end = simd_begin + (simd_end - simd_begin) / 4 * 4;
+          for (unsigned x = simd_begin; x < simd_end; x += 4)
+            SlopeIndex4(row, src + (x - x0),
+                        row_minus_offset, row_plus_offset,
+                        quantisation_effective, slopes + (x - x0));
+        } else
+          simd_begin = simd_end = 0;
+      }
+
+      for (unsigned x = x0; x < x0 + n; ++x, ++src) {
+        const auto e = *src;
+        if (!e.IsSpecial()) [[likely]] {
+          unsigned h = std::max(0, (int)e.GetValue());
+
+          const unsigned contour_interval = SIMD
+            ? intervals[x - x0]
+            : ContourInterval(h, s.contour_height_scale);
+
+          h = std::min(254u, h >> s.height_scale);
+
+          int sindex = 0;
+          unsigned p20 = 0;
+          int p22 = 0, p32 = 0;
+
+          const bool vectorised = SIMD && x >= simd_begin && x < simd_end;
+          bool special_neighbour;
+          if (vectorised) {
+            sindex = slopes[x - x0];
+            special_neighbour = sindex == SPECIAL_NEIGHBOUR;
+          } else {
+            // no need to calculate slope if undefined height or sea level
+
+            // Y direction
+            assert(src - row_minus_offset >= s.src);
+            assert(src + row_plus_offset >= s.src);
+            assert(src - row_minus_offset < s.src + size.Area());
+            assert(src + row_plus_offset < s.src + size.Area());
+
+            // X direction
+
+            const unsigned column_plus_index = x < border_right
+              ? quantisation_effective
+              : size.x - 1 - x;
+            const unsigned column_minus_index = x >= border_left
+              ? quantisation_effective : x;
+
+            assert(src - column_minus_index >= s.src);
+            assert(src + column_plus_index >= s.src);
+            assert(src - column_minus_index < s.src + size.Area());
+            assert(src + column_plus_index < s.src + size.Area());
+
+            const auto h_above = src[-(int)row_minus_offset];
+            const auto h_below = src[row_plus_offset];
+            const auto h_left = src[-(int)column_minus_index];
+            const auto h_right = src[column_plus_index];
+
+            special_neighbour = h_above.IsSpecial() || h_below.IsSpecial() ||
+              h_left.IsSpecial() || h_right.IsSpecial();
+
+            p32 = ClipHeightDelta(h_above, h_below);
+            p22 = ClipHeightDelta(h_right, h_left);
+            p20 = column_plus_index + column_minus_index;
+          }
+
+          if (special_neighbour) [[unlikely]] {
+            /* some "special" terrain value surrounding us (water or
+               invalid), skip slope calculation */
+            *p++ = oColorBuf[h];
+            contour_this_column_base++;
+            continue;
+          }
+
+          if (contour_interval != contour_row_base ||
+              contour_interval != *contour_this_column_base) [[unlikely]] {
+
+            *contour_this_column_base++ = contour_row_base = contour_interval;
+            *p++ = oColorBuf[int(h) - 64 * 256];
+            continue;
+          }
+
+          if (!vectorised)
+            sindex = SlopeIndex(row, p20, p22, p32);
+
+          *p++ = oColorBuf[int(h) + 256 * sindex];
+        } else if (e.IsWater()) {
+          // we're in the water, so look up the color for water
+          *p++ = oColorBuf[255];
+        } else {
+          /* outside the terrain file bounds: white background */
+          *p++ = RawColor(0xff, 0xff, 0xff);
+        }
+        contour_this_column_base++;
+      }
+    }
+  }
+}
+
+void
+RasterShading::GenerateSlopeImage(int contrast, int sx, int sy, int sz,
+                                  unsigned quantisation_effective,
+                                  unsigned height_slope_factor) const noexcept
+{
+  if (simd)
+    ::GenerateSlopeImage<true>(*this, contrast, sx, sy, sz,
+                               quantisation_effective, height_slope_factor);
+  else
+    ::GenerateSlopeImage<false>(*this, contrast, sx, sy, sz,
+                                quantisation_effective, height_slope_factor);
+}
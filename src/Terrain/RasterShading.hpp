@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Height.hpp"
+#include "Math/Point2D.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+struct RawColor;
+
+/**
+ * The pixel loops of #RasterRenderer which convert a height matrix
+ * to an image, using the color table prepared by
+ * RasterRenderer::PrepareColorTable().
+ *
+ * There are two implementations: a portable one and a vectorised one
+ * (SSE2/NEON, via gcc vector extensions) which calculates slopes and
+ * contour intervals of several pixels at a time.  Both produce
+ * bit-identical output.
+ */
+struct RasterShading {
+  /**
+   * The height matrix (row-major, #size.x values per row).
+   */
+  const TerrainHeight *src;
+
+  UnsignedPoint2D size;
+
+  /**
+   * 256 heights times 128 illumination levels, see
+   * RasterRenderer::PrepareColorTable().
+   */
+  const RawColor *color_table;
+
+  /**
+   * The top-most row of the destination image.
+   */
+  RawColor *dest;
+
+  /**
+   * The distance between two rows in #dest (in pixels).  This is
+   * negative for bottom-up bitmaps (WIN32).
+   */
+  std::ptrdiff_t dest_pitch;
+
+  /**
+   * A buffer with #size.x elements which stores the contour interval
+   * of the previous row.
+   */
+  uint8_t *contour_column_base;
+
+  unsigned height_scale, contour_height_scale;
+
+  /**
+   * Use the vectorised implementation?
+   */
+  bool simd;
+
+  /**
+   * Does this CPU have a vector unit which makes the vectorised
+   * implementation worthwhile?  Without one, the compiler emulates
+   * vectors with scalar code, which works, but is slower than the
+   * portable implementation.
+   */
+  [[gnu::const]]
+  static bool IsSIMDAvailable() noexcept;
+
+  /**
+   * Initialise #contour_column_base with the first row.
+   */
+  void ContourStart() const noexcept;
+
+  void GenerateUnshadedImage() const noexcept;
+
+  /**
+   * @param sx, sy, sz the light source vector
+   * @param quantisation_effective the step size for slope
+   * calculations (non-zero)
+   */
+  void GenerateSlopeImage(int contrast, int sx, int sy, int sz,
+                          unsigned quantisation_effective,
+                          unsigned height_slope_factor) const noexcept;
+};
@@ -3,6 +3,7 @@
 
 #include "RasterTerrain.hpp"
 #include "Loader.hpp"
+#include "RawTileStore.hpp"
 #include "Profile/Profile.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/FileCache.hpp"
@@ -12,11 +13,26 @@
 #include "io/BufferedReader.hxx"
 #include "system/ConvertPathName.hpp"
 #include "Operation/Operation.hpp"
+#include "thread/ThreadPool.hpp"
 #include "util/ConvertString.hpp"
 #include "LogFile.hpp"
 
+#include <algorithm>
+
 static const TCHAR *const terrain_cache_name = _T("terrain");
 
+/**
+ * The maximum number of threads decoding JPEG2000 tiles.  Each one
+ * makes a separate pass over the file, so more threads have
+ * diminishing returns.
+ */
+static constexpr unsigned MAX_DECODE_THREADS = 4;
+
+RasterTerrain::RasterTerrain(ZipArchive &&_archive) noexcept
+  :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+
+RasterTerrain::~RasterTerrain() noexcept = default;
+
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
 {
@@ -45,13 +61,64 @@ RasterTerrain::SaveCache(FileCache &cache, Path path) const
   os->Commit();
 }
 
+inline void
+RasterTerrain::OpenRawTiles(FileCache *cache, Path path) noexcept
+{
+  if (cache == nullptr)
+    return;
+
+  try {
+    auto store = RawTileStore::Open(*cache, path);
+    if (!store)
+      return;
+
+    if (!store->IsCompatible(map.GetTileCache())) {
+      LogString("Raw terrain tile store does not match the terrain");
+      return;
+    }
+
+    raw_tiles = std::move(store);
+  } catch (...) {
+    LogError(std::current_exception(),
+             "Failed to open raw terrain tile store");
+  }
+}
+
+inline void
+RasterTerrain::OpenDecodePool(Path path) noexcept
+{
+  const unsigned n_threads =
+    std::min(ThreadPool::GetProcessorCount(), MAX_DECODE_THREADS);
+  if (n_threads <= 1)
+    return;
+
+  try {
+    for (unsigned i = 1; i < n_threads; ++i)
+      extra_archives.emplace_back(path);
+
+    decode_dirs.push_back(archive.get());
+    for (auto &i : extra_archives)
+      decode_dirs.push_back(i.get());
+
+    decode_pool = std::make_unique<ThreadPool>("TerrainDecode",
+                                               n_threads - 1);
+  } catch (...) {
+    LogError(std::current_exception(),
+             "Failed to start terrain decoder threads");
+    decode_dirs.clear();
+    extra_archives.clear();
+  }
+}
+
 inline void
 RasterTerrain::Load(Path path, FileCache *cache,
                     OperationEnvironment &operation)
 {
   try {
-    if (LoadCache(cache, path))
+    if (LoadCache(cache, path)) {
+      OpenRawTiles(cache, path);
       return;
+    }
   } catch (...) {
     LogError(std::current_exception(), "Failed to load terrain cache");
   }
@@ -67,6 +134,8 @@ RasterTerrain::Load(Path path, FileCache *cache,
       LogError(std::current_exception(), "Failed to save terrain cache");
     }
   }
+
+  OpenRawTiles(cache, path);
 }
 
 std::unique_ptr<RasterTerrain>
@@ -75,6 +144,8 @@ RasterTerrain::OpenTerrain(FileCache *cache, Path path,
 {
   auto rt = std::make_unique<RasterTerrain>(ZipArchive{path});
   rt->Load(path, cache, operation);
+  if (rt->raw_tiles == nullptr)
+    rt->OpenDecodePool(path);
   return rt;
 }
 
@@ -99,8 +170,18 @@ RasterTerrain::UpdateTiles(const GeoPoint &location, double radius) noexcept
     return false;
 
   try {
-    UpdateTerrainTiles(archive.get(), tile_cache, mutex,
-                       map.GetProjection(), location, radius);
+    if (raw_tiles != nullptr) {
+      if (UpdateTerrainTiles(*raw_tiles, tile_cache, mutex,
+                             map.GetProjection(), location, radius))
+        /* some tiles are missing in the store; decode them from
+           the JPEG2000 file */
+        LoadRequestedTerrainTiles(archive.get(), tile_cache, mutex);
+    } else if (decode_pool != nullptr)
+      UpdateTerrainTiles(*decode_pool, decode_dirs, tile_cache, mutex,
+                         map.GetProjection(), location, radius);
+    else
+      UpdateTerrainTiles(archive.get(), tile_cache, mutex,
+                         map.GetProjection(), location, radius);
   } catch (...) {
     LogError(std::current_exception(), "Failed to update terrain tiles");
   }
@@ -9,9 +9,12 @@
 #include "io/ZipArchive.hpp"
 
 #include <memory>
+#include <vector>
 
 class Path;
 class FileCache;
+class RawTileStore;
+class ThreadPool;
 class OperationEnvironment;
 
 /**
@@ -27,14 +30,40 @@ public:
 private:
   ZipArchive archive;
 
+  /**
+   * Additional handles to the terrain file for the threads of
+   * #decode_pool (libzzip is not thread-safe).
+   */
+  std::vector<ZipArchive> extra_archives;
+
+  /**
+   * The #zzip_dir of #archive followed by those of #extra_archives.
+   */
+  std::vector<struct zzip_dir *> decode_dirs;
+
+  /**
+   * If set, then requested tiles are decoded by multiple threads.
+   * This is only used on multi-core CPUs.
+   */
+  std::unique_ptr<ThreadPool> decode_pool;
+
+  /**
+   * The optional pre-decoded tiles; if this is set, then tiles are
+   * loaded from here instead of being decoded from #archive (except
+   * for tiles which are missing in the store).  This must be
+   * declared before #map, because the tiles refer to its memory.
+   */
+  std::unique_ptr<RawTileStore> raw_tiles;
+
   RasterMap map;
 
 public:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(ZipArchive &&_archive) noexcept
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+  explicit RasterTerrain(ZipArchive &&_archive) noexcept;
+
+  ~RasterTerrain() noexcept;
 
   const Serial &GetSerial() const noexcept {
     return map.GetSerial();
@@ -84,6 +113,17 @@ private:
    */
   void SaveCache(FileCache &cache, Path path) const;
 
+  /**
+   * Attempt to map the #RawTileStore from the #FileCache.
+   */
+  void OpenRawTiles(FileCache *cache, Path path) noexcept;
+
+  /**
+   * Prepare for decoding tiles with multiple threads.  Does nothing
+   * on single-core CPUs.
+   */
+  void OpenDecodePool(Path path) noexcept;
+
   /**
    * Throws on error.
    */
@@ -27,11 +27,12 @@ RasterTile::LoadCache(BufferedReader &r)
   Set(data.start, data.end);
 }
 
-void
-RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
+RasterBuffer
+RasterTile::Convert(const struct jas_matrix &m) const noexcept
 {
+  RasterBuffer buffer;
   if (!IsDefined())
-    return;
+    return buffer;
 
   buffer.Resize(size);
 
@@ -46,6 +47,8 @@ RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
     for (unsigned i = 0; i < width; ++i)
       *dest++ = TerrainHeight(src[i]);
   }
+
+  return buffer;
 }
 
 TerrainHeight
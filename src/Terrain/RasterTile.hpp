@@ -6,6 +6,10 @@
 #include "RasterTraits.hpp"
 #include "RasterLocation.hpp"
 #include "RasterBuffer.hpp"
+#include "HeightPyramid.hpp"
+
+#include <optional>
+#include <utility>
 
 struct jas_matrix;
 class BufferedOutputStream;
@@ -29,6 +33,12 @@ public:
 
   RasterBuffer buffer;
 
+  /**
+   * The maximum heights of #buffer; only defined while the tile is
+   * loaded.
+   */
+  HeightPyramid pyramid;
+
 public:
   RasterTile() noexcept = default;
 
@@ -79,13 +89,45 @@ public:
 
   void Unload() noexcept {
     buffer.Reset();
+    pyramid.Reset();
   }
 
   bool IsLoaded() const noexcept {
     return buffer.IsDefined();
   }
 
-  void CopyFrom(const struct jas_matrix &m) noexcept;
+  /**
+   * Convert the decoded JPEG2000 matrix to a #RasterBuffer suitable
+   * for this tile.  This does not modify the tile, and thus does not
+   * need to be protected by the terrain lock; pass the result (and
+   * its #HeightPyramid) to Install().
+   *
+   * @return an undefined buffer if the tile is not defined
+   */
+  RasterBuffer Convert(const struct jas_matrix &m) const noexcept;
+
+  /**
+   * @param _pyramid the pyramid built from #_buffer
+   */
+  void Install(RasterBuffer &&_buffer, HeightPyramid &&_pyramid) noexcept {
+    buffer = std::move(_buffer);
+    pyramid = std::move(_pyramid);
+  }
+
+  /**
+   * Refer to pre-decoded data (e.g. from a #RawTileStore) instead of
+   * copying it.  The memory must remain valid until the tile gets
+   * unloaded.
+   *
+   * @param cells the #HeightPyramid cells of the data (see
+   * HeightPyramid::Generate())
+   */
+  void MapFrom(const TerrainHeight *data, const int16_t *cells) noexcept {
+    if (IsDefined()) {
+      buffer.SetExternal(data, size);
+      pyramid.SetExternal(cells, size);
+    }
+  }
 
   /**
    * Determine the non-interpolated height at the specified pixel
@@ -110,6 +152,27 @@ public:
   TerrainHeight GetInterpolatedHeight(unsigned x, unsigned y,
                                       unsigned ix, unsigned iy) const noexcept;
 
+  /**
+   * Determine an upper bound for the heights within the given
+   * rectangle (see HeightPyramid::GetMaximum()).
+   *
+   * @param min, max the pixel rectangle (inclusive) within the map;
+   * must be inside this tile
+   */
+  [[gnu::pure]]
+  std::optional<int> GetMaximumHeight(RasterLocation min,
+                                      RasterLocation max) const noexcept {
+    assert(IsLoaded());
+    assert(min.x >= start.x && min.y >= start.y);
+
+    min -= start;
+    max -= start;
+
+    assert(max.x < size.x && max.y < size.y);
+
+    return pyramid.GetMaximum(min, max);
+  }
+
   bool VisibilityChanged(IntPoint2D view, unsigned view_radius) noexcept;
 
   void ScanLine(RasterLocation a, RasterLocation b,
@@ -119,4 +182,13 @@ public:
                     b - (start << RasterTraits::SUBPIXEL_BITS),
                     dest, dest_size, interpolate);
   }
+
+  void ScanLineRange(RasterLocation a, RasterLocation b,
+                     TerrainHeight *dest, unsigned dest_size,
+                     unsigned begin, unsigned end,
+                     bool interpolate) const noexcept {
+    buffer.ScanLineRange(a - (start << RasterTraits::SUBPIXEL_BITS),
+                         b - (start << RasterTraits::SUBPIXEL_BITS),
+                         dest, dest_size, begin, end, interpolate);
+  }
 };
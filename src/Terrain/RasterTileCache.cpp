@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "RasterTileCache.hpp"
+#include "RawTileStore.hpp"
 #include "Math/Angle.hpp"
 #include "io/BufferedOutputStream.hxx"
 #include "io/BufferedReader.hxx"
@@ -56,15 +57,62 @@ RasterTileCache::PutOverviewTile(unsigned index,
     CopyOverviewRow(dest, m.rows_[y], width, skip);
 }
 
+RasterBuffer
+RasterTileCache::ConvertTileData(unsigned index,
+                                 const struct jas_matrix &m) const noexcept
+{
+  const auto &tile = tiles.GetLinear(index);
+  if (!tile.IsRequested())
+    return {};
+
+  return tile.Convert(m);
+}
+
 void
-RasterTileCache::PutTileData(unsigned index,
-                             const struct jas_matrix &m) noexcept
+RasterTileCache::PutTileData(unsigned index, RasterBuffer &&buffer,
+                             HeightPyramid &&pyramid) noexcept
 {
   auto &tile = tiles.GetLinear(index);
   if (!tile.IsRequested())
     return;
 
-  tile.CopyFrom(m);
+  tile.Install(std::move(buffer), std::move(pyramid));
+}
+
+std::vector<uint16_t>
+RasterTileCache::GetRequestedTiles() const noexcept
+{
+  std::vector<uint16_t> result;
+
+  for (const auto i : request_tiles)
+    if (tiles.GetLinear(i).IsRequested())
+      result.push_back(i);
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+bool
+RasterTileCache::MapRequestedTiles(const RawTileStore &store) noexcept
+{
+  bool complete = true;
+
+  for (std::size_t i : request_tiles) {
+    RasterTile &tile = tiles.GetLinear(i);
+    if (!tile.IsRequested())
+      continue;
+
+    const auto data = store.GetTile(i, tile.start, tile.end);
+    if (data) {
+      tile.MapFrom(data->heights, data->pyramid);
+
+      /* don't let the JPEG2000 decoder load this one again */
+      tile.ClearRequest();
+    } else
+      complete = false;
+  }
+
+  return complete;
 }
 
 struct RTDistanceSort {
@@ -215,6 +263,7 @@ RasterTileCache::Reset() noexcept
   segments.clear();
 
   overview.Reset();
+  overview_pyramid.Reset();
 
   for (auto &i : tiles)
     i.Unload();
@@ -336,4 +385,6 @@ RasterTileCache::LoadCache(BufferedReader &r)
         overview.GetData(),
         overview_size,
       }));
+
+  FinishOverview();
 }
@@ -5,6 +5,7 @@
 
 #include "RasterTraits.hpp"
 #include "RasterTile.hpp"
+#include "HeightPyramid.hpp"
 #include "RasterLocation.hpp"
 #include "Geo/GeoBounds.hpp"
 #include "util/StaticArray.hxx"
@@ -13,11 +14,13 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 static constexpr unsigned  RASTER_SLOPE_FACT = 12;
 
 struct jas_matrix;
 struct GridLocation;
+class RawTileStore;
 class BufferedOutputStream;
 class BufferedReader;
 
@@ -98,6 +101,12 @@ protected:
   Point2D<uint_least16_t> tile_size;
 
   RasterBuffer overview;
+
+  /**
+   * The maximum heights of #overview, see FinishOverview().
+   */
+  HeightPyramid overview_pyramid;
+
   RasterLocation size;
   RasterLocation overview_size_fine;
 
@@ -112,6 +121,13 @@ protected:
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  /**
+   * Shall FirstIntersection() and GroundIntersection() jump directly
+   * from one sample to the next one, and skip samples which are known
+   * to be clear of the terrain (see #HeightPyramid)?
+   */
+  bool fast_intersection = true;
+
 public:
   RasterTileCache() noexcept {
     Reset();
@@ -126,9 +142,23 @@ public:
     bounds = _bounds;
   }
 
+  /**
+   * Disable the optimisations of FirstIntersection() and
+   * GroundIntersection() (which do not change the results).  This is
+   * only useful for testing and benchmarking.
+   */
+  void SetFastIntersection(bool _fast_intersection) noexcept {
+    fast_intersection = _fast_intersection;
+  }
+
 protected:
+  /**
+   * Scan the part of a line within one tile, but only the samples
+   * [begin, end) of the whole line.
+   */
   void ScanTileLine(GridLocation start, GridLocation end,
                     TerrainHeight *buffer, unsigned size,
+                    unsigned begin, unsigned end_index,
                     bool interpolate) const noexcept;
 
 public:
@@ -159,7 +189,19 @@ public:
    */
   void ScanLine(const RasterLocation start, const RasterLocation end,
                 TerrainHeight *buffer, unsigned size,
-                bool interpolate) const noexcept;
+                bool interpolate) const noexcept {
+    ScanLineRange(start, end, buffer, size, 0, size, interpolate);
+  }
+
+  /**
+   * Like ScanLine(), but calculate only the samples [begin, end_index),
+   * with exactly the same values.  The rest of the buffer is not
+   * touched.
+   */
+  void ScanLineRange(const RasterLocation start, const RasterLocation end,
+                     TerrainHeight *buffer, unsigned size,
+                     unsigned begin, unsigned end_index,
+                     bool interpolate) const noexcept;
 
   struct Intersection {
     RasterLocation location;
@@ -185,6 +227,45 @@ public:
                      int height_floor) const noexcept;
 
 private:
+  class LineSteps;
+
+  /**
+   * Determine an upper bound for the terrain heights which
+   * GetFieldDirect() returns within the given rectangle.
+   *
+   * @param min, max the pixel rectangle (inclusive); must be inside
+   * the tile which contains #min
+   * @return the maximum height or std::nullopt if unknown
+   */
+  [[gnu::pure]]
+  std::optional<int> GetMaximumHeight(RasterLocation min,
+                                      RasterLocation max) const noexcept;
+
+  /**
+   * Called by FirstIntersection() and GroundIntersection() after a
+   * sample has been found to be clear of the terrain: if the
+   * #HeightPyramid shows that the terrain below the following
+   * iterations (up to the edge of the current tile) is low enough,
+   * walk over them without looking up the terrain.
+   *
+   * @param step the number of steps between two samples
+   * @param limit the last iteration which may be skipped
+   * @param span the number of iterations to try; adjusted according
+   * to the success
+   * @param clear a function which checks whether the samples between
+   * the two given total step numbers are clear of the given terrain
+   * height
+   * @param last_location, last_steps receive the location and the
+   * total number of steps of the last skipped sample
+   * @return true if at least one sample has been skipped
+   */
+  template<typename L, typename F>
+  bool SkipClearSamples(const LineSteps &line, L &location, int &err,
+                        int &total_steps, unsigned &step_counter,
+                        unsigned step, int limit, unsigned &span,
+                        RasterLocation &last_location, int &last_steps,
+                        F &&clear) const noexcept;
+
   /**
    * Get field (not interpolated) directly, without bringing tiles to front.
    * @param p position/256
@@ -258,9 +339,42 @@ public:
                        RasterLocation start, RasterLocation end,
                        const struct jas_matrix &m) noexcept;
 
+  /**
+   * Called after the overview has been loaded completely.
+   */
+  void FinishOverview() noexcept {
+    overview_pyramid.Build(overview);
+  }
+
   bool PollTiles(SignedRasterLocation p, unsigned radius) noexcept;
 
-  void PutTileData(unsigned index, const struct jas_matrix &m) noexcept;
+  /**
+   * Convert decoded tile data for PutTileData().  This method does
+   * not modify this object and may be called without holding the
+   * terrain lock.
+   *
+   * @return an undefined buffer if the tile was not requested
+   */
+  RasterBuffer ConvertTileData(unsigned index,
+                               const struct jas_matrix &m) const noexcept;
+
+  void PutTileData(unsigned index, RasterBuffer &&buffer,
+                   HeightPyramid &&pyramid) noexcept;
+
+  /**
+   * Returns the indexes of all tiles which were requested by the
+   * last PollTiles() call, in ascending order.
+   */
+  std::vector<uint16_t> GetRequestedTiles() const noexcept;
+
+  /**
+   * Let all requested tiles refer to the pre-decoded data in the
+   * given #RawTileStore (instead of decoding them with libjasper).
+   * Tiles which are not in the store remain requested.
+   *
+   * @return true if all requested tiles were found in the store
+   */
+  bool MapRequestedTiles(const RawTileStore &store) noexcept;
 
   void FinishTileUpdate() noexcept;
 
@@ -280,6 +394,18 @@ public:
     return size;
   }
 
+  /**
+   * Returns the size of a tile (in pixels); the tiles at the right
+   * and bottom edge may be smaller.
+   */
+  RasterLocation GetTileSize() const noexcept {
+    return {tile_size.x, tile_size.y};
+  }
+
+  UnsignedPoint2D GetTileCount() const noexcept {
+    return {tiles.GetWidth(), tiles.GetHeight()};
+  }
+
   RasterLocation GetFineSize() const noexcept {
     return size << RasterTraits::SUBPIXEL_BITS;
   }
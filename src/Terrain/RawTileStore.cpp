@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "RawTileStore.hpp"
+#include "RasterTileCache.hpp"
+#include "RasterProjection.hpp"
+#include "HeightPyramid.hpp"
+#include "io/FileCache.hpp"
+#include "io/FileMapping.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "util/Compiler.h"
+
+extern "C" {
+#include "jasper/jas_seq.h"
+}
+
+#include <cassert>
+#include <stdexcept>
+
+#include <string.h>
+
+RawTileStore::RawTileStore(std::unique_ptr<FileMapping> &&_mapping,
+                           std::span<const std::byte> _payload)
+  :mapping(std::move(_mapping)), payload(_payload)
+{
+  if (payload.size() < sizeof(footer))
+    throw std::runtime_error("Raw terrain tile store too small");
+
+  /* copy the footer, because it may not be aligned properly */
+  memcpy(&footer, payload.data() + payload.size() - sizeof(footer),
+         sizeof(footer));
+
+  if (footer.magic != RawTileFooter::MAGIC ||
+      footer.version != RawTileFooter::VERSION)
+    throw std::runtime_error("Wrong raw terrain tile store version");
+
+  const std::size_t n = footer.n_tiles.Area();
+  if (n == 0 || n > 64 * 1024 ||
+      footer.table_offset > payload.size() - sizeof(footer) ||
+      n * sizeof(RawTileEntry) >
+      payload.size() - sizeof(footer) - footer.table_offset)
+    throw std::runtime_error("Malformed raw terrain tile store");
+}
+
+RawTileStore::~RawTileStore() noexcept = default;
+
+std::unique_ptr<RawTileStore>
+RawTileStore::Open(FileCache &cache, Path original_path)
+{
+  auto mapping = cache.Map(CACHE_NAME, original_path);
+  if (!mapping)
+    return nullptr;
+
+  const auto payload = FileCache::SkipHeader(*mapping);
+  return std::make_unique<RawTileStore>(std::move(mapping), payload);
+}
+
+bool
+RawTileStore::IsCompatible(const RasterTileCache &rtc) const noexcept
+{
+  return rtc.IsValid() &&
+    footer.size == rtc.GetSize() &&
+    footer.n_tiles == rtc.GetTileCount();
+}
+
+std::optional<RawTileStore::Tile>
+RawTileStore::GetTile(unsigned index,
+                      RasterLocation start,
+                      RasterLocation end) const noexcept
+{
+  if (index >= footer.n_tiles.Area())
+    return std::nullopt;
+
+  RawTileEntry entry;
+  memcpy(&entry, payload.data() + footer.table_offset
+         + index * sizeof(entry), sizeof(entry));
+
+  if (!entry.IsDefined() || entry.start != start || entry.end != end)
+    return std::nullopt;
+
+  const auto size = end - start;
+  const std::size_t n_height_bytes = size.Area() * sizeof(TerrainHeight);
+  const std::size_t n_bytes = n_height_bytes +
+    HeightPyramid::GetCellCount(size) * sizeof(int16_t);
+  if (entry.offset % alignof(TerrainHeight) != 0 ||
+      entry.offset > footer.table_offset ||
+      n_bytes > footer.table_offset - entry.offset)
+    return std::nullopt;
+
+  const std::byte *p = payload.data() + entry.offset;
+  if (reinterpret_cast<std::uintptr_t>(p) % alignof(TerrainHeight) != 0)
+    return std::nullopt;
+
+  static_assert(sizeof(TerrainHeight) % alignof(int16_t) == 0);
+
+  return Tile{
+    reinterpret_cast<const TerrainHeight *>(p),
+    reinterpret_cast<const int16_t *>(p + n_height_bytes),
+  };
+}
+
+void
+RawTileWriter::Pad(std::size_t alignment)
+{
+  static constexpr std::byte zero[16]{};
+  assert(alignment <= sizeof(zero));
+
+  const std::size_t n = (alignment - position % alignment) % alignment;
+  os.Write(std::span{zero, n});
+  position += n;
+}
+
+void
+RawTileWriter::PutTile(unsigned index,
+                       RasterLocation start, RasterLocation end,
+                       const struct jas_matrix &m) noexcept
+{
+  if (error)
+    /* an earlier tile has failed already */
+    return;
+
+  try {
+    WriteTile(index, start, end, m);
+  } catch (...) {
+    /* don't let the exception propagate through libjasper; it will
+       be rethrown by Finish() */
+    error = std::current_exception();
+  }
+}
+
+inline void
+RawTileWriter::WriteTile(unsigned index,
+                         RasterLocation start, RasterLocation end,
+                         const struct jas_matrix &m)
+{
+  const unsigned width = m.numcols_, height = m.numrows_;
+  if (end.x - start.x != width || end.y - start.y != height)
+    /* shouldn't happen */
+    return;
+
+  if (index >= table.size())
+    table.resize(index + 1, RawTileEntry{0, {0, 0}, {0, 0}});
+
+  Pad(alignof(TerrainHeight));
+
+  if (position > UINT32_MAX)
+    throw std::runtime_error("Raw terrain tile store too large");
+
+  table[index] = RawTileEntry{uint32_t(position), start, end};
+
+  heights.resize(std::size_t(width) * height);
+
+  auto *gcc_restrict dest = heights.data();
+  for (unsigned y = 0; y != height; ++y) {
+    const jas_seqent_t *gcc_restrict src = m.rows_[y];
+
+    for (unsigned x = 0; x < width; ++x)
+      *dest++ = TerrainHeight(src[x]);
+  }
+
+  /* the pyramid is stored right after the heights, so mapping a tile
+     doesn't need to read all of its pages to build it */
+  const RasterLocation tile_size{width, height};
+  pyramid.resize(HeightPyramid::GetCellCount(tile_size));
+  HeightPyramid::Generate(heights.data(), tile_size, pyramid.data());
+
+  os.Write(std::as_bytes(std::span{heights}));
+  os.Write(std::as_bytes(std::span{pyramid}));
+
+  position += heights.size() * sizeof(TerrainHeight) +
+    pyramid.size() * sizeof(int16_t);
+}
+
+void
+RawTileWriter::Finish()
+{
+  if (error)
+    std::rethrow_exception(error);
+
+  if (n_tiles.Area() == 0)
+    throw std::runtime_error("No tiles");
+
+  if (table.size() > n_tiles.Area())
+    throw std::runtime_error("Bad tile index");
+
+  table.resize(n_tiles.Area(), RawTileEntry{0, {0, 0}, {0, 0}});
+
+  Pad(alignof(RawTileEntry));
+
+  if (position > UINT32_MAX)
+    throw std::runtime_error("Raw terrain tile store too large");
+
+  RawTileFooter footer;
+
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset(&footer, 0, sizeof(footer));
+
+  footer.magic = RawTileFooter::MAGIC;
+  footer.version = RawTileFooter::VERSION;
+  footer.size = size;
+  footer.n_tiles = n_tiles;
+  footer.table_offset = position;
+
+  os.Write(std::as_bytes(std::span{table}));
+  os.WriteT(footer);
+}
+
+bool
+UpdateTerrainTiles(const RawTileStore &store,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   SignedRasterLocation p, unsigned radius) noexcept
+{
+  if (!raster_tile_cache.IsValid())
+    return false;
+
+  /* installing a tile costs only a few pointer assignments (the
+     actual data is paged in later on demand), so there's no point in
+     releasing the lock in between */
+  const std::lock_guard lock{mutex};
+
+  if (!raster_tile_cache.PollTiles(p, radius))
+    /* nothing to do */
+    return false;
+
+  if (!raster_tile_cache.MapRequestedTiles(store))
+    /* LoadRequestedTerrainTiles() will decode the missing tiles and
+       then call FinishTileUpdate() */
+    return true;
+
+  raster_tile_cache.FinishTileUpdate();
+  return false;
+}
+
+bool
+UpdateTerrainTiles(const RawTileStore &store,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius) noexcept
+{
+  const auto raster_location = projection.ProjectCoarse(location);
+
+  return UpdateTerrainTiles(store, raster_tile_cache, mutex,
+                            raster_location,
+                            projection.DistancePixelsCoarse(radius));
+}
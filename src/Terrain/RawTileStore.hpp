@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RasterLocation.hpp"
+#include "Height.hpp"
+#include "thread/SharedMutex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <tchar.h>
+
+struct jas_matrix;
+struct GeoPoint;
+class Path;
+class FileCache;
+class FileMapping;
+class BufferedOutputStream;
+class RasterTileCache;
+class RasterProjection;
+
+/**
+ * The on-disk format of a #RawTileStore.  All offsets are relative
+ * to the start of the payload (i.e. after the #FileCache header).
+ *
+ * The file consists of the raw #TerrainHeight rows of all tiles,
+ * each followed by the cells of its #HeightPyramid, then a table of
+ * #RawTileEntry (indexed by the tile number) and the
+ * #RawTileFooter.  The footer is at the end so the file can
+ * be written in one pass while the JPEG2000 file is being decoded.
+ */
+struct RawTileEntry {
+  uint32_t offset;
+
+  RasterLocation start, end;
+
+  constexpr bool IsDefined() const noexcept {
+    return end.x > start.x && end.y > start.y;
+  }
+};
+
+struct RawTileFooter {
+  static constexpr uint32_t MAGIC = 0x52415754;
+  static constexpr uint32_t VERSION = 2;
+
+  uint32_t magic, version;
+
+  UnsignedPoint2D size, n_tiles;
+
+  uint32_t table_offset;
+};
+
+/**
+ * An optional store of pre-decoded terrain tiles.  It is generated
+ * once from the JPEG2000 file (see #RawTileWriter) and kept in the
+ * #FileCache.  Instead of decoding the JPEG2000 file with libjasper,
+ * #RasterTileCache can then refer directly to the memory mapped
+ * tiles, which makes bringing a tile to the front as cheap as a page
+ * fault.
+ */
+class RawTileStore {
+  std::unique_ptr<FileMapping> mapping;
+
+  std::span<const std::byte> payload;
+
+  RawTileFooter footer;
+
+public:
+  /**
+   * The name of the #FileCache entry.
+   */
+  static constexpr const TCHAR *CACHE_NAME = _T("terrain-tiles");
+
+  /**
+   * Throws on error.
+   */
+  RawTileStore(std::unique_ptr<FileMapping> &&_mapping,
+               std::span<const std::byte> _payload);
+
+  ~RawTileStore() noexcept;
+
+  RawTileStore(const RawTileStore &) = delete;
+  RawTileStore &operator=(const RawTileStore &) = delete;
+
+  /**
+   * Map the store belonging to the specified terrain file from the
+   * #FileCache.
+   *
+   * Throws on error.
+   *
+   * @return the store or nullptr if there is none (or if it is
+   * stale)
+   */
+  static std::unique_ptr<RawTileStore> Open(FileCache &cache,
+                                            Path original_path);
+
+  /**
+   * Does this store match the geometry of the given (already
+   * loaded) #RasterTileCache?
+   */
+  [[gnu::pure]]
+  bool IsCompatible(const RasterTileCache &rtc) const noexcept;
+
+  struct Tile {
+    /**
+     * The mapped #TerrainHeight rows.
+     */
+    const TerrainHeight *heights;
+
+    /**
+     * The mapped #HeightPyramid cells.
+     */
+    const int16_t *pyramid;
+  };
+
+  /**
+   * Look up the pre-decoded data of a tile.
+   *
+   * @return the mapped data or std::nullopt if the tile is not
+   * available or its dimensions don't match
+   */
+  [[gnu::pure]]
+  std::optional<Tile> GetTile(unsigned index,
+                              RasterLocation start,
+                              RasterLocation end) const noexcept;
+};
+
+/**
+ * Writes a #RawTileStore.  Pass it to ConvertTerrainTiles(), which
+ * calls PutTile() for each decoded tile, and then call Finish().
+ */
+class RawTileWriter {
+  BufferedOutputStream &os;
+
+  std::vector<RawTileEntry> table;
+
+  /**
+   * Buffers for WriteTile(), kept here to avoid reallocating them
+   * for each tile.
+   */
+  std::vector<TerrainHeight> heights;
+  std::vector<int16_t> pyramid;
+
+  std::size_t position = 0;
+
+  UnsignedPoint2D size{0, 0}, n_tiles{0, 0};
+
+  /**
+   * The first error which occurred in PutTile(); it is rethrown by
+   * Finish().
+   */
+  std::exception_ptr error;
+
+public:
+  explicit RawTileWriter(BufferedOutputStream &_os) noexcept
+    :os(_os) {}
+
+  void SetSize(UnsignedPoint2D _size, UnsignedPoint2D _n_tiles) noexcept {
+    size = _size;
+    n_tiles = _n_tiles;
+  }
+
+  /**
+   * This is called from within libjasper and must not throw; errors
+   * are postponed until Finish().
+   */
+  void PutTile(unsigned index, RasterLocation start, RasterLocation end,
+               const struct jas_matrix &m) noexcept;
+
+  /**
+   * Write the tile table and the footer.  The caller is responsible
+   * for flushing the #BufferedOutputStream.
+   *
+   * Throws on error.
+   */
+  void Finish();
+
+private:
+  void WriteTile(unsigned index, RasterLocation start, RasterLocation end,
+                 const struct jas_matrix &m);
+
+  void Pad(std::size_t alignment);
+};
+
+/**
+ * Load all requested tiles from the #RawTileStore.  This is the
+ * counterpart to the JPEG2000 based UpdateTerrainTiles() overload.
+ *
+ * @return true if some tiles are missing in the store; they are
+ * still requested, and the caller must decode them with
+ * LoadRequestedTerrainTiles()
+ */
+bool
+UpdateTerrainTiles(const RawTileStore &store,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   SignedRasterLocation p, unsigned radius) noexcept;
+
+bool
+UpdateTerrainTiles(const RawTileStore &store,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius) noexcept;
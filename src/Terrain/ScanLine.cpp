@@ -4,6 +4,8 @@
 #include "Terrain/RasterTileCache.hpp"
 #include "Terrain/RasterLocation.hpp"
 
+#include <algorithm>
+
 /**
  * A #RasterLocation with some cached computations.  The
  * #RasterLocation base holds the linear subpixel coordinates within
@@ -254,12 +256,14 @@ NextGridIntersection(const GridRay &ray,
 inline void
 RasterTileCache::ScanTileLine(GridLocation start, GridLocation end,
                               TerrainHeight *buffer, [[maybe_unused]] unsigned size,
+                              unsigned begin, unsigned end_index,
                               bool interpolate) const noexcept
 {
   assert(end.index >= start.index);
   assert(end.index <= size);
 
-  if (start.index == end.index)
+  if (start.index == end.index ||
+      end.index <= begin || start.index >= end_index)
     return;
 
   if (start.tile.x < end.tile.x) {
@@ -288,32 +292,52 @@ RasterTileCache::ScanTileLine(GridLocation start, GridLocation end,
     --start.tile.y;
   }
 
+  TerrainHeight *const dest = buffer + start.index;
+  const unsigned n = end.index - start.index;
+
   const RasterTile &tile = tiles.Get(start.tile.x, start.tile.y);
+
+  if (begin > start.index || end_index < end.index) {
+    /* only a part of this segment is requested */
+    const unsigned range_begin = std::max(begin, start.index) - start.index;
+    const unsigned range_end = std::min(end_index, end.index) - start.index;
+
+    if (tile.IsLoaded())
+      tile.ScanLineRange(start, end, dest, n, range_begin, range_end,
+                         interpolate);
+    else
+      overview.ScanLineRangeChecked(start >> RasterTraits::OVERVIEW_BITS,
+                                    end >> RasterTraits::OVERVIEW_BITS,
+                                    dest, n, range_begin, range_end,
+                                    interpolate);
+    return;
+  }
+
   if (tile.IsLoaded())
-    tile.ScanLine(start, end,
-                  buffer + start.index, end.index - start.index,
-                  interpolate);
+    tile.ScanLine(start, end, dest, n, interpolate);
   else
     /* need range checking in the overview buffer because its size may
        be rounded down, and then the "fine" location may exceed its
        bounds */
     overview.ScanLineChecked(start >> RasterTraits::OVERVIEW_BITS,
                              end >> RasterTraits::OVERVIEW_BITS,
-                             buffer + start.index, end.index - start.index,
-                             interpolate);
+                             dest, n, interpolate);
 }
 
 void
-RasterTileCache::ScanLine(const RasterLocation _start,
-                          const RasterLocation _end,
-                          TerrainHeight *buffer, unsigned size,
-                          bool interpolate) const noexcept
+RasterTileCache::ScanLineRange(const RasterLocation _start,
+                               const RasterLocation _end,
+                               TerrainHeight *buffer, unsigned size,
+                               unsigned begin, unsigned end_index,
+                               bool interpolate) const noexcept
 {
   assert(_start.x < GetFineSize().x);
   assert(_start.y < GetFineSize().y);
   assert(_end.x < GetFineSize().x);
   assert(_end.y < GetFineSize().y);
   assert(size >= 2);
+  assert(begin < end_index);
+  assert(end_index <= size);
 
   const GridRay ray(GetFineTileSize(), _start, _end, size);
   assert(ray.size == size);
@@ -321,9 +345,10 @@ RasterTileCache::ScanLine(const RasterLocation _start,
   assert(ray.end.index == size);
 
   GridLocation current = ray.start;
-  while (current.index < size) {
+  while (current.index < end_index) {
     GridLocation next = NextGridIntersection(ray, current);
-    ScanTileLine(current, next, buffer, size, interpolate);
+    ScanTileLine(current, next, buffer, size, begin, end_index,
+                 interpolate);
     current = next;
   }
 }
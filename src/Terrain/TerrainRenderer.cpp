@@ -258,6 +258,11 @@ TerrainRenderer::TerrainRenderer(const RasterTerrain &_terrain)
   :terrain(_terrain)
 {
   settings.SetDefaults();
+  raster_renderer.SetScanThreads(settings.threads);
+
+  /* RasterTerrain increments the serial whenever new tiles have
+     been loaded */
+  raster_renderer.SetIncrementalScan(true);
 }
 
 #ifdef ENABLE_OPENGL
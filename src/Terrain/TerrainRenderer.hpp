@@ -58,7 +58,10 @@ public:
   }
 
   void SetSettings(const TerrainRendererSettings &_settings) {
+    const bool threads_changed = _settings.threads != settings.threads;
     settings = _settings;
+    if (threads_changed)
+      raster_renderer.SetScanThreads(settings.threads);
   }
 
   /**
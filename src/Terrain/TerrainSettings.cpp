@@ -12,4 +12,5 @@ TerrainRendererSettings::SetDefaults()
   brightness = 192;
   ramp = 0;
   contours = Contours::OFF;
+  threads = 0;
 }
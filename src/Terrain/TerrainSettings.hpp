@@ -42,6 +42,12 @@ struct TerrainRendererSettings {
    */
   Contours contours;
 
+  /**
+   * The maximum number of threads used to scan the terrain.  0 means
+   * automatic (one per CPU core, up to a limit).
+   */
+  uint8_t threads;
+
   /**
    * Set all attributes to the default values.
    */
@@ -53,7 +59,8 @@ struct TerrainRendererSettings {
       contrast == other.contrast &&
       brightness == other.brightness &&
       ramp == other.ramp &&
-      contours == other.contours;
+      contours == other.contours &&
+      threads == other.threads;
   }
 
   bool operator!=(const TerrainRendererSettings &other) const {
@@ -10,13 +10,30 @@
 #include "net/UniqueSocketDescriptor.hxx"
 #include "util/CRC.hpp"
 
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#endif
+
 static UniqueSocketDescriptor
-CreateBindUDP(SocketAddress address)
+CreateBindUDP(SocketAddress address, bool reuse_port)
 {
   UniqueSocketDescriptor s;
   if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
     throw MakeSocketError("Failed to create socket");
 
+  if (reuse_port) {
+#ifdef __linux__
+    if (!s.SetReusePort())
+      throw MakeSocketError("Failed to set SO_REUSEPORT");
+#else
+    throw std::runtime_error("SO_REUSEPORT is not supported");
+#endif
+  }
+
   if (!s.Bind(address))
     throw MakeSocketError("Failed to connect socket");
 
@@ -26,15 +43,19 @@ CreateBindUDP(SocketAddress address)
 namespace SkyLinesTracking {
 
 Server::Server(EventLoop &event_loop,
-               SocketAddress server_address)
+               SocketAddress server_address, bool reuse_port)
   :socket(event_loop, BIND_THIS_METHOD(OnSocketReady),
-          CreateBindUDP(server_address).Release())
+          CreateBindUDP(server_address, reuse_port).Release()),
+   flush_event(event_loop, BIND_THIS_METHOD(FlushSendQueue)),
+   receive_buffer(std::make_unique<Datagram[]>(BATCH_SIZE)),
+   send_queue(std::make_unique<Datagram[]>(BATCH_SIZE))
 {
   socket.ScheduleRead();
 }
 
 Server::~Server()
 {
+  FlushSendQueue();
   socket.Close();
 }
 
@@ -42,13 +63,71 @@ void
 Server::SendBuffer(SocketAddress address,
                    std::span<const std::byte> buffer) noexcept
 {
-  try {
-    ssize_t nbytes = socket.GetSocket().Write(buffer.data(), buffer.size());
-    if (nbytes < 0)
-      throw MakeSocketError("Failed to send");
-  } catch (...) {
-    OnSendError(address, std::current_exception());
+  if (buffer.size() > MAX_DATAGRAM_SIZE) {
+    OnSendError(address,
+                std::make_exception_ptr(std::length_error("Datagram too large")));
+    return;
   }
+
+  if (send_queue_size == BATCH_SIZE)
+    FlushSendQueue();
+
+  Datagram &datagram = send_queue[send_queue_size++];
+  datagram.address = address;
+  datagram.size = buffer.size();
+  std::memcpy(datagram.data, buffer.data(), buffer.size());
+
+  flush_event.Schedule();
+}
+
+void
+Server::FlushSendQueue() noexcept
+{
+  flush_event.Cancel();
+
+  const std::size_t n = send_queue_size;
+  send_queue_size = 0;
+
+  if (!socket.IsDefined())
+    return;
+
+#ifdef __linux__
+  std::array<struct mmsghdr, BATCH_SIZE> msgs;
+  std::array<struct iovec, BATCH_SIZE> iov;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    Datagram &datagram = send_queue[i];
+    iov[i] = {datagram.data, datagram.size};
+
+    auto &h = msgs[i].msg_hdr;
+    h = {};
+    h.msg_name = static_cast<struct sockaddr *>(datagram.address);
+    h.msg_namelen = datagram.address.GetSize();
+    h.msg_iov = &iov[i];
+    h.msg_iovlen = 1;
+  }
+
+  for (std::size_t i = 0; i < n;) {
+    int result = sendmmsg(socket.GetSocket().Get(), &msgs[i], n - i,
+                          MSG_DONTWAIT);
+    if (result > 0) {
+      i += result;
+    } else {
+      /* the datagram at position i has failed; report and skip it */
+      OnSendError(send_queue[i].address,
+                  std::make_exception_ptr(MakeSocketError("Failed to send")));
+      ++i;
+    }
+  }
+#else
+  for (std::size_t i = 0; i < n; ++i) {
+    const Datagram &datagram = send_queue[i];
+    if (socket.GetSocket().Write(datagram.data, datagram.size,
+                                 datagram.address) < 0)
+      OnSendError(datagram.address,
+                  std::make_exception_ptr(MakeSocketError("Failed to send")));
+  }
+#endif
 }
 
 void
@@ -162,25 +241,88 @@ Server::OnDatagramReceived(Client &&client,
   }
 }
 
+std::size_t
+Server::ReceiveBatch()
+{
+#ifdef __linux__
+  std::array<struct mmsghdr, BATCH_SIZE> msgs;
+  std::array<struct iovec, BATCH_SIZE> iov;
+
+  for (std::size_t i = 0; i < BATCH_SIZE; ++i) {
+    Datagram &datagram = receive_buffer[i];
+    iov[i] = {datagram.data, sizeof(datagram.data)};
+
+    auto &h = msgs[i].msg_hdr;
+    h = {};
+    h.msg_name = static_cast<struct sockaddr *>(datagram.address);
+    h.msg_namelen = datagram.address.GetCapacity();
+    h.msg_iov = &iov[i];
+    h.msg_iovlen = 1;
+  }
+
+  int n = recvmmsg(socket.GetSocket().Get(), msgs.data(), BATCH_SIZE,
+                   MSG_DONTWAIT, nullptr);
+  if (n < 0) {
+    const auto e = GetSocketError();
+    if (IsSocketErrorReceiveWouldBlock(e))
+      return 0;
+
+    throw MakeSocketError(e, "Failed to receive");
+  }
+
+  for (int i = 0; i < n; ++i) {
+    Datagram &datagram = receive_buffer[i];
+    datagram.address.SetSize(msgs[i].msg_hdr.msg_namelen);
+    datagram.size = msgs[i].msg_len;
+  }
+
+  return n;
+#else
+  std::size_t n = 0;
+  for (; n < BATCH_SIZE; ++n) {
+    Datagram &datagram = receive_buffer[n];
+    socklen_t address_size = datagram.address.GetCapacity();
+
+    ssize_t nbytes = recvfrom(socket.GetSocket().Get(),
+                              (char *)datagram.data, sizeof(datagram.data),
+                              MSG_DONTWAIT,
+                              datagram.address, &address_size);
+    if (nbytes < 0) {
+      const auto e = GetSocketError();
+      if (IsSocketErrorReceiveWouldBlock(e))
+        break;
+
+      throw MakeSocketError(e, "Failed to receive");
+    }
+
+    datagram.address.SetSize(address_size);
+    datagram.size = nbytes;
+  }
+
+  return n;
+#endif
+}
+
 void
 Server::OnSocketReady(unsigned) noexcept
 try {
-  // TODO: use recvmmsg() on Linux
+  for (unsigned i = 0; i < MAX_RECEIVE_BATCHES; ++i) {
+    const std::size_t n = ReceiveBatch();
 
-  Client client;
-  socklen_t address_size = sizeof(client.address);
-  char buffer[4096];
+    for (std::size_t j = 0; j < n; ++j) {
+      Datagram &datagram = receive_buffer[j];
 
-  ssize_t nbytes = recvfrom(socket.GetSocket().Get(), buffer, sizeof(buffer),
-                            MSG_DONTWAIT,
-                            client.address, &address_size);
-  if (nbytes < 0)
-    throw MakeSocketError("Failed to receive");
+      Client client;
+      client.address = datagram.address;
+      // TODO: set client.key
 
-  client.address.SetSize(address_size);
-  // TODO: set client.key
+      OnDatagramReceived(std::move(client), datagram.data, datagram.size);
+    }
 
-  OnDatagramReceived(std::move(client), buffer, nbytes);
+    if (n < BATCH_SIZE)
+      /* the socket is empty */
+      break;
+  }
 } catch (...) {
   socket.Close();
   OnError(std::current_exception());
@@ -4,11 +4,14 @@
 #pragma once
 
 #include "event/SocketEvent.hxx"
+#include "event/IdleEvent.hxx"
 #include "net/StaticSocketAddress.hxx"
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <memory>
 #include <span>
 
 struct GeoPoint;
@@ -20,10 +23,54 @@ namespace SkyLinesTracking {
  *
  * To use this class, derive your class from it and implement the
  * virtual methods.
+ *
+ * Incoming datagrams are received in batches, and outgoing datagrams
+ * are queued and sent in batches when the #EventLoop becomes idle
+ * (with recvmmsg() and sendmmsg() on Linux).
  */
 class Server {
+  /**
+   * The maximum number of datagrams received or sent with one
+   * system call.
+   */
+  static constexpr std::size_t BATCH_SIZE = 64;
+
+  /**
+   * The maximum number of receive batches per OnSocketReady() call;
+   * this gives other events a chance to run under heavy load.
+   */
+  static constexpr unsigned MAX_RECEIVE_BATCHES = 16;
+
+  /**
+   * The maximum size of a datagram.  Larger incoming datagrams are
+   * truncated (and then discarded because the CRC does not match).
+   */
+  static constexpr std::size_t MAX_DATAGRAM_SIZE = 2048;
+
+  struct Datagram {
+    StaticSocketAddress address;
+    std::size_t size;
+    std::byte data[MAX_DATAGRAM_SIZE];
+  };
+
   SocketEvent socket;
 
+  /**
+   * Flushes #send_queue.
+   */
+  IdleEvent flush_event;
+
+  /**
+   * Buffers for receiving one batch.
+   */
+  const std::unique_ptr<Datagram[]> receive_buffer;
+
+  /**
+   * Outgoing datagrams which have not been sent yet.
+   */
+  const std::unique_ptr<Datagram[]> send_queue;
+  std::size_t send_queue_size = 0;
+
 public:
   struct Client {
     StaticSocketAddress address;
@@ -31,7 +78,15 @@ public:
   };
 
 public:
-  Server(EventLoop &event_loop, SocketAddress server_address);
+  /**
+   * Throws on error.
+   *
+   * @param reuse_port set SO_REUSEPORT, which allows several
+   * instances (e.g. one per thread) to share the port; the kernel
+   * distributes incoming datagrams by the client address
+   */
+  Server(EventLoop &event_loop, SocketAddress server_address,
+         bool reuse_port=false);
 
   ~Server();
 
@@ -49,15 +104,33 @@ public:
     return socket.GetEventLoop();
   }
 
+  /**
+   * Queue a datagram.  It will be sent when the #EventLoop becomes
+   * idle, or when the queue is full.
+   */
   void SendBuffer(SocketAddress address,
                   std::span<const std::byte> buffer) noexcept;
 
+  /**
+   * Send all queued datagrams now.
+   */
+  void FlushSendQueue() noexcept;
+
   template<typename P>
   void SendPacket(SocketAddress address, const P &packet) noexcept {
     SendBuffer(address, std::as_bytes(std::span{&packet, 1}));
   }
 
 private:
+  /**
+   * Receive up to #BATCH_SIZE datagrams into #receive_buffer.
+   *
+   * Throws on error.
+   *
+   * @return the number of datagrams (0 if the socket is empty)
+   */
+  std::size_t ReceiveBatch();
+
   void OnDatagramReceived(Client &&client, void *data, size_t length);
   void OnSocketReady(unsigned events) noexcept;
 
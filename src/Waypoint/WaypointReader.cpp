@@ -11,8 +11,25 @@
 #include "WaypointFileType.hpp"
 #include "io/ZipLineReader.hpp"
 #include "io/FileLineReader.hpp"
+#include "io/FileMapping.hpp"
+#include "system/FileUtil.hpp"
+#include "thread/ThreadPool.hpp"
+#include "util/SpanCast.hxx"
+#include "util/UTF8.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+
+/**
+ * Parse files of at least this size (bytes) on a #ThreadPool.
+ */
+static constexpr std::size_t MIN_CONCURRENT_SIZE = 256 * 1024;
+
+/**
+ * The maximum number of threads parsing one file.
+ */
+static constexpr unsigned MAX_PARSER_THREADS = 8;
 
 static WaypointReaderBase *
 CreateWaypointReader(WaypointFileType type, WaypointFactory factory)
@@ -53,6 +70,31 @@ ReadWaypointFile(Path path, WaypointFileType file_type,
   if (!reader)
     throw std::runtime_error{"Unrecognised waypoint file"};
 
+#ifndef _UNICODE
+  if ((file_type == WaypointFileType::SEEYOU ||
+       file_type == WaypointFileType::WINPILOT) &&
+      /* FileMapping refuses to map empty files */
+      File::GetSize(path) > 0) {
+    /* fast path for the formats which are commonly used for large
+       files: parse the mapped file directly (and concurrently),
+       unless it needs charset conversion */
+    const FileMapping mapping(path);
+    const auto src = ToStringView(std::span<const std::byte>{mapping});
+    if (ValidateUTF8(src)) {
+      const unsigned n_threads =
+        std::min(ThreadPool::GetProcessorCount(), MAX_PARSER_THREADS);
+
+      std::optional<ThreadPool> thread_pool;
+      if (src.size() >= MIN_CONCURRENT_SIZE && n_threads > 1)
+        thread_pool.emplace("WaypointParser", n_threads - 1);
+
+      reader->Parse(way_points, src, progress,
+                    thread_pool ? &*thread_pool : nullptr);
+      return;
+    }
+  }
+#endif
+
   FileLineReader line_reader(path, Charset::AUTO);
   reader->Parse(way_points, line_reader, progress);
 }
@@ -5,6 +5,19 @@
 #include "Operation/ProgressListener.hpp"
 #include "io/LineReader.hpp"
 
+#ifndef _UNICODE
+#include "Waypoint/Waypoints.hpp"
+#include "thread/ThreadPool.hpp"
+#include "util/StringSplit.hxx"
+#include "util/UTF8.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <string>
+#include <vector>
+#endif
+
 void
 WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
                           ProgressListener &progress)
@@ -22,3 +35,193 @@ WaypointReaderBase::Parse(Waypoints &way_points, TLineReader &reader,
       progress.SetProgressPosition(reader.Tell() * 100 / filesize);
   }
 }
+
+WaypointReaderBase::LineResult
+WaypointReaderBase::ParseWaypoint(const TCHAR *,
+                                  std::optional<Waypoint> &) const
+{
+  /* not reachable, because the default CanParseConcurrently()
+     returns false */
+  return LineResult::IGNORED;
+}
+
+#ifndef _UNICODE
+
+/**
+ * Don't create chunks smaller than this (bytes).
+ */
+static constexpr std::size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * The number of chunks per thread; more than one balances the load
+ * between threads when some chunks are more expensive than others.
+ */
+static constexpr unsigned CHUNKS_PER_THREAD = 4;
+
+/**
+ * Remove the next line from the buffer.  Like ReadBufferedLine(),
+ * this splits at '\n' and strips a trailing '\r'.
+ */
+static std::string_view
+NextLine(std::string_view &src) noexcept
+{
+  auto [line, rest] = Split(src, '\n');
+  src = rest;
+
+  if (!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+
+  return line;
+}
+
+/**
+ * Copy the line to the (reused) buffer and null-terminate it.
+ */
+static const char *
+Terminate(std::string &buffer, std::string_view line)
+{
+  buffer.assign(line);
+  return buffer.c_str();
+}
+
+/**
+ * Split the buffer into (at most) the given number of chunks of
+ * roughly the same size, each ending at a line boundary.
+ */
+static std::vector<std::string_view>
+SplitChunks(std::string_view src, unsigned n) noexcept
+{
+  assert(n > 0);
+
+  const std::size_t chunk_size = src.size() / n;
+
+  std::vector<std::string_view> chunks;
+  chunks.reserve(n);
+
+  while (!src.empty()) {
+    std::size_t end = src.size();
+    if (chunks.size() + 1 < n && chunk_size > 0)
+      if (const auto newline = src.find('\n', chunk_size - 1);
+          newline != src.npos)
+        end = newline + 1;
+
+    chunks.push_back(src.substr(0, end));
+    src.remove_prefix(end);
+  }
+
+  return chunks;
+}
+
+namespace {
+
+struct Chunk {
+  std::string_view src;
+
+  std::vector<Waypoint> waypoints;
+
+  std::exception_ptr error;
+
+  /**
+   * Was the end of the waypoint list found in this chunk?
+   */
+  bool end = false;
+
+  explicit Chunk(std::string_view _src) noexcept
+    :src(_src) {}
+};
+
+} // anonymous namespace
+
+void
+WaypointReaderBase::Parse(Waypoints &way_points, std::string_view src,
+                          ProgressListener &progress,
+                          ThreadPool *thread_pool)
+{
+  const char *const begin = src.data();
+  const std::size_t filesize = std::max<std::size_t>(src.size(), 1);
+  progress.SetProgressRange(100);
+
+  if (src.starts_with(utf8_byte_order_mark))
+    src.remove_prefix(utf8_byte_order_mark.size());
+
+  /* the header determines the reader state, therefore it is parsed
+     serially */
+
+  std::string buffer;
+  while (!src.empty() && !CanParseConcurrently())
+    ParseLine(Terminate(buffer, NextLine(src)), way_points);
+
+  if (src.empty())
+    return;
+
+  const std::size_t n_chunks = thread_pool != nullptr
+    ? std::min<std::size_t>(src.size() / MIN_CHUNK_SIZE,
+                            thread_pool->GetConcurrency() * CHUNKS_PER_THREAD)
+    : 1;
+  if (n_chunks <= 1) {
+    /* not worth splitting: parse directly into the #Waypoints
+       instance */
+    for (unsigned i = 0; !src.empty(); ++i) {
+      if ((i & 0x3ff) == 0)
+        progress.SetProgressPosition((src.data() - begin) * 100 / filesize);
+
+      ParseLine(Terminate(buffer, NextLine(src)), way_points);
+    }
+
+    return;
+  }
+
+  std::vector<Chunk> chunks;
+  for (const auto i : SplitChunks(src, n_chunks))
+    chunks.emplace_back(i);
+
+  const auto parse_chunk = [this](Chunk &chunk) noexcept {
+    try {
+      std::string line_buffer;
+      std::optional<Waypoint> waypoint;
+
+      for (auto rest = chunk.src; !rest.empty();) {
+        switch (ParseWaypoint(Terminate(line_buffer, NextLine(rest)),
+                              waypoint)) {
+        case LineResult::IGNORED:
+        case LineResult::INVALID:
+          break;
+
+        case LineResult::WAYPOINT:
+          chunk.waypoints.emplace_back(std::move(*waypoint));
+          break;
+
+        case LineResult::END:
+          chunk.end = true;
+          return;
+        }
+      }
+    } catch (...) {
+      chunk.error = std::current_exception();
+    }
+  };
+
+  thread_pool->Run(chunks.size(), [&chunks, &parse_chunk](unsigned i){
+    parse_chunk(chunks[i]);
+  });
+
+  /* append the waypoints in file order */
+
+  for (auto &chunk : chunks) {
+    if (chunk.error)
+      std::rethrow_exception(chunk.error);
+
+    for (auto &i : chunk.waypoints)
+      way_points.Append(std::move(i));
+
+    chunk.waypoints = {};
+
+    progress.SetProgressPosition((chunk.src.data() + chunk.src.size() - begin)
+                                 * 100 / filesize);
+
+    if (chunk.end)
+      break;
+  }
+}
+
+#endif
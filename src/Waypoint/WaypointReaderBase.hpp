@@ -5,17 +5,48 @@
 
 #include "Factory.hpp"
 
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
 #include <tchar.h>
 
 class Waypoints;
 class TLineReader;
 class ProgressListener;
+class ThreadPool;
 
 class WaypointReaderBase
 {
 protected:
   const WaypointFactory factory;
 
+  /**
+   * The result of ParseWaypoint().
+   */
+  enum class LineResult : uint8_t {
+    /**
+     * The line does not describe a waypoint (e.g. a comment).
+     */
+    IGNORED,
+
+    /**
+     * The line is malformed.
+     */
+    INVALID,
+
+    /**
+     * A waypoint was parsed.
+     */
+    WAYPOINT,
+
+    /**
+     * This line ends the waypoint list; all following lines shall be
+     * ignored.
+     */
+    END,
+  };
+
 protected:
   explicit WaypointReaderBase(WaypointFactory _factory)
     :factory(_factory) {}
@@ -31,6 +62,24 @@ public:
   void Parse(Waypoints &way_points, TLineReader &reader,
              ProgressListener &progress);
 
+#ifndef _UNICODE
+  /**
+   * Parses a waypoint file which is completely in memory (e.g. a
+   * #FileMapping) and contains only valid UTF-8.  Lines are parsed
+   * directly from the buffer.
+   *
+   * Throws on error.
+   *
+   * @param thread_pool if not nullptr (and the reader supports it),
+   * the lines after the header are split into chunks which are
+   * parsed concurrently on this pool; the resulting waypoints are
+   * appended in file order
+   */
+  void Parse(Waypoints &way_points, std::string_view src,
+             ProgressListener &progress,
+             ThreadPool *thread_pool=nullptr);
+#endif
+
 protected:
   /**
    * Parse a file line
@@ -41,4 +90,24 @@ protected:
    * parsing error occured
    */
   virtual bool ParseLine(const TCHAR* line, Waypoints &way_points) = 0;
+
+  /**
+   * May all following lines be parsed with ParseWaypoint() instead
+   * of ParseLine()?  This is the case when the reader state (e.g.
+   * the column layout found in the header) will not change anymore.
+   */
+  virtual bool CanParseConcurrently() const noexcept {
+    return false;
+  }
+
+  /**
+   * Parse one line without modifying the reader state.  This may be
+   * called from several threads at the same time, but only if
+   * CanParseConcurrently() returns true.
+   *
+   * @param dest receives the waypoint if #LineResult::WAYPOINT is
+   * returned
+   */
+  virtual LineResult ParseWaypoint(const TCHAR *line,
+                                   std::optional<Waypoint> &dest) const;
 };
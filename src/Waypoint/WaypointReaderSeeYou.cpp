@@ -165,92 +165,135 @@ ParseStyle(const TCHAR* src, Waypoint::Type &type)
   return true;
 }
 
+enum {
+  iName = 0,
+  iShortname = 1,
+  iLatitude = 3,
+  iLongitude = 4,
+  iElevation = 5,
+  iStyle = 6,
+  iRWDir = 7,
+  iRWLen = 8,
+  iRWWidth = 9,
+  iUserData = 12,
+  iPics = 13
+};
+
+static bool
+IsEndMarker(const TCHAR *line) noexcept
+{
+  return StringStartsWith(line, _T("-----Related Tasks-----"));
+}
+
+void
+WaypointReaderSeeYou::ParseHeader(const TCHAR *line) noexcept
+{
+  TCHAR ctemp[MAX_LINE_LENGTH];
+  const TCHAR *params[20];
+  size_t n_params = ExtractParameters(line, ctemp, params,
+                                      ARRAY_SIZE(params), true, _T('"'));
+
+  if (iRWWidth < n_params &&
+      StringIsEqual(params[iRWWidth], _T("rwwidth"))) {
+    /*
+     * The name of the 10th field is "rwwidth" (runway width).
+     * This field doesn't exist in "typical" SeeYou (*.cup) waypoint
+     * files but is in files saved by at least some versions of
+     * SeeYou Mobile. If the rwwidth field exists, the frequency and
+     * description fields are shifted one position to the right.
+     */
+    iFrequency = 10;
+    iDescription = 11;
+  } else {
+    iFrequency = 9;
+    iDescription = 10;
+  }
+}
+
 bool
 WaypointReaderSeeYou::ParseLine(const TCHAR* line, Waypoints &waypoints)
 {
-  enum {
-    iName = 0,
-    iShortname = 1,
-    iLatitude = 3,
-    iLongitude = 4,
-    iElevation = 5,
-    iStyle = 6,
-    iRWDir = 7,
-    iRWLen = 8,
-    iRWWidth = 9,
-    iUserData = 12,
-    iPics = 13
-  };
+  if (ignore_following)
+    return true;
+
+  if (first && !StringIsEmpty(line) && !StringStartsWith(line, _T("*")) &&
+      _tcslen(line) < MAX_LINE_LENGTH && !IsEndMarker(line)) {
+    first = false;
+    if (line[0] != _T('\"')) {
+      /*
+       * If the first line doesn't begin with a quotation mark, it
+       * doesn't describe a waypoint. It probably contains field names.
+       */
+      ParseHeader(line);
+      return true;
+    }
+  }
+
+  std::optional<Waypoint> waypoint;
+  switch (ParseWaypoint(line, waypoint)) {
+  case LineResult::IGNORED:
+    break;
+
+  case LineResult::INVALID:
+    return false;
 
+  case LineResult::WAYPOINT:
+    waypoints.Append(std::move(*waypoint));
+    break;
+
+  case LineResult::END:
+    // If task marker is reached ignore all following lines
+    ignore_following = true;
+    break;
+  }
+
+  return true;
+}
+
+WaypointReaderSeeYou::LineResult
+WaypointReaderSeeYou::ParseWaypoint(const TCHAR *line,
+                                    std::optional<Waypoint> &dest) const
+{
   // If (end-of-file or comment)
   if (StringIsEmpty(line) ||
       StringStartsWith(line, _T("*")))
     // -> return without error condition
-    return true;
+    return LineResult::IGNORED;
 
-  TCHAR ctemp[4096];
+  TCHAR ctemp[MAX_LINE_LENGTH];
   if (_tcslen(line) >= ARRAY_SIZE(ctemp))
     /* line too long for buffer */
-    return false;
+    return LineResult::INVALID;
 
-  // If task marker is reached ignore all following lines
-  if (StringStartsWith(line, _T("-----Related Tasks-----")))
-    ignore_following = true;
-  if (ignore_following)
-    return true;
+  if (IsEndMarker(line))
+    return LineResult::END;
 
   // Get fields
   const TCHAR *params[20];
   size_t n_params = ExtractParameters(line, ctemp, params,
                                       ARRAY_SIZE(params), true, _T('"'));
 
-  if (first) {
-    first = false;
-    if (line[0] != _T('\"')) {
-      /*
-       * If the first line doesn't begin with a quotation mark, it
-       * doesn't describe a waypoint. It probably contains field names.
-       */
-      if (iRWWidth < n_params &&
-          StringIsEqual(params[iRWWidth], _T("rwwidth"))) {
-        /*
-         * The name of the 10th field is "rwwidth" (runway width).
-         * This field doesn't exist in "typical" SeeYou (*.cup) waypoint
-         * files but is in files saved by at least some versions of
-         * SeeYou Mobile. If the rwwidth field exists, the frequency and
-         * description fields are shifted one position to the right.
-         */
-        iFrequency = 10;
-        iDescription = 11;
-      } else {
-        iFrequency = 9;
-        iDescription = 10;
-      }
-      return true;
-    }
-  }
-
   // Check if the basic fields are provided
   if (n_params <= iLatitude)
-    return false;
+    return LineResult::INVALID;
 
   GeoPoint location;
 
   // Latitude (e.g. 5115.900N)
   if (!ParseAngle(params[iLatitude], location.latitude, true))
-    return false;
+    return LineResult::INVALID;
 
   // Longitude (e.g. 00715.900W)
   if (!ParseAngle(params[iLongitude], location.longitude, false))
-    return false;
+    return LineResult::INVALID;
 
   location.Normalize(); // ensure longitude is within -180:180
 
-  Waypoint new_waypoint = factory.Create(location);
+  Waypoint &new_waypoint = dest.emplace(factory.Create(location));
 
   // Name (e.g. "Some Turnpoint")
   if (*params[iName] == _T('\0'))
-    return false;
+    return LineResult::INVALID;
   new_waypoint.name = params[iName];
 
   // Elevation (e.g. 458.0m)
@@ -318,6 +361,6 @@ WaypointReaderSeeYou::ParseLine(const TCHAR* line, Waypoints &waypoints)
       new_waypoint.files_embed.emplace_front(i);
     }
   }
-  waypoints.Append(std::move(new_waypoint));
-  return true;
+
+  return LineResult::WAYPOINT;
 }
@@ -5,12 +5,19 @@
 
 #include "WaypointReaderBase.hpp"
 
+#include <cstddef>
+
 /**
  * Parses a SeeYou waypoint file.
  *
  * @see http://data.naviter.si/docs/cup_format.pdf
  */
 class WaypointReaderSeeYou final : public WaypointReaderBase {
+  /**
+   * Longer lines are rejected.
+   */
+  static constexpr std::size_t MAX_LINE_LENGTH = 4096;
+
   bool first = true;
 
   bool ignore_following = false;
@@ -26,4 +33,18 @@ public:
 
   /* virtual methods from class WaypointReaderBase */
   bool ParseLine(const TCHAR* line, Waypoints &way_points) override;
+
+protected:
+  bool CanParseConcurrently() const noexcept override {
+    return !first && !ignore_following;
+  }
+
+  LineResult ParseWaypoint(const TCHAR *line,
+                           std::optional<Waypoint> &dest) const override;
+
+private:
+  /**
+   * Parse the field names in the first line.
+   */
+  void ParseHeader(const TCHAR *line) noexcept;
 };
@@ -170,52 +170,76 @@ ParseFlags(const TCHAR* src, Waypoint &dest)
 bool
 WaypointReaderWinPilot::ParseLine(const TCHAR *line, Waypoints &waypoints)
 {
-  TCHAR ctemp[4096];
-  const TCHAR *params[20];
-  static constexpr unsigned int max_params = ARRAY_SIZE(params);
-  size_t n_params;
-
   // If (end-of-file)
   if (line[0] == '\0')
     // -> return without error condition
     return true;
 
-  // If comment
-  if (line[0] == _T('*')) {
-    if (first) {
-      first = false;
-      welt2000_format = (_tcsstr(line, _T("WRITTEN BY WELT2000")) != nullptr);
-    }
+  if (first) {
+    /* the WELT2000 signature is in the first line; after that, the
+       reader state does not change anymore, which allows parsing the
+       remaining lines concurrently */
+    first = false;
+    welt2000_format = line[0] == _T('*') &&
+      _tcsstr(line, _T("WRITTEN BY WELT2000")) != nullptr;
+  }
 
-    // -> return without error condition
-    return true;
+  std::optional<Waypoint> waypoint;
+  switch (ParseWaypoint(line, waypoint)) {
+  case LineResult::IGNORED:
+  case LineResult::END:
+    break;
+
+  case LineResult::INVALID:
+    return false;
+
+  case LineResult::WAYPOINT:
+    waypoints.Append(std::move(*waypoint));
+    break;
   }
 
+  return true;
+}
+
+WaypointReaderWinPilot::LineResult
+WaypointReaderWinPilot::ParseWaypoint(const TCHAR *line,
+                                      std::optional<Waypoint> &dest) const
+{
+  TCHAR ctemp[4096];
+  const TCHAR *params[20];
+  static constexpr unsigned int max_params = ARRAY_SIZE(params);
+  size_t n_params;
+
+  // If (end-of-file or comment)
+  if (line[0] == '\0' || line[0] == _T('*'))
+    // -> return without error condition
+    return LineResult::IGNORED;
+
   if (_tcslen(line) >= ARRAY_SIZE(ctemp))
     /* line too long for buffer */
-    return false;
+    return LineResult::INVALID;
 
   GeoPoint location;
 
   // Get fields
   n_params = ExtractParameters(line, ctemp, params, max_params, true);
   if (n_params < 6)
-    return false;
+    return LineResult::INVALID;
 
   // Latitude (e.g. 51:15.900N)
   if (!ParseAngle(params[1], location.latitude, true))
-    return false;
+    return LineResult::INVALID;
 
   // Longitude (e.g. 00715.900W)
   if (!ParseAngle(params[2], location.longitude, false))
-    return false;
+    return LineResult::INVALID;
   location.Normalize(); // ensure longitude is within -180:180
 
-  Waypoint new_waypoint = factory.Create(location);
+  Waypoint &new_waypoint = dest.emplace(factory.Create(location));
 
   // Name (e.g. KAMPLI)
   if (*params[5] == _T('\0'))
-    return false;
+    return LineResult::INVALID;
   new_waypoint.name=params[5];
 
   // Altitude (e.g. 458M)
@@ -235,6 +259,5 @@ WaypointReaderWinPilot::ParseLine(const TCHAR *line, Waypoints &waypoints)
   // Waypoint Flags (e.g. AT)
   ParseFlags(params[4], new_waypoint);
 
-  waypoints.Append(std::move(new_waypoint));
-  return true;
+  return LineResult::WAYPOINT;
 }
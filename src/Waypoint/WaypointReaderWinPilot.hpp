@@ -19,4 +19,11 @@ public:
 protected:
   /* virtual methods from class WaypointReaderBase */
   bool ParseLine(const TCHAR *line, Waypoints &way_points) override;
+
+  bool CanParseConcurrently() const noexcept override {
+    return !first;
+  }
+
+  LineResult ParseWaypoint(const TCHAR *line,
+                           std::optional<Waypoint> &dest) const override;
 };
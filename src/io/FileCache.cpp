@@ -4,6 +4,7 @@
 #include "FileCache.hpp"
 #include "FileReader.hxx"
 #include "FileOutputStream.hxx"
+#include "FileMapping.hpp"
 #include "system/FileUtil.hpp"
 
 #ifdef _WIN32
@@ -70,6 +71,31 @@ GetRegularFileInfo(Path path, FileInfo &info)
 #endif
 }
 
+static constexpr std::size_t HEADER_SIZE =
+  sizeof(FILE_CACHE_MAGIC) + sizeof(FileInfo);
+
+/**
+ * Check whether the cache file exists and is not older than the
+ * original file; delete it if it is stale.
+ */
+static bool
+CheckCacheFileInfo(Path path, const FileInfo &original_info) noexcept
+{
+  FileInfo cached_info;
+  if (!GetRegularFileInfo(path, cached_info))
+    return false;
+
+  /* if the original file is newer than the cache, discard the cache -
+     unless the system clock is skewed (origina file's modification
+     time is in the future) */
+  if (original_info.mtime > cached_info.mtime && !original_info.IsFuture()) {
+    File::Delete(path);
+    return false;
+  }
+
+  return true;
+}
+
 FileCache::FileCache(AllocatedPath &&_cache_path)
   :cache_path(std::move(_cache_path)) {}
 
@@ -87,18 +113,8 @@ FileCache::Load(const TCHAR *name, Path original_path) noexcept
     return nullptr;
 
   const auto path = MakeCachePath(name);
-
-  FileInfo cached_info;
-  if (!GetRegularFileInfo(path, cached_info))
-    return nullptr;
-
-  /* if the original file is newer than the cache, discard the cache -
-     unless the system clock is skewed (origina file's modification
-     time is in the future) */
-  if (original_info.mtime > cached_info.mtime && !original_info.IsFuture()) {
-    File::Delete(path);
+  if (!CheckCacheFileInfo(path, original_info))
     return nullptr;
-  }
 
   try {
     auto r = std::make_unique<FileReader>(path);
@@ -119,6 +135,47 @@ FileCache::Load(const TCHAR *name, Path original_path) noexcept
   return nullptr;
 }
 
+std::unique_ptr<FileMapping>
+FileCache::Map(const TCHAR *name, Path original_path) noexcept
+{
+  FileInfo original_info;
+  if (!GetRegularFileInfo(original_path, original_info))
+    return nullptr;
+
+  const auto path = MakeCachePath(name);
+  if (!CheckCacheFileInfo(path, original_info))
+    return nullptr;
+
+  try {
+    auto m = std::make_unique<FileMapping>(path);
+    const std::span<const std::byte> src = *m;
+
+    if (src.size() >= HEADER_SIZE) {
+      unsigned magic;
+      struct FileInfo old_info;
+
+      memcpy(&magic, src.data(), sizeof(magic));
+      memcpy(&old_info, src.data() + sizeof(magic), sizeof(old_info));
+
+      if (magic == FILE_CACHE_MAGIC &&
+          old_info == original_info)
+        return m;
+    }
+  } catch (...) {
+  }
+
+  File::Delete(path);
+  return nullptr;
+}
+
+std::span<const std::byte>
+FileCache::SkipHeader(std::span<const std::byte> src) noexcept
+{
+  return src.size() >= HEADER_SIZE
+    ? src.subspan(HEADER_SIZE)
+    : std::span<const std::byte>{};
+}
+
 std::unique_ptr<FileOutputStream>
 FileCache::Save(const TCHAR *name, Path original_path)
 {
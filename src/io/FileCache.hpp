@@ -5,12 +5,15 @@
 
 #include "system/Path.hpp"
 
+#include <cstddef>
 #include <memory>
+#include <span>
 #include <stdio.h>
 #include <tchar.h>
 
 class Reader;
 class FileOutputStream;
+class FileMapping;
 
 class FileCache {
   AllocatedPath cache_path;
@@ -32,6 +35,19 @@ public:
    */
   std::unique_ptr<Reader> Load(const TCHAR *name, Path original_path) noexcept;
 
+  /**
+   * Like Load(), but map the whole file into memory.  The mapping
+   * includes the cache header; use SkipHeader() to obtain the
+   * payload.
+   *
+   * Returns nullptr on error.
+   */
+  std::unique_ptr<FileMapping> Map(const TCHAR *name,
+                                   Path original_path) noexcept;
+
+  [[gnu::const]]
+  static std::span<const std::byte> SkipHeader(std::span<const std::byte> src) noexcept;
+
   /**
    * Throws on error.
    */
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ThreadPool.hpp"
+#include "Thread.hpp"
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <sysinfoapi.h>
+#endif
+
+class ThreadPool::Worker final : public Thread {
+  ThreadPool &pool;
+
+public:
+  Worker(ThreadPool &_pool, const char *_name) noexcept
+    :Thread(_name), pool(_pool) {}
+
+protected:
+  void Run() noexcept override {
+    pool.WorkerRun();
+  }
+};
+
+ThreadPool::ThreadPool(const char *name, unsigned n_threads)
+{
+  for (unsigned i = 0; i < n_threads; ++i) {
+    try {
+      workers.emplace_front(*this, name);
+    } catch (...) {
+      /* stop the ones which are already running */
+      Stop();
+      throw;
+    }
+
+    try {
+      workers.front().Start();
+    } catch (...) {
+      /* this one has failed to start; remove it and stop the
+         others */
+      workers.pop_front();
+      Stop();
+      throw;
+    }
+
+    ++n_workers;
+  }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+  Stop();
+}
+
+void
+ThreadPool::Stop() noexcept
+{
+  {
+    const std::lock_guard lock{mutex};
+    quit = true;
+    wake_cond.notify_all();
+  }
+
+  for (auto &i : workers)
+    i.Join();
+
+  workers.clear();
+}
+
+unsigned
+ThreadPool::GetProcessorCount() noexcept
+{
+#ifdef HAVE_POSIX
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 1 ? unsigned(n) : 1;
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 1 ? info.dwNumberOfProcessors : 1;
+#endif
+}
+
+inline void
+ThreadPool::RunTasks(std::unique_lock<Mutex> &lock) noexcept
+{
+  ++n_busy;
+
+  while (next_task < n_tasks) {
+    const unsigned i = next_task++;
+    const auto &f = *function;
+
+    lock.unlock();
+    f(i);
+    lock.lock();
+  }
+
+  if (--n_busy == 0)
+    done_cond.notify_all();
+}
+
+void
+ThreadPool::WorkerRun() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  unsigned seen_generation = generation;
+
+  while (true) {
+    wake_cond.wait(lock, [this, seen_generation]{
+      return quit || generation != seen_generation;
+    });
+
+    if (quit)
+      break;
+
+    seen_generation = generation;
+    RunTasks(lock);
+  }
+}
+
+void
+ThreadPool::Run(unsigned n, const std::function<void(unsigned)> &f) noexcept
+{
+  const std::lock_guard run_lock{run_mutex};
+
+  if (n_workers == 0 || n <= 1) {
+    /* no need to wake up the workers */
+    for (unsigned i = 0; i < n; ++i)
+      f(i);
+    return;
+  }
+
+  std::unique_lock lock{mutex};
+
+  function = &f;
+  n_tasks = n;
+  next_task = 0;
+  ++generation;
+  wake_cond.notify_all();
+
+  RunTasks(lock);
+
+  done_cond.wait(lock, [this]{ return n_busy == 0; });
+
+  function = nullptr;
+  n_tasks = next_task = 0;
+}
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "Cond.hxx"
+
+#include <forward_list>
+#include <functional>
+
+/**
+ * A fixed set of worker threads which implement a "parallel for"
+ * loop: Run() invokes a function for each index in [0, n),
+ * distributed over the workers and the calling thread, and returns
+ * when all invocations have finished.
+ *
+ * The workers sleep while Run() is not active.
+ */
+class ThreadPool {
+  class Worker;
+
+  Mutex mutex;
+
+  /**
+   * Wakes up the workers when new work arrives (or when they shall
+   * quit).
+   */
+  Cond wake_cond;
+
+  /**
+   * Signalled by the last worker leaving RunTasks().
+   */
+  Cond done_cond;
+
+  std::forward_list<Worker> workers;
+
+  /**
+   * Serialises Run() calls from different threads.
+   */
+  Mutex run_mutex;
+
+  const std::function<void(unsigned)> *function = nullptr;
+
+  unsigned n_tasks = 0, next_task = 0;
+
+  /**
+   * The number of threads currently inside RunTasks().
+   */
+  unsigned n_busy = 0;
+
+  /**
+   * Incremented by each Run() call; used by the workers to detect
+   * new work.
+   */
+  unsigned generation = 0;
+
+  unsigned n_workers = 0;
+
+  bool quit = false;
+
+public:
+  /**
+   * Throws on error.
+   *
+   * @param n_threads the number of worker threads; the calling
+   * thread participates in Run(), so the concurrency is one more
+   * than this
+   */
+  ThreadPool(const char *name, unsigned n_threads);
+
+  ~ThreadPool() noexcept;
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * The number of CPU cores which are online (at least 1).
+   */
+  static unsigned GetProcessorCount() noexcept;
+
+  /**
+   * The maximum number of threads which may execute tasks at the
+   * same time (including the caller of Run()).
+   */
+  unsigned GetConcurrency() const noexcept {
+    return n_workers + 1;
+  }
+
+  /**
+   * Call the function for each index in [0, n) and wait for
+   * completion.  The function is called concurrently from different
+   * threads and must not throw.
+   */
+  void Run(unsigned n, const std::function<void(unsigned)> &f) noexcept;
+
+private:
+  /**
+   * Ask all workers to quit and wait for them.
+   */
+  void Stop() noexcept;
+
+  /**
+   * Execute pending tasks until there are none left.
+   *
+   * Caller must lock the mutex.
+   */
+  void RunTasks(std::unique_lock<Mutex> &lock) noexcept;
+
+  void WorkerRun() noexcept;
+};
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * A priority queue implemented as a d-ary heap.  Compared to the
+ * binary heap of std::priority_queue, it is shallower, which makes
+ * push() cheaper and keeps the children of a node in one cache line.
+ *
+ * Like std::priority_queue, top() is the "largest" element according
+ * to #Compare.  The storage is kept by clear(), therefore a heap which
+ * is reused does not allocate memory again.
+ */
+template<typename T, typename Compare, std::size_t D=4>
+class DaryHeap {
+  static_assert(D >= 2);
+
+  std::vector<T> c;
+
+  [[no_unique_address]] Compare compare;
+
+public:
+  using size_type = std::size_t;
+
+  [[gnu::pure]]
+  bool empty() const noexcept {
+    return c.empty();
+  }
+
+  [[gnu::pure]]
+  size_type size() const noexcept {
+    return c.size();
+  }
+
+  void reserve(size_type capacity) {
+    c.reserve(capacity);
+  }
+
+  void clear() noexcept {
+    c.clear();
+  }
+
+  [[gnu::pure]]
+  const T &top() const noexcept {
+    assert(!empty());
+
+    return c.front();
+  }
+
+  template<typename... Args>
+  void emplace(Args&&... args) {
+    c.emplace_back(std::forward<Args>(args)...);
+    SiftUp(c.size() - 1);
+  }
+
+  void pop() noexcept {
+    assert(!empty());
+
+    if (c.size() > 1) {
+      c.front() = std::move(c.back());
+      c.pop_back();
+      SiftDown(0);
+    } else
+      c.pop_back();
+  }
+
+private:
+  void SiftUp(size_type i) noexcept {
+    T value = std::move(c[i]);
+
+    while (i > 0) {
+      const size_type parent = (i - 1) / D;
+      if (!compare(c[parent], value))
+        break;
+
+      c[i] = std::move(c[parent]);
+      i = parent;
+    }
+
+    c[i] = std::move(value);
+  }
+
+  void SiftDown(size_type i) noexcept {
+    const size_type n = c.size();
+    T value = std::move(c[i]);
+
+    while (true) {
+      const size_type first = i * D + 1;
+      if (first >= n)
+        break;
+
+      /* find the "largest" child */
+      const size_type last = first + D < n ? first + D : n;
+      size_type best = first;
+      for (size_type j = first + 1; j < last; ++j)
+        if (compare(c[best], c[j]))
+          best = j;
+
+      if (!compare(value, c[best]))
+        break;
+
+      c[i] = std::move(c[best]);
+      i = best;
+    }
+
+    c[i] = std::move(value);
+  }
+};
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+
+#include <algorithm>
+
+static inline bool
+operator==(const AirspaceInterceptSolution &a,
+           const AirspaceInterceptSolution &b) noexcept
+{
+  if (!a.IsValid() || !b.IsValid())
+    return a.IsValid() == b.IsValid();
+
+  return a.location == b.location && a.distance == b.distance &&
+    a.altitude == b.altitude && a.elapsed_time == b.elapsed_time;
+}
+
+/**
+ * Do both managers have the same warnings (referring to the same
+ * airspaces), in the same order?
+ */
+[[gnu::pure]]
+static inline bool
+CompareAirspaceWarnings(const AirspaceWarningManager &a,
+                        const AirspaceWarningManager &b) noexcept
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const AirspaceWarning &x, const AirspaceWarning &y){
+                      return &x.GetAirspace() == &y.GetAirspace() &&
+                        x.GetWarningState() == y.GetWarningState() &&
+                        x.GetSolution() == y.GetSolution();
+                    });
+}
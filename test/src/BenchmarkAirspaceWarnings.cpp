@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program replays a flight and measures
+ * AirspaceWarningManager::Update() with and without the batched
+ * evaluation.  It fails if the warnings differ.
+ */
+
+#include "AirspaceWarningCompare.hpp"
+#include "DebugReplay.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceWarningConfig.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "NMEA/Aircraft.hpp"
+#include "Operation/Operation.hpp"
+#include "io/FileLineReader.hpp"
+#include "system/Args.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using Clock = std::chrono::steady_clock;
+
+static std::vector<AircraftState>
+LoadStates(DebugReplay &replay)
+{
+  std::vector<AircraftState> states;
+
+  Validity last_location_available;
+  last_location_available.Clear();
+
+  while (replay.Next()) {
+    const MoreData &basic = replay.Basic();
+    if (!basic.location_available.Modified(last_location_available))
+      continue;
+
+    last_location_available = basic.location_available;
+    states.push_back(ToAircraftState(basic, replay.Calculated()));
+  }
+
+  return states;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "AIRSPACEFILE REPLAYFILE");
+  const auto airspace_path = args.ExpectNextPath();
+
+  Airspaces airspaces;
+
+  {
+    FileLineReader reader(airspace_path, Charset::AUTO);
+    NullOperationEnvironment operation;
+    ParseAirspaceFile(airspaces, reader, operation);
+  }
+
+  airspaces.Optimise();
+
+  std::unique_ptr<DebugReplay> replay(CreateDebugReplay(args));
+  if (!replay)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  const auto states = LoadStates(*replay);
+  if (states.empty()) {
+    fprintf(stderr, "No fixes\n");
+    return EXIT_FAILURE;
+  }
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  const GlidePolar glide_polar(1);
+  TaskStats task_stats;
+  task_stats.reset();
+
+  AirspaceWarningManager batched(config, airspaces);
+  AirspaceWarningManager unbatched(config, airspaces);
+  unbatched.SetBatch(false);
+
+  batched.Reset(states.front());
+  unbatched.Reset(states.front());
+
+  Clock::duration batched_duration{}, unbatched_duration{};
+  unsigned n_warnings = 0;
+
+  for (const auto &state : states) {
+    auto start = Clock::now();
+    batched.Update(state, glide_polar, task_stats, false,
+                   std::chrono::seconds{1});
+    batched_duration += Clock::now() - start;
+
+    start = Clock::now();
+    unbatched.Update(state, glide_polar, task_stats, false,
+                     std::chrono::seconds{1});
+    unbatched_duration += Clock::now() - start;
+
+    if (!CompareAirspaceWarnings(batched, unbatched)) {
+      fprintf(stderr, "Warnings differ\n");
+      return EXIT_FAILURE;
+    }
+
+    n_warnings += batched.size();
+  }
+
+  using Microseconds = std::chrono::duration<double, std::micro>;
+
+  printf("%u airspaces, %zu updates, %u warnings\n",
+         airspaces.GetSize(), states.size(), n_warnings);
+  printf("unbatched %.2f us, batched %.2f us per update\n",
+         Microseconds{unbatched_duration}.count() / states.size(),
+         Microseconds{batched_duration}.count() / states.size());
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program replays a flight into the contest solvers like
+ * TaskComputer does, and measures the time spent in the incremental
+ * search and the time to the final (exhaustive) score, with and
+ * without a #ThreadPool.  It fails if the scores differ.
+ */
+
+#include "DebugReplay.hpp"
+#include "Engine/Contest/ContestManager.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "system/Args.hpp"
+#include "thread/ThreadPool.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static std::vector<TracePoint>
+LoadPoints(DebugReplay &replay)
+{
+  std::vector<TracePoint> points;
+
+  while (replay.Next()) {
+    const MoreData &basic = replay.Basic();
+    if (basic.time_available && basic.location_available &&
+        basic.NavAltitudeAvailable())
+      points.emplace_back(basic);
+  }
+
+  return points;
+}
+
+struct ContestTiming {
+  Clock::duration incremental{}, exhaustive{};
+
+  ContestStatistics stats;
+};
+
+static ContestTiming
+Run(Contest contest, const std::vector<TracePoint> &points,
+    ThreadPool *thread_pool)
+{
+  Trace full_trace({}, Trace::null_time, 512);
+  Trace triangle_trace({}, Trace::null_time, 1024);
+  Trace sprint_trace({}, std::chrono::minutes{150}, 128);
+
+  ContestManager manager(contest, full_trace, triangle_trace, sprint_trace);
+  manager.SetIncremental(true);
+  manager.SetThreadPool(thread_pool);
+
+  ContestTiming timing;
+
+  for (const auto &point : points) {
+    full_trace.push_back(point);
+    triangle_trace.push_back(point);
+    sprint_trace.push_back(point);
+
+    const auto start = Clock::now();
+    manager.UpdateIdle();
+    timing.incremental += Clock::now() - start;
+  }
+
+  const auto start = Clock::now();
+  manager.SolveExhaustive();
+  timing.exhaustive = Clock::now() - start;
+
+  timing.stats = manager.GetStats();
+  return timing;
+}
+
+static bool
+Equals(const ContestStatistics &a, const ContestStatistics &b) noexcept
+{
+  for (std::size_t i = 0; i < ContestStatistics::N; ++i)
+    if (a.result[i].score != b.result[i].score ||
+        a.result[i].distance != b.result[i].distance)
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "REPLAYFILE");
+
+  std::unique_ptr<DebugReplay> replay(CreateDebugReplay(args));
+  if (!replay)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  const auto points = LoadPoints(*replay);
+  if (points.empty()) {
+    fprintf(stderr, "No fixes\n");
+    return EXIT_FAILURE;
+  }
+
+  ThreadPool thread_pool("Contest", 2);
+
+  static constexpr struct {
+    Contest contest;
+    const char *name;
+  } contests[] = {
+    { Contest::OLC_PLUS, "OLC-Plus" },
+    { Contest::XCONTEST, "XContest" },
+    { Contest::DHV_XC, "DHV-XC" },
+    { Contest::WEGLIDE_FREE, "WeGlide Free" },
+  };
+
+  printf("%zu fixes\n", points.size());
+
+  for (const auto &i : contests) {
+    const auto serial = Run(i.contest, points, nullptr);
+    const auto threaded = Run(i.contest, points, &thread_pool);
+
+    if (!Equals(serial.stats, threaded.stats)) {
+      fprintf(stderr, "%s: scores differ\n", i.name);
+      return EXIT_FAILURE;
+    }
+
+    printf("%s: score %.1f\n", i.name, serial.stats.GetResult().score);
+    printf("  serial:   incremental %.1f ms, final %.1f ms\n",
+           Milliseconds{serial.incremental}.count(),
+           Milliseconds{serial.exhaustive}.count());
+    printf("  threaded: incremental %.1f ms, final %.1f ms\n",
+           Milliseconds{threaded.incremental}.count(),
+           Milliseconds{threaded.exhaustive}.count());
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
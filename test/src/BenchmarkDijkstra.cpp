@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures the Dijkstra based solvers: it replays a
+ * flight into the Dijkstra contest solvers like test_replay_olc
+ * does, and it runs TaskDijkstraMin and TaskDijkstraMax on a
+ * synthetic task like test_task does.
+ */
+
+#include "DebugReplay.hpp"
+#include "Engine/Contest/ContestManager.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMin.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMax.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "system/Args.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static std::vector<TracePoint>
+LoadPoints(DebugReplay &replay)
+{
+  std::vector<TracePoint> points;
+
+  while (replay.Next()) {
+    const MoreData &basic = replay.Basic();
+    if (basic.time_available && basic.location_available &&
+        basic.NavAltitudeAvailable())
+      points.emplace_back(basic);
+  }
+
+  return points;
+}
+
+static void
+RunContest(Contest contest, const char *name,
+           const std::vector<TracePoint> &points)
+{
+  Trace full_trace({}, Trace::null_time, 512);
+  Trace triangle_trace({}, Trace::null_time, 1024);
+  Trace sprint_trace({}, std::chrono::minutes{150}, 128);
+
+  ContestManager manager(contest, full_trace, triangle_trace, sprint_trace);
+  manager.SetIncremental(true);
+
+  const auto start = Clock::now();
+
+  for (const auto &point : points) {
+    full_trace.push_back(point);
+    triangle_trace.push_back(point);
+    sprint_trace.push_back(point);
+    manager.UpdateIdle();
+  }
+
+  manager.SolveExhaustive();
+
+  const auto duration = Clock::now() - start;
+
+  printf("%-16s score %8.2f  %8.1f ms\n",
+         name, manager.GetStats().GetResult().score,
+         Milliseconds{duration}.count());
+}
+
+/**
+ * Create the boundary of a circular observation zone.
+ */
+static SearchPointVector
+MakeCircle(const GeoPoint &center, double radius, unsigned n,
+           const FlatProjection &projection)
+{
+  SearchPointVector v;
+  for (unsigned i = 0; i < n; ++i) {
+    const GeoVector vector(radius, Angle::FullCircle() * i / n);
+    v.emplace_back(vector.EndPoint(center), projection);
+  }
+
+  return v;
+}
+
+static void
+RunTask(unsigned n_points, unsigned n_iterations)
+{
+  static constexpr unsigned n_turnpoints = 6;
+
+  const GeoPoint origin(Angle::Degrees(7.7), Angle::Degrees(51.05));
+  const FlatProjection projection(origin);
+
+  SearchPointVector boundaries[n_turnpoints];
+  for (unsigned i = 0; i < n_turnpoints; ++i) {
+    const GeoVector leg(60000 * (i % 3), Angle::Degrees(120 * i));
+    boundaries[i] = MakeCircle(leg.EndPoint(origin),
+                               i == 0 || i == n_turnpoints - 1 ? 1000 : 20000,
+                               n_points, projection);
+  }
+
+  TaskDijkstraMin dijkstra_min;
+  TaskDijkstraMax dijkstra_max;
+
+  double total_min = 0, total_max = 0;
+
+  const auto start = Clock::now();
+
+  for (unsigned i = 0; i < n_iterations; ++i) {
+    dijkstra_max.SetTaskSize(n_turnpoints);
+    for (unsigned j = 0; j < n_turnpoints; ++j)
+      dijkstra_max.SetBoundary(j, boundaries[j]);
+
+    if (dijkstra_max.DistanceMax())
+      for (unsigned j = 1; j < n_turnpoints; ++j)
+        total_max += dijkstra_max.GetSolution(j).GetLocation()
+          .Distance(dijkstra_max.GetSolution(j - 1).GetLocation());
+
+    /* the aircraft is on its way to the second turn point */
+    const SearchPoint location(GeoVector(30000 + 10 * (i % 1000),
+                                         Angle::Degrees(40))
+                               .EndPoint(origin), projection);
+    dijkstra_min.SetTaskSize(n_turnpoints - 2);
+    for (unsigned j = 2; j < n_turnpoints; ++j)
+      dijkstra_min.SetBoundary(j - 2, boundaries[j]);
+
+    if (dijkstra_min.DistanceMin(location))
+      for (unsigned j = 1; j < n_turnpoints - 2; ++j)
+        total_min += dijkstra_min.GetSolution(j).GetLocation()
+          .Distance(dijkstra_min.GetSolution(j - 1).GetLocation());
+  }
+
+  const auto duration = Clock::now() - start;
+
+  printf("task %3u points   min %.0f max %.0f  %8.1f ms\n", n_points,
+         total_min / n_iterations, total_max / n_iterations,
+         Milliseconds{duration}.count());
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "REPLAYFILE");
+
+  std::unique_ptr<DebugReplay> replay(CreateDebugReplay(args));
+  if (!replay)
+    return EXIT_FAILURE;
+
+  args.ExpectEnd();
+
+  const auto points = LoadPoints(*replay);
+  if (points.empty()) {
+    fprintf(stderr, "No fixes\n");
+    return EXIT_FAILURE;
+  }
+
+  static constexpr struct {
+    Contest contest;
+    const char *name;
+  } contests[] = {
+    { Contest::OLC_SPRINT, "OLC-Sprint" },
+    { Contest::OLC_CLASSIC, "OLC-Classic" },
+    { Contest::OLC_LEAGUE, "OLC-League" },
+    { Contest::DMST, "DMSt" },
+    { Contest::NET_COUPE, "NetCoupe" },
+    { Contest::SIS_AT, "SIS-AT" },
+    { Contest::WEGLIDE_DISTANCE, "WeGlide Distance" },
+    { Contest::CHARRON, "Charron" },
+  };
+
+  printf("%zu fixes\n", points.size());
+
+  for (const auto &i : contests)
+    RunContest(i.contest, i.name, points);
+
+  RunTask(16, 2000);
+  RunTask(64, 200);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
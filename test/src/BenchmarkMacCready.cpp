@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures the MacCready solver on a large number of
+ * targets, like the waypoint renderer and the abort task do: it
+ * solves each target with its own GlideState, and then all targets
+ * at once with a GlideBatch.
+ */
+
+#include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Engine/GlideSolvers/GlideSettings.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/GlideSolvers/GlideState.hpp"
+#include "Engine/GlideSolvers/GlideResult.hpp"
+#include "Engine/GlideSolvers/GlideBatch.hpp"
+#include "Engine/GlideSolvers/MacCready.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static constexpr unsigned N_TARGETS = 5000;
+static constexpr unsigned N_ITERATIONS = 200;
+
+static GlideBatch
+MakeBatch(const SpeedVector wind)
+{
+  GlideBatch batch(1500, wind);
+  batch.reserve(N_TARGETS);
+
+  /* pseudo-random targets within 150 km */
+  unsigned seed = 1;
+  for (unsigned i = 0; i < N_TARGETS; ++i) {
+    seed = seed * 1103515245 + 12345;
+    const double distance = (seed >> 8) % 150000;
+    const Angle bearing = Angle::Degrees((seed >> 4) % 360);
+    const double elevation = (seed >> 12) % 1000;
+    batch.push_back(GeoVector(distance, bearing), elevation + 300);
+  }
+
+  return batch;
+}
+
+static void
+Run(const MacCready &mac_cready, const GlideBatch &batch, bool straight)
+{
+  std::vector<GlideResult> results(batch.size());
+  unsigned reachable = 0;
+
+  auto start = Clock::now();
+
+  for (unsigned n = 0; n < N_ITERATIONS; ++n) {
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      const GlideState state(GeoVector(batch.distances[i], batch.bearings[i]),
+                             batch.min_arrival_altitudes[i], batch.altitude,
+                             batch.wind);
+      results[i] = straight
+        ? mac_cready.SolveStraight(state)
+        : mac_cready.Solve(state);
+    }
+
+    for (const auto &result : results)
+      if (result.IsAchievable())
+        ++reachable;
+  }
+
+  const auto scalar_duration = Clock::now() - start;
+
+  start = Clock::now();
+
+  for (unsigned n = 0; n < N_ITERATIONS; ++n) {
+    if (straight)
+      mac_cready.SolveStraight(batch, results);
+    else
+      mac_cready.Solve(batch, results);
+
+    for (const auto &result : results)
+      if (result.IsAchievable())
+        --reachable;
+  }
+
+  const auto batch_duration = Clock::now() - start;
+
+  printf("%-8s wind %4.1f  scalar %8.1f ms  batch %8.1f ms%s\n",
+         straight ? "straight" : "cruise", batch.wind.norm,
+         Milliseconds{scalar_duration}.count(),
+         Milliseconds{batch_duration}.count(),
+         reachable != 0 ? "  MISMATCH" : "");
+}
+
+int main()
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+
+  GlidePolar polar(1);
+
+  const MacCready mac_cready(settings, polar);
+
+  printf("%u targets, %u iterations\n", N_TARGETS, N_ITERATIONS);
+
+  for (const SpeedVector wind : {SpeedVector::Zero(),
+                                 SpeedVector(Angle::Degrees(250), 8)}) {
+    const auto batch = MakeBatch(wind);
+    Run(mac_cready, batch, true);
+    Run(mac_cready, batch, false);
+  }
+
+  return EXIT_SUCCESS;
+}
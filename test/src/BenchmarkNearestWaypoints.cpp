@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures the lookups which NearestWaypoints performs
+ * on a large synthetic waypoint set, once with the packed
+ * #WaypointIndex and once with the #QuadTree fallback, and verifies
+ * that both return the same results.
+ */
+
+#include "Waypoint/Waypoints.hpp"
+#include "system/Args.hpp"
+#include "util/StringCompare.hxx"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+static unsigned seed = 1;
+
+static unsigned
+Random() noexcept
+{
+  seed = seed * 1103515245 + 12345;
+  return seed >> 8;
+}
+
+/**
+ * A pseudo-random location in a 20x10 degree area, like a large
+ * country-wide waypoint file.
+ */
+static GeoPoint
+RandomLocation() noexcept
+{
+  return GeoPoint(Angle::Degrees(0. + (Random() % 2000000) / 100000.),
+                  Angle::Degrees(40. + (Random() % 1000000) / 100000.));
+}
+
+static Waypoint
+MakeWaypoint(const GeoPoint &location) noexcept
+{
+  Waypoint waypoint(location);
+
+  /* 5% airfields, 15% outlanding fields, the rest turn points */
+  const unsigned r = Random() % 100;
+  waypoint.type = r < 5
+    ? Waypoint::Type::AIRFIELD
+    : (r < 20 ? Waypoint::Type::OUTLANDING : Waypoint::Type::NORMAL);
+  return waypoint;
+}
+
+/**
+ * @param packed use the #WaypointIndex?
+ */
+static void
+Fill(Waypoints &waypoints, const std::vector<GeoPoint> &locations,
+     bool packed) noexcept
+{
+  seed = 42;
+  for (const auto &i : locations)
+    waypoints.Append(MakeWaypoint(i));
+
+  if (packed) {
+    waypoints.Optimise();
+  } else {
+    /* erasing a waypoint after Optimise() clears the packed index,
+       but the QuadTree remains usable */
+    auto extra = waypoints.Append(MakeWaypoint(locations.front()));
+    waypoints.Optimise();
+    waypoints.Erase(std::move(extra));
+  }
+}
+
+static bool
+IsAirport(const Waypoint &waypoint) noexcept
+{
+  return waypoint.IsAirport();
+}
+
+struct Results {
+  std::vector<const Waypoint *> nearest, landable, airport;
+  unsigned long visited = 0;
+};
+
+static Results
+Run(const char *name, const Waypoints &waypoints,
+    const std::vector<GeoPoint> &queries, double range)
+{
+  Results results;
+  results.nearest.reserve(queries.size());
+  results.landable.reserve(queries.size());
+  results.airport.reserve(queries.size());
+
+  auto start = Clock::now();
+  for (const auto &i : queries)
+    results.nearest.push_back(waypoints.GetNearest(i, range).get());
+  const auto nearest_duration = Clock::now() - start;
+
+  start = Clock::now();
+  for (const auto &i : queries)
+    results.landable.push_back(waypoints.GetNearestLandable(i, range).get());
+  const auto landable_duration = Clock::now() - start;
+
+  start = Clock::now();
+  for (const auto &i : queries)
+    results.airport.push_back(waypoints.GetNearestIf(i, range,
+                                                     IsAirport).get());
+  const auto airport_duration = Clock::now() - start;
+
+  start = Clock::now();
+  for (const auto &i : queries)
+    waypoints.VisitWithinRange(i, range, [&results](const WaypointPtr &){
+      ++results.visited;
+    });
+  const auto visit_duration = Clock::now() - start;
+
+  printf("%-8s nearest %8.1f ms  landable %8.1f ms  airport %8.1f ms  visit %8.1f ms\n",
+         name,
+         Milliseconds{nearest_duration}.count(),
+         Milliseconds{landable_duration}.count(),
+         Milliseconds{airport_duration}.count(),
+         Milliseconds{visit_duration}.count());
+
+  return results;
+}
+
+/**
+ * Count the results which differ.  Both containers were filled in
+ * the same order, so the same waypoint has the same id in both.
+ * Different waypoints at the same projected distance are
+ * equivalent.
+ */
+static unsigned
+Compare(const std::vector<const Waypoint *> &a,
+        const std::vector<const Waypoint *> &b,
+        const Waypoints &waypoints,
+        const std::vector<GeoPoint> &queries) noexcept
+{
+  unsigned n = 0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if ((a[i] == nullptr) != (b[i] == nullptr)) {
+      ++n;
+    } else if (a[i] != nullptr && a[i]->id != b[i]->id) {
+      const auto q = waypoints.GetProjection().ProjectInteger(queries[i]);
+      if (a[i]->flat_location.DistanceSquared(q) !=
+          b[i]->flat_location.DistanceSquared(q))
+        ++n;
+    }
+  }
+
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned n_waypoints = 50000;
+  unsigned n_queries = 20000;
+  double range = 100000;
+
+  Args args(argc, argv,
+            "[--waypoints=N] [--queries=N] [--range=M]");
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--waypoints=")) != nullptr)
+      n_waypoints = strtoul(value, nullptr, 10);
+    else if ((value = StringAfterPrefix(arg, "--queries=")) != nullptr)
+      n_queries = strtoul(value, nullptr, 10);
+    else if ((value = StringAfterPrefix(arg, "--range=")) != nullptr)
+      range = strtod(value, nullptr);
+    else
+      args.UsageError();
+  }
+
+  args.ExpectEnd();
+
+  if (n_waypoints == 0)
+    args.UsageError();
+
+  std::vector<GeoPoint> locations;
+  locations.reserve(n_waypoints);
+  for (unsigned i = 0; i < n_waypoints; ++i)
+    locations.push_back(RandomLocation());
+
+  std::vector<GeoPoint> queries;
+  queries.reserve(n_queries);
+  for (unsigned i = 0; i < n_queries; ++i)
+    queries.push_back(RandomLocation());
+
+  Waypoints packed, quad_tree;
+  Fill(packed, locations, true);
+  Fill(quad_tree, locations, false);
+
+  printf("%u waypoints, %u queries, range %.0f m\n",
+         n_waypoints, n_queries, range);
+
+  const auto a = Run("packed", packed, queries, range);
+  const auto b = Run("quadtree", quad_tree, queries, range);
+
+  const unsigned mismatches =
+    Compare(a.nearest, b.nearest, packed, queries) +
+    Compare(a.landable, b.landable, packed, queries) +
+    Compare(a.airport, b.airport, packed, queries) +
+    (a.visited != b.visited);
+  if (mismatches > 0) {
+    printf("%u MISMATCHES\n", mismatches);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures the pixel loops of #RasterRenderer (see
+ * #RasterShading) for a full-screen terrain image at several
+ * quantisation levels, comparing the portable and the vectorised
+ * implementation.  It fails if the two produce different images.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/RasterShading.hpp"
+#include "Terrain/HeightMatrix.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/Operation.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Screen/Layout.hpp"
+#include "ui/canvas/RawBitmap.hpp"
+#include "Math/Angle.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include <stdio.h>
+#include <string.h>
+
+unsigned Layout::scale_1024 = 1024;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr PixelSize screen_size{800, 480};
+
+static constexpr unsigned quantisations[] = { 1, 2, 3, 4 };
+
+static constexpr unsigned N_ITERATIONS = 50;
+
+/**
+ * Generate the image #N_ITERATIONS times.
+ *
+ * @return the average duration of one image in milliseconds
+ */
+static double
+Run(RasterShading s, bool simd, bool slope,
+    int sx, int sy, int sz, unsigned height_slope_factor) noexcept
+{
+  s.simd = simd;
+
+  const auto start = Clock::now();
+
+  for (unsigned i = 0; i < N_ITERATIONS; ++i) {
+    s.ContourStart();
+    if (slope)
+      s.GenerateSlopeImage(64, sx, sy, sz, 1, height_slope_factor);
+    else
+      s.GenerateUnshadedImage();
+  }
+
+  const std::chrono::duration<double, std::milli> duration =
+    Clock::now() - start;
+  return duration.count() / N_ITERATIONS;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  {
+    NullOperationEnvironment operation;
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  WindowProjection projection;
+  projection.SetScreenSize(screen_size);
+  projection.SetScaleFromRadius(50000);
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(screen_size.width / 2, screen_size.height / 2);
+  projection.UpdateScreenBounds();
+
+  /* the same light source as RasterRenderer::GenerateSlopeImage()
+     with default settings */
+  const Angle sunazimuth = Angle::Degrees(45);
+  const Angle fudgeelevation = Angle::Degrees(10) +
+    Angle::Degrees(80.0 / 255.0) * 128;
+  const int sx = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastsine());
+  const int sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
+  const int sz = (int)(255 * fudgeelevation.fastsine());
+
+  /* a color table with distinct entries, to detect differences */
+  const auto color_table = std::make_unique<RawColor[]>(256 * 128);
+  for (unsigned i = 0; i < 256 * 128; ++i)
+    color_table[i] = RawColor(i, i >> 8, i * 31);
+
+  printf("SIMD available: %s\n",
+         RasterShading::IsSIMDAvailable() ? "yes" : "no");
+
+  for (const unsigned quantisation_pixels : quantisations) {
+    HeightMatrix matrix;
+#ifdef ENABLE_OPENGL
+    matrix.Fill(map, projection.GetScreenBounds(),
+                (UnsignedPoint2D)screen_size / quantisation_pixels,
+                true);
+#else
+    matrix.Fill(map, projection, quantisation_pixels, true);
+#endif
+
+    const auto size = matrix.GetSize();
+    const unsigned height_slope_factor =
+      std::clamp((unsigned)projection.DistancePixelsToMeters(quantisation_pixels),
+                 1u, 8192u);
+
+    const auto portable_image = std::make_unique<RawColor[]>(size.Area());
+    const auto simd_image = std::make_unique<RawColor[]>(size.Area());
+    const auto contour = std::make_unique<uint8_t[]>(size.x);
+
+    RasterShading s{
+      matrix.GetData(), size,
+      color_table.get(),
+      nullptr, std::ptrdiff_t(size.x),
+      contour.get(),
+      4, 8,
+      false,
+    };
+
+    for (const bool slope : {false, true}) {
+      s.dest = portable_image.get();
+      const double portable = Run(s, false, slope, sx, sy, sz,
+                                  height_slope_factor);
+
+      s.dest = simd_image.get();
+      const double simd = Run(s, true, slope, sx, sy, sz,
+                              height_slope_factor);
+
+      printf("quantisation=%u %ux%u %s: portable %.3f ms, SIMD %.3f ms\n",
+             quantisation_pixels, size.x, size.y,
+             slope ? "slope" : "unshaded",
+             portable, simd);
+
+      if (memcmp(portable_image.get(), simd_image.get(),
+                 size.Area() * sizeof(RawColor)) != 0) {
+        fprintf(stderr, "Images differ\n");
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
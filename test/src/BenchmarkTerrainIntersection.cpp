@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures RasterMap::FirstIntersection() and
+ * RasterMap::GroundIntersection() for random rays of several lengths,
+ * with and without the optimisations of #RasterTileCache (closed-form
+ * line stepping and #HeightPyramid).  It fails if the results differ.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/Operation.hpp"
+#include "Geo/GeoVector.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Ray lengths in meters.
+ */
+static constexpr double lengths[] = { 1000, 5000, 20000, 80000 };
+
+static constexpr unsigned N_RAYS = 20000;
+
+struct Ray {
+  GeoPoint origin, destination;
+  int h_origin, h_destination, h_glide;
+};
+
+static std::vector<Ray>
+MakeRays(const RasterMap &map, double length) noexcept
+{
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> random_lat(map.GetBounds().GetSouth().Degrees(),
+                                                    map.GetBounds().GetNorth().Degrees());
+  std::uniform_real_distribution<double> random_lon(map.GetBounds().GetWest().Degrees(),
+                                                    map.GetBounds().GetEast().Degrees());
+  std::uniform_real_distribution<double> random_bearing(0, 360);
+  std::uniform_int_distribution<int> random_height(0, 1500);
+
+  std::vector<Ray> rays;
+  rays.reserve(N_RAYS);
+
+  for (unsigned i = 0; i < N_RAYS; ++i) {
+    const GeoPoint origin(Angle::Degrees(random_lon(rng)),
+                          Angle::Degrees(random_lat(rng)));
+    const GeoPoint destination =
+      GeoVector(length, Angle::Degrees(random_bearing(rng))).EndPoint(origin);
+    const int h_terrain = map.GetHeight(origin).GetValueOr0();
+
+    rays.push_back({
+      origin, destination,
+      h_terrain + random_height(rng),
+      h_terrain + random_height(rng),
+      int(length / 30),
+    });
+  }
+
+  return rays;
+}
+
+struct Results {
+  std::vector<RasterMap::Intersection> first;
+  std::vector<GeoPoint> ground;
+};
+
+static Results
+Run(const std::vector<Ray> &rays, const RasterMap &map,
+    double &first_duration, double &ground_duration) noexcept
+{
+  Results results;
+  results.first.reserve(rays.size());
+  results.ground.reserve(rays.size());
+
+  using Microseconds = std::chrono::duration<double, std::micro>;
+
+  auto start = Clock::now();
+  for (const auto &ray : rays)
+    results.first.push_back(map.FirstIntersection(ray.origin, ray.h_origin,
+                                                  ray.destination,
+                                                  ray.h_destination,
+                                                  ray.h_glide,
+                                                  ray.h_origin + 3000,
+                                                  100));
+  first_duration = Microseconds{Clock::now() - start}.count() / rays.size();
+
+  start = Clock::now();
+  for (const auto &ray : rays)
+    results.ground.push_back(map.GroundIntersection(ray.origin, ray.h_origin,
+                                                    ray.h_glide,
+                                                    ray.destination, 0));
+  ground_duration = Microseconds{Clock::now() - start}.count() / rays.size();
+
+  return results;
+}
+
+static bool
+operator==(const RasterMap::Intersection &a,
+           const RasterMap::Intersection &b) noexcept
+{
+  if (!a || !b)
+    return bool(a) == bool(b);
+
+  return a.location == b.location && a.height == b.height;
+}
+
+static bool
+operator==(const Results &a, const Results &b) noexcept
+{
+  if (a.first != b.first)
+    return false;
+
+  for (std::size_t i = 0; i < a.ground.size(); ++i)
+    if (a.ground[i].IsValid() != b.ground[i].IsValid() ||
+        (a.ground[i].IsValid() && a.ground[i] != b.ground[i]))
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  {
+    NullOperationEnvironment operation;
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  for (const double length : lengths) {
+    const auto rays = MakeRays(map, length);
+
+    double plain_first, plain_ground, fast_first, fast_ground;
+
+    map.GetTileCache().SetFastIntersection(false);
+    const auto plain = Run(rays, map, plain_first, plain_ground);
+
+    map.GetTileCache().SetFastIntersection(true);
+    const auto fast = Run(rays, map, fast_first, fast_ground);
+
+    printf("length=%.0f m: FirstIntersection plain %.2f us, fast %.2f us; "
+           "GroundIntersection plain %.2f us, fast %.2f us\n",
+           length, plain_first, fast_first, plain_ground, fast_ground);
+
+    if (!(plain == fast)) {
+      fprintf(stderr, "Results differ\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures the time it takes to bring all tiles around
+ * the map center to the front ("time to first full map"): by
+ * decoding the JPEG2000 file (with one and with several threads) and
+ * from the #RawTileStore generated by ConvertTerrainTiles (if
+ * CACHEDIR is given).
+ */
+
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/RawTileStore.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/Operation.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/FileCache.hpp"
+#include "thread/ThreadPool.hpp"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <stdio.h>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr unsigned N_THREADS = 4;
+
+/**
+ * Sample the whole map, to make sure the tile data is really paged
+ * in.
+ */
+static long
+SampleMap(const RasterTileCache &rtc) noexcept
+{
+  constexpr unsigned n = 1024;
+  const auto fine_size = rtc.GetFineSize();
+
+  TerrainHeight buffer[n];
+  long sum = 0;
+  for (unsigned y = 0; y < n; ++y) {
+    const unsigned fy = (unsigned long)fine_size.y * y / n;
+    rtc.ScanLine({0, fy}, {fine_size.x - 1, fy}, buffer, n, false);
+
+    for (const auto h : buffer)
+      sum += h.GetValueOr0();
+  }
+
+  return sum;
+}
+
+template<typename U>
+static void
+Run(const char *name, RasterTileCache &rtc, U &&update)
+{
+  const SignedRasterLocation center(rtc.GetSize().x / 2,
+                                    rtc.GetSize().y / 2);
+  const unsigned radius = std::max(rtc.GetSize().x, rtc.GetSize().y);
+
+  const auto start = Clock::now();
+
+  unsigned n_passes = 0;
+  do {
+    update(center, radius);
+    ++n_passes;
+  } while (rtc.IsDirty());
+
+  const long sum = SampleMap(rtc);
+
+  const std::chrono::duration<double> duration = Clock::now() - start;
+  printf("%s: %.3f s (%u passes, checksum %ld)\n",
+         name, duration.count(), n_passes, sum);
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "MAP [CACHEDIR]");
+  const auto map_path = args.ExpectNextPath();
+
+  ZipArchive archive(map_path);
+  SharedMutex mutex;
+
+  {
+    NullOperationEnvironment operation;
+    auto rtc = std::make_unique<RasterTileCache>();
+    LoadTerrainOverview(archive.get(), *rtc, operation);
+
+    Run("JPEG2000", *rtc, [&](SignedRasterLocation p, unsigned radius){
+      UpdateTerrainTiles(archive.get(), *rtc, mutex, p, radius);
+    });
+  }
+
+  {
+    std::vector<ZipArchive> archives;
+    std::vector<struct zzip_dir *> dirs;
+    for (unsigned i = 0; i < N_THREADS; ++i)
+      dirs.push_back(archives.emplace_back(map_path).get());
+
+    ThreadPool pool("Decode", N_THREADS - 1);
+
+    NullOperationEnvironment operation;
+    auto rtc = std::make_unique<RasterTileCache>();
+    LoadTerrainOverview(archive.get(), *rtc, operation);
+
+    Run("JPEG2000 parallel", *rtc,
+        [&](SignedRasterLocation p, unsigned radius){
+          UpdateTerrainTiles(pool, dirs, *rtc, mutex, p, radius);
+        });
+  }
+
+  if (args.IsEmpty())
+    return EXIT_SUCCESS;
+
+  const auto cache_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  FileCache cache{Path{cache_path}};
+  const auto store = RawTileStore::Open(cache, map_path);
+  if (!store) {
+    fprintf(stderr, "No raw tile store; run ConvertTerrainTiles first\n");
+    return EXIT_FAILURE;
+  }
+
+  {
+    NullOperationEnvironment operation;
+    auto rtc = std::make_unique<RasterTileCache>();
+    LoadTerrainOverview(archive.get(), *rtc, operation);
+
+    if (!store->IsCompatible(*rtc)) {
+      fprintf(stderr, "Raw tile store does not match the map file\n");
+      return EXIT_FAILURE;
+    }
+
+    Run("raw", *rtc, [&](SignedRasterLocation p, unsigned radius){
+      UpdateTerrainTiles(*store, *rtc, mutex, p, radius);
+    });
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
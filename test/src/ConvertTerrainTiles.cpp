@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program decodes all tiles of a map file and stores them in a
+ * #RawTileStore inside the specified cache directory (usually
+ * "~/.xcsoar/cache").
+ */
+
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/RawTileStore.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/ConsoleOperationEnvironment.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/FileCache.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "util/PrintException.hxx"
+
+#include <stdio.h>
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "MAP CACHEDIR");
+  const auto map_path = args.ExpectNextPath();
+  const auto cache_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  FileCache cache{Path{cache_path}};
+  auto os = cache.Save(RawTileStore::CACHE_NAME, map_path);
+  BufferedOutputStream bos(*os);
+
+  RasterTileCache rtc;
+  RawTileWriter writer(bos);
+
+  {
+    ConsoleOperationEnvironment operation;
+    ConvertTerrainTiles(archive.get(), rtc, writer, operation);
+  }
+
+  bos.Flush();
+  os->Commit();
+
+  printf("size = %ux%u\n", rtc.GetSize().x, rtc.GetSize().y);
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -2,21 +2,80 @@
 // Copyright The XCSoar Project
 
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "system/Args.hpp"
+#include "io/FileCache.hpp"
 #include "io/FileLineReader.hpp"
+#include "io/FileReader.hxx"
 #include "Operation/ConsoleOperationEnvironment.hpp"
 #include "util/PrintException.hxx"
 
+#include <chrono>
+
 #include <stdio.h>
 #include <tchar.h>
 
+using Clock = std::chrono::steady_clock;
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+/**
+ * Compare parsing the file with loading it from the airspace cache
+ * in the given directory.
+ */
+static int
+RunCache(Path path, AllocatedPath &&cache_path, const Airspaces &parsed,
+         Clock::duration parse_duration)
+{
+  auto start = Clock::now();
+
+  AirspaceCacheKey key;
+  {
+    FileReader reader(path);
+    key.Update(reader);
+  }
+  key.Finish();
+
+  const auto key_duration = Clock::now() - start;
+
+  FileCache cache{std::move(cache_path)};
+  SaveAirspaceCache(cache, path, key, parsed);
+
+  Airspaces loaded;
+
+  start = Clock::now();
+  if (!LoadAirspaceCache(cache, path, key, loaded)) {
+    fprintf(stderr, "Failed to load the cache\n");
+    return EXIT_FAILURE;
+  }
+
+  const auto load_duration = Clock::now() - start;
+
+  if (loaded.GetSize() != parsed.GetSize()) {
+    fprintf(stderr, "Cache has %u airspaces instead of %u\n",
+            loaded.GetSize(), parsed.GetSize());
+    return EXIT_FAILURE;
+  }
+
+  printf("%u airspaces\n", parsed.GetSize());
+  printf("parse %.2f ms, digest %.2f ms, cache load %.2f ms\n",
+         Milliseconds{parse_duration}.count(),
+         Milliseconds{key_duration}.count(),
+         Milliseconds{load_duration}.count());
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv)
 try {
-  Args args(argc, argv, "PATH");
+  Args args(argc, argv, "PATH [CACHEDIR]");
   const auto path = args.ExpectNextPath();
+  AllocatedPath cache_path = nullptr;
+  if (!args.IsEmpty())
+    cache_path = args.ExpectNextPath();
   args.ExpectEnd();
 
+  const auto start = Clock::now();
+
   FileLineReader reader(path, Charset::AUTO);
 
   Airspaces airspaces;
@@ -26,6 +85,10 @@ try {
 
   airspaces.Optimise();
 
+  if (cache_path != nullptr)
+    return RunCache(path, std::move(cache_path), airspaces,
+                    Clock::now() - start);
+
   printf("OK\n");
 
   return EXIT_SUCCESS;
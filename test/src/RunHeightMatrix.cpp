@@ -1,22 +1,142 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // Copyright The XCSoar Project
 
+/*
+ * This program fills a #HeightMatrix, then pans the map step by step
+ * and measures HeightMatrix::Update() against a complete scan.  With
+ * OpenGL, the rescanned cells must be exactly equal to the complete
+ * scan, and the shifted cells to the previous matrix.
+ * Finally, it verifies that a scan with a #ThreadPool produces exactly
+ * the same matrix as a scan by the calling thread.
+ */
+
 #include "Terrain/RasterMap.hpp"
 #include "Terrain/HeightMatrix.hpp"
 #include "Terrain/Loader.hpp"
 #include "Operation/ConsoleOperationEnvironment.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Screen/Layout.hpp"
+#include "thread/ThreadPool.hpp"
 #include "system/Args.hpp"
 #include "io/ZipArchive.hpp"
 #include "util/PrintException.hxx"
 
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
 #include <stdio.h>
 #include <string.h>
 #include <tchar.h>
 
 unsigned Layout::scale_1024 = 1024;
 
+using Clock = std::chrono::steady_clock;
+
+static constexpr unsigned N_STEPS = 100;
+
+/**
+ * The distance the map moves in each step (in pixels).
+ */
+static constexpr PixelPoint step{3, -2};
+
+/**
+ * The number of worker threads for the parallel scan; this is fixed
+ * (and not derived from the number of CPU cores) so the row bands are
+ * exercised on every machine.
+ */
+static constexpr unsigned N_WORKERS = 3;
+
+/**
+ * Calculate the mean absolute difference between the cells (x,y) of
+ * "a" and (x+dx,y) of "b", ignoring special values.
+ */
+static double
+MeanDifference(const HeightMatrix &a, const HeightMatrix &b,
+               unsigned dx=0) noexcept
+{
+  assert(a.GetSize() == b.GetSize());
+
+  const auto size = a.GetSize();
+  unsigned long sum = 0, n = 0;
+
+  for (unsigned y = 0; y < size.y; ++y) {
+    const TerrainHeight *row_a = a.GetRow(y), *row_b = b.GetRow(y) + dx;
+    for (unsigned x = 0; x + dx < size.x; ++x) {
+      if (row_a[x].IsSpecial() || row_b[x].IsSpecial())
+        continue;
+
+      sum += std::abs(row_a[x].GetValue() - row_b[x].GetValue());
+      ++n;
+    }
+  }
+
+  return n > 0 ? double(sum) / n : 0;
+}
+
+#ifdef ENABLE_OPENGL
+
+/**
+ * Verify a matrix which was updated from "previous" (scanned at
+ * "previous_bounds") to "bounds": the shifted cells must be equal to
+ * the previous ones, and the rescanned cells must be equal to the
+ * complete scan "reference".
+ *
+ * The shifted cells are not compared with the complete scan:
+ * RasterMap::ScanLine() spreads the samples of each map tile evenly,
+ * and the number of samples per tile depends on where the row starts.
+ *
+ * @param shifted false if Update() has scanned the whole matrix
+ * @return false after printing the first mismatch
+ */
+static bool
+CheckUpdate(const HeightMatrix &matrix, const HeightMatrix &reference,
+            const std::vector<TerrainHeight> &previous,
+            const GeoBounds &previous_bounds, const GeoBounds &bounds,
+            bool shifted) noexcept
+{
+  assert(matrix.GetSize() == reference.GetSize());
+
+  const auto size = matrix.GetSize();
+  assert(previous.size() == size.Area());
+
+  const Angle delta_x = previous_bounds.GetWidth() / size.x;
+  const Angle delta_y = previous_bounds.GetHeight() / size.y;
+  const int dx = shifted
+    ? (int)std::lround((bounds.GetWest() - previous_bounds.GetWest()) / delta_x)
+    : int(size.x);
+  const int dy = shifted
+    ? (int)std::lround((previous_bounds.GetNorth() - bounds.GetNorth()) / delta_y)
+    : int(size.y);
+
+  for (unsigned y = 0; y < size.y; ++y) {
+    const TerrainHeight *row = matrix.GetRow(y);
+    const TerrainHeight *reference_row = reference.GetRow(y);
+    const int old_y = int(y) + dy;
+
+    for (unsigned x = 0; x < size.x; ++x) {
+      const int old_x = int(x) + dx;
+      const bool reused = old_x >= 0 && old_x < int(size.x) &&
+        old_y >= 0 && old_y < int(size.y);
+      const TerrainHeight expected = reused
+        ? previous[old_y * size.x + old_x]
+        : reference_row[x];
+
+      if (row[x].GetValue() != expected.GetValue()) {
+        fprintf(stderr, "%s cell differs: row %u column %u\n",
+                reused ? "Shifted" : "Rescanned", y, x);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+#endif
+
 int main(int argc, char **argv)
 try {
   Args args(argc, argv, "PATH");
@@ -49,15 +169,125 @@ try {
   projection.SetScreenOrigin(320, 240);
   projection.UpdateScreenBounds();
 
+  /* interpolate like RasterRenderer::ScanMap() */
   HeightMatrix matrix;
 #ifdef ENABLE_OPENGL
-  matrix.Fill(map, projection.GetScreenBounds(),
-              (UnsignedPoint2D)projection.GetScreenSize(),
-              false);
+  const auto size = (UnsignedPoint2D)projection.GetScreenSize();
+  GeoBounds previous_bounds = projection.GetScreenBounds();
+  matrix.Fill(map, previous_bounds, size, true);
+  std::vector<TerrainHeight> previous;
 #else
-  matrix.Fill(map, projection, 1, false);
+  matrix.Fill(map, projection, 1, true);
+#endif
+
+  /* pan the map step by step, update the matrix incrementally and
+     compare it with a complete scan */
+
+  HeightMatrix reference;
+  Clock::duration update_duration{}, fill_duration{};
+  double difference = 0, offset_difference = 0;
+
+  for (unsigned i = 0; i < N_STEPS; ++i) {
+    const GeoPoint location =
+      projection.ScreenToGeo(projection.GetScreenOrigin() + step);
+    projection.SetGeoLocation(location);
+    projection.UpdateScreenBounds();
+
+#ifdef ENABLE_OPENGL
+    previous.assign(matrix.GetData(), matrix.GetDataEnd());
+    const auto n_updates = matrix.GetStatistics().updates;
 #endif
 
+    auto start = Clock::now();
+#ifdef ENABLE_OPENGL
+    GeoBounds bounds = projection.GetScreenBounds();
+    matrix.Update(map, bounds, size, true);
+#else
+    matrix.Update(map, projection, 1, true);
+#endif
+    update_duration += Clock::now() - start;
+
+    start = Clock::now();
+#ifdef ENABLE_OPENGL
+    reference.Fill(map, bounds, size, true);
+#else
+    reference.Fill(map, projection, 1, true);
+#endif
+    fill_duration += Clock::now() - start;
+
+#ifdef ENABLE_OPENGL
+    if (!CheckUpdate(matrix, reference, previous, previous_bounds, bounds,
+                     matrix.GetStatistics().updates != n_updates)) {
+      fprintf(stderr, "Step %u failed\n", i);
+      return EXIT_FAILURE;
+    }
+
+    previous_bounds = bounds;
+#endif
+
+    difference += MeanDifference(matrix, reference);
+    offset_difference += MeanDifference(reference, reference, 1);
+  }
+
+  const auto &statistics = matrix.GetStatistics();
+  printf("full scans: %lu\n"
+         "updates: %lu\n"
+         "rescanned rows: %lu\n"
+         "rescanned columns: %lu\n",
+         statistics.full_scans, statistics.updates,
+         statistics.rows, statistics.columns);
+
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  printf("update: %.3f ms, fill: %.3f ms\n",
+         Milliseconds{update_duration}.count() / N_STEPS,
+         Milliseconds{fill_duration}.count() / N_STEPS);
+
+  /* the shifted cells may differ a bit from a complete scan (see
+     CheckUpdate()); the differences must stay below those of a
+     matrix which is misaligned by one cell */
+  printf("mean difference to a complete scan: %.2f m\n"
+         "mean difference with one cell offset: %.2f m\n",
+         difference / N_STEPS, offset_difference / N_STEPS);
+  if (difference > offset_difference) {
+    fprintf(stderr, "Too many differences\n");
+    return EXIT_FAILURE;
+  }
+
+  /* scan the last position again with worker threads */
+
+  ThreadPool thread_pool("HeightMatrix", N_WORKERS);
+  HeightMatrix parallel;
+  parallel.SetThreadPool(&thread_pool);
+
+  auto start = Clock::now();
+#ifdef ENABLE_OPENGL
+  GeoBounds bounds = projection.GetScreenBounds();
+  reference.Fill(map, bounds, size, true);
+#else
+  reference.Fill(map, projection, 1, true);
+#endif
+  const auto serial_duration = Clock::now() - start;
+
+  start = Clock::now();
+#ifdef ENABLE_OPENGL
+  parallel.Fill(map, bounds, size, true);
+#else
+  parallel.Fill(map, projection, 1, true);
+#endif
+  const auto parallel_duration = Clock::now() - start;
+
+  printf("serial fill: %.3f ms, parallel fill (%u threads): %.3f ms\n",
+         Milliseconds{serial_duration}.count(),
+         thread_pool.GetConcurrency(),
+         Milliseconds{parallel_duration}.count());
+
+  if (parallel.GetSize() != reference.GetSize() ||
+      memcmp(parallel.GetData(), reference.GetData(),
+             reference.GetSize().Area() * sizeof(TerrainHeight)) != 0) {
+    fprintf(stderr, "Parallel scan differs\n");
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 } catch (const std::runtime_error &e) {
   PrintException(e);
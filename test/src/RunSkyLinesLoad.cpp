@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * A load generator for a SkyLines tracking server (e.g.
+ * xcsoar-cloud-server).  It simulates many clients, each with its own
+ * UDP socket, which submit a fix every second and request nearby
+ * traffic.  At the end, it prints how many packets were exchanged.
+ */
+
+#include "Tracking/SkyLines/Client.hpp"
+#include "Tracking/SkyLines/Handler.hpp"
+#include "NMEA/Info.hpp"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "system/Args.hpp"
+#include "event/Loop.hxx"
+#include "event/FineTimerEvent.hxx"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+
+#include <forward_list>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace std::chrono;
+
+/**
+ * Each client sends a fix at this interval.
+ */
+static constexpr milliseconds FIX_INTERVAL = seconds(1);
+
+/**
+ * The fixes are spread over this many slots per #FIX_INTERVAL.
+ */
+static constexpr unsigned N_SLOTS = 10;
+
+/**
+ * Each client renews its traffic request at this interval.
+ */
+static constexpr auto TRAFFIC_REQUEST_INTERVAL = minutes(1);
+
+/**
+ * Wait this long for late responses after the last fix.
+ */
+static constexpr auto LINGER = seconds(1);
+
+struct Statistics {
+  unsigned long fixes = 0, traffic_requests = 0;
+  unsigned long traffic = 0;
+  unsigned long errors = 0;
+};
+
+class SimulatedClient final : public SkyLinesTracking::Handler {
+  Statistics &statistics;
+
+  SkyLinesTracking::Client client;
+
+  GeoPoint location;
+
+public:
+  SimulatedClient(EventLoop &event_loop, Statistics &_statistics,
+                  uint64_t key, GeoPoint _location) noexcept
+    :statistics(_statistics),
+     client(event_loop, this),
+     location(_location)
+  {
+    client.SetKey(key);
+  }
+
+  void Open(SocketAddress address) {
+    if (!client.Open(address))
+      throw std::runtime_error("Failed to create socket");
+  }
+
+  void SendFix(TimeStamp time) {
+    /* fly slowly eastwards */
+    location.longitude += Angle::Degrees(0.0005);
+
+    NMEAInfo basic;
+    basic.Reset();
+    basic.UpdateClock();
+    basic.time = time;
+    basic.time_available.Update(basic.clock);
+    basic.location = location;
+    basic.location_available.Update(basic.clock);
+    basic.gps_altitude = 1500;
+    basic.gps_altitude_available.Update(basic.clock);
+
+    client.SendFix(basic);
+    ++statistics.fixes;
+  }
+
+  void SendTrafficRequest() {
+    client.SendTrafficRequest(false, false, true);
+    ++statistics.traffic_requests;
+  }
+
+  /* virtual methods from SkyLinesTracking::Handler */
+  void OnTraffic(uint32_t, unsigned, const GeoPoint &, int) override {
+    ++statistics.traffic;
+  }
+
+  void OnSkyLinesError(std::exception_ptr e) override {
+    if (statistics.errors++ == 0)
+      PrintException(e);
+  }
+};
+
+class LoadGenerator {
+  EventLoop &event_loop;
+
+  Statistics statistics;
+
+  std::forward_list<SimulatedClient> clients;
+  std::vector<SimulatedClient *> client_index;
+
+  FineTimerEvent slot_timer{event_loop, BIND_THIS_METHOD(OnSlotTimer)};
+  FineTimerEvent stop_timer{event_loop, BIND_THIS_METHOD(OnStopTimer)};
+
+  unsigned n_rounds, round = 0, slot = 0;
+
+  steady_clock::time_point start_time;
+
+public:
+  LoadGenerator(EventLoop &_event_loop, SocketAddress address,
+                unsigned n_clients, unsigned _n_rounds)
+    :event_loop(_event_loop), n_rounds(_n_rounds)
+  {
+    /* a 2x3 degree area; with the server's 50 km traffic range,
+       each client sees roughly 15% of the others */
+    srand(42);
+    for (unsigned i = 0; i < n_clients; ++i) {
+      const GeoPoint location(Angle::Degrees(10 + (rand() % 3000) / 1000.),
+                              Angle::Degrees(46 + (rand() % 2000) / 1000.));
+      auto &client = clients.emplace_front(event_loop, statistics,
+                                           0x10000 + i, location);
+      client.Open(address);
+      client_index.push_back(&client);
+    }
+  }
+
+  void Start() noexcept {
+    start_time = steady_clock::now();
+    slot_timer.Schedule(seconds(0));
+  }
+
+  void PrintStatistics() const noexcept {
+    const duration<double> elapsed = steady_clock::now() - start_time;
+
+    printf("%zu clients, %.1f s\n"
+           "sent %lu fixes (%.0f/s), %lu traffic requests\n"
+           "received %lu traffic records (%.0f/s)\n"
+           "%lu errors\n",
+           client_index.size(), elapsed.count(),
+           statistics.fixes, statistics.fixes / elapsed.count(),
+           statistics.traffic_requests,
+           statistics.traffic, statistics.traffic / elapsed.count(),
+           statistics.errors);
+  }
+
+private:
+  void OnSlotTimer() noexcept {
+    const std::size_t n = client_index.size();
+    const std::size_t begin = n * slot / N_SLOTS;
+    const std::size_t end = n * (slot + 1) / N_SLOTS;
+
+    const TimeStamp time{duration_cast<FloatDuration>(hours(10) +
+                                                      FIX_INTERVAL * round)};
+    const bool request_traffic = round % (TRAFFIC_REQUEST_INTERVAL /
+                                          FIX_INTERVAL) == 0;
+
+    for (std::size_t i = begin; i < end; ++i) {
+      auto &client = *client_index[i];
+
+      try {
+        client.SendFix(time);
+        if (request_traffic)
+          client.SendTrafficRequest();
+      } catch (...) {
+        client.OnSkyLinesError(std::current_exception());
+      }
+    }
+
+    if (++slot == N_SLOTS) {
+      slot = 0;
+
+      if (++round == n_rounds) {
+        stop_timer.Schedule(LINGER);
+        return;
+      }
+    }
+
+    slot_timer.Schedule(FIX_INTERVAL / N_SLOTS);
+  }
+
+  void OnStopTimer() noexcept {
+    event_loop.Break();
+  }
+};
+
+int
+main(int argc, char *argv[])
+try {
+  Args args(argc, argv, "HOST [CLIENTS [SECONDS]]");
+  const char *host = args.ExpectNext();
+  const unsigned n_clients = args.IsEmpty()
+    ? 1000
+    : ParseUnsigned(args.GetNext());
+  const unsigned n_seconds = args.IsEmpty()
+    ? 10
+    : ParseUnsigned(args.GetNext());
+  args.ExpectEnd();
+
+  if (n_clients == 0 || n_seconds == 0)
+    args.UsageError();
+
+  const auto address_list = Resolve(host,
+                                    SkyLinesTracking::Client::GetDefaultPort(),
+                                    0, SOCK_DGRAM);
+
+  EventLoop event_loop;
+
+  LoadGenerator generator(event_loop, address_list.GetBest(),
+                          n_clients,
+                          n_seconds * (seconds(1) / FIX_INTERVAL));
+  generator.Start();
+
+  event_loop.Run();
+
+  generator.PrintStatistics();
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
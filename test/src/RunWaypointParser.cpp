@@ -8,6 +8,8 @@
 #include "Operation/ConsoleOperationEnvironment.hpp"
 #include "util/PrintException.hxx"
 
+#include <chrono>
+
 #include <stdio.h>
 #include <tchar.h>
 
@@ -19,13 +21,24 @@ try {
 
   Waypoints way_points;
 
+  const auto start = std::chrono::steady_clock::now();
+
   ConsoleOperationEnvironment operation;
   ReadWaypointFile(path, way_points,
                    WaypointFactory(WaypointOrigin::NONE),
                    operation);
 
+  const auto parsed = std::chrono::steady_clock::now();
+
   way_points.Optimise();
+
+  const auto optimised = std::chrono::steady_clock::now();
+
+  using Milliseconds = std::chrono::duration<double, std::milli>;
   printf("Size %d\n", way_points.size());
+  fprintf(stderr, "Parsed in %.1f ms, optimised in %.1f ms\n",
+          Milliseconds{parsed - start}.count(),
+          Milliseconds{optimised - parsed}.count());
 
   way_points.VisitNamePrefix(_T(""), [](const auto &p){
     const auto &wp = *p;
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that the airspace cache restores all airspaces exactly as
+ * they were parsed.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "io/FileCache.hpp"
+#include "io/FileLineReader.hpp"
+#include "io/FileReader.hxx"
+#include "Operation/Operation.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+#include "util/StringAPI.hxx"
+#include "util/tstring_view.hxx"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include <tchar.h>
+
+static constexpr const TCHAR *files[] = {
+  _T("test/data/AirspaceAus-DAA.txt"),
+  _T("test/data/airspace/openair.txt"),
+  _T("test/data/airspace/openair_extended.txt"),
+  _T("test/data/airspace/tnp.sua"),
+};
+
+static bool
+operator==(const AirspaceAltitude &a, const AirspaceAltitude &b) noexcept
+{
+  return a.altitude == b.altitude && a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain &&
+    a.reference == b.reference;
+}
+
+static bool
+operator==(const SearchPoint &a, const SearchPoint &b) noexcept
+{
+  return a.GetLocation() == b.GetLocation() &&
+    a.GetFlatLocation() == b.GetFlatLocation();
+}
+
+static bool
+Equals(const Airspace &a, const Airspace &b) noexcept
+{
+  const AbstractAirspace &x = a.GetAirspace(), &y = b.GetAirspace();
+
+  return a.GetLowerLeft() == b.GetLowerLeft() &&
+    a.GetUpperRight() == b.GetUpperRight() &&
+    x.GetShape() == y.GetShape() &&
+    x.GetClass() == y.GetClass() &&
+    x.GetBase() == y.GetBase() && x.GetTop() == y.GetTop() &&
+    x.GetRadioFrequency() == y.GetRadioFrequency() &&
+    x.GetDays().equals(y.GetDays()) &&
+    StringIsEqual(x.GetName(), y.GetName()) &&
+    StringIsEqual(x.GetType(), y.GetType()) &&
+    std::equal(x.GetPoints().begin(), x.GetPoints().end(),
+               y.GetPoints().begin(), y.GetPoints().end());
+}
+
+/**
+ * Returns all airspaces sorted by their attributes, because the
+ * cache may change the order of the tree.
+ */
+static std::vector<Airspace>
+GetSorted(const Airspaces &airspaces)
+{
+  std::vector<Airspace> v;
+  for (const auto &i : airspaces.QueryAll())
+    v.push_back(i);
+
+  std::sort(v.begin(), v.end(), [](const Airspace &a, const Airspace &b){
+    const AbstractAirspace &x = a.GetAirspace(), &y = b.GetAirspace();
+    const GeoPoint &px = x.GetPoints().front().GetLocation();
+    const GeoPoint &py = y.GetPoints().front().GetLocation();
+    return std::tuple(px.latitude, px.longitude, x.GetPoints().size(),
+                      x.GetBase().altitude, x.GetBase().flight_level,
+                      x.GetTop().altitude, x.GetTop().flight_level,
+                      tstring_view{x.GetName()}, x.GetClass()) <
+      std::tuple(py.latitude, py.longitude, y.GetPoints().size(),
+                 y.GetBase().altitude, y.GetBase().flight_level,
+                 y.GetTop().altitude, y.GetTop().flight_level,
+                 tstring_view{y.GetName()}, y.GetClass());
+  });
+
+  return v;
+}
+
+static bool
+Compare(const Airspaces &parsed, const Airspaces &loaded)
+{
+  if (loaded.GetSize() != parsed.GetSize() ||
+      !(loaded.GetProjection().GetCenter() ==
+        parsed.GetProjection().GetCenter()))
+    return false;
+
+  const auto a = GetSorted(parsed), b = GetSorted(loaded);
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), Equals);
+}
+
+static AirspaceCacheKey
+MakeKey(Path path)
+{
+  AirspaceCacheKey key;
+  FileReader reader(path);
+  key.Update(reader);
+  key.Finish();
+  return key;
+}
+
+static void
+TestFile(FileCache &cache, Path path)
+{
+  Airspaces parsed;
+
+  {
+    FileLineReader reader(path, Charset::AUTO);
+    NullOperationEnvironment operation;
+    ParseAirspaceFile(parsed, reader, operation);
+  }
+
+  parsed.Optimise();
+
+  const auto key = MakeKey(path);
+  SaveAirspaceCache(cache, path, key, parsed);
+
+  Airspaces loaded;
+  ok(LoadAirspaceCache(cache, path, key, loaded) && Compare(parsed, loaded),
+     "%s", path.c_str());
+}
+
+/**
+ * The cache must not be used for different source files.
+ */
+static void
+TestKeyMismatch(FileCache &cache, Path path, Path other_path)
+{
+  Airspaces parsed;
+
+  {
+    FileLineReader reader(path, Charset::AUTO);
+    NullOperationEnvironment operation;
+    ParseAirspaceFile(parsed, reader, operation);
+  }
+
+  parsed.Optimise();
+  SaveAirspaceCache(cache, path, MakeKey(path), parsed);
+
+  Airspaces loaded;
+  ok1(!LoadAirspaceCache(cache, path, MakeKey(other_path), loaded));
+  ok1(loaded.IsEmpty());
+}
+
+int main()
+try {
+  plan_tests(std::size(files) + 2);
+
+  FileCache cache(AllocatedPath(_T("output/airspace-cache")));
+
+  for (const TCHAR *file : files)
+    TestFile(cache, Path(file));
+
+  TestKeyMismatch(cache, Path(files[1]), Path(files[2]));
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that AirspacePolygon::Inside() and
+ * AirspacePolygon::Intersects() return the same results with and
+ * without the #PolygonEdgeIndex, for all large polygons in the
+ * airspace files in test/data.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/Airspace.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVector.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "io/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <memory>
+#include <random>
+
+#include <tchar.h>
+
+static constexpr const TCHAR *files[] = {
+  _T("test/data/AirspaceAus-DAA.txt"),
+  _T("test/data/airspace/openair.txt"),
+  _T("test/data/airspace/openair_extended.txt"),
+  _T("test/data/airspace/tnp.sua"),
+};
+
+static constexpr unsigned N_POINTS = 2000;
+static constexpr unsigned N_RAYS = 500;
+
+static std::mt19937 rng;
+
+static double
+Random(double min, double max) noexcept
+{
+  return std::uniform_real_distribution<double>{min, max}(rng);
+}
+
+/**
+ * Pick a random location around the polygon.  Half of them have the
+ * latitude of a vertex, to test the corner cases of the winding
+ * number algorithm.
+ */
+static GeoPoint
+RandomLocation(const std::vector<GeoPoint> &points,
+               const GeoBounds &bounds) noexcept
+{
+  const double margin = bounds.GetHeight().Native() / 4;
+  const Angle longitude =
+    Angle::Native(Random(bounds.GetWest().Native() - margin,
+                         bounds.GetEast().Native() + margin));
+
+  if (std::uniform_int_distribution<int>{0, 1}(rng)) {
+    const std::size_t i =
+      std::uniform_int_distribution<std::size_t>{0, points.size() - 1}(rng);
+    return {longitude, points[i].latitude};
+  }
+
+  return {longitude,
+          Angle::Native(Random(bounds.GetSouth().Native() - margin,
+                               bounds.GetNorth().Native() + margin))};
+}
+
+static bool
+operator==(const AirspaceIntersectionVector &a,
+           const AirspaceIntersectionVector &b) noexcept
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+/**
+ * FlatRay::IntersectsRatio() calculates cross products of coordinate
+ * differences with "int", which overflows if the ray and the polygon
+ * span more than this.  The linear scan then reports bogus
+ * intersections with distant edges, which the index skips.
+ */
+static constexpr unsigned MAX_FLAT_SPAN = 32767;
+
+[[gnu::pure]]
+static bool
+CanOverflow(FlatBoundingBox box, const FlatProjection &projection,
+            const GeoPoint &start, const GeoPoint &end) noexcept
+{
+  box.Expand(projection.ProjectInteger(start));
+  box.Expand(projection.ProjectInteger(end));
+  return box.GetWidth() > MAX_FLAT_SPAN || box.GetHeight() > MAX_FLAT_SPAN;
+}
+
+static bool
+TestPolygon(const AbstractAirspace &airspace,
+            const FlatProjection &projection)
+{
+  std::vector<GeoPoint> points;
+  for (const auto &i : airspace.GetPoints())
+    points.push_back(i.GetLocation());
+
+  auto indexed_ptr = std::make_shared<AirspacePolygon>(points);
+  auto linear_ptr = std::make_shared<AirspacePolygon>(points);
+  linear_ptr->ClearEdgeIndex();
+
+  /* project the borders */
+  const Airspace indexed_item(indexed_ptr, projection);
+  const Airspace linear_item(linear_ptr, projection);
+
+  const AirspacePolygon &indexed = *indexed_ptr, &linear = *linear_ptr;
+
+  const GeoBounds bounds = airspace.GetGeoBounds();
+
+  bool success = true;
+
+  for (unsigned i = 0; i < N_POINTS; ++i) {
+    const GeoPoint p = RandomLocation(points, bounds);
+    if (indexed.Inside(p) != linear.Inside(p)) {
+      diag("Inside() differs: %s %f %f", airspace.GetName(),
+           (double)p.latitude.Degrees(), (double)p.longitude.Degrees());
+      success = false;
+    }
+  }
+
+  const FlatBoundingBox flat_bounds = indexed.GetPoints().CalculateBoundingbox();
+
+  for (unsigned i = 0; i < N_RAYS; ++i) {
+    const GeoPoint start = RandomLocation(points, bounds);
+    const GeoPoint end = RandomLocation(points, bounds);
+    if (CanOverflow(flat_bounds, projection, start, end))
+      continue;
+
+    if (indexed.Intersects(start, end, projection) !=
+        linear.Intersects(start, end, projection)) {
+      diag("Intersects() differs: %s", airspace.GetName());
+      success = false;
+    }
+  }
+
+  return success;
+}
+
+static void
+TestFile(Path path)
+{
+  Airspaces airspaces;
+
+  {
+    FileLineReader reader(path, Charset::AUTO);
+    NullOperationEnvironment operation;
+    ParseAirspaceFile(airspaces, reader, operation);
+  }
+
+  airspaces.Optimise();
+
+  unsigned n_indexed = 0;
+  bool success = true;
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    if (airspace.GetShape() != AbstractAirspace::Shape::POLYGON ||
+        airspace.GetPoints().size() <= PolygonEdgeIndex::MIN_EDGES)
+      continue;
+
+    ++n_indexed;
+    if (!TestPolygon(airspace, airspaces.GetProjection()))
+      success = false;
+  }
+
+  ok(success, "%s: %u indexed polygons", path.c_str(), n_indexed);
+}
+
+int main()
+try {
+  plan_tests(std::size(files));
+
+  for (const TCHAR *file : files)
+    TestFile(Path(file));
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
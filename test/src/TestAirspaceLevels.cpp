@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that Airspaces::SetFlightLevels() and
+ * Airspaces::SetActivity() update all airspaces which depend on QNH
+ * and on the day of week, although they only visit those.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Atmosphere/Pressure.hpp"
+#include "io/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <tchar.h>
+
+static void
+AddCircle(Airspaces &airspaces, const GeoPoint &center,
+          AirspaceActivity days)
+{
+  auto as = std::make_shared<AirspaceCircle>(center, 5000);
+  as->SetProperties(_T("Circle"), AirspaceClass::DANGER, _T(""),
+                    AirspaceAltitude{}, AirspaceAltitude{});
+  as->SetDays(days);
+  airspaces.Add(std::move(as));
+}
+
+static void
+Load(Airspaces &airspaces)
+{
+  {
+    FileLineReader reader(Path(_T("test/data/AirspaceAus-DAA.txt")),
+                          Charset::AUTO);
+    NullOperationEnvironment operation;
+    ParseAirspaceFile(airspaces, reader, operation);
+  }
+
+  AirspaceActivity weekend, weekdays;
+  weekend.SetWeekend();
+  weekdays.SetWeekdays();
+
+  const GeoPoint center(Angle::Degrees(135), Angle::Degrees(-25));
+  AddCircle(airspaces, center, weekend);
+  AddCircle(airspaces, center, weekdays);
+  AddCircle(airspaces, center, AirspaceActivity{});
+
+  airspaces.Optimise();
+}
+
+/**
+ * Compare all flight level altitudes with a fresh calculation.
+ */
+static bool
+CheckFlightLevels(const Airspaces &airspaces, AtmosphericPressure press)
+{
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+
+    AirspaceAltitude base = airspace.GetBase(), top = airspace.GetTop();
+    base.SetFlightLevel(press);
+    top.SetFlightLevel(press);
+
+    if (base.altitude != airspace.GetBase().altitude ||
+        top.altitude != airspace.GetTop().altitude)
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+CheckActivity(const Airspaces &airspaces, AirspaceActivity mask)
+{
+  unsigned n_inactive = 0;
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    if (airspace.IsActive() != airspace.GetDays().Matches(mask))
+      return false;
+
+    if (!airspace.IsActive())
+      ++n_inactive;
+  }
+
+  /* exactly one of the two restricted circles is inactive on any
+     given day */
+  return n_inactive == 1;
+}
+
+static void
+TestFlightLevels(Airspaces &airspaces)
+{
+  for (const double hpa : {1013.25, 990., 1030., 1013.25}) {
+    const Serial serial = airspaces.GetLevelsSerial();
+    const auto press = AtmosphericPressure::HectoPascal(hpa);
+    airspaces.SetFlightLevels(press);
+    ok(airspaces.GetLevelsSerial() != serial &&
+       CheckFlightLevels(airspaces, press),
+       "QNH %.2f", hpa);
+  }
+
+  /* no change, no new serial */
+  const Serial serial = airspaces.GetLevelsSerial();
+  airspaces.SetFlightLevels(AtmosphericPressure::HectoPascal(1013.4));
+  ok1(airspaces.GetLevelsSerial() == serial);
+}
+
+static void
+TestActivity(Airspaces &airspaces)
+{
+  for (int8_t day = 0; day < 7; ++day) {
+    const AirspaceActivity mask(day);
+    airspaces.SetActivity(mask);
+    ok(CheckActivity(airspaces, mask), "day %d", day);
+  }
+
+  /* Monday to Tuesday: no airspace changes its state */
+  airspaces.SetActivity(AirspaceActivity(1));
+  Serial serial = airspaces.GetActivitySerial();
+  airspaces.SetActivity(AirspaceActivity(2));
+  ok1(airspaces.GetActivitySerial() == serial);
+
+  /* Tuesday to Saturday: both restricted circles change */
+  airspaces.SetActivity(AirspaceActivity(6));
+  ok1(airspaces.GetActivitySerial() != serial);
+}
+
+int main()
+try {
+  plan_tests(5 + 9);
+
+  Airspaces airspaces;
+  Load(airspaces);
+
+  TestFlightLevels(airspaces);
+  TestActivity(airspaces);
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
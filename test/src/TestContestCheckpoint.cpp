@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that the contest solvers can be resumed from a checkpoint
+ * taken in the middle of a flight, and find the same final result
+ * as a solver which was never interrupted.
+ */
+
+#include "Engine/Contest/ContestManager.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/Vector.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "io/FileLineReader.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <optional>
+#include <vector>
+
+using namespace std::chrono;
+
+static std::vector<TracePoint>
+LoadPoints(Path path)
+{
+  FileLineReaderA reader(path);
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  std::vector<TracePoint> points;
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    IGCFix fix;
+    if (IGCParseFix(line, extensions, fix) && fix.gps_valid)
+      points.emplace_back(fix.location,
+                          duration_cast<duration<unsigned>>(fix.time.DurationSinceMidnight()),
+                          fix.gps_altitude, 0, 0);
+  }
+
+  return points;
+}
+
+/**
+ * Feed the contest solvers like TaskComputer does, with the trace
+ * sizes of TraceComputer.
+ */
+struct Flight {
+  Trace full{minutes{2}, Trace::null_time, 1024};
+  Trace triangle{{}, Trace::null_time, 256};
+  Trace sprint{{}, minutes{150}, 128};
+
+  ContestManager manager;
+
+  explicit Flight(Contest contest) noexcept
+    :manager(contest, full, triangle, sprint) {
+    manager.SetIncremental(true);
+  }
+
+  void Feed(const TracePoint &point) noexcept {
+    full.push_back(point);
+    triangle.push_back(point);
+    sprint.push_back(point);
+    manager.UpdateIdle();
+  }
+};
+
+struct SolverState {
+  ContestResult result;
+  ContestTraceVector solution;
+  std::optional<TriangleContest::Checkpoint> triangle;
+};
+
+static std::vector<SolverState>
+GetSolverStates(const ContestManager &manager)
+{
+  struct {
+    std::vector<SolverState> states;
+
+    void operator()(const AbstractContest &solver) {
+      states.push_back({solver.GetBestResult(), solver.GetBestSolution(), {}});
+    }
+
+    void operator()(const TriangleContest &solver) {
+      (*this)(static_cast<const AbstractContest &>(solver));
+      states.back().triangle = solver.GetCheckpoint();
+    }
+  } visitor;
+
+  manager.ForEachSolver(visitor);
+  return std::move(visitor.states);
+}
+
+static void
+Restore(Trace &dest, const Trace &src)
+{
+  TracePointVector v;
+  src.GetPoints(v);
+  for (const auto &i : v)
+    dest.push_back(i);
+}
+
+/**
+ * Check whether the restored solver state matches the checkpoint.
+ * The restored solver may have picked up trace points which the
+ * original one had not seen yet.
+ */
+static bool
+IsRestored(const TriangleContest::Checkpoint &checkpoint,
+           const TriangleContest::Checkpoint &restored) noexcept
+{
+  return restored.n_points >= checkpoint.n_points &&
+    (checkpoint.n_points == 0 ||
+     (restored.best_d == checkpoint.best_d &&
+      restored.solved_ranges == checkpoint.solved_ranges));
+}
+
+static void
+TestContest(Contest contest, const std::vector<TracePoint> &points)
+{
+  const std::size_t half = points.size() / 2;
+
+  Flight original(contest);
+  for (std::size_t i = 0; i < half; ++i)
+    original.Feed(points[i]);
+
+  /* "restart" with the checkpoint of the original flight */
+
+  auto states = GetSolverStates(original.manager);
+
+  Flight resumed(contest);
+  Restore(resumed.full, original.full);
+  Restore(resumed.triangle, original.triangle);
+  Restore(resumed.sprint, original.sprint);
+  resumed.manager.RestoreStats(original.manager.GetStats());
+
+  struct {
+    std::vector<SolverState>::iterator i;
+
+    void operator()(AbstractContest &solver) {
+      solver.RestoreBest(i->result, i->solution);
+      ++i;
+    }
+
+    void operator()(TriangleContest &solver) {
+      solver.RestoreCheckpoint(TriangleContest::Checkpoint{*i->triangle});
+      (*this)(static_cast<AbstractContest &>(solver));
+    }
+  } restore{states.begin()};
+  resumed.manager.ForEachSolver(restore);
+
+  const auto restored_states = GetSolverStates(resumed.manager);
+  bool equal = restored_states.size() == states.size();
+  for (std::size_t i = 0; equal && i < states.size(); ++i)
+    equal = states[i].result.score == restored_states[i].result.score &&
+      states[i].triangle.has_value() == restored_states[i].triangle.has_value() &&
+      (!states[i].triangle ||
+       IsRestored(*states[i].triangle, *restored_states[i].triangle));
+
+  ok(equal, "restore %u", unsigned(contest));
+
+  /* continue both flights */
+
+  for (std::size_t i = half; i < points.size(); ++i) {
+    original.Feed(points[i]);
+    resumed.Feed(points[i]);
+  }
+
+  original.manager.SolveExhaustive();
+  resumed.manager.SolveExhaustive();
+
+  const auto &a = original.manager.GetStats(), &b = resumed.manager.GetStats();
+  equal = true;
+  for (std::size_t i = 0; i < ContestStatistics::N; ++i)
+    if (a.result[i].score != b.result[i].score)
+      equal = false;
+
+  ok(equal, "final %u", unsigned(contest));
+}
+
+int main()
+try {
+  const auto points = LoadPoints(Path(_T("test/data/0asljd01.igc")));
+
+  static constexpr Contest contests[] = {
+    Contest::OLC_FAI,
+    Contest::OLC_PLUS,
+    Contest::XCONTEST,
+    Contest::WEGLIDE_FREE,
+  };
+
+  plan_tests(std::size(contests) * 2);
+
+  for (const auto contest : contests)
+    TestContest(contest, points);
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -5,6 +5,7 @@
 #include "GlideSolvers/GlidePolar.hpp"
 #include "Units/System.hpp"
 
+#include <algorithm>
 #include <cstdio>
 
 class GlidePolarTest
@@ -20,6 +21,7 @@ private:
   void TestBallast();
   void TestBugs();
   void TestMC();
+  void TestSpeedToFly();
 };
 
 void
@@ -145,6 +147,46 @@ GlidePolarTest::TestMC()
   ok1(equals(polar.GetVBestLD(), 25.830434162));
 }
 
+/**
+ * Find the speed to fly by scanning all speeds over ground.
+ */
+static double
+ScanSpeedToFly(const GlidePolar &polar, double net_sink_rate, double head_wind)
+{
+  double best_v = 0, best_f = 0;
+  for (double v = std::max(1., polar.GetVMin() - head_wind);
+       v <= polar.GetVMax() - head_wind; v += 0.001) {
+    const double f = (polar.MSinkRate(v + head_wind) + net_sink_rate) / v;
+    if (best_v <= 0 || f < best_f) {
+      best_v = v;
+      best_f = f;
+    }
+  }
+
+  return best_v + head_wind;
+}
+
+void
+GlidePolarTest::TestSpeedToFly()
+{
+  ok1(equals(polar.SpeedToFly(0, 0), polar.GetVBestLD()));
+
+  for (const double mc : {0., 1., 3.}) {
+    polar.SetMC(mc);
+
+    bool equal = true;
+    for (const double net_sink_rate : {-4., -1., 0., 0.5, 2.})
+      for (const double head_wind : {-15., 0., 10., 25.})
+        if (fabs(polar.SpeedToFly(net_sink_rate, head_wind) -
+                 ScanSpeedToFly(polar, net_sink_rate, head_wind)) > 0.002)
+          equal = false;
+
+    ok(equal, "speed to fly mc=%.0f", mc);
+  }
+
+  polar.SetMC(0);
+}
+
 void
 GlidePolarTest::Run()
 {
@@ -153,11 +195,12 @@ GlidePolarTest::Run()
   TestBallast();
   TestBugs();
   TestMC();
+  TestSpeedToFly();
 }
 
 int main()
 {
-  plan_tests(46);
+  plan_tests(50);
 
   GlidePolarTest test;
   test.Run();
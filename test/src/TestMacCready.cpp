@@ -6,10 +6,13 @@
 #include "Engine/GlideSolvers/GlidePolar.hpp"
 #include "Engine/GlideSolvers/GlideState.hpp"
 #include "Engine/GlideSolvers/GlideResult.hpp"
+#include "Engine/GlideSolvers/GlideBatch.hpp"
 #include "Engine/GlideSolvers/MacCready.hpp"
 
 #include "TestUtil.hpp"
 
+#include <vector>
+
 static GlideSettings glide_settings;
 static GlidePolar glide_polar(0);
 
@@ -109,9 +112,71 @@ TestWind(const SpeedVector &wind)
   Test(100000, 4000, wind);
 }
 
+static bool
+Equals(const GlideResult &a, const GlideResult &b)
+{
+  if (a.validity != b.validity)
+    return false;
+
+  if (!a.IsOk())
+    return true;
+
+  return equals(a.head_wind, b.head_wind) &&
+    equals(a.vector.distance, b.vector.distance) &&
+    equals(a.height_climb, b.height_climb) &&
+    equals(a.height_glide, b.height_glide) &&
+    equals(a.altitude_difference, b.altitude_difference) &&
+    equals(a.pure_glide_altitude_difference,
+           b.pure_glide_altitude_difference) &&
+    equals(a.time_elapsed, b.time_elapsed) &&
+    equals(a.time_virtual, b.time_virtual);
+}
+
+/**
+ * Compare MacCready::Solve(const GlideBatch &) with solving each
+ * target on its own.
+ */
+static void
+TestBatch(const SpeedVector wind)
+{
+  GlideBatch batch(2000, wind);
+
+  for (const double distance : {0., 100., 1000., 10000., 100000.})
+    for (const double altitude : {-1000., -200., 0., 200., 4000.})
+      for (unsigned bearing = 0; bearing < 360; bearing += 30)
+        batch.push_back(GeoVector(distance, Angle::Degrees(bearing)),
+                        2000 - altitude);
+
+  const MacCready mac_cready(glide_settings, glide_polar);
+  std::vector<GlideResult> results(batch.size()), straight(batch.size());
+  mac_cready.Solve(batch, results);
+  mac_cready.SolveStraight(batch, straight);
+
+  bool equal = true, equal_straight = true;
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    const GlideState state(GeoVector(batch.distances[i], batch.bearings[i]),
+                           batch.min_arrival_altitudes[i], batch.altitude,
+                           wind);
+
+    if (!Equals(results[i], mac_cready.Solve(state)))
+      equal = false;
+
+    if (!Equals(straight[i], mac_cready.SolveStraight(state)))
+      equal_straight = false;
+  }
+
+  ok(equal, "batch wind=%.0f", wind.norm);
+  ok(equal_straight, "straight batch wind=%.0f", wind.norm);
+}
+
 static void
 TestAll()
 {
+  TestBatch(SpeedVector(Angle::Zero(), 0));
+  TestBatch(SpeedVector(Angle::Degrees(45), 5));
+  TestBatch(SpeedVector(Angle::Degrees(200), 15));
+  TestBatch(SpeedVector(Angle::Degrees(90), 30));
+
   TestWind(SpeedVector(Angle::Zero(), 0));
   TestWind(SpeedVector(Angle::Zero(), 2));
   TestWind(SpeedVector(Angle::Zero(), 5));
@@ -122,7 +187,7 @@ TestAll()
 
 int main()
 {
-  plan_tests(2103);
+  plan_tests(2103 + 5 * 8);
 
   glide_settings.SetDefaults();
 
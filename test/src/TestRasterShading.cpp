@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that the vectorised #RasterShading implementation produces
+ * the same images as the portable one.
+ */
+
+#include "Terrain/RasterShading.hpp"
+#include "ui/canvas/RawBitmap.hpp"
+
+extern "C" {
+#include "tap.h"
+}
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include <string.h>
+
+static std::mt19937 rng;
+
+static int
+Random(int min, int max) noexcept
+{
+  return std::uniform_int_distribution<int>{min, max}(rng);
+}
+
+static std::unique_ptr<TerrainHeight[]>
+MakeHeights(UnsignedPoint2D size) noexcept
+{
+  auto heights = std::make_unique<TerrainHeight[]>(size.Area());
+
+  int h = Random(-100, 3000);
+  for (unsigned i = 0; i < size.Area(); ++i) {
+    int value;
+
+    switch (Random(0, 19)) {
+    case 0:
+      /* water */
+      value = -31000;
+      break;
+
+    case 1:
+      value = TerrainHeight::Invalid().GetValue();
+      break;
+
+    case 2:
+      /* cliff (or a broken map file) */
+      value = Random(-29999, 32767);
+      break;
+
+    default:
+      h = std::clamp(h + Random(-40, 40), -500, 9000);
+      value = h;
+      break;
+    }
+
+    heights[i] = TerrainHeight(value);
+  }
+
+  return heights;
+}
+
+static std::unique_ptr<RawColor[]>
+MakeColorTable() noexcept
+{
+  auto table = std::make_unique<RawColor[]>(256 * 128);
+  for (unsigned i = 0; i < 256 * 128; ++i)
+    table[i] = RawColor(i, i >> 8, i * 31);
+  return table;
+}
+
+struct Image {
+  std::unique_ptr<RawColor[]> pixels;
+  std::unique_ptr<uint8_t[]> contour;
+};
+
+static Image
+Generate(const RasterShading &base, bool simd, bool slope,
+         int contrast, int sx, int sy, int sz,
+         unsigned quantisation_effective,
+         unsigned height_slope_factor) noexcept
+{
+  const std::size_t n = base.size.Area();
+
+  Image image{
+    std::make_unique<RawColor[]>(n),
+    std::make_unique<uint8_t[]>(base.size.x),
+  };
+
+  RasterShading s = base;
+  s.dest = image.pixels.get();
+  s.contour_column_base = image.contour.get();
+  s.simd = simd;
+
+  s.ContourStart();
+  if (slope)
+    s.GenerateSlopeImage(contrast, sx, sy, sz,
+                         quantisation_effective, height_slope_factor);
+  else
+    s.GenerateUnshadedImage();
+
+  return image;
+}
+
+static bool
+Compare(const RasterShading &s, bool slope,
+        int contrast, int sx, int sy, int sz,
+        unsigned quantisation_effective,
+        unsigned height_slope_factor) noexcept
+{
+  const auto a = Generate(s, false, slope, contrast, sx, sy, sz,
+                          quantisation_effective, height_slope_factor);
+  const auto b = Generate(s, true, slope, contrast, sx, sy, sz,
+                          quantisation_effective, height_slope_factor);
+
+  return memcmp(a.pixels.get(), b.pixels.get(),
+                s.size.Area() * sizeof(RawColor)) == 0 &&
+    memcmp(a.contour.get(), b.contour.get(), s.size.x) == 0;
+}
+
+static constexpr UnsignedPoint2D sizes[] = {
+  {4, 4},
+  {7, 5},
+  {37, 23},
+  {300, 9},
+  {640, 480},
+};
+
+static constexpr unsigned quantisations[] = { 1, 2, 3, 5 };
+
+/**
+ * Is the image large enough for slope shading with the given
+ * quantisation?
+ */
+static constexpr bool
+CanSlope(UnsignedPoint2D size, unsigned q) noexcept
+{
+  return size.x > q && size.y > q;
+}
+
+static constexpr unsigned
+CountTests() noexcept
+{
+  unsigned n = 0;
+  for (const auto size : sizes)
+    for (const unsigned q : quantisations)
+      n += 1 + CanSlope(size, q);
+  return n;
+}
+
+int main()
+{
+  plan_tests(CountTests());
+
+  const auto color_table = MakeColorTable();
+
+  for (const auto size : sizes) {
+    const auto heights = MakeHeights(size);
+
+    for (const unsigned q : quantisations) {
+      RasterShading s{
+        heights.get(), size,
+        color_table.get(),
+        nullptr, std::ptrdiff_t(size.x),
+        nullptr,
+        unsigned(Random(0, 6)), unsigned(Random(4, 16)),
+        false,
+      };
+
+      ok1(Compare(s, false, 0, 0, 0, 0, q, 1));
+
+      if (!CanSlope(size, q))
+        continue;
+
+      const int contrast = Random(0, 255);
+      const int sx = Random(-255, 255), sy = Random(-255, 255);
+      const int sz = Random(44, 255);
+      const unsigned height_slope_factor =
+        Random(1, 8192 / (q * q));
+
+      ok1(Compare(s, true, contrast, sx, sy, sz,
+                  q, height_slope_factor));
+    }
+  }
+
+  return exit_status();
+}
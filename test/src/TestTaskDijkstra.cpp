@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that TaskDijkstraMin and TaskDijkstraMax find the same
+ * solution when they reuse the results of the previous search as a
+ * new solver does, while the aircraft moves, turn points get
+ * achieved and observation zones change.  In debug builds, each
+ * result is also checked against a full Dijkstra search.
+ */
+
+#include "Engine/Task/PathSolvers/TaskDijkstraMin.hpp"
+#include "Engine/Task/PathSolvers/TaskDijkstraMax.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+static constexpr unsigned N_TURNPOINTS = 6;
+
+static const GeoPoint origin(Angle::Degrees(7.7), Angle::Degrees(51.05));
+static const FlatProjection projection(origin);
+
+static SearchPointVector
+MakeCircle(const GeoPoint &center, double radius, unsigned n)
+{
+  SearchPointVector v;
+  for (unsigned i = 0; i < n; ++i) {
+    const GeoVector vector(radius, Angle::FullCircle() * i / n);
+    v.emplace_back(vector.EndPoint(center), projection);
+  }
+
+  return v;
+}
+
+static GeoPoint
+GetTurnpointLocation(unsigned i)
+{
+  return GeoVector(60000 * (i % 3), Angle::Degrees(120 * i)).EndPoint(origin);
+}
+
+/**
+ * Run the solver and return the locations of the solution.
+ */
+template<typename F>
+static std::vector<GeoPoint>
+Solve(TaskDijkstra &dijkstra, const SearchPointVector *boundaries,
+      unsigned size, F &&run)
+{
+  dijkstra.SetTaskSize(size);
+  for (unsigned i = 0; i < size; ++i)
+    dijkstra.SetBoundary(i, boundaries[i]);
+
+  std::vector<GeoPoint> result;
+  if (run())
+    for (unsigned i = 0; i < size; ++i)
+      result.push_back(dijkstra.GetSolution(i).GetLocation());
+
+  return result;
+}
+
+static std::vector<GeoPoint>
+SolveMin(TaskDijkstraMin &dijkstra, const SearchPointVector *boundaries,
+         unsigned size, const SearchPoint &location)
+{
+  return Solve(dijkstra, boundaries, size, [&]{
+    return dijkstra.DistanceMin(location);
+  });
+}
+
+static std::vector<GeoPoint>
+SolveMax(TaskDijkstraMax &dijkstra, const SearchPointVector *boundaries,
+         unsigned size)
+{
+  return Solve(dijkstra, boundaries, size, [&]{
+    return dijkstra.DistanceMax();
+  });
+}
+
+static void
+TestMin(SearchPointVector *boundaries)
+{
+  TaskDijkstraMin incremental;
+#ifndef NDEBUG
+  incremental.SetVerify(true);
+#endif
+
+  for (unsigned active = 0; active < N_TURNPOINTS; ++active) {
+    bool equal = true;
+
+    /* fly towards the active turn point */
+    const GeoPoint target = GetTurnpointLocation(active);
+    const GeoPoint start = GetTurnpointLocation(active > 0 ? active - 1 : 0);
+    for (unsigned step = 0; step < 10; ++step) {
+      const SearchPoint location(start.Interpolate(target, step / 10.),
+                                 projection);
+
+      TaskDijkstraMin full;
+      const auto a = SolveMin(incremental, boundaries + active,
+                              N_TURNPOINTS - active, location);
+      const auto b = SolveMin(full, boundaries + active,
+                              N_TURNPOINTS - active, location);
+      if (a.empty() || a != b)
+        equal = false;
+    }
+
+    ok(equal, "min active=%u", active);
+  }
+
+  /* an observation zone changes */
+  boundaries[4] = MakeCircle(GetTurnpointLocation(4), 5000, 24);
+
+  const SearchPoint location(origin, projection);
+  TaskDijkstraMin full;
+  const auto a = SolveMin(incremental, boundaries, N_TURNPOINTS, location);
+  const auto b = SolveMin(full, boundaries, N_TURNPOINTS, location);
+  ok1(!a.empty() && a == b);
+}
+
+static void
+TestMax(SearchPointVector *boundaries)
+{
+  TaskDijkstraMax incremental;
+#ifndef NDEBUG
+  incremental.SetVerify(true);
+#endif
+
+  for (unsigned i = 0; i < N_TURNPOINTS; ++i) {
+    /* the aircraft has achieved this observation zone, and only the
+       part it has visited remains */
+    boundaries[i].resize(boundaries[i].size() / 2);
+
+    TaskDijkstraMax full;
+    const auto a = SolveMax(incremental, boundaries, N_TURNPOINTS);
+    const auto b = SolveMax(full, boundaries, N_TURNPOINTS);
+    ok(!a.empty() && a == b, "max achieved=%u", i);
+  }
+
+  /* a solver can't find a path through an empty stage */
+  boundaries[2].clear();
+  ok1(SolveMax(incremental, boundaries, N_TURNPOINTS).empty());
+}
+
+int main()
+{
+  plan_tests(N_TURNPOINTS + 1 + N_TURNPOINTS + 1);
+
+  SearchPointVector boundaries[N_TURNPOINTS];
+  for (unsigned i = 0; i < N_TURNPOINTS; ++i)
+    boundaries[i] = MakeCircle(GetTurnpointLocation(i),
+                               i == 0 || i == N_TURNPOINTS - 1 ? 1000 : 20000,
+                               32);
+
+  TestMin(boundaries);
+  TestMax(boundaries);
+
+  return exit_status();
+}
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that RasterTileCache::FirstIntersection() and
+ * RasterTileCache::GroundIntersection() return the same results with
+ * and without the optimisations (closed-form line stepping and
+ * #HeightPyramid), for random rays over a real map which is partly
+ * loaded at full resolution.  This is done once with tiles decoded
+ * from the JPEG2000 file and once with tiles (and their pyramids)
+ * mapped from a #RawTileStore.
+ *
+ * Additionally, verify that a tile which is missing in the
+ * #RawTileStore is decoded from the JPEG2000 file instead.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/Loader.hpp"
+#include "Terrain/RawTileStore.hpp"
+#include "Operation/Operation.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/FileCache.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/BufferedOutputStream.hxx"
+#include "io/FileMapping.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+
+extern "C" {
+#include "tap.h"
+}
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <string.h>
+
+static constexpr int lengths[] = { 10, 100, 1000, 10000 };
+
+static constexpr unsigned N_RAYS = 1000;
+
+static std::mt19937 rng;
+
+static int
+Random(int min, int max) noexcept
+{
+  return std::uniform_int_distribution<int>{min, max}(rng);
+}
+
+static SignedRasterLocation
+RandomLocation(const RasterTileCache &cache) noexcept
+{
+  const auto size = cache.GetSize();
+  return {Random(0, size.x - 1), Random(0, size.y - 1)};
+}
+
+/**
+ * Pick a random destination which is different from the origin (like
+ * RasterMap, because the line algorithm does not terminate
+ * otherwise).
+ */
+static SignedRasterLocation
+RandomDestination(SignedRasterLocation origin, int length) noexcept
+{
+  SignedRasterLocation destination;
+  do {
+    destination = {origin.x + Random(-length, length),
+                   origin.y + Random(-length, length)};
+  } while (destination == origin);
+
+  return destination;
+}
+
+static int
+GetTerrainHeight(const RasterTileCache &cache,
+                 SignedRasterLocation p) noexcept
+{
+  return cache.GetHeight(p).GetValueOr0();
+}
+
+/**
+ * Calculate the slope factor like RasterMap does it.
+ */
+static int
+CalcSlopeFact(SignedRasterLocation origin, SignedRasterLocation destination,
+              int height) noexcept
+{
+  const int distance = std::max(ManhattanDistance(origin, destination), 1);
+  return (height << RASTER_SLOPE_FACT) / distance;
+}
+
+static bool
+operator==(const RasterTileCache::Intersection &a,
+           const RasterTileCache::Intersection &b) noexcept
+{
+  return a.location == b.location && a.height == b.height;
+}
+
+static bool
+TestFirstIntersection(RasterTileCache &cache, int length,
+                      unsigned &n_found) noexcept
+{
+  bool success = true;
+
+  for (unsigned i = 0; i < N_RAYS; ++i) {
+    const auto origin = RandomLocation(cache);
+    const auto destination = RandomDestination(origin, length);
+
+    const int h_origin = GetTerrainHeight(cache, origin) + Random(-200, 1500);
+    const int h_virt = Random(0, 2000);
+    const int h_dest = h_origin + Random(-500, 500);
+    const int slope_fact = CalcSlopeFact(origin, destination, h_virt);
+    const int h_ceiling = h_origin + Random(0, 3000);
+    const int h_safety = Random(0, 300);
+    const bool can_climb = Random(0, 1);
+
+    cache.SetFastIntersection(false);
+    const auto expected =
+      cache.FirstIntersection(origin, destination, h_origin, h_dest,
+                              slope_fact, h_ceiling, h_safety, can_climb);
+
+    cache.SetFastIntersection(true);
+    const auto result =
+      cache.FirstIntersection(origin, destination, h_origin, h_dest,
+                              slope_fact, h_ceiling, h_safety, can_climb);
+
+    if (result != expected) {
+      diag("FirstIntersection() differs: %d,%d -> %d,%d",
+           origin.x, origin.y, destination.x, destination.y);
+      success = false;
+    }
+
+    if (expected)
+      ++n_found;
+  }
+
+  return success;
+}
+
+static bool
+TestGroundIntersection(RasterTileCache &cache, int length,
+                       unsigned &n_found) noexcept
+{
+  bool success = true;
+
+  for (unsigned i = 0; i < N_RAYS; ++i) {
+    const auto origin = RandomLocation(cache);
+    const auto destination = RandomDestination(origin, length);
+
+    const int h_origin = GetTerrainHeight(cache, origin) + Random(0, 2000);
+    const int slope_fact = CalcSlopeFact(origin, destination,
+                                         Random(0, 3000));
+    const int height_floor = Random(-100, 500);
+
+    cache.SetFastIntersection(false);
+    const auto expected =
+      cache.GroundIntersection(origin, destination, h_origin, slope_fact,
+                               height_floor);
+
+    cache.SetFastIntersection(true);
+    const auto result =
+      cache.GroundIntersection(origin, destination, h_origin, slope_fact,
+                               height_floor);
+
+    if (result != expected) {
+      diag("GroundIntersection() differs: %d,%d -> %d,%d",
+           origin.x, origin.y, destination.x, destination.y);
+      success = false;
+    }
+
+    if (expected.x >= 0)
+      ++n_found;
+  }
+
+  return success;
+}
+
+static void
+TestIntersections(RasterTileCache &cache) noexcept
+{
+  unsigned n_first = 0, n_ground = 0;
+  for (const int length : lengths) {
+    ok(TestFirstIntersection(cache, length, n_first),
+       "FirstIntersection", 0);
+    ok(TestGroundIntersection(cache, length, n_ground),
+       "GroundIntersection", 0);
+  }
+
+  /* make sure the rays are not trivial */
+  ok1(n_first > 0);
+  ok1(n_ground > 0);
+}
+
+static void
+LoadOverview(struct zzip_dir *dir, RasterMap &map)
+{
+  NullOperationEnvironment operation;
+  LoadTerrainOverview(dir, map.GetTileCache(), operation);
+  map.UpdateProjection();
+}
+
+static void
+ConvertTiles(struct zzip_dir *dir, FileCache &cache, Path map_path)
+{
+  auto os = cache.Save(RawTileStore::CACHE_NAME, map_path);
+  BufferedOutputStream bos(*os);
+
+  RasterTileCache rtc;
+  RawTileWriter writer(bos);
+
+  {
+    NullOperationEnvironment operation;
+    ConvertTerrainTiles(dir, rtc, writer, operation);
+  }
+
+  bos.Flush();
+  os->Commit();
+}
+
+/**
+ * Rewrite the #RawTileStore without the entry of the tile which
+ * contains the given pixel.
+ */
+static void
+DropTile(FileCache &cache, Path map_path, RasterLocation p)
+{
+  std::vector<std::byte> payload;
+
+  {
+    const auto mapping = cache.Map(RawTileStore::CACHE_NAME, map_path);
+    if (!mapping)
+      throw std::runtime_error("No raw tile store");
+
+    const auto src = FileCache::SkipHeader(*mapping);
+    payload.assign(src.begin(), src.end());
+  }
+
+  RawTileFooter footer;
+  memcpy(&footer, payload.data() + payload.size() - sizeof(footer),
+         sizeof(footer));
+
+  unsigned n_dropped = 0;
+  for (unsigned i = 0; i < footer.n_tiles.Area(); ++i) {
+    std::byte *const dest = payload.data() + footer.table_offset
+      + i * sizeof(RawTileEntry);
+
+    RawTileEntry entry;
+    memcpy(&entry, dest, sizeof(entry));
+
+    if (entry.IsDefined() &&
+        p.x >= entry.start.x && p.x < entry.end.x &&
+        p.y >= entry.start.y && p.y < entry.end.y) {
+      entry.end = entry.start;
+      memcpy(dest, &entry, sizeof(entry));
+      ++n_dropped;
+    }
+  }
+
+  if (n_dropped != 1)
+    throw std::runtime_error("Tile not found in raw tile store");
+
+  auto os = cache.Save(RawTileStore::CACHE_NAME, map_path);
+  os->Write(std::span{payload});
+  os->Commit();
+}
+
+/**
+ * Do both caches return the same height for all pixels?
+ */
+[[gnu::pure]]
+static bool
+CompareHeights(const RasterTileCache &a, const RasterTileCache &b) noexcept
+{
+  const auto size = a.GetSize();
+  if (b.GetSize() != size)
+    return false;
+
+  for (unsigned y = 0; y < size.y; ++y)
+    for (unsigned x = 0; x < size.x; ++x)
+      if (a.GetHeight({x, y}).GetValue() != b.GetHeight({x, y}).GetValue())
+        return false;
+
+  return true;
+}
+
+int main()
+try {
+  plan_tests(2 * (2 * std::size(lengths) + 2) + 3);
+
+  const Path map_path("test/data/benalla9.xcm");
+  ZipArchive archive(map_path);
+
+  /* load only the tiles near the center, so the rays cross both
+     loaded tiles and the overview */
+  static constexpr double RADIUS = 20000;
+
+  SharedMutex mutex;
+
+  RasterMap decoded_map;
+  LoadOverview(archive.get(), decoded_map);
+
+  do {
+    UpdateTerrainTiles(archive.get(), decoded_map.GetTileCache(), mutex,
+                       decoded_map.GetProjection(),
+                       decoded_map.GetMapCenter(), RADIUS);
+  } while (decoded_map.IsDirty());
+
+  TestIntersections(decoded_map.GetTileCache());
+
+  FileCache file_cache(Path("output/test/terrain-cache"));
+  ConvertTiles(archive.get(), file_cache, map_path);
+
+  const auto store = RawTileStore::Open(file_cache, map_path);
+  ok1(store != nullptr);
+  if (!store)
+    return exit_status();
+
+  {
+    RasterMap map;
+    LoadOverview(archive.get(), map);
+
+    do {
+      UpdateTerrainTiles(*store, map.GetTileCache(), mutex,
+                         map.GetProjection(),
+                         map.GetMapCenter(), RADIUS);
+    } while (map.IsDirty());
+
+    TestIntersections(map.GetTileCache());
+  }
+
+  /* remove the center tile from the store; it must be decoded from
+     the JPEG2000 file, and the result must be the same as without
+     the store */
+  const auto center = decoded_map.GetProjection()
+    .ProjectCoarse(decoded_map.GetMapCenter());
+  DropTile(file_cache, map_path, RasterLocation(center.x, center.y));
+
+  const auto incomplete_store = RawTileStore::Open(file_cache, map_path);
+  ok1(incomplete_store != nullptr);
+  if (!incomplete_store)
+    return exit_status();
+
+  RasterMap map;
+  LoadOverview(archive.get(), map);
+
+  do {
+    if (UpdateTerrainTiles(*incomplete_store, map.GetTileCache(), mutex,
+                           map.GetProjection(),
+                           map.GetMapCenter(), RADIUS))
+      LoadRequestedTerrainTiles(archive.get(), map.GetTileCache(), mutex);
+  } while (map.IsDirty());
+
+  ok(CompareHeights(map.GetTileCache(), decoded_map.GetTileCache()),
+     "missing raw tile decoded");
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Verify that the triangle search, which remembers the results of
+ * the ranges it has already searched across trace refreshes, finds
+ * the same triangle as a new solver which searches the whole trace.
+ * This is checked after each refresh, once with a trace which is only
+ * appended to and once with a trace which gets thinned (i.e. whose
+ * modify serial changes).
+ *
+ * The solvers are not incremental: an incremental solver updates
+ * only the tail of its trace most of the time and keeps improving its
+ * previous triangle, which is not expected to match a new solver.
+ */
+
+#include "Engine/Contest/Solvers/OLCFAI.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "io/FileLineReader.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+using namespace std::chrono;
+
+static std::vector<TracePoint>
+LoadPoints(Path path)
+{
+  FileLineReaderA reader(path);
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  std::vector<TracePoint> points;
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    IGCFix fix;
+    if (IGCParseFix(line, extensions, fix) && fix.gps_valid)
+      points.emplace_back(fix.location,
+                          duration_cast<duration<unsigned>>(fix.time.DurationSinceMidnight()),
+                          fix.gps_altitude, 0, 0);
+  }
+
+  return points;
+}
+
+/**
+ * Search the whole trace with a new solver.
+ *
+ * @return the best flat distance
+ */
+static unsigned
+SolveFresh(const Trace &trace) noexcept
+{
+  OLCFAI solver(trace, false);
+  solver.Reset();
+  solver.SetIncremental(false);
+  solver.Solve(false);
+  return solver.GetCheckpoint().best_d;
+}
+
+/**
+ * Feed every #step-th point into the trace and call the solver once
+ * for each point, like ContestManager::UpdateIdle().
+ */
+static void
+TestTrace(const std::vector<TracePoint> &points, std::size_t step,
+          unsigned max_size, bool expect_modified)
+{
+  Trace trace{{}, Trace::null_time, max_size};
+
+  OLCFAI solver(trace, false);
+  solver.Reset();
+  solver.SetIncremental(false);
+
+  const auto initial_serial = trace.GetModifySerial();
+  unsigned last_n_points = 0, n_compared = 0, n_mismatches = 0;
+  bool memo_used = false;
+
+  for (std::size_t i = 0; i < points.size(); i += step) {
+    trace.push_back(points[i]);
+    solver.Solve(false);
+
+    const auto checkpoint = solver.GetCheckpoint();
+    if (checkpoint.n_points == 0 ||
+        checkpoint.n_points != trace.size() ||
+        checkpoint.n_points == last_n_points)
+      /* no refresh, or the working copy lags behind the master
+         trace */
+      continue;
+
+    last_n_points = checkpoint.n_points;
+    ++n_compared;
+    if (!checkpoint.solved_ranges.empty())
+      memo_used = true;
+
+    const unsigned fresh_d = SolveFresh(trace);
+    if (checkpoint.best_d != fresh_d) {
+      if (n_mismatches++ == 0)
+        diag("mismatch at point %zu: %u != %u",
+             i, checkpoint.best_d, fresh_d);
+    }
+  }
+
+  ok1(n_compared > 0 && memo_used);
+  ok1((trace.GetModifySerial() != initial_serial) == expect_modified);
+  ok(n_mismatches == 0, "memo %u", max_size);
+}
+
+int main()
+try {
+  const auto points = LoadPoints(Path(_T("test/data/0asljd01.igc")));
+
+  plan_tests(9);
+
+  /* large enough for the whole (sparse) flight: only appended */
+  TestTrace(points, 8, 1024, false);
+
+  /* small traces which get thinned */
+  TestTrace(points, 2, 128, true);
+  TestTrace(points, 1, 256, true);
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -3,6 +3,8 @@
 
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
+#include "Waypoint/WaypointReaderSeeYou.hpp"
+#include "Waypoint/WaypointReaderWinPilot.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Units/System.hpp"
@@ -13,9 +15,17 @@
 #include "util/StringStrip.hxx"
 #include "util/ExtractParameters.hpp"
 #include "Operation/Operation.hpp"
+#include "thread/ThreadPool.hpp"
+#include "io/MemoryReader.hxx"
+#include "io/BufferedLineReader.hpp"
 
+#include <iterator>
+#include <span>
+#include <string>
 #include <vector>
 
+#include <stdio.h>
+
 static void
 TestExtractParameters()
 {
@@ -440,6 +450,112 @@ TestCompeGPS_UTM(wp_vector org_wp)
   }
 }
 
+/**
+ * Parse a file from memory on a #ThreadPool and compare the result
+ * with the line based parser.
+ *
+ * @param serial receives the waypoints from the line based parser
+ * @param concurrent receives the waypoints from the concurrent parser
+ */
+template<typename R>
+static void
+TestConcurrent(std::string_view src, unsigned n,
+               Waypoints &serial, Waypoints &concurrent)
+{
+  NullOperationEnvironment operation;
+
+  MemoryReader reader{std::as_bytes(std::span{src})};
+  BufferedLineReader line_reader{reader};
+  R(WaypointFactory(WaypointOrigin::NONE))
+    .Parse(serial, line_reader, operation);
+
+  ThreadPool thread_pool("Test", 3);
+  R(WaypointFactory(WaypointOrigin::NONE))
+    .Parse(concurrent, src, operation, &thread_pool);
+
+  ok1(serial.size() == n);
+  ok1(concurrent.size() == serial.size());
+
+  unsigned mismatches = 0;
+  for (unsigned id = 1; id <= n; ++id) {
+    const auto a = serial.LookupId(id), b = concurrent.LookupId(id);
+    if (a == nullptr || b == nullptr || a->name != b->name ||
+        a->location != b->location || a->elevation != b->elevation ||
+        a->type != b->type || a->comment != b->comment ||
+        a->runway.IsDirectionDefined() != b->runway.IsDirectionDefined() ||
+        (a->runway.IsDirectionDefined() &&
+         a->runway.GetDirectionDegrees() != b->runway.GetDirectionDegrees()))
+      ++mismatches;
+  }
+
+  ok1(mismatches == 0);
+}
+
+/**
+ * Parse a large SeeYou file on a #ThreadPool and compare the result
+ * with the line based parser.
+ */
+static void
+TestSeeYouConcurrent()
+{
+  static constexpr unsigned N = 10000;
+
+  /* the header moves the description to column 11; the task marker
+     ends the waypoint list */
+  std::string src =
+    "name,code,country,lat,lon,elev,style,rwdir,rwlen,rwwidth,freq,desc\r\n";
+  for (unsigned i = 0; i < N; ++i) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "\"WP %u\",W%u,DE,%02u%02u.%03uN,%03u%02u.%03uE,%um,%u,,,,,\"Desc %u\"\r\n",
+             i, i, 45 + i % 10, i % 60, i % 1000, 5 + i % 20, (i / 7) % 60,
+             (i * 7) % 1000, i % 3000, 1 + i % 5, i);
+    src += line;
+  }
+
+  src += "-----Related Tasks-----\r\n"
+    "\"After\",A,DE,5000.000N,00700.000E,100m,1,,,,,\"\"\r\n";
+
+  Waypoints serial, concurrent;
+  TestConcurrent<WaypointReaderSeeYou>(src, N, serial, concurrent);
+
+  ok1(concurrent.LookupName(_T("WP 9999")) != nullptr &&
+      concurrent.LookupName(_T("WP 9999"))->comment == _T("Desc 9999"));
+  ok1(concurrent.LookupName(_T("After")) == nullptr);
+}
+
+/**
+ * Parse a large WELT2000 file (WinPilot format with runway directions
+ * in the description) on a #ThreadPool and compare the result with
+ * the line based parser.
+ */
+static void
+TestWinPilotConcurrent()
+{
+  static constexpr unsigned N = 10000;
+  static constexpr const char *flags[] = { "T", "AT", "L", "TL", "ATH" };
+
+  /* the signature in the first line enables parsing the runway
+     direction */
+  std::string src = "* WRITTEN BY WELT2000 AT 05.12.2010\r\n";
+  for (unsigned i = 0; i < N; ++i) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "%u,%02u:%02u.%03uN,%03u:%02u.%03uE,%uM,%s,WP %u,123.500 %02u%02u\r\n",
+             i + 1, 45 + i % 10, i % 60, i % 1000, 5 + i % 20, (i / 7) % 60,
+             (i * 7) % 1000, i % 3000, flags[i % std::size(flags)], i,
+             i % 36, (i % 36 + 18) % 36);
+    src += line;
+  }
+
+  Waypoints serial, concurrent;
+  TestConcurrent<WaypointReaderWinPilot>(src, N, serial, concurrent);
+
+  const auto wp = concurrent.LookupName(_T("WP 9999"));
+  ok1(wp != nullptr && wp->runway.IsDirectionDefined() &&
+      wp->runway.GetDirectionDegrees() == 9999 % 36 * 10);
+}
+
 static wp_vector
 CreateOriginalWaypoints()
 {
@@ -542,7 +658,7 @@ int main()
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(513);
+  plan_tests(522);
 
   TestExtractParameters();
 
@@ -554,6 +670,8 @@ int main()
   TestOzi(org_wp);
   TestCompeGPS(org_wp);
   TestCompeGPS_UTM(org_wp);
+  TestSeeYouConcurrent();
+  TestWinPilotConcurrent();
 
   return exit_status();
 }
@@ -6,6 +6,7 @@
 #include "test_debug.hpp"
 
 #include <functional>
+#include <vector>
 
 #include <stdio.h>
 #include <tchar.h>
@@ -218,6 +219,78 @@ TestGetNearest(const Waypoints &waypoints, const GeoPoint &center)
   ok1(waypoint->original_id == 6);
 }
 
+static WaypointPtr
+MakeWaypoint(const GeoPoint &location, const TCHAR *name,
+             Waypoint::Type type)
+{
+  Waypoint waypoint{location};
+  waypoint.origin = WaypointOrigin::USER;
+  waypoint.original_id = 0;
+  waypoint.type = type;
+  waypoint.name = name;
+  return WaypointPtr(new Waypoint(std::move(waypoint)));
+}
+
+/**
+ * Waypoints added by CheckExistsOrAppend() are found without another
+ * Optimise() call, and so are the others.
+ */
+static void
+TestCheckExistsOrAppend(Waypoints &waypoints, const GeoPoint &center)
+{
+  const unsigned size = waypoints.size();
+
+  const WaypointPtr existing = waypoints.LookupName(_T("Waypoint #5"));
+  ok1(waypoints.CheckExistsOrAppend(WaypointPtr(new Waypoint(*existing))) == existing);
+  ok1(waypoints.size() == size);
+
+  const GeoPoint marker_location =
+    GeoVector(400, Angle::Degrees(200)).EndPoint(center);
+  const WaypointPtr marker = MakeWaypoint(marker_location, _T("Marker"),
+                                          Waypoint::Type::MARKER);
+  ok1(waypoints.CheckExistsOrAppend(marker) == marker);
+  ok1(waypoints.GetNearest(marker_location, 1) == marker);
+  ok1(waypoints.LookupLocation(marker_location) == marker);
+
+  WaypointPredicateCounter counter([](const Waypoint &){ return true; });
+  waypoints.VisitWithinRange(marker_location, 1,
+                             [&](const auto &wp){ counter.Visit(wp); });
+  ok1(counter.GetCounter() == 1);
+
+  const GeoPoint airfield_location =
+    GeoVector(2500, Angle::Degrees(270)).EndPoint(center);
+  const WaypointPtr airfield =
+    MakeWaypoint(airfield_location, _T("Appended Airfield"),
+                 Waypoint::Type::AIRFIELD);
+  waypoints.CheckExistsOrAppend(airfield);
+  ok1(waypoints.GetNearestLandable(airfield_location, 1) == airfield);
+
+  TestGetNearest(waypoints, center);
+
+  /* more markers than fit into the unsorted tail of the packed
+     index */
+  std::vector<WaypointPtr> markers;
+  for (unsigned i = 0; i < 40; ++i) {
+    StaticString<32> name;
+    name.Format(_T("Marker #%u"), i);
+    markers.push_back(MakeWaypoint(GeoVector(500 + i * 1000,
+                                             Angle::Degrees(100)).EndPoint(center),
+                                   name, Waypoint::Type::MARKER));
+    waypoints.CheckExistsOrAppend(markers.back());
+  }
+
+  unsigned n_found = 0;
+  for (const auto &i : markers)
+    if (waypoints.GetNearest(i->location, 1) == i)
+      ++n_found;
+  ok1(n_found == markers.size());
+
+  waypoints.EraseUserMarkers();
+  ok1(waypoints.LookupLocation(marker_location) == nullptr);
+  ok1(waypoints.GetNearestLandable(airfield_location, 1) == airfield);
+  ok1(waypoints.size() == size + 1);
+}
+
 static void
 TestIterator(const Waypoints &waypoints)
 {
@@ -285,7 +358,7 @@ main(int argc, char** argv)
   if (!ParseArgs(argc, argv))
     return 0;
 
-  plan_tests(52);
+  plan_tests(103);
 
   Waypoints waypoints;
   GeoPoint center(Angle::Degrees(51.4), Angle::Degrees(7.85));
@@ -303,6 +376,14 @@ main(int argc, char** argv)
   TestGetNearest(waypoints, center);
   TestIterator(waypoints);
 
+  /* appending a waypoint invalidates the packed index; the same
+     lookups fall back to the QuadTree until the next Optimise() call */
+  waypoints.Append(Waypoint{*waypoints.LookupId(151)});
+  TestGetNearest(waypoints, center);
+  waypoints.Optimise();
+
+  TestCheckExistsOrAppend(waypoints, center);
+
   ok(TestCopy(waypoints), "waypoint copy", 0);
   ok(TestErase(waypoints, 3), "waypoint erase", 0);
   ok(TestReplace(waypoints, 4), "waypoint replace", 0);
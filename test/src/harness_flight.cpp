@@ -4,6 +4,7 @@
 #include "Printing.hpp"
 #include "harness_flight.hpp"
 #include "harness_airspace.hpp"
+#include "AirspaceWarningCompare.hpp"
 #include "harness_wind.hpp"
 #include "TaskEventsPrint.hpp"
 #include "Engine/Util/AircraftStateFilter.hpp"
@@ -114,16 +115,32 @@ run_flight(TestFlightComponents components, TaskManager &task_manager,
                  parms.start_alt);
 
   AirspaceWarningManager *airspace_warnings;
+
+  /* a second manager without batched evaluation, which must generate
+     the same warnings */
+  AirspaceWarningManager *airspace_warnings_unbatched;
+
   if (airspaces) {
     AirspaceWarningConfig airspace_warning_config;
     airspace_warning_config.SetDefaults();
     airspace_warnings = new AirspaceWarningManager(airspace_warning_config,
                                                    *airspaces);
     airspace_warnings->Reset(aircraft.GetState());
+
+    if (components.compare_airspace_warnings) {
+      airspace_warnings_unbatched =
+        new AirspaceWarningManager(airspace_warning_config, *airspaces);
+      airspace_warnings_unbatched->SetBatch(false);
+      airspace_warnings_unbatched->Reset(aircraft.GetState());
+    } else
+      airspace_warnings_unbatched = NULL;
   } else {
     airspace_warnings = NULL;
+    airspace_warnings_unbatched = NULL;
   }
 
+  bool warnings_equal = true;
+
   do {
 
     if ((task_manager.GetActiveTaskPointIndex() == 1) &&
@@ -163,19 +180,30 @@ run_flight(TestFlightComponents components, TaskManager &task_manager,
                      do_print, 
                      autopilot.GetTarget(ta));
     }
-    if (airspace_warnings) {
-      if (verbose > 1) {
-        bool warnings_updated = airspace_warnings->Update(aircraft.GetState(),
-                                                          task_manager.GetGlidePolar(),
-                                                          task_manager.GetStats(),
-                                                          false,
-                                                          std::chrono::seconds{1});
-        if (warnings_updated) {
-          printf("# airspace warnings updated, size %d\n",
-                 (int)airspace_warnings->size());
-          print_warnings(*airspace_warnings);
-          WaitPrompt();
-        }
+    if (airspace_warnings &&
+        (verbose > 1 || airspace_warnings_unbatched != NULL)) {
+      bool warnings_updated = airspace_warnings->Update(aircraft.GetState(),
+                                                        task_manager.GetGlidePolar(),
+                                                        task_manager.GetStats(),
+                                                        false,
+                                                        std::chrono::seconds{1});
+
+      if (airspace_warnings_unbatched != NULL) {
+        airspace_warnings_unbatched->Update(aircraft.GetState(),
+                                            task_manager.GetGlidePolar(),
+                                            task_manager.GetStats(),
+                                            false,
+                                            std::chrono::seconds{1});
+        if (!CompareAirspaceWarnings(*airspace_warnings,
+                                     *airspace_warnings_unbatched))
+          warnings_equal = false;
+      }
+
+      if (verbose > 1 && warnings_updated) {
+        printf("# airspace warnings updated, size %d\n",
+               (int)airspace_warnings->size());
+        print_warnings(*airspace_warnings);
+        WaitPrompt();
       }
     }
 
@@ -221,10 +249,15 @@ run_flight(TestFlightComponents components, TaskManager &task_manager,
   if (verbose)
     PrintDistanceCounts();
 
-  if (airspace_warnings)
+  if (airspace_warnings) {
     delete airspace_warnings;
+    delete airspace_warnings_unbatched;
+  }
+
+  if (!warnings_equal)
+    printf("# batched airspace warnings differ\n");
 
-  result.result = true;
+  result.result = warnings_equal;
   return result;
 }
 
@@ -15,7 +15,16 @@ struct TestFlightComponents
   AircraftStateFilter *aircraft_filter;
   Airspaces *airspaces;
 
-  TestFlightComponents():aircraft_filter(NULL), airspaces(NULL) {}
+  /**
+   * Update a batched and an unbatched #AirspaceWarningManager in
+   * lockstep on every step and fail if their warnings differ
+   * (requires #airspaces).
+   */
+  bool compare_airspace_warnings;
+
+  TestFlightComponents()
+    :aircraft_filter(NULL), airspaces(NULL),
+     compare_airspace_warnings(false) {}
 };
 
 struct TestFlightResult
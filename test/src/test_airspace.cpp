@@ -13,6 +13,7 @@ test_airspace(const unsigned n_airspaces)
 {
   TestFlightComponents components;
   components.airspaces = new Airspaces;
+  components.compare_airspace_warnings = true;
   setup_airspaces(*components.airspaces, GeoPoint(Angle::Degrees(0.5), Angle::Degrees(0.5)), n_airspaces);
   bool fine = test_flight(components, 4, 0);
   delete components.airspaces;
@@ -7,6 +7,7 @@
 #include "TestUtil.hpp"
 #include "Route/TerrainRoute.hpp"
 #include "Route/ReachFan.hpp"
+#include "Route/FlatTriangleFanVisitor.hpp"
 #include "Engine/Route/ReachResult.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Terrain/Loader.hpp"
@@ -15,16 +16,47 @@
 #include "GlideSolvers/GlideSettings.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
 #include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
 #include "Operation/Operation.hpp"
+#include "thread/ThreadPool.hpp"
+#include "Geo/GeoBounds.hpp"
 #include "system/FileUtil.hpp"
 #include "util/PrintException.hxx"
 
 #include <zzip/zzip.h>
 
+#include <chrono>
+#include <vector>
+
 #include <string.h>
 
+/**
+ * Collects all fans of a #ReachFan.
+ */
+struct FanCollector final : FlatTriangleFanVisitor {
+  std::vector<std::vector<FlatGeoPoint>> fans;
+
+  void VisitFan(FlatGeoPoint origin,
+                std::span<const FlatGeoPoint> fan) noexcept override {
+    auto &v = fans.emplace_back(fan.begin(), fan.end());
+    v.push_back(origin);
+  }
+};
+
+[[gnu::pure]]
+static bool
+IsEqual(const ReachFan &a, const ReachFan &b, const GeoBounds &bounds)
+{
+  FanCollector fa, fb;
+  a.AcceptInRange(bounds, fa);
+  b.AcceptInRange(bounds, fb);
+  return !fa.fans.empty() && fa.fans == fb.fans &&
+    a.GetTerrainBase() == b.GetTerrainBase();
+}
+
 static void
-test_reach(const RasterMap &map, double mwind, double mc, double height_min_working)
+test_reach(const RasterMap &map, ThreadPool &thread_pool,
+           double mwind, double mc, double height_min_working)
 {
   GlideSettings settings;
   settings.SetDefaults();
@@ -46,6 +78,12 @@ test_reach(const RasterMap &map, double mwind, double mc, double height_min_work
                                               true, false);
   PrintHelper::print(reach_terrain);
 
+  /* the parallel calculation must find the same reach */
+  ReachFan parallel;
+  parallel.Solve(aorigin, route.GetReachPolar(), &map, true, &thread_pool);
+  ok(IsEqual(reach_terrain, parallel, map.GetBounds()),
+     "parallel reach %.0f", height_min_working);
+
   const auto reach_working = route.SolveReach(aorigin, config, INT_MAX,
                                               true, true);
   PrintHelper::print(reach_working);
@@ -84,6 +122,86 @@ test_reach(const RasterMap &map, double mwind, double mc, double height_min_work
   //  printf("# pixel size %g\n", (double)pd);
 }
 
+/**
+ * Fly a synthetic flight of glides and thermals over the map, update
+ * the reach every 5 seconds like RouteComputer does, and compare it
+ * with a reach which is calculated from scratch each time.
+ */
+static void
+test_flight(const RasterMap &map)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+
+  GlidePolar polar(1);
+  TerrainRoute route, fresh_route;
+  route.UpdatePolar(settings, config, polar, polar, SpeedVector::Zero(), 0);
+  route.SetTerrain(&map);
+  fresh_route.UpdatePolar(settings, config, polar, polar,
+                          SpeedVector::Zero(), 0);
+  fresh_route.SetTerrain(&map);
+
+  GeoPoint location = map.GetMapCenter();
+  double altitude = map.GetHeight(location).GetValueOr0() + 1500;
+  Angle heading = Angle::Zero();
+
+  ReachFan reach;
+  unsigned n_updates = 0;
+  bool conservative = true;
+
+  for (unsigned leg = 0; leg < 8; ++leg) {
+    /* glide for 5 minutes, then circle for 3 minutes */
+    for (unsigned t = 0; t < 480; t += 5) {
+      const bool circling = t >= 300;
+      if (circling) {
+        heading += Angle::Degrees(90);
+        location = GeoVector(100, heading).EndPoint(location);
+        altitude += 10;
+      } else {
+        location = GeoVector(175, heading).EndPoint(location);
+        altitude -= 5;
+      }
+
+      const AGeoPoint origin(location, altitude);
+      if (auto r = route.UpdateReach(reach, origin, config, INT_MAX,
+                                     true, false))
+        reach = std::move(*r);
+      ++n_updates;
+
+      const auto fresh = fresh_route.SolveReach(origin, config, INT_MAX,
+                                                true, false);
+
+      /* the reused reach must never promise more height than the
+         new one */
+      for (unsigned i = 0; i < 12; ++i) {
+        const GeoPoint p = GeoVector(5000, Angle::Degrees(30 * i))
+          .EndPoint(location);
+        const AGeoPoint dest(p, map.GetHeight(p).GetValueOr0());
+        const auto a = reach.FindPositiveArrival(dest, route.GetReachPolar());
+        const auto b = fresh.FindPositiveArrival(dest,
+                                                 fresh_route.GetReachPolar());
+        if (a && b && a->direct > b->direct + 1)
+          conservative = false;
+      }
+    }
+
+    heading += Angle::Degrees(70);
+  }
+
+  const auto &stats = route.GetReachStatistics();
+  const auto &fresh_stats = fresh_route.GetReachStatistics();
+  printf("# %u updates, %u solved, %u reused, %.1f ms (%.1f ms without reuse)\n",
+         n_updates, stats.solved, stats.reused,
+         std::chrono::duration<double, std::milli>(stats.solve_time).count(),
+         std::chrono::duration<double, std::milli>(fresh_stats.solve_time).count());
+
+  ok1(stats.solved + stats.reused == n_updates);
+  ok1(stats.reused > 0);
+  ok1(conservative);
+}
+
 int
 main(int argc, char **argv)
 try {
@@ -118,11 +236,14 @@ try {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(6);
-  test_reach(map, 0, 0.1, 0);
-  test_reach(map, 0, 0.1, 750);
-  test_reach(map, 0, 0.1, 500);
-  test_reach(map, 0, 0.1, 250);
+  ThreadPool thread_pool("Reach", 3);
+
+  plan_tests(4 + 3);
+  test_reach(map, thread_pool, 0, 0.1, 0);
+  test_reach(map, thread_pool, 0, 0.1, 750);
+  test_reach(map, thread_pool, 0, 0.1, 500);
+  test_reach(map, thread_pool, 0, 0.1, 250);
+  test_flight(map);
 
   return exit_status();
 } catch (const std::runtime_error &e) {